@@ -18,6 +18,7 @@
 #include "common/Platform.h"
 #include "utils/BackendBinding.h"
 #include "utils/TerribleCommandBuffer.h"
+#include "utils/WireCapture.h"
 
 #include <dawn/dawn.h>
 #include <dawn/dawncpp.h>
@@ -65,6 +66,8 @@ static dawn_wire::CommandHandler* wireServer = nullptr;
 static dawn_wire::CommandHandler* wireClient = nullptr;
 static utils::TerribleCommandBuffer* c2sBuf = nullptr;
 static utils::TerribleCommandBuffer* s2cBuf = nullptr;
+static const char* capturePath = nullptr;
+static utils::WireCaptureSerializer* c2sCapture = nullptr;
 
 dawn::Device CreateCppDawnDevice() {
     binding = utils::CreateBinding(backendType);
@@ -104,9 +107,19 @@ dawn::Device CreateCppDawnDevice() {
                 wireServer = dawn_wire::NewServerCommandHandler(backendDevice, backendProcs, s2cBuf);
                 c2sBuf->SetHandler(wireServer);
 
+                dawn_wire::CommandSerializer* clientSerializer = c2sBuf;
+                if (capturePath != nullptr) {
+                    c2sCapture = new utils::WireCaptureSerializer(c2sBuf, capturePath);
+                    if (!c2sCapture->IsOpen()) {
+                        fprintf(stderr, "Couldn't open %s to capture the wire commands\n", capturePath);
+                        return dawn::Device();
+                    }
+                    clientSerializer = c2sCapture;
+                }
+
                 dawnDevice clientDevice;
                 dawnProcTable clientProcs;
-                wireClient = dawn_wire::NewClientDevice(&clientProcs, &clientDevice, c2sBuf);
+                wireClient = dawn_wire::NewClientDevice(&clientProcs, &clientDevice, clientSerializer);
                 s2cBuf->SetHandler(wireClient);
 
                 procs = clientProcs;
@@ -203,10 +216,20 @@ bool InitSample(int argc, const char** argv) {
             fprintf(stderr, "--command-buffer expects a command buffer name (none, terrible)\n");
             return false;
         }
+        if (std::string("--capture") == argv[i]) {
+            i++;
+            if (i < argc) {
+                capturePath = argv[i];
+                continue;
+            }
+            fprintf(stderr, "--capture expects a file name\n");
+            return false;
+        }
         if (std::string("-h") == argv[i] || std::string("--help") == argv[i]) {
-            printf("Usage: %s [-b BACKEND] [-c COMMAND_BUFFER]\n", argv[0]);
+            printf("Usage: %s [-b BACKEND] [-c COMMAND_BUFFER] [--capture FILE]\n", argv[0]);
             printf("  BACKEND is one of: d3d12, metal, null, opengl, vulkan\n");
             printf("  COMMAND_BUFFER is one of: none, terrible\n");
+            printf("  FILE receives the wire commands, to be replayed with dawn_wire_replay\n");
             return false;
         }
     }
@@ -215,7 +238,8 @@ bool InitSample(int argc, const char** argv) {
 
 void DoFlush() {
     if (cmdBufType == CmdBufType::Terrible) {
-        bool c2sSuccess = c2sBuf->Flush();
+        // Each flush is a frame for the replay of the capture.
+        bool c2sSuccess = c2sCapture != nullptr ? c2sCapture->EndFrame() : c2sBuf->Flush();
         bool s2cSuccess = s2cBuf->Flush();
 
         ASSERT(c2sSuccess && s2cSuccess);
@@ -111,8 +111,13 @@ class StructureType(Type):
 ############################################################
 import json
 
+# Native methods are implemented manually by the wire: the ones using natively defined types like
+# callbacks, and the ones returning a value that isn't an object since the client can't wait for
+# the answer of the server.
 def is_native_method(method):
     return method.return_type.category == "natively defined" or \
+        (method.return_type.category == "native" and
+         method.return_type.name.canonical_case() != "void") or \
         any([arg.type.category == "natively defined" for arg in method.arguments])
 
 def link_object(obj, types):
@@ -391,7 +396,14 @@ def js_native_methods(types, typ):
 def debug(text):
     print(text)
 
-def get_renders_for_targets(api_params, targets):
+def is_byte_sized_enum(typ):
+    return typ.category == 'enum' and all([value.value < 256 for value in typ.values])
+
+def is_raw_compact_array(member):
+    # Arrays of these types are copied as-is by the compact wire encoding.
+    return member.type.category == 'native' and member.type.name.canonical_case() != 'bool'
+
+def get_renders_for_targets(api_params, targets, generator_options):
     base_params = {
         'enumerate': enumerate,
         'format': format,
@@ -455,7 +467,10 @@ def get_renders_for_targets(api_params, targets):
             api_params,
             c_params,
             {
-                'as_wireType': lambda typ: typ.name.CamelCase() + '*' if typ.category == 'object' else as_cppType(typ.name)
+                'as_wireType': lambda typ: typ.name.CamelCase() + '*' if typ.category == 'object' else as_cppType(typ.name),
+                'is_byte_sized_enum': is_byte_sized_enum,
+                'is_raw_compact_array': is_raw_compact_array,
+                'wire_compact_encoding': generator_options.wire_compact_encoding,
             }
         ]
         renders.append(FileRender('dawn_wire/WireCmd.h', 'dawn_wire/WireCmd_autogen.h', wire_params))
@@ -497,6 +512,7 @@ def main():
     parser.add_argument('json', metavar='DAWN_JSON', nargs=1, type=str, help ='The DAWN JSON definition to use.')
     parser.add_argument('-t', '--template-dir', default='templates', type=str, help='Directory with template files.')
     parser.add_argument('-T', '--targets', required=True, type=str, help='Comma-separated subset of targets to output. Available targets: ' + ', '.join(allowed_targets))
+    parser.add_argument('--wire-compact-encoding', action='store_true', help='Also generate the compact variable-length encoding for the dawn_wire commands')
     # Arguments used only for the GN build
     parser.add_argument(kExtraPythonPath, default=None, type=str, help='Additional python path to set before loading Jinja2')
     parser.add_argument('--output-json-tarball', default=None, type=str, help='Name of the "JSON tarball" to create (tar is too annoying to use in python).')
@@ -515,7 +531,7 @@ def main():
     api_params = parse_json(loaded_json)
 
     targets = args.targets.split(',')
-    renders = get_renders_for_targets(api_params, targets)
+    renders = get_renders_for_targets(api_params, targets, args)
 
     # Print outputs and dependencies for CMake
     if args.print_dependencies:
@@ -19,6 +19,8 @@
 #include "dawn_native/ErrorData.h"
 #include "dawn_native/ValidationUtils_autogen.h"
 
+#include <mutex>
+
 {% for type in by_category["object"] %}
     {% if not type.is_builder and type.name.canonical_case() not in ["buffer view", "texture view"] %}
         #include "dawn_native/{{type.name.CamelCase()}}.h"
@@ -33,9 +35,31 @@ namespace dawn_native {
             "CommandBufferBuilderGetResult",
         ) %}
 
+        //* Entry points that don't lock the device mutex: the device can't be locked while it
+        //* deletes itself, and command buffers are recorded without the lock so that independent
+        //* builders can be used in parallel.
+        {% set methodsWithoutDeviceLock = (
+            "DeviceReference",
+            "DeviceRelease",
+        ) %}
+
+        //* The command buffer builder methods that lock the device mutex. Releasing a builder can
+        //* destroy the objects its commands reference, and GetResult creates the command buffer or
+        //* reports the error on the device.
+        {% set commandBufferBuilderMethodsWithDeviceLock = (
+            "CommandBufferBuilderReference",
+            "CommandBufferBuilderRelease",
+            "CommandBufferBuilderGetResult",
+        ) %}
+
         {% for type in by_category["object"] %}
             {% for method in native_methods(type) %}
                 {% set suffix = as_MethodSuffix(type.name, method.name) %}
+                {% if type.name.canonical_case() == "command buffer builder" %}
+                    {% set locksDevice = suffix in commandBufferBuilderMethodsWithDeviceLock %}
+                {% else %}
+                    {% set locksDevice = suffix not in methodsWithoutDeviceLock %}
+                {% endif %}
 
                 //* Autogenerated part of the entry point validation
                 //*  - Check that enum and bitmaks are in the correct range
@@ -87,6 +111,10 @@ namespace dawn_native {
                         , {{as_annotated_frontendType(arg)}}
                     {%- endfor -%}
                 ) {
+                    {% if locksDevice %}
+                        std::lock_guard<std::recursive_mutex> lock(self->GetDevice()->GetMutex());
+                    {% endif %}
+
                     //* Do the autogenerated checks
                     bool valid = ValidateBase{{suffix}}(self
                         {%- for arg in method.arguments -%}
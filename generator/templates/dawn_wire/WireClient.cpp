@@ -14,14 +14,23 @@
 
 #include "dawn_wire/Wire.h"
 #include "dawn_wire/WireCmd.h"
+#include "dawn_wire/WireStatistics.h"
 
 #include "common/Assert.h"
 
+#include <atomic>
+#include <condition_variable>
 #include <cstring>
 #include <cstdlib>
+#include <deque>
+#include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <new>
 #include <string>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
 namespace dawn_wire {
@@ -68,6 +77,7 @@ namespace dawn_wire {
         {% set special_objects = [
             "device",
             "buffer",
+            "fence",
         ] %}
         {% for type in by_category["object"] if not type.name.canonical_case() in special_objects %}
             struct {{type.name.CamelCase()}} : ObjectBase {
@@ -108,6 +118,8 @@ namespace dawn_wire {
                 dawnCallbackUserdata userdata = 0;
                 uint32_t size = 0;
                 bool isWrite = false;
+                //* Only set when the wire statistics are enabled, to measure the latency of the reply.
+                uint64_t requestTime = 0;
             };
             std::map<uint32_t, MapRequestData> requests;
             uint32_t requestSerial = 0;
@@ -118,77 +130,149 @@ namespace dawn_wire {
             bool isWriteMapped = false;
         };
 
+        struct Fence : ObjectBase {
+            using ObjectBase::ObjectBase;
+
+            ~Fence() {
+                //* Callbacks need to be fired in all cases, as they can handle freeing resources
+                //* so we call them with "Unknown" status.
+                for (auto& request : requests) {
+                    request.second.completionCallback(DAWN_FENCE_COMPLETION_STATUS_UNKNOWN,
+                                                      request.second.userdata);
+                }
+                requests.clear();
+            }
+
+            void CheckPassedFences() {
+                //* The requests are taken out first because the callbacks can make new ones.
+                std::vector<OnCompletionData> completedRequests;
+                auto end = requests.upper_bound(completedValue);
+                for (auto it = requests.begin(); it != end; ++it) {
+                    completedRequests.push_back(it->second);
+                }
+                requests.erase(requests.begin(), end);
+
+                for (const OnCompletionData& request : completedRequests) {
+                    request.completionCallback(DAWN_FENCE_COMPLETION_STATUS_SUCCESS, request.userdata);
+                }
+            }
+
+            //* The values are tracked on the client so that OnCompletion can be validated and
+            //* GetCompletedValue answered without a round-trip to the server.
+            struct OnCompletionData {
+                dawnFenceOnCompletionCallback completionCallback = nullptr;
+                dawnCallbackUserdata userdata = 0;
+            };
+            Queue* queue = nullptr;
+            uint64_t signaledValue = 0;
+            uint64_t completedValue = 0;
+            std::multimap<uint64_t, OnCompletionData> requests;
+        };
+
         //* TODO(cwallez@chromium.org): Do something with objects before they are destroyed ?
         //*  - Call still uncalled builder callbacks
         template<typename T>
         class ObjectAllocator {
             public:
                 struct ObjectAndSerial {
-                    ObjectAndSerial(std::unique_ptr<T> object, uint32_t serial)
-                        : object(std::move(object)), serial(serial) {
-                    }
-                    std::unique_ptr<T> object;
+                    T* object;
                     uint32_t serial;
                 };
 
                 ObjectAllocator(Device* device) : mDevice(device) {
                     // ID 0 is nullptr
-                    mObjects.emplace_back(nullptr, 0);
+                    GetSlot(mCurrentId++)->serial = 0;
                 }
 
-                ObjectAndSerial* New() {
-                    uint32_t id = GetNewId();
-                    T* result = new T(mDevice, 1, id);
-                    auto object = std::unique_ptr<T>(result);
+                ~ObjectAllocator() {
+                    for (uint32_t id = 1; id < mCurrentId; ++id) {
+                        Slot* slot = GetSlot(id);
+                        if (slot->alive) {
+                            slot->GetObject()->~T();
+                        }
+                    }
+                }
 
-                    if (id >= mObjects.size()) {
-                        ASSERT(id == mObjects.size());
-                        mObjects.emplace_back(std::move(object), 0);
-                    } else {
-                        ASSERT(mObjects[id].object == nullptr);
+                ObjectAndSerial New() {
+                    uint32_t id;
+                    Slot* slot;
+                    if (mFreeListHead != 0) {
+                        id = mFreeListHead;
+                        slot = GetSlot(id);
+                        ASSERT(!slot->alive);
+                        mFreeListHead = slot->nextFree;
                         //* TODO(cwallez@chromium.org): investigate if overflows could cause bad things to happen
-                        mObjects[id].serial++;
-                        mObjects[id].object = std::move(object);
+                        slot->serial++;
+                    } else {
+                        id = mCurrentId++;
+                        slot = GetSlot(id);
                     }
 
-                    return &mObjects[id];
+                    new (&slot->storage) T(mDevice, 1, id);
+                    slot->alive = true;
+
+                    return {slot->GetObject(), slot->serial};
                 }
                 void Free(T* obj) {
-                    FreeId(obj->id);
-                    mObjects[obj->id].object = nullptr;
+                    uint32_t id = obj->id;
+                    Slot* slot = GetSlot(id);
+                    ASSERT(slot->alive && slot->GetObject() == obj);
+
+                    //* Destroy the object before putting its ID in the free list in case its
+                    //* destructor calls back into the allocator.
+                    obj->~T();
+                    slot->alive = false;
+                    slot->nextFree = mFreeListHead;
+                    mFreeListHead = id;
                 }
 
                 T* GetObject(uint32_t id) {
-                    if (id >= mObjects.size()) {
+                    if (id >= mCurrentId) {
                         return nullptr;
                     }
-                    return mObjects[id].object.get();
+                    Slot* slot = GetSlot(id);
+                    return slot->alive ? slot->GetObject() : nullptr;
                 }
 
                 uint32_t GetSerial(uint32_t id) {
-                    if (id >= mObjects.size()) {
+                    if (id >= mCurrentId) {
                         return 0;
                     }
-                    return mObjects[id].serial;
+                    return GetSlot(id)->serial;
                 }
 
             private:
-                uint32_t GetNewId() {
-                    if (mFreeIds.empty()) {
-                        return mCurrentId ++;
+                //* Objects are stored in slabs of slots indexed directly by ID. Slabs are never
+                //* reallocated so that pointers to the objects stay valid. Free slots form an
+                //* intrusive linked list.
+                static constexpr uint32_t kSlabSize = 256;
+
+                struct Slot {
+                    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+                    uint32_t serial = 0;
+                    //* The next ID in the free list, 0 for the end of the list.
+                    uint32_t nextFree = 0;
+                    bool alive = false;
+
+                    T* GetObject() {
+                        return reinterpret_cast<T*>(&storage);
                     }
-                    uint32_t id = mFreeIds.back();
-                    mFreeIds.pop_back();
-                    return id;
-                }
-                void FreeId(uint32_t id) {
-                    mFreeIds.push_back(id);
+                };
+
+                //* Returns the slot for the ID, allocating its slab if needed.
+                Slot* GetSlot(uint32_t id) {
+                    uint32_t slab = id / kSlabSize;
+                    if (slab >= mSlabs.size()) {
+                        ASSERT(slab == mSlabs.size());
+                        mSlabs.emplace_back(new Slot[kSlabSize]);
+                    }
+                    return &mSlabs[slab][id % kSlabSize];
                 }
 
                 // 0 is an ID reserved to represent nullptr
-                uint32_t mCurrentId = 1;
-                std::vector<uint32_t> mFreeIds;
-                std::vector<ObjectAndSerial> mObjects;
+                uint32_t mCurrentId = 0;
+                uint32_t mFreeListHead = 0;
+                std::vector<std::unique_ptr<Slot[]>> mSlabs;
                 Device* mDevice;
         };
 
@@ -196,16 +280,92 @@ namespace dawn_wire {
         //* and the object id allocators.
         class Device : public ObjectBase, public ObjectIdProvider {
             public:
-                Device(CommandSerializer* serializer)
+                Device(CommandSerializer* serializer, const ClientOptions& options)
                     : ObjectBase(this, 1, 1),
                     {% for type in by_category["object"] if not type.name.canonical_case() == "device" %}
                         {{type.name.camelCase()}}(this),
                     {% endfor %}
-                    mSerializer(serializer) {
+                    mSerializer(serializer),
+                    mFlowControlWindow(options.flowControlWindowBytes),
+                    mFlowControlBlocks(options.flowControlBlocks && options.replyThread) {
+                    if (mFlowControlWindow != 0) {
+                        mSendLimit = mFlowControlWindow;
+                    }
                 }
 
+                //* Commands are written in the space reserved from the serializer when possible, so
+                //* that there is only a call to the serializer when the reservation is exhausted
+                //* or when the commands would go over the flow control window.
                 void* GetCmdSpace(size_t size) {
-                    return mSerializer->GetCmdSpace(size);
+                    if (size <= static_cast<size_t>(mReservation->end - mReservation->cursor) &&
+                        mBytesSerialized + size <= mSendLimit) {
+                        mBytesSerialized += size;
+                        char* space = mReservation->cursor;
+                        mReservation->cursor += size;
+                        return space;
+                    }
+                    return GetCmdSpaceSlow(size);
+                }
+
+                //* Objects of the same type released one after the other share a destroy command
+                //* as long as it is the last thing written in the reservation, so that tearing
+                //* down many objects doesn't send a command for each of them.
+                template <typename Cmd>
+                void SerializeDestroy(ObjectId objectId) {
+                    const WireCmd commandId = Cmd().commandId;
+
+                    if (mOpenDestroyCount != nullptr && mOpenDestroyCommand == commandId &&
+                        mReservation->cursor == mOpenDestroyEnd &&
+                        sizeof(ObjectId) <= static_cast<size_t>(mReservation->end - mReservation->cursor) &&
+                        mBytesSerialized + sizeof(ObjectId) <= mSendLimit) {
+                        memcpy(mReservation->cursor, &objectId, sizeof(ObjectId));
+                        mReservation->cursor += sizeof(ObjectId);
+                        mBytesSerialized += sizeof(ObjectId);
+                        mOpenDestroyEnd = mReservation->cursor;
+                        (*mOpenDestroyCount)++;
+                        RecordClientCommandBytes(commandId, sizeof(ObjectId));
+                        return;
+                    }
+
+                    Cmd cmd;
+                    cmd.objectCount = 1;
+
+                    size_t requiredSize = sizeof(cmd) + sizeof(ObjectId);
+                    char* allocatedBuffer = static_cast<char*>(GetCmdSpace(requiredSize));
+                    memcpy(allocatedBuffer, &cmd, sizeof(cmd));
+                    memcpy(allocatedBuffer + sizeof(cmd), &objectId, sizeof(ObjectId));
+                    RecordClientCommand(commandId, requiredSize);
+
+                    mOpenDestroyCommand = commandId;
+                    mOpenDestroyCount = &reinterpret_cast<Cmd*>(allocatedBuffer)->objectCount;
+                    mOpenDestroyEnd = allocatedBuffer + requiredSize;
+                }
+
+                //* Called with the credit from the server, on the thread receiving the replies.
+                void OnBytesConsumed(uint64_t bytesConsumed) {
+                    {
+                        std::lock_guard<std::mutex> lock(mFlowControlMutex);
+                        mBytesConsumed.store(bytesConsumed, std::memory_order_release);
+                    }
+                    mFlowControlCondition.notify_all();
+                }
+
+                //* Unblocks the client for good when no credit can be received anymore.
+                void StopFlowControl() {
+                    {
+                        std::lock_guard<std::mutex> lock(mFlowControlMutex);
+                        mFlowControlStopped = true;
+                    }
+                    mFlowControlCondition.notify_all();
+                }
+
+                uint64_t GetInFlightBytes() const {
+                    uint64_t consumed = mBytesConsumed.load(std::memory_order_acquire);
+                    return mBytesSerialized > consumed ? mBytesSerialized - consumed : 0;
+                }
+
+                bool WouldBlock() const {
+                    return mFlowControlWindow != 0 && GetInFlightBytes() >= mFlowControlWindow;
                 }
 
                 {% for type in by_category["object"] if not type.name.canonical_case() == "device" %}
@@ -229,7 +389,78 @@ namespace dawn_wire {
                 dawnCallbackUserdata errorUserdata;
 
             private:
-               CommandSerializer* mSerializer = nullptr;
+                void* GetCmdSpaceSlow(size_t size) {
+                    //* A new reservation can start where the previous one ended, the open destroy
+                    //* command must not be extended in it.
+                    mOpenDestroyCount = nullptr;
+
+                    if (mFlowControlWindow != 0) {
+                        WaitForCredit(size);
+                    }
+                    mBytesSerialized += size;
+
+                    //* Without blocking, commands over the window still use the reservation.
+                    if (size <= static_cast<size_t>(mReservation->end - mReservation->cursor)) {
+                        char* space = mReservation->cursor;
+                        mReservation->cursor += size;
+                        return space;
+                    }
+
+                    CommandSpaceReservation* reservation = mSerializer->ReserveCmdSpace(size);
+                    if (reservation == nullptr) {
+                        mReservation = &mNoReservation;
+                        return mSerializer->GetCmdSpace(size);
+                    }
+
+                    mReservation = reservation;
+                    ASSERT(size <= static_cast<size_t>(mReservation->end - mReservation->cursor));
+                    char* space = mReservation->cursor;
+                    mReservation->cursor += size;
+                    return space;
+                }
+
+                bool HasCredit(size_t size) const {
+                    uint64_t inFlight = GetInFlightBytes();
+                    //* A command larger than the window is sent once all the others are consumed.
+                    return inFlight == 0 || inFlight + size <= mFlowControlWindow;
+                }
+
+                void WaitForCredit(size_t size) {
+                    if (mFlowControlBlocks && !HasCredit(size)) {
+                        //* The server can only consume the commands once they are flushed.
+                        mSerializer->Flush();
+
+                        std::unique_lock<std::mutex> lock(mFlowControlMutex);
+                        mFlowControlCondition.wait(lock, [&]() {
+                            return mFlowControlStopped || HasCredit(size);
+                        });
+                    }
+
+                    mSendLimit = mBytesConsumed.load(std::memory_order_acquire) + mFlowControlWindow;
+                }
+
+                CommandSerializer* mSerializer = nullptr;
+
+                //* The reservation is owned by the serializer, that can end it at any time.
+                CommandSpaceReservation mNoReservation;
+                CommandSpaceReservation* mReservation = &mNoReservation;
+
+                //* The last destroy command, that can be extended while the cursor of the
+                //* reservation is still at mOpenDestroyEnd.
+                WireCmd mOpenDestroyCommand;
+                uint32_t* mOpenDestroyCount = nullptr;
+                char* mOpenDestroyEnd = nullptr;
+
+                //* Flow control. The commands can be written without checking the credit until
+                //* mBytesSerialized reaches mSendLimit, which never happens when it is disabled.
+                uint64_t mFlowControlWindow = 0;
+                bool mFlowControlBlocks = false;
+                uint64_t mBytesSerialized = 0;
+                uint64_t mSendLimit = std::numeric_limits<uint64_t>::max();
+                std::atomic<uint64_t> mBytesConsumed{0};
+                std::mutex mFlowControlMutex;
+                std::condition_variable mFlowControlCondition;
+                bool mFlowControlStopped = false;
         };
 
         //* Implementation of the client API functions.
@@ -255,18 +486,18 @@ namespace dawn_wire {
 
                     //* For object creation, store the object ID the client will use for the result.
                     {% if method.return_type.category == "object" %}
-                        auto* allocation = self->device->{{method.return_type.name.camelCase()}}.New();
+                        auto allocation = self->device->{{method.return_type.name.camelCase()}}.New();
 
                         {% if type.is_builder %}
                             //* We are in GetResult, so the callback that should be called is the
                             //* currently set one. Copy it over to the created object and prevent the
                             //* builder from calling the callback on destruction.
-                            allocation->object->builderCallback = self->builderCallback;
+                            allocation.object->builderCallback = self->builderCallback;
                             self->builderCallback.canCall = false;
                         {% endif %}
 
-                        cmd.resultId = allocation->object->id;
-                        cmd.resultSerial = allocation->serial;
+                        cmd.resultId = allocation.object->id;
+                        cmd.resultSerial = allocation.serial;
                     {% endif %}
 
                     {% for arg in method.arguments %}
@@ -277,9 +508,10 @@ namespace dawn_wire {
                     size_t requiredSize = cmd.GetRequiredSize();
                     char* allocatedBuffer = static_cast<char*>(device->GetCmdSpace(requiredSize));
                     cmd.Serialize(allocatedBuffer, *device);
+                    RecordClientCommand(WireCmd::{{Suffix}}, requiredSize);
 
                     {% if method.return_type.category == "object" %}
-                        return allocation->object.get();
+                        return allocation.object;
                     {% endif %}
                 }
             {% endfor %}
@@ -306,12 +538,9 @@ namespace dawn_wire {
 
                     obj->builderCallback.Call(DAWN_BUILDER_ERROR_STATUS_UNKNOWN, "Unknown");
 
-                    {{as_MethodSuffix(type.name, Name("destroy"))}}Cmd cmd;
-                    cmd.objectId = obj->id;
-
-                    auto allocCmd = static_cast<decltype(cmd)*>(obj->device->GetCmdSpace(sizeof(cmd)));
-                    *allocCmd = cmd;
-
+                    //* The destroy command is written before the ID goes back to the free list
+                    //* so that it always precedes the creation of an object reusing the ID.
+                    obj->device->SerializeDestroy<{{as_MethodSuffix(type.name, Name("destroy"))}}Cmd>(obj->id);
                     obj->device->{{type.name.camelCase()}}.Free(obj);
                 }
 
@@ -330,6 +559,7 @@ namespace dawn_wire {
             request.userdata = userdata;
             request.size = size;
             request.isWrite = false;
+            request.requestTime = GetStatisticsTimestamp();
             buffer->requests[serial] = request;
 
             BufferMapAsyncCmd cmd;
@@ -341,6 +571,8 @@ namespace dawn_wire {
 
             auto allocCmd = static_cast<decltype(cmd)*>(buffer->device->GetCmdSpace(sizeof(cmd)));
             *allocCmd = cmd;
+            RecordClientCommand(WireCmd::BufferMapAsync, sizeof(cmd));
+            RecordMapRequest();
         }
 
         void ClientBufferMapWriteAsync(Buffer* buffer, uint32_t start, uint32_t size, dawnBufferMapWriteCallback callback, dawnCallbackUserdata userdata) {
@@ -352,6 +584,7 @@ namespace dawn_wire {
             request.userdata = userdata;
             request.size = size;
             request.isWrite = true;
+            request.requestTime = GetStatisticsTimestamp();
             buffer->requests[serial] = request;
 
             BufferMapAsyncCmd cmd;
@@ -363,6 +596,8 @@ namespace dawn_wire {
 
             auto allocCmd = static_cast<decltype(cmd)*>(buffer->device->GetCmdSpace(sizeof(cmd)));
             *allocCmd = cmd;
+            RecordClientCommand(WireCmd::BufferMapAsync, sizeof(cmd));
+            RecordMapRequest();
         }
 
         void ProxyClientBufferUnmap(dawnBuffer cBuffer) {
@@ -383,11 +618,12 @@ namespace dawn_wire {
                     cmd.bufferId = buffer->id;
                     cmd.dataLength = static_cast<uint32_t>(buffer->mappedDataSize);
 
-                    auto allocCmd = static_cast<decltype(cmd)*>(buffer->device->GetCmdSpace(sizeof(cmd)));
-                    *allocCmd = cmd;
-
-                    void* dataAlloc = buffer->device->GetCmdSpace(cmd.dataLength);
-                    memcpy(dataAlloc, buffer->mappedData, cmd.dataLength);
+                    //* The command and its data are allocated together so that the serializer
+                    //* can't be flushed, or the flow control block, between the two.
+                    char* allocatedBuffer = static_cast<char*>(buffer->device->GetCmdSpace(sizeof(cmd) + cmd.dataLength));
+                    memcpy(allocatedBuffer, &cmd, sizeof(cmd));
+                    memcpy(allocatedBuffer + sizeof(cmd), buffer->mappedData, cmd.dataLength);
+                    RecordClientCommand(WireCmd::BufferUpdateMappedDataCmd, sizeof(cmd) + cmd.dataLength);
                 }
 
                 free(buffer->mappedData);
@@ -398,6 +634,49 @@ namespace dawn_wire {
             ClientBufferUnmap(cBuffer);
         }
 
+        dawnFence ProxyClientQueueCreateFence(dawnQueue cSelf, const dawnFenceDescriptor* descriptor) {
+            Fence* fence = ClientQueueCreateFence(cSelf, descriptor);
+            fence->queue = reinterpret_cast<Queue*>(cSelf);
+            fence->signaledValue = descriptor->initialValue;
+            fence->completedValue = descriptor->initialValue;
+            return reinterpret_cast<dawnFence>(fence);
+        }
+
+        void ProxyClientQueueSignal(dawnQueue cQueue, dawnFence cFence, uint64_t signalValue) {
+            Fence* fence = reinterpret_cast<Fence*>(cFence);
+            Queue* queue = reinterpret_cast<Queue*>(cQueue);
+
+            //* Invalid signals are still sent so that the server produces the validation error,
+            //* but they don't change the value tracked on the client.
+            if (fence != nullptr && fence->queue == queue && signalValue > fence->signaledValue) {
+                fence->signaledValue = signalValue;
+            }
+
+            ClientQueueSignal(cQueue, cFence, signalValue);
+        }
+
+        uint64_t ClientFenceGetCompletedValue(Fence* fence) {
+            return fence->completedValue;
+        }
+
+        void ClientFenceOnCompletion(Fence* fence, uint64_t value, dawnFenceOnCompletionCallback callback, dawnCallbackUserdata userdata) {
+            if (value > fence->signaledValue) {
+                fence->device->HandleError("Value greater than fence signaled value");
+                callback(DAWN_FENCE_COMPLETION_STATUS_ERROR, userdata);
+                return;
+            }
+
+            if (value <= fence->completedValue) {
+                callback(DAWN_FENCE_COMPLETION_STATUS_SUCCESS, userdata);
+                return;
+            }
+
+            Fence::OnCompletionData request;
+            request.completionCallback = callback;
+            request.userdata = userdata;
+            fence->requests.emplace(value, request);
+        }
+
         void ClientDeviceReference(Device*) {
         }
 
@@ -414,7 +693,7 @@ namespace dawn_wire {
         //  - An autogenerated Client{{suffix}} method that sends the command on the wire
         //  - A manual ProxyClient{{suffix}} method that will be inserted in the proctable instead of
         //    the autogenerated one, and that will have to call Client{{suffix}}
-        {% set proxied_commands = ["BufferUnmap"] %}
+        {% set proxied_commands = ["BufferUnmap", "QueueCreateFence", "QueueSignal"] %}
 
         dawnProcTable GetProcs() {
             dawnProcTable table;
@@ -431,36 +710,51 @@ namespace dawn_wire {
             return table;
         }
 
-        class Client : public CommandHandler {
+        //* A reply of the server that was checked for size errors. Its variable-sized data is kept
+        //* in the buffer it was decoded from.
+        struct DecodedReply {
+            ReturnWireCmd commandId;
+            const void* cmd;
+            //* The message of error callbacks or the data of map read callbacks.
+            const char* extraData;
+        };
+
+        //* A batch of replies copied from the transport to be decoded on the reply thread.
+        struct ReplyBatch {
+            std::vector<char> commands;
+            std::vector<DecodedReply> replies;
+        };
+
+        class Client : public ClientCommandHandler {
             public:
-                Client(Device* device) : mDevice(device) {
+                Client(Device* device, const ClientOptions& options)
+                    : mDevice(device), mOptions(options) {
+                    if (mOptions.replyThread) {
+                        mReplyThread = std::thread([this]() { ReplyThreadLoop(); });
+                    }
                 }
 
-                const char* HandleCommands(const char* commands, size_t size) override {
-                    while (size >= sizeof(ReturnWireCmd)) {
-                        ReturnWireCmd cmdId = *reinterpret_cast<const ReturnWireCmd*>(commands);
+                ~Client() {
+                    mDevice->StopFlowControl();
 
-                        bool success = false;
-                        switch (cmdId) {
-                            case ReturnWireCmd::DeviceErrorCallback:
-                                success = HandleDeviceErrorCallbackCmd(&commands, &size);
-                                break;
-                            {% for type in by_category["object"] if type.is_builder %}
-                                case ReturnWireCmd::{{type.name.CamelCase()}}ErrorCallback:
-                                    success = Handle{{type.name.CamelCase()}}ErrorCallbackCmd(&commands, &size);
-                                    break;
-                            {% endfor %}
-                            case ReturnWireCmd::BufferMapReadAsyncCallback:
-                                success = HandleBufferMapReadAsyncCallback(&commands, &size);
-                                break;
-                            case ReturnWireCmd::BufferMapWriteAsyncCallback:
-                                success = HandleBufferMapWriteAsyncCallback(&commands, &size);
-                                break;
-                            default:
-                                success = false;
+                    if (mReplyThread.joinable()) {
+                        {
+                            std::lock_guard<std::mutex> lock(mReplyMutex);
+                            mStopReplyThread = true;
                         }
+                        mReplyCondition.notify_all();
+                        mReplyThread.join();
+                    }
+                }
 
-                        if (!success) {
+                const char* HandleCommands(const char* commands, size_t size) override {
+                    if (mOptions.replyThread) {
+                        return QueueCommands(commands, size);
+                    }
+
+                    while (size >= sizeof(ReturnWireCmd)) {
+                        DecodedReply reply;
+                        if (!DecodeReply(&commands, &size, &reply) || !ApplyReply(reply)) {
                             return nullptr;
                         }
                     }
@@ -472,20 +766,134 @@ namespace dawn_wire {
                     return commands;
                 }
 
+                bool DeliverCallbacks() override {
+                    if (!mOptions.replyThread) {
+                        return true;
+                    }
+
+                    std::deque<std::unique_ptr<ReplyBatch>> batches;
+                    bool decodeError;
+                    {
+                        std::unique_lock<std::mutex> lock(mReplyMutex);
+                        mReplyCondition.wait(lock, [this]() {
+                            return mReceivedBatches.empty() && !mDecodingBatch;
+                        });
+                        batches.swap(mDecodedBatches);
+                        decodeError = mReplyError;
+                    }
+
+                    //* The batches decoded before an error are still delivered.
+                    for (const auto& batch : batches) {
+                        for (const DecodedReply& reply : batch->replies) {
+                            if (!ApplyReply(reply)) {
+                                std::lock_guard<std::mutex> lock(mReplyMutex);
+                                mReplyError = true;
+                                return false;
+                            }
+                        }
+                    }
+
+                    return !decodeError;
+                }
+
+                uint64_t GetInFlightBytes() const override {
+                    return mDevice->GetInFlightBytes();
+                }
+
+                bool WouldBlock() const override {
+                    return mDevice->WouldBlock();
+                }
+
             private:
                 Device* mDevice = nullptr;
+                ClientOptions mOptions;
+
+                //* State shared between the thread receiving the replies, the reply thread and
+                //* the thread delivering the callbacks, protected by mReplyMutex.
+                std::thread mReplyThread;
+                std::mutex mReplyMutex;
+                std::condition_variable mReplyCondition;
+                std::deque<std::unique_ptr<ReplyBatch>> mReceivedBatches;
+                std::deque<std::unique_ptr<ReplyBatch>> mDecodedBatches;
+                bool mDecodingBatch = false;
+                bool mReplyError = false;
+                bool mStopReplyThread = false;
+
+                //* The reply buffer isn't valid after HandleCommands returns so it is copied for
+                //* the reply thread.
+                const char* QueueCommands(const char* commands, size_t size) {
+                    auto batch = std::make_unique<ReplyBatch>();
+                    batch->commands.assign(commands, commands + size);
+
+                    {
+                        std::lock_guard<std::mutex> lock(mReplyMutex);
+                        if (mReplyError) {
+                            return nullptr;
+                        }
+                        mReceivedBatches.push_back(std::move(batch));
+                    }
+                    mReplyCondition.notify_all();
+
+                    return commands + size;
+                }
+
+                void ReplyThreadLoop() {
+                    std::unique_lock<std::mutex> lock(mReplyMutex);
+                    while (true) {
+                        mReplyCondition.wait(lock, [this]() {
+                            return mStopReplyThread || !mReceivedBatches.empty();
+                        });
+                        if (mStopReplyThread) {
+                            return;
+                        }
+
+                        std::unique_ptr<ReplyBatch> batch = std::move(mReceivedBatches.front());
+                        mReceivedBatches.pop_front();
+                        mDecodingBatch = true;
+
+                        lock.unlock();
+                        const char* commands = batch->commands.data();
+                        size_t size = batch->commands.size();
+                        bool success = true;
+                        while (size >= sizeof(ReturnWireCmd)) {
+                            DecodedReply reply;
+                            if (!DecodeReply(&commands, &size, &reply)) {
+                                success = false;
+                                break;
+                            }
+
+                            //* Credits are applied right away since the application thread
+                            //* can be blocked until it receives them.
+                            if (reply.commandId == ReturnWireCmd::BytesConsumed) {
+                                ApplyReply(reply);
+                                continue;
+                            }
+                            batch->replies.push_back(reply);
+                        }
+                        success = success && size == 0;
+                        if (!success) {
+                            mDevice->StopFlowControl();
+                        }
+                        lock.lock();
+
+                        mDecodedBatches.push_back(std::move(batch));
+                        mDecodingBatch = false;
+                        mReplyError = mReplyError || !success;
+                        mReplyCondition.notify_all();
+                    }
+                }
 
                 //* Helper function for the getting of the command data in command handlers.
                 //* Checks there is enough data left, updates the buffer / size and returns
                 //* the command (or nullptr for an error).
                 template <typename T>
                 static const T* GetData(const char** buffer, size_t* size, size_t count) {
-                    // TODO(cwallez@chromium.org): Check for overflow
-                    size_t totalSize = count * sizeof(T);
-                    if (*size < totalSize) {
+                    if (count > *size / sizeof(T)) {
                         return nullptr;
                     }
 
+                    size_t totalSize = count * sizeof(T);
+
                     const T* data = reinterpret_cast<const T*>(*buffer);
 
                     *buffer += totalSize;
@@ -498,47 +906,120 @@ namespace dawn_wire {
                     return GetData<T>(commands, size, 1);
                 }
 
-                bool HandleDeviceErrorCallbackCmd(const char** commands, size_t* size) {
-                    const auto* cmd = GetCommand<ReturnDeviceErrorCallbackCmd>(commands, size);
+                //* Decoding only checks the replies are well-formed so that it doesn't touch the
+                //* client objects and can run on the reply thread.
+                static bool DecodeReply(const char** commands, size_t* size, DecodedReply* reply) {
+                    reply->commandId = *reinterpret_cast<const ReturnWireCmd*>(*commands);
+                    reply->extraData = nullptr;
+
+                    switch (reply->commandId) {
+                        case ReturnWireCmd::DeviceErrorCallback:
+                            return DecodeErrorCallback<ReturnDeviceErrorCallbackCmd>(commands, size, reply);
+                        {% for type in by_category["object"] if type.is_builder %}
+                            case ReturnWireCmd::{{type.name.CamelCase()}}ErrorCallback:
+                                return DecodeErrorCallback<Return{{type.name.CamelCase()}}ErrorCallbackCmd>(commands, size, reply);
+                        {% endfor %}
+                        case ReturnWireCmd::BufferMapReadAsyncCallback:
+                            return DecodeBufferMapReadAsyncCallback(commands, size, reply);
+                        case ReturnWireCmd::BufferMapWriteAsyncCallback:
+                            reply->cmd = GetCommand<ReturnBufferMapWriteAsyncCallbackCmd>(commands, size);
+                            return reply->cmd != nullptr;
+                        case ReturnWireCmd::FenceUpdateCompletedValue:
+                            reply->cmd = GetCommand<ReturnFenceUpdateCompletedValueCmd>(commands, size);
+                            return reply->cmd != nullptr;
+                        case ReturnWireCmd::BytesConsumed:
+                            reply->cmd = GetCommand<ReturnBytesConsumedCmd>(commands, size);
+                            return reply->cmd != nullptr;
+                        default:
+                            return false;
+                    }
+                }
+
+                template <typename T>
+                static bool DecodeErrorCallback(const char** commands, size_t* size, DecodedReply* reply) {
+                    const auto* cmd = GetCommand<T>(commands, size);
                     if (cmd == nullptr) {
                         return false;
                     }
 
+                    //* Check the length before adding the null terminator so that it can't wrap.
+                    if (cmd->messageStrlen >= *size) {
+                        return false;
+                    }
                     const char* message = GetData<char>(commands, size, cmd->messageStrlen + 1);
                     if (message == nullptr || message[cmd->messageStrlen] != '\0') {
                         return false;
                     }
 
-                    mDevice->HandleError(message);
-
+                    reply->cmd = cmd;
+                    reply->extraData = message;
                     return true;
                 }
 
-                {% for type in by_category["object"] if type.is_builder %}
-                    {% set Type = type.name.CamelCase() %}
-                    bool Handle{{Type}}ErrorCallbackCmd(const char** commands, size_t* size) {
-                        const auto* cmd = GetCommand<Return{{Type}}ErrorCallbackCmd>(commands, size);
-                        if (cmd == nullptr) {
+                static bool DecodeBufferMapReadAsyncCallback(const char** commands, size_t* size, DecodedReply* reply) {
+                    const auto* cmd = GetCommand<ReturnBufferMapReadAsyncCallbackCmd>(commands, size);
+                    if (cmd == nullptr) {
+                        return false;
+                    }
+
+                    //* Unconditionnally get the data from the buffer so that the correct amount of data is
+                    //* consumed from the buffer, even when we ignore the command and early out.
+                    if (cmd->status == DAWN_BUFFER_MAP_ASYNC_STATUS_SUCCESS) {
+                        reply->extraData = GetData<char>(commands, size, cmd->dataLength);
+                        if (reply->extraData == nullptr) {
                             return false;
                         }
+                    }
+
+                    reply->cmd = cmd;
+                    return true;
+                }
 
-                        const char* message = GetData<char>(commands, size, cmd->messageStrlen + 1);
-                        if (message == nullptr || message[cmd->messageStrlen] != '\0') {
+                bool ApplyReply(const DecodedReply& reply) {
+                    switch (reply.commandId) {
+                        case ReturnWireCmd::DeviceErrorCallback:
+                            mDevice->HandleError(reply.extraData);
+                            return true;
+                        {% for type in by_category["object"] if type.is_builder %}
+                            {% set Type = type.name.CamelCase() %}
+                            case ReturnWireCmd::{{Type}}ErrorCallback:
+                                return Handle{{Type}}ErrorCallback(
+                                    *static_cast<const Return{{Type}}ErrorCallbackCmd*>(reply.cmd), reply.extraData);
+                        {% endfor %}
+                        case ReturnWireCmd::BufferMapReadAsyncCallback:
+                            return HandleBufferMapReadAsyncCallback(
+                                *static_cast<const ReturnBufferMapReadAsyncCallbackCmd*>(reply.cmd), reply.extraData);
+                        case ReturnWireCmd::BufferMapWriteAsyncCallback:
+                            return HandleBufferMapWriteAsyncCallback(
+                                *static_cast<const ReturnBufferMapWriteAsyncCallbackCmd*>(reply.cmd));
+                        case ReturnWireCmd::FenceUpdateCompletedValue:
+                            return HandleFenceUpdateCompletedValue(
+                                *static_cast<const ReturnFenceUpdateCompletedValueCmd*>(reply.cmd));
+                        case ReturnWireCmd::BytesConsumed:
+                            mDevice->OnBytesConsumed(
+                                static_cast<const ReturnBytesConsumedCmd*>(reply.cmd)->bytesConsumed);
+                            return true;
+                        default:
+                            UNREACHABLE();
                             return false;
-                        }
+                    }
+                }
 
-                        auto* builtObject = mDevice->{{type.built_type.name.camelCase()}}.GetObject(cmd->builtObjectId);
-                        uint32_t objectSerial = mDevice->{{type.built_type.name.camelCase()}}.GetSerial(cmd->builtObjectId);
+                {% for type in by_category["object"] if type.is_builder %}
+                    {% set Type = type.name.CamelCase() %}
+                    bool Handle{{Type}}ErrorCallback(const Return{{Type}}ErrorCallbackCmd& cmd, const char* message) {
+                        auto* builtObject = mDevice->{{type.built_type.name.camelCase()}}.GetObject(cmd.builtObjectId);
+                        uint32_t objectSerial = mDevice->{{type.built_type.name.camelCase()}}.GetSerial(cmd.builtObjectId);
 
                         //* The object might have been deleted or a new object created with the same ID.
-                        if (builtObject == nullptr || objectSerial != cmd->builtObjectSerial) {
+                        if (builtObject == nullptr || objectSerial != cmd.builtObjectSerial) {
                             return true;
                         }
 
-                        bool called = builtObject->builderCallback.Call(static_cast<dawnBuilderErrorStatus>(cmd->status), message);
+                        bool called = builtObject->builderCallback.Call(static_cast<dawnBuilderErrorStatus>(cmd.status), message);
 
                         // Unhandled builder errors are forwarded to the device
-                        if (!called && cmd->status != DAWN_BUILDER_ERROR_STATUS_SUCCESS && cmd->status != DAWN_BUILDER_ERROR_STATUS_UNKNOWN) {
+                        if (!called && cmd.status != DAWN_BUILDER_ERROR_STATUS_SUCCESS && cmd.status != DAWN_BUILDER_ERROR_STATUS_UNKNOWN) {
                             mDevice->HandleError(("Unhandled builder error: " + std::string(message)).c_str());
                         }
 
@@ -546,32 +1027,17 @@ namespace dawn_wire {
                     }
                 {% endfor %}
 
-                bool HandleBufferMapReadAsyncCallback(const char** commands, size_t* size) {
-                    const auto* cmd = GetCommand<ReturnBufferMapReadAsyncCallbackCmd>(commands, size);
-                    if (cmd == nullptr) {
-                        return false;
-                    }
-
-                    //* Unconditionnally get the data from the buffer so that the correct amount of data is
-                    //* consumed from the buffer, even when we ignore the command and early out.
-                    const char* requestData = nullptr;
-                    if (cmd->status == DAWN_BUFFER_MAP_ASYNC_STATUS_SUCCESS) {
-                        requestData = GetData<char>(commands, size, cmd->dataLength);
-                        if (requestData == nullptr) {
-                            return false;
-                        }
-                    }
-
-                    auto* buffer = mDevice->buffer.GetObject(cmd->bufferId);
-                    uint32_t bufferSerial = mDevice->buffer.GetSerial(cmd->bufferId);
+                bool HandleBufferMapReadAsyncCallback(const ReturnBufferMapReadAsyncCallbackCmd& cmd, const char* requestData) {
+                    auto* buffer = mDevice->buffer.GetObject(cmd.bufferId);
+                    uint32_t bufferSerial = mDevice->buffer.GetSerial(cmd.bufferId);
 
                     //* The buffer might have been deleted or recreated so this isn't an error.
-                    if (buffer == nullptr || bufferSerial != cmd->bufferSerial) {
+                    if (buffer == nullptr || bufferSerial != cmd.bufferSerial) {
                         return true;
                     }
 
                     //* The requests can have been deleted via an Unmap so this isn't an error.
-                    auto requestIt = buffer->requests.find(cmd->requestSerial);
+                    auto requestIt = buffer->requests.find(cmd.requestSerial);
                     if (requestIt == buffer->requests.end()) {
                         return true;
                     }
@@ -585,12 +1051,13 @@ namespace dawn_wire {
                     //* Delete the request before calling the callback otherwise the callback could be fired a
                     //* second time. If, for example, buffer.Unmap() is called inside the callback.
                     buffer->requests.erase(requestIt);
+                    RecordMapReply(request.requestTime);
 
                     //* On success, we copy the data locally because the IPC buffer isn't valid outside of this function
-                    if (cmd->status == DAWN_BUFFER_MAP_ASYNC_STATUS_SUCCESS) {
+                    if (cmd.status == DAWN_BUFFER_MAP_ASYNC_STATUS_SUCCESS) {
                         //* The server didn't send the right amount of data, this is an error and could cause
                         //* the application to crash if we did call the callback.
-                        if (request.size != cmd->dataLength) {
+                        if (request.size != cmd.dataLength) {
                             return false;
                         }
 
@@ -605,30 +1072,25 @@ namespace dawn_wire {
                         buffer->mappedData = malloc(request.size);
                         memcpy(buffer->mappedData, requestData, request.size);
 
-                        request.readCallback(static_cast<dawnBufferMapAsyncStatus>(cmd->status), buffer->mappedData, request.userdata);
+                        request.readCallback(static_cast<dawnBufferMapAsyncStatus>(cmd.status), buffer->mappedData, request.userdata);
                     } else {
-                        request.readCallback(static_cast<dawnBufferMapAsyncStatus>(cmd->status), nullptr, request.userdata);
+                        request.readCallback(static_cast<dawnBufferMapAsyncStatus>(cmd.status), nullptr, request.userdata);
                     }
 
                     return true;
                 }
 
-                bool HandleBufferMapWriteAsyncCallback(const char** commands, size_t* size) {
-                    const auto* cmd = GetCommand<ReturnBufferMapWriteAsyncCallbackCmd>(commands, size);
-                    if (cmd == nullptr) {
-                        return false;
-                    }
-
-                    auto* buffer = mDevice->buffer.GetObject(cmd->bufferId);
-                    uint32_t bufferSerial = mDevice->buffer.GetSerial(cmd->bufferId);
+                bool HandleBufferMapWriteAsyncCallback(const ReturnBufferMapWriteAsyncCallbackCmd& cmd) {
+                    auto* buffer = mDevice->buffer.GetObject(cmd.bufferId);
+                    uint32_t bufferSerial = mDevice->buffer.GetSerial(cmd.bufferId);
 
                     //* The buffer might have been deleted or recreated so this isn't an error.
-                    if (buffer == nullptr || bufferSerial != cmd->bufferSerial) {
+                    if (buffer == nullptr || bufferSerial != cmd.bufferSerial) {
                         return true;
                     }
 
                     //* The requests can have been deleted via an Unmap so this isn't an error.
-                    auto requestIt = buffer->requests.find(cmd->requestSerial);
+                    auto requestIt = buffer->requests.find(cmd.requestSerial);
                     if (requestIt == buffer->requests.end()) {
                         return true;
                     }
@@ -641,9 +1103,10 @@ namespace dawn_wire {
                     auto request = requestIt->second;
                     //* Delete the request before calling the callback otherwise the callback could be fired a second time. If, for example, buffer.Unmap() is called inside the callback.
                     buffer->requests.erase(requestIt);
+                    RecordMapReply(request.requestTime);
 
                     //* On success, we copy the data locally because the IPC buffer isn't valid outside of this function
-                    if (cmd->status == DAWN_BUFFER_MAP_ASYNC_STATUS_SUCCESS) {
+                    if (cmd.status == DAWN_BUFFER_MAP_ASYNC_STATUS_SUCCESS) {
                         if (buffer->mappedData != nullptr) {
                             return false;
                         }
@@ -653,24 +1116,48 @@ namespace dawn_wire {
                         buffer->mappedData = malloc(request.size);
                         memset(buffer->mappedData, 0, request.size);
 
-                        request.writeCallback(static_cast<dawnBufferMapAsyncStatus>(cmd->status), buffer->mappedData, request.userdata);
+                        request.writeCallback(static_cast<dawnBufferMapAsyncStatus>(cmd.status), buffer->mappedData, request.userdata);
                     } else {
-                        request.writeCallback(static_cast<dawnBufferMapAsyncStatus>(cmd->status), nullptr, request.userdata);
+                        request.writeCallback(static_cast<dawnBufferMapAsyncStatus>(cmd.status), nullptr, request.userdata);
+                    }
+
+                    return true;
+                }
+
+                bool HandleFenceUpdateCompletedValue(const ReturnFenceUpdateCompletedValueCmd& cmd) {
+                    auto* fence = mDevice->fence.GetObject(cmd.fenceId);
+                    uint32_t fenceSerial = mDevice->fence.GetSerial(cmd.fenceId);
+
+                    //* The fence might have been deleted or recreated so this isn't an error.
+                    if (fence == nullptr || fenceSerial != cmd.fenceSerial) {
+                        return true;
+                    }
+
+                    //* The server only sends values that the client signaled.
+                    if (cmd.value > fence->signaledValue) {
+                        return false;
+                    }
+                    //* Values signaled on the same serial can complete out of order, in which case
+                    //* the smaller value is stale.
+                    if (cmd.value < fence->completedValue) {
+                        return true;
                     }
 
+                    fence->completedValue = cmd.value;
+                    fence->CheckPassedFences();
                     return true;
                 }
         };
 
     }
 
-    CommandHandler* NewClientDevice(dawnProcTable* procs, dawnDevice* device, CommandSerializer* serializer) {
-        auto clientDevice = new client::Device(serializer);
+    ClientCommandHandler* NewClientDevice(dawnProcTable* procs, dawnDevice* device, CommandSerializer* serializer, const ClientOptions& options) {
+        auto clientDevice = new client::Device(serializer, options);
 
         *device = reinterpret_cast<dawnDeviceImpl*>(clientDevice);
         *procs = client::GetProcs();
 
-        return new client::Client(clientDevice);
+        return new client::Client(clientDevice, options);
     }
 
 }  // namespace dawn_wire
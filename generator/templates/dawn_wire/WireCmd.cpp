@@ -17,6 +17,7 @@
 #include "common/Assert.h"
 
 #include <cstring>
+#include <limits>
 
 //* Helper macros so that the main [de]serialization functions can be written in a generic manner.
 
@@ -61,7 +62,7 @@
     {%- if member.type.category == "object" -%}
         DESERIALIZE_TRY(resolver.GetFromId({{in}}, &{{out}}));
     {% elif member.type.category == "structure"%}
-        DESERIALIZE_TRY({{as_cType(member.type.name)}}Deserialize(&{{out}}, &{{in}}, buffer, size, allocator, resolver));
+        DESERIALIZE_TRY({{as_cType(member.type.name)}}Deserialize(&{{out}}, &{{in}}, buffer, allocator, resolver));
     {%- else -%}
         {{out}} = {{in}};
     {%- endif -%}
@@ -184,15 +185,53 @@
         {% endfor %}
     }
 
-    //* Deserializes `transfer` into `record` getting more serialized data from `buffer` and `size`
-    //* if needed, using `allocator` to store pointed-to values and `resolver` to translate object
-    //* Ids to actual objects.
+    //* Computes in `extraSize` how many bytes of `buffer` are used by the data following
+    //* `transfer`. Returns FatalError if they don't fit in the `size` bytes of the buffer. Lengths
+    //* are known from the transfer structure, except for structure members that have their own
+    //* transfer structures in the buffer; these are only read once they are known to be in bounds.
+    DeserializeResult {{name}}GetExtraTransferSize(const {{name}}Transfer* transfer, const char* buffer,
+                                                   size_t size, size_t* extraSize) {
+        DAWN_UNUSED(transfer);
+        DAWN_UNUSED(buffer);
+        DAWN_UNUSED(size);
+
+        size_t result = 0;
+
+        {% for member in members if member.length == "strlen" %}
+            DESERIALIZE_TRY(AddTransferSize(&result, transfer->{{as_varName(member.name)}}Strlen, 1, size));
+        {% endfor %}
+
+        {% for member in members if member.annotation != "value" and member.length != "strlen" %}
+            {
+                size_t memberLength = {{member_length(member, "transfer->")}};
+                {% if member.type.category == "structure" %}
+                    auto memberBuffer = reinterpret_cast<const {{member_transfer_type(member)}}*>(buffer + result);
+                {% endif %}
+                DESERIALIZE_TRY(AddTransferSize(&result, memberLength, {{member_transfer_sizeof(member)}}, size));
+
+                //* Structures are followed by the data they point to.
+                {% if member.type.category == "structure" %}
+                    for (size_t i = 0; i < memberLength; ++i) {
+                        size_t memberExtraSize;
+                        DESERIALIZE_TRY({{as_cType(member.type.name)}}GetExtraTransferSize(&memberBuffer[i], buffer + result, size - result, &memberExtraSize));
+                        result += memberExtraSize;
+                    }
+                {% endif %}
+            }
+        {% endfor %}
+
+        *extraSize = result;
+        return DeserializeResult::Success;
+    }
+
+    //* Deserializes `transfer` into `record` getting more serialized data from `buffer` if needed,
+    //* using `allocator` to store pointed-to values and `resolver` to translate object Ids to actual
+    //* objects. The data in `buffer` must have been validated with GetExtraTransferSize first.
     DeserializeResult {{name}}Deserialize({{name}}* record, const {{name}}Transfer* transfer,
-                                          const char** buffer, size_t* size, DeserializeAllocator* allocator, const ObjectIdResolver& resolver) {
+                                          const char** buffer, DeserializeAllocator* allocator, const ObjectIdResolver& resolver) {
         DAWN_UNUSED(allocator);
         DAWN_UNUSED(resolver);
         DAWN_UNUSED(buffer);
-        DAWN_UNUSED(size);
 
         //* Handle special transfer members for methods
         {% if is_method %}
@@ -225,8 +264,7 @@
             {% set memberName = as_varName(member.name) %}
             {
                 size_t stringLength = transfer->{{memberName}}Strlen;
-                const char* stringInBuffer = nullptr;
-                DESERIALIZE_TRY(GetPtrFromBuffer(buffer, size, stringLength, &stringInBuffer));
+                const char* stringInBuffer = ConsumeValidatedBuffer<char>(buffer, stringLength);
 
                 char* copiedString = nullptr;
                 DESERIALIZE_TRY(GetSpace(allocator, stringLength + 1, &copiedString));
@@ -241,8 +279,7 @@
             {% set memberName = as_varName(member.name) %}
             {
                 size_t memberLength = {{member_length(member, "record->")}};
-                auto memberBuffer = reinterpret_cast<const {{member_transfer_type(member)}}*>(buffer);
-                DESERIALIZE_TRY(GetPtrFromBuffer(buffer, size, memberLength, &memberBuffer));
+                auto memberBuffer = ConsumeValidatedBuffer<{{member_transfer_type(member)}}>(buffer, memberLength);
 
                 {{as_cType(member.type.name)}}* copiedMembers = nullptr;
                 DESERIALIZE_TRY(GetSpace(allocator, memberLength, &copiedMembers));
@@ -258,6 +295,242 @@
     }
 {% endmacro %}
 
+{% if wire_compact_encoding %}
+    //* Helper macros for the compact encoding. Scalars use the overloaded CompactSize /
+    //* WriteCompact / ReadCompact helpers, objects are sent as varint IDs.
+
+    //* Outputs an rvalue that's the compact size of `in`
+    {% macro compact_member_size(member, in) -%}
+        {%- if member.type.category == "object" -%}
+            VarintSize(provider.GetId({{in}}))
+        {%- elif member.type.category == "structure" -%}
+            {{as_cType(member.type.name)}}GetCompactSize({{in}}, provider)
+        {%- else -%}
+            CompactSize({{in}})
+        {%- endif -%}
+    {%- endmacro %}
+
+    //* Outputs the compact serialization code to put `in` at `buffer`
+    {% macro serialize_compact_member(member, in) %}
+        {%- if member.type.category == "object" -%}
+            WriteVarint(&buffer, provider.GetId({{in}}));
+        {%- elif member.type.category == "structure" -%}
+            {{as_cType(member.type.name)}}SerializeCompact({{in}}, &buffer, provider);
+        {%- else -%}
+            WriteCompact(&buffer, {{in}});
+        {%- endif -%}
+    {% endmacro %}
+
+    //* Outputs the compact deserialization code to read `out` from `buffer`
+    {% macro deserialize_compact_member(member, out) %}
+        {%- if member.type.category == "object" -%}
+            {
+                ObjectId memberId;
+                DESERIALIZE_TRY(ReadCompact(buffer, size, &memberId));
+                DESERIALIZE_TRY_CONTINUE(resolver.GetFromId(memberId, &{{out}}));
+            }
+        {%- elif member.type.category == "structure" -%}
+            DESERIALIZE_TRY_CONTINUE({{as_cType(member.type.name)}}DeserializeCompact(&{{out}}, buffer, size, allocator, resolver));
+        {%- else -%}
+            DESERIALIZE_TRY(ReadCompact(buffer, size, &{{out}}));
+        {%- endif -%}
+    {% endmacro %}
+
+    //* The compact equivalent of write_serialization_methods. There is no transfer structure
+    //* because nothing is aligned: all members are written one after the other.
+    {% macro write_compact_serialization_methods(name, members, as_method=None, as_struct=None) %}
+        {% set is_method = as_method != None %}
+        {% set is_struct = as_struct != None %}
+        {% set returns_object = is_method and as_method.return_type.category == "object" %}
+
+        //* Returns the number of bytes needed to write `record` in the compact encoding.
+        size_t {{name}}GetCompactSize(const {{name}}& record, const ObjectIdProvider& provider
+            {%- if is_method -%}, const CompactEncodingState& state{%- endif -%}
+        ) {
+            DAWN_UNUSED(record);
+            DAWN_UNUSED(provider);
+
+            size_t result = 0;
+
+            {% if is_method %}
+                result += VarintSize(static_cast<uint32_t>(WireCmd::{{name}}));
+                result += VarintSize(EncodeSelfId(provider.GetId(record.self), state));
+                {% if returns_object %}
+                    result += VarintSize(record.resultId);
+                    result += VarintSize(record.resultSerial);
+                {% endif %}
+            {% endif %}
+
+            {% for member in members if member.annotation == "value" %}
+                result += {{compact_member_size(member, "record." + as_varName(member.name))}};
+            {% endfor %}
+
+            {% for member in members if member.length == "strlen" %}
+                {
+                    size_t stringLength = std::strlen(record.{{as_varName(member.name)}});
+                    result += VarintSize(stringLength) + stringLength;
+                }
+            {% endfor %}
+
+            {% for member in members if member.annotation != "value" and member.length != "strlen" %}
+                {
+                    size_t memberLength = {{member_length(member, "record.")}};
+                    {% if is_raw_compact_array(member) %}
+                        result += memberLength * sizeof({{as_cType(member.type.name)}});
+                    {% else %}
+                        for (size_t i = 0; i < memberLength; ++i) {
+                            result += {{compact_member_size(member, "record." + as_varName(member.name) + "[i]")}};
+                        }
+                    {% endif %}
+                }
+            {% endfor %}
+
+            return result;
+        }
+
+        //* Writes `record` at *bufferPtr and advances it by the compact size of `record`.
+        void {{name}}SerializeCompact(const {{name}}& record, char** bufferPtr, const ObjectIdProvider& provider
+            {%- if is_method -%}, CompactEncodingState* state{%- endif -%}
+        ) {
+            DAWN_UNUSED(provider);
+            char* buffer = *bufferPtr;
+
+            {% if is_method %}
+                WriteVarint(&buffer, static_cast<uint32_t>(WireCmd::{{name}}));
+                {
+                    ObjectId selfId = provider.GetId(record.self);
+                    WriteVarint(&buffer, EncodeSelfId(selfId, *state));
+                    state->lastSelfId = selfId;
+                }
+                {% if returns_object %}
+                    WriteVarint(&buffer, record.resultId);
+                    WriteVarint(&buffer, record.resultSerial);
+                {% endif %}
+            {% endif %}
+
+            {% for member in members if member.annotation == "value" %}
+                {{serialize_compact_member(member, "record." + as_varName(member.name))}}
+            {% endfor %}
+
+            {% for member in members if member.length == "strlen" %}
+                {% set memberName = as_varName(member.name) %}
+                {
+                    size_t stringLength = std::strlen(record.{{memberName}});
+                    WriteVarint(&buffer, stringLength);
+                    memcpy(buffer, record.{{memberName}}, stringLength);
+                    buffer += stringLength;
+                }
+            {% endfor %}
+
+            {% for member in members if member.annotation != "value" and member.length != "strlen" %}
+                {% set memberName = as_varName(member.name) %}
+                {
+                    size_t memberLength = {{member_length(member, "record.")}};
+                    {% if is_raw_compact_array(member) %}
+                        size_t memberSize = memberLength * sizeof({{as_cType(member.type.name)}});
+                        memcpy(buffer, record.{{memberName}}, memberSize);
+                        buffer += memberSize;
+                    {% else %}
+                        for (size_t i = 0; i < memberLength; ++i) {
+                            {{serialize_compact_member(member, "record." + memberName + "[i]")}}
+                        }
+                    {% endif %}
+                }
+            {% endfor %}
+
+            *bufferPtr = buffer;
+        }
+
+        //* Reads `record` from (buffer, size) with a bounds check for each read. Objects that are
+        //* error values don't stop the decoding so that the whole record is always consumed.
+        DeserializeResult {{name}}DeserializeCompact({{name}}* record, const char** buffer, size_t* size,
+                                                     DeserializeAllocator* allocator, const ObjectIdResolver& resolver
+            {%- if is_method -%}, CompactEncodingState* state{%- endif -%}
+        ) {
+            DAWN_UNUSED(allocator);
+            DAWN_UNUSED(resolver);
+
+            DeserializeResult result = DeserializeResult::Success;
+
+            {% if is_method %}
+                {
+                    uint32_t commandId;
+                    DESERIALIZE_TRY(ReadCompact(buffer, size, &commandId));
+                    if (commandId != static_cast<uint32_t>(WireCmd::{{name}})) {
+                        return DeserializeResult::FatalError;
+                    }
+
+                    uint64_t encodedSelfId;
+                    DESERIALIZE_TRY(ReadVarint(buffer, size, &encodedSelfId));
+                    DESERIALIZE_TRY(DecodeSelfId(encodedSelfId, state, &record->selfId));
+                }
+                {% if returns_object %}
+                    DESERIALIZE_TRY(ReadCompact(buffer, size, &record->resultId));
+                    DESERIALIZE_TRY(ReadCompact(buffer, size, &record->resultSerial));
+                {% endif %}
+                DESERIALIZE_TRY_CONTINUE(resolver.GetFromId(record->selfId, &record->self));
+            {% endif %}
+
+            {% if is_struct and as_struct.extensible %}
+                record->nextInChain = nullptr;
+            {% endif %}
+
+            {% for member in members if member.annotation == "value" %}
+                {{deserialize_compact_member(member, "record->" + as_varName(member.name))}}
+            {% endfor %}
+
+            {% for member in members if member.length == "strlen" %}
+                {
+                    uint64_t stringLength;
+                    DESERIALIZE_TRY(ReadVarint(buffer, size, &stringLength));
+
+                    const char* stringInBuffer = nullptr;
+                    DESERIALIZE_TRY(GetPtrFromBuffer(buffer, size, stringLength, &stringInBuffer));
+
+                    char* copiedString = nullptr;
+                    DESERIALIZE_TRY(GetSpace(allocator, stringLength + 1, &copiedString));
+                    memcpy(copiedString, stringInBuffer, stringLength);
+                    copiedString[stringLength] = '\0';
+                    record->{{as_varName(member.name)}} = copiedString;
+                }
+            {% endfor %}
+
+            {% for member in members if member.annotation != "value" and member.length != "strlen" %}
+                {% set memberName = as_varName(member.name) %}
+                {
+                    size_t memberLength = {{member_length(member, "record->")}};
+                    if (memberLength > std::numeric_limits<size_t>::max() / sizeof({{as_cType(member.type.name)}})) {
+                        return DeserializeResult::FatalError;
+                    }
+                    //* Each element takes at least one byte of the compact stream. Checking this
+                    //* before allocating prevents small commands from requesting huge allocations.
+                    if (memberLength > *size) {
+                        return DeserializeResult::FatalError;
+                    }
+
+                    {{as_cType(member.type.name)}}* copiedMembers = nullptr;
+                    DESERIALIZE_TRY(GetSpace(allocator, memberLength, &copiedMembers));
+                    record->{{memberName}} = copiedMembers;
+
+                    {% if is_raw_compact_array(member) %}
+                        //* The compact stream isn't aligned so the data is only accessed through memcpy.
+                        size_t memberSize = memberLength * sizeof({{as_cType(member.type.name)}});
+                        const char* memberBuffer = nullptr;
+                        DESERIALIZE_TRY(GetPtrFromBuffer(buffer, size, memberSize, &memberBuffer));
+                        memcpy(copiedMembers, memberBuffer, memberSize);
+                    {% else %}
+                        for (size_t i = 0; i < memberLength; ++i) {
+                            {{deserialize_compact_member(member, "copiedMembers[i]")}}
+                        }
+                    {% endif %}
+                }
+            {% endfor %}
+
+            return result;
+        }
+    {% endmacro %}
+{% endif %}
+
 namespace dawn_wire {
 
     // Macro to simplify error handling, similar to DAWN_TRY but for DeserializeResult.
@@ -268,6 +541,21 @@ namespace dawn_wire {
             return exprResult; \
         } \
     }
+{% if wire_compact_encoding %}
+
+        // Similar to DESERIALIZE_TRY but only returns early on FatalError. ErrorObject is remembered in
+        // the `result` local variable so that the rest of the command is still consumed.
+    #define DESERIALIZE_TRY_CONTINUE(EXPR) \
+        { \
+            DeserializeResult exprResult = EXPR; \
+            if (exprResult == DeserializeResult::FatalError) { \
+                return exprResult; \
+            } \
+            if (exprResult == DeserializeResult::ErrorObject) { \
+                result = exprResult; \
+            } \
+        }
+{% endif %}
 
     namespace {
 
@@ -275,12 +563,12 @@ namespace dawn_wire {
         // Returns FatalError if not enough memory was available
         template <typename T>
         DeserializeResult GetPtrFromBuffer(const char** buffer, size_t* size, size_t count, const T** data) {
-            // TODO(cwallez@chromium.org): For robustness we would need to handle overflows here.
-            size_t totalSize = sizeof(T) * count;
-            if (totalSize > *size) {
+            if (count > *size / sizeof(T)) {
                 return DeserializeResult::FatalError;
             }
 
+            size_t totalSize = sizeof(T) * count;
+
             *data = reinterpret_cast<const T*>(*buffer);
             *buffer += totalSize;
             *size -= totalSize;
@@ -288,11 +576,34 @@ namespace dawn_wire {
             return DeserializeResult::Success;
         }
 
+        // Adds the size of T[count] to *total without overflowing. Returns FatalError if the new
+        // total would be larger than limit, which *total must not be larger than already.
+        DeserializeResult AddTransferSize(size_t* total, size_t count, size_t elementSize, size_t limit) {
+            ASSERT(*total <= limit);
+            if (elementSize != 0 && count > (limit - *total) / elementSize) {
+                return DeserializeResult::FatalError;
+            }
+
+            *total += count * elementSize;
+            return DeserializeResult::Success;
+        }
+
+        // Consumes T[count] from a buffer that is already known to be large enough.
+        template <typename T>
+        const T* ConsumeValidatedBuffer(const char** buffer, size_t count) {
+            const T* data = reinterpret_cast<const T*>(*buffer);
+            *buffer += sizeof(T) * count;
+            return data;
+        }
+
         // Allocates enough space from allocator to countain T[count] and return it in out.
-        // Return FatalError if the allocator couldn't allocate the memory.
+        // Return FatalError if the size overflows or the allocator couldn't allocate the memory.
         template <typename T>
         DeserializeResult GetSpace(DeserializeAllocator* allocator, size_t count, T** out) {
-            // TODO(cwallez@chromium.org): For robustness we would need to handle overflows here.
+            if (count > std::numeric_limits<size_t>::max() / sizeof(T)) {
+                return DeserializeResult::FatalError;
+            }
+
             size_t totalSize = sizeof(T) * count;
             *out = static_cast<T*>(allocator->GetSpace(totalSize));
             if (*out == nullptr) {
@@ -302,6 +613,182 @@ namespace dawn_wire {
             return DeserializeResult::Success;
         }
 
+        {% if wire_compact_encoding %}
+            // Helpers for the compact encoding. Unsigned integers are written as LEB128 varints:
+            // 7 bits per byte, least significant group first, with the high bit set on all bytes
+            // but the last one.
+            size_t VarintSize(uint64_t value) {
+                size_t result = 1;
+                while (value >= 0x80) {
+                    value >>= 7;
+                    result++;
+                }
+                return result;
+            }
+
+            void WriteVarint(char** buffer, uint64_t value) {
+                char* ptr = *buffer;
+                while (value >= 0x80) {
+                    *ptr++ = static_cast<char>((value & 0x7F) | 0x80);
+                    value >>= 7;
+                }
+                *ptr++ = static_cast<char>(value);
+                *buffer = ptr;
+            }
+
+            // Returns FatalError if the buffer ends in the middle of the varint or if the varint
+            // is longer than what's needed for 64 bits.
+            DeserializeResult ReadVarint(const char** buffer, size_t* size, uint64_t* value) {
+                uint64_t result = 0;
+                for (uint32_t shift = 0; shift < 64; shift += 7) {
+                    if (*size == 0) {
+                        return DeserializeResult::FatalError;
+                    }
+
+                    uint8_t byte = static_cast<uint8_t>(**buffer);
+                    (*buffer)++;
+                    (*size)--;
+
+                    result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                    if ((byte & 0x80) == 0) {
+                        *value = result;
+                        return DeserializeResult::Success;
+                    }
+                }
+
+                return DeserializeResult::FatalError;
+            }
+
+            // IDs of "self" objects are optionally sent as the zigzag-encoded delta with the
+            // previous command's "self" ID so that both small positive and negative deltas fit in a
+            // byte.
+            uint64_t EncodeSelfId(ObjectId id, const CompactEncodingState& state) {
+                if (!state.deltaObjectIds) {
+                    return id;
+                }
+
+                int64_t delta = static_cast<int64_t>(id) - static_cast<int64_t>(state.lastSelfId);
+                return (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+            }
+
+            DeserializeResult DecodeSelfId(uint64_t encoded, CompactEncodingState* state, ObjectId* id) {
+                uint64_t value = encoded;
+                if (state->deltaObjectIds) {
+                    uint64_t delta = (encoded >> 1) ^ (~(encoded & 1) + 1);
+                    value = static_cast<uint64_t>(state->lastSelfId) + delta;
+                }
+
+                if (value > std::numeric_limits<ObjectId>::max()) {
+                    return DeserializeResult::FatalError;
+                }
+
+                *id = static_cast<ObjectId>(value);
+                state->lastSelfId = *id;
+                return DeserializeResult::Success;
+            }
+
+            // Compact [de]serialization of scalars, overloaded on the type so the generated code
+            // doesn't have to special case each of them.
+            size_t CompactSize(bool) {
+                return 1;
+            }
+            size_t CompactSize(char) {
+                return 1;
+            }
+            size_t CompactSize(uint8_t) {
+                return 1;
+            }
+            size_t CompactSize(float) {
+                return sizeof(float);
+            }
+            size_t CompactSize(uint32_t value) {
+                return VarintSize(value);
+            }
+            size_t CompactSize(uint64_t value) {
+                return VarintSize(value);
+            }
+
+            void WriteCompact(char** buffer, uint8_t value) {
+                **buffer = static_cast<char>(value);
+                (*buffer)++;
+            }
+            void WriteCompact(char** buffer, bool value) {
+                WriteCompact(buffer, static_cast<uint8_t>(value ? 1 : 0));
+            }
+            void WriteCompact(char** buffer, char value) {
+                WriteCompact(buffer, static_cast<uint8_t>(value));
+            }
+            void WriteCompact(char** buffer, float value) {
+                memcpy(*buffer, &value, sizeof(float));
+                *buffer += sizeof(float);
+            }
+            void WriteCompact(char** buffer, uint32_t value) {
+                WriteVarint(buffer, value);
+            }
+            void WriteCompact(char** buffer, uint64_t value) {
+                WriteVarint(buffer, value);
+            }
+
+            DeserializeResult ReadCompact(const char** buffer, size_t* size, uint8_t* out) {
+                if (*size < 1) {
+                    return DeserializeResult::FatalError;
+                }
+                *out = static_cast<uint8_t>(**buffer);
+                (*buffer)++;
+                (*size)--;
+                return DeserializeResult::Success;
+            }
+            DeserializeResult ReadCompact(const char** buffer, size_t* size, bool* out) {
+                uint8_t value;
+                DESERIALIZE_TRY(ReadCompact(buffer, size, &value));
+                *out = value != 0;
+                return DeserializeResult::Success;
+            }
+            DeserializeResult ReadCompact(const char** buffer, size_t* size, char* out) {
+                uint8_t value;
+                DESERIALIZE_TRY(ReadCompact(buffer, size, &value));
+                *out = static_cast<char>(value);
+                return DeserializeResult::Success;
+            }
+            DeserializeResult ReadCompact(const char** buffer, size_t* size, float* out) {
+                const char* data = nullptr;
+                DESERIALIZE_TRY(GetPtrFromBuffer(buffer, size, sizeof(float), &data));
+                memcpy(out, data, sizeof(float));
+                return DeserializeResult::Success;
+            }
+            DeserializeResult ReadCompact(const char** buffer, size_t* size, uint64_t* out) {
+                return ReadVarint(buffer, size, out);
+            }
+            DeserializeResult ReadCompact(const char** buffer, size_t* size, uint32_t* out) {
+                uint64_t value;
+                DESERIALIZE_TRY(ReadVarint(buffer, size, &value));
+                if (value > std::numeric_limits<uint32_t>::max()) {
+                    return DeserializeResult::FatalError;
+                }
+                *out = static_cast<uint32_t>(value);
+                return DeserializeResult::Success;
+            }
+
+            //* Enums that have all their values smaller than 256 are packed in a single byte, other
+            //* enums and bitmasks are varints.
+            {% for type in by_category["enum"] + by_category["bitmask"] %}
+                {% set cType = as_cType(type.name) %}
+                {% set WireType = "uint8_t" if is_byte_sized_enum(type) else "uint32_t" %}
+                size_t CompactSize({{cType}} value) {
+                    return CompactSize(static_cast<{{WireType}}>(value));
+                }
+                void WriteCompact(char** buffer, {{cType}} value) {
+                    WriteCompact(buffer, static_cast<{{WireType}}>(value));
+                }
+                DeserializeResult ReadCompact(const char** buffer, size_t* size, {{cType}}* out) {
+                    {{WireType}} value;
+                    DESERIALIZE_TRY(ReadCompact(buffer, size, &value));
+                    *out = static_cast<{{cType}}>(value);
+                    return DeserializeResult::Success;
+                }
+            {% endfor %}
+
+        {% endif %}
         //* Output structure [de]serialization first because it is used by methods.
         {% for type in by_category["structure"] %}
             {% set name = as_cType(type.name) %}
@@ -317,6 +804,19 @@ namespace dawn_wire {
                 {{write_serialization_methods(name, method.arguments, as_method=method)}}
             {% endfor %}
         {% endfor %}
+
+        {% if wire_compact_encoding %}
+            //* Same for the compact encoding.
+            {% for type in by_category["structure"] %}
+                {{write_compact_serialization_methods(as_cType(type.name), type.members, as_struct=type)}}
+            {% endfor %}
+
+            {% for type in by_category["object"] %}
+                {% for method in type.methods %}
+                    {{write_compact_serialization_methods(as_MethodSuffix(type.name, method.name), method.arguments, as_method=method)}}
+                {% endfor %}
+            {% endfor %}
+        {% endif %}
     }  // anonymous namespace
 
     {% for type in by_category["object"] %}
@@ -336,12 +836,65 @@ namespace dawn_wire {
             }
 
             DeserializeResult {{Cmd}}::Deserialize(const char** buffer, size_t* size, DeserializeAllocator* allocator, const ObjectIdResolver& resolver) {
+                //* Check the whole command is in bounds up front, so that the deserialization of
+                //* its members doesn't need any check.
                 const {{name}}Transfer* transfer = nullptr;
                 DESERIALIZE_TRY(GetPtrFromBuffer(buffer, size, 1, &transfer));
 
-                return {{name}}Deserialize(this, transfer, buffer, size, allocator, resolver);
+                size_t extraSize;
+                DESERIALIZE_TRY({{name}}GetExtraTransferSize(transfer, *buffer, *size, &extraSize));
+
+                const char* extraData = *buffer;
+                *buffer += extraSize;
+                *size -= extraSize;
+
+                return {{name}}Deserialize(this, transfer, &extraData, allocator, resolver);
             }
+
+            {% if wire_compact_encoding %}
+                size_t {{Cmd}}::GetRequiredCompactSize(const ObjectIdProvider& objectIdProvider, const CompactEncodingState& state) const {
+                    return {{name}}GetCompactSize(*this, objectIdProvider, state);
+                }
+
+                void {{Cmd}}::SerializeCompact(char* buffer, const ObjectIdProvider& objectIdProvider, CompactEncodingState* state) const {
+                    {{name}}SerializeCompact(*this, &buffer, objectIdProvider, state);
+                }
+
+                DeserializeResult {{Cmd}}::DeserializeCompact(const char** buffer, size_t* size, DeserializeAllocator* allocator, const ObjectIdResolver& resolver, CompactEncodingState* state) {
+                    return {{name}}DeserializeCompact(this, buffer, size, allocator, resolver, state);
+                }
+            {% endif %}
         {% endfor %}
     {% endfor %}
 
+    const char* GetWireCmdName(WireCmd command) {
+        switch (command) {
+            {% for type in by_category["object"] %}
+                {% for method in type.methods %}
+                    {% set Suffix = as_MethodSuffix(type.name, method.name) %}
+                    case WireCmd::{{Suffix}}:
+                        return "{{Suffix}}";
+                {% endfor %}
+                {% set Suffix = as_MethodSuffix(type.name, Name("destroy")) %}
+                case WireCmd::{{Suffix}}:
+                    return "{{Suffix}}";
+            {% endfor %}
+            case WireCmd::BufferMapAsync:
+                return "BufferMapAsync";
+            case WireCmd::BufferUpdateMappedDataCmd:
+                return "BufferUpdateMappedData";
+            default:
+                return nullptr;
+        }
+    }
+
+    {% if wire_compact_encoding %}
+        DeserializeResult PeekCompactCommandId(const char* buffer, size_t size, WireCmd* commandId) {
+            uint32_t value;
+            DESERIALIZE_TRY(ReadCompact(&buffer, &size, &value));
+            *commandId = static_cast<WireCmd>(value);
+            return DeserializeResult::Success;
+        }
+    {% endif %}
+
 }  // namespace dawn_wire
@@ -33,6 +33,13 @@ namespace dawn_wire {
             virtual void* GetSpace(size_t size) = 0;
     };
 
+    //* X-macro listing the C types of all the objects, for code that implements the resolver and
+    //* provider interfaces below for every type.
+    #define DAWN_WIRE_FOREACH_OBJECT_TYPE(X) \
+        {% for type in by_category["object"] %}
+            X({{as_cType(type.name)}}) \
+        {% endfor %}
+
     // Interface to convert an ID to a server object, if possible.
     // Methods return FatalError if the ID is for a non-existent object, ErrorObject if the
     // object is an error value and Success otherwise.
@@ -51,6 +58,17 @@ namespace dawn_wire {
             {% endfor %}
     };
 
+    {% if wire_compact_encoding %}
+        //* State shared by consecutive commands of a compact stream. The serializer and the
+        //* deserializer each keep one and must see the same sequence of commands.
+        struct CompactEncodingState {
+            //* When set, the ID of the "self" object of each command is encoded as a delta from the
+            //* "self" ID of the previous command, which is small for runs of calls on one object.
+            bool deltaObjectIds = false;
+            ObjectId lastSelfId = 0;
+        };
+    {% endif %}
+
     //* Enum used as a prefix to each command on the wire format.
     enum class WireCmd : uint32_t {
         {% for type in by_category["object"] %}
@@ -63,6 +81,12 @@ namespace dawn_wire {
         BufferUpdateMappedDataCmd,
     };
 
+    //* The number of WireCmd values, used to size per-command tables.
+    static constexpr size_t kWireCmdCount = static_cast<size_t>(WireCmd::BufferUpdateMappedDataCmd) + 1;
+
+    //* Returns the name of the command, or nullptr if it isn't a valid WireCmd.
+    const char* GetWireCmdName(WireCmd command);
+
     {% for type in by_category["object"] %}
         {% for method in type.methods %}
             {% set Suffix = as_MethodSuffix(type.name, method.name) %}
@@ -88,9 +112,21 @@ namespace dawn_wire {
                 //*  - ErrorObject if one if the deserialized object is an error value, for the implementation
                 //*    of the Maybe monad.
                 //* If the return value is not FatalError, selfId, resultId and resultSerial (if present) are
-                //* filled.
+                //* filled and the whole command is consumed. The size of the command is checked before any
+                //* of its members is deserialized.
                 DeserializeResult Deserialize(const char** buffer, size_t* size, DeserializeAllocator* allocator, const ObjectIdResolver& resolver);
 
+                {% if wire_compact_encoding %}
+                    //* Same as the functions above but for the compact encoding where integers are
+                    //* varints, enums are bytes and there is no padding. The size depends on the
+                    //* values of the IDs so the provider is needed to compute it. Like Deserialize,
+                    //* DeserializeCompact consumes the whole command, even when it returns
+                    //* ErrorObject.
+                    size_t GetRequiredCompactSize(const ObjectIdProvider& objectIdProvider, const CompactEncodingState& state) const;
+                    void SerializeCompact(char* serializeBuffer, const ObjectIdProvider& objectIdProvider, CompactEncodingState* state) const;
+                    DeserializeResult DeserializeCompact(const char** buffer, size_t* size, DeserializeAllocator* allocator, const ObjectIdResolver& resolver, CompactEncodingState* state);
+                {% endif %}
+
                 {{as_cType(type.name)}} self;
 
                 //* Command handlers want to know the object ID in addition to the backing object.
@@ -109,15 +145,21 @@ namespace dawn_wire {
             };
         {% endfor %}
 
-        //* The command structure used when sending that an ID is destroyed.
+        //* The command structure used when sending that IDs are destroyed, followed by
+        //* objectCount ObjectIds. Objects released one after the other share a command.
         {% set Suffix = as_MethodSuffix(type.name, Name("destroy")) %}
         struct {{Suffix}}Cmd {
             WireCmd commandId = WireCmd::{{Suffix}};
-            ObjectId objectId;
+            uint32_t objectCount;
         };
 
     {% endfor %}
 
+    {% if wire_compact_encoding %}
+        //* Reads the ID of the next command of a compact stream without consuming it.
+        DeserializeResult PeekCompactCommandId(const char* buffer, size_t size, WireCmd* commandId);
+
+    {% endif %}
     //* Enum used as a prefix to each command on the return wire format.
     enum class ReturnWireCmd : uint32_t {
         DeviceErrorCallback,
@@ -126,6 +168,8 @@ namespace dawn_wire {
         {% endfor %}
         BufferMapReadAsyncCallback,
         BufferMapWriteAsyncCallback,
+        FenceUpdateCompletedValue,
+        BytesConsumed,
     };
 
     //* Command for the server calling a builder status callback.
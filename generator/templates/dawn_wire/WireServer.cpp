@@ -14,12 +14,23 @@
 
 #include "dawn_wire/Wire.h"
 #include "dawn_wire/WireCmd.h"
+#include "dawn_wire/WireStatistics.h"
 
 #include "common/Assert.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace dawn_wire {
@@ -36,109 +47,232 @@ namespace dawn_wire {
             bool isWrite;
         };
 
-        //* Stores what the backend knows about the type.
-        template<typename T>
-        struct ObjectDataBase {
-            //* The backend-provided handle and serial to this object.
-            T handle;
-            uint32_t serial = 0;
-
-            //* Built object ID and serial, needed to send to the client along with builder error callbacks
-            //* TODO(cwallez@chromium.org) only have this for builder T
-            uint32_t builtObjectId = 0;
-            uint32_t builtObjectSerial = 0;
-
-            //* Used by the error-propagation mechanism to know if this object is an error.
-            //* TODO(cwallez@chromium.org): this is doubling the memory usage of
-            //* std::vector<ObjectDataBase> consider making it a special marker value in handle instead.
-            bool valid;
-            //* Whether this object has been allocated, used by the KnownObjects queries
-            //* TODO(cwallez@chromium.org): make this an internal bit vector in KnownObjects.
-            bool allocated;
-
-            //* TODO(cwallez@chromium.org): this is only useful for buffers
-            void* mappedData = nullptr;
-            size_t mappedDataSize = 0;
+        struct FenceCompletionUserdata {
+            Server* server;
+            uint32_t fenceId;
+            uint32_t fenceSerial;
+            uint64_t value;
         };
 
-        //* Keeps track of the mapping between client IDs and backend objects.
+        //* Keeps track of the mapping between client IDs and backend objects. The data is stored as
+        //* a structure of arrays indexed by ID so that the arrays only contain what's needed for
+        //* all types of objects, and the queries on a single field touch as little memory as
+        //* possible.
         template<typename T>
         class KnownObjects {
             public:
-                using Data = ObjectDataBase<T>;
-
                 KnownObjects() {
                     //* Pre-allocate ID 0 to refer to the null handle.
-                    Data nullObject;
-                    nullObject.handle = nullptr;
-                    nullObject.valid = true;
-                    nullObject.allocated = true;
-                    mKnown.push_back(nullObject);
+                    Allocate(0);
+                    SetHandle(0, nullptr);
+                    SetValid(0, true);
                 }
 
-                //* Get a backend objects for a given client ID.
-                //* Returns nullptr if the ID hasn't previously been allocated.
-                const Data* Get(uint32_t id) const {
-                    if (id >= mKnown.size()) {
-                        return nullptr;
+                //* Returns whether the ID has previously been allocated. The other queries can only
+                //* be used on allocated IDs.
+                bool IsAllocated(uint32_t id) const {
+                    return id < mAllocated.size() && mAllocated[id];
+                }
+
+                T GetHandle(uint32_t id) const {
+                    ASSERT(IsAllocated(id));
+                    return mHandles[id];
+                }
+                void SetHandle(uint32_t id, T handle) {
+                    ASSERT(IsAllocated(id));
+                    mHandles[id] = handle;
+                }
+
+                uint32_t GetSerial(uint32_t id) const {
+                    ASSERT(IsAllocated(id));
+                    return mSerials[id];
+                }
+                void SetSerial(uint32_t id, uint32_t serial) {
+                    ASSERT(IsAllocated(id));
+                    mSerials[id] = serial;
+                }
+
+                //* Used by the error-propagation mechanism to know if this object is an error.
+                bool IsValid(uint32_t id) const {
+                    ASSERT(IsAllocated(id));
+                    return mValid[id];
+                }
+                void SetValid(uint32_t id, bool valid) {
+                    ASSERT(IsAllocated(id));
+                    mValid[id] = valid;
+                }
+
+                //* Allocates the data for a given ID, as an invalid object with a null handle.
+                //* Returns false if the ID is already allocated, or too far ahead.
+                bool Allocate(uint32_t id) {
+                    if (id > mAllocated.size()) {
+                        return false;
                     }
 
-                    const Data* data = &mKnown[id];
+                    if (id == mAllocated.size()) {
+                        mHandles.push_back(nullptr);
+                        mSerials.push_back(0);
+                        mValid.push_back(false);
+                        mAllocated.push_back(true);
+                        return true;
+                    }
 
-                    if (!data->allocated) {
-                        return nullptr;
+                    if (mAllocated[id]) {
+                        return false;
                     }
 
-                    return data;
+                    mHandles[id] = nullptr;
+                    mSerials[id] = 0;
+                    mValid[id] = false;
+                    mAllocated[id] = true;
+                    return true;
                 }
-                Data* Get(uint32_t id) {
-                    if (id >= mKnown.size()) {
-                        return nullptr;
-                    }
 
-                    Data* data = &mKnown[id];
+                //* Marks an ID as deallocated
+                void Free(uint32_t id) {
+                    ASSERT(IsAllocated(id));
+                    mAllocated[id] = false;
+                }
 
-                    if (!data->allocated) {
-                        return nullptr;
+                //* IDs are only allocated below this bound.
+                uint32_t GetIdBound() const {
+                    return static_cast<uint32_t>(mAllocated.size());
+                }
+
+            private:
+                std::vector<T> mHandles;
+                std::vector<uint32_t> mSerials;
+                //* std::vector<bool> is specialized to be a bit vector.
+                std::vector<bool> mValid;
+                std::vector<bool> mAllocated;
+        };
+
+        //* Builders additionally remember the ID and serial of the object they built, that are
+        //* needed to send to the client along with the builder error callbacks.
+        template<typename T>
+        class KnownBuilders : public KnownObjects<T> {
+            public:
+                struct BuiltObject {
+                    uint32_t id = 0;
+                    uint32_t serial = 0;
+                };
+
+                const BuiltObject& GetBuiltObject(uint32_t id) const {
+                    ASSERT(this->IsAllocated(id));
+                    return mBuiltObjects[id];
+                }
+                void SetBuiltObject(uint32_t id, uint32_t builtId, uint32_t builtSerial) {
+                    ASSERT(this->IsAllocated(id));
+                    mBuiltObjects[id].id = builtId;
+                    mBuiltObjects[id].serial = builtSerial;
+                }
+
+                bool Allocate(uint32_t id) {
+                    if (!KnownObjects<T>::Allocate(id)) {
+                        return false;
                     }
 
-                    return data;
+                    if (id >= mBuiltObjects.size()) {
+                        mBuiltObjects.resize(id + 1);
+                    }
+                    mBuiltObjects[id] = BuiltObject();
+                    return true;
                 }
 
-                //* Allocates the data for a given ID and returns it.
-                //* Returns nullptr if the ID is already allocated, or too far ahead.
-                //* Invalidates all the Data*
-                Data* Allocate(uint32_t id) {
-                    if (id > mKnown.size()) {
+            private:
+                //* Starts with the entry for the null object, that KnownObjects pre-allocates.
+                std::vector<BuiltObject> mBuiltObjects = std::vector<BuiltObject>(1);
+        };
+
+        //* Buffers additionally remember where their data is mapped for writing. Only a few buffers
+        //* are mapped at any time so this is a sparse side table.
+        class KnownBuffers : public KnownObjects<dawnBuffer> {
+            public:
+                struct MappedData {
+                    void* data = nullptr;
+                    size_t size = 0;
+                };
+
+                //* Returns nullptr if the buffer isn't mapped for writing.
+                const MappedData* GetMappedData(uint32_t id) const {
+                    ASSERT(IsAllocated(id));
+                    auto it = mMappedData.find(id);
+                    if (it == mMappedData.end()) {
                         return nullptr;
                     }
+                    return &it->second;
+                }
+                void SetMappedData(uint32_t id, void* data, size_t size) {
+                    ASSERT(IsAllocated(id));
+                    mMappedData[id] = {data, size};
+                }
+                void ClearMappedData(uint32_t id) {
+                    mMappedData.erase(id);
+                }
+
+                bool Allocate(uint32_t id) {
+                    if (!KnownObjects<dawnBuffer>::Allocate(id)) {
+                        return false;
+                    }
+                    ClearMappedData(id);
+                    return true;
+                }
+
+            private:
+                std::unordered_map<uint32_t, MappedData> mMappedData;
+        };
 
-                    Data data;
-                    data.allocated = true;
-                    data.valid = false;
-                    data.handle = nullptr;
+        //* Fences additionally remember the queue they were created on and their signaled value,
+        //* so that completion values are only requested for the signals that succeeded, and the
+        //* highest completed value sent to the client. The commands refer to fences by handle, so
+        //* the IDs can be looked up from the handles.
+        class KnownFences : public KnownObjects<dawnFence> {
+            public:
+                struct FenceData {
+                    dawnQueue queue = nullptr;
+                    uint64_t signaledValue = 0;
+                    uint64_t sentCompletedValue = 0;
+                };
+
+                FenceData* GetFenceData(uint32_t id) {
+                    ASSERT(IsAllocated(id));
+                    return &mFenceData[id];
+                }
+                void SetFenceData(uint32_t id, dawnQueue queue, uint64_t signaledValue) {
+                    ASSERT(IsValid(id));
+                    mFenceData[id] = {queue, signaledValue, signaledValue};
+                    mIds[GetHandle(id)] = id;
+                }
 
-                    if (id >= mKnown.size()) {
-                        mKnown.push_back(data);
-                        return &mKnown.back();
+                //* Returns 0, the ID of the null object, if the handle isn't a known fence.
+                uint32_t GetId(dawnFence handle) const {
+                    auto it = mIds.find(handle);
+                    if (it == mIds.end()) {
+                        return 0;
                     }
+                    return it->second;
+                }
 
-                    if (mKnown[id].allocated) {
-                        return nullptr;
+                bool Allocate(uint32_t id) {
+                    if (!KnownObjects<dawnFence>::Allocate(id)) {
+                        return false;
                     }
 
-                    mKnown[id] = data;
-                    return &mKnown[id];
+                    if (id >= mFenceData.size()) {
+                        mFenceData.resize(id + 1);
+                    }
+                    mFenceData[id] = FenceData();
+                    return true;
                 }
-
-                //* Marks an ID as deallocated
                 void Free(uint32_t id) {
-                    ASSERT(id < mKnown.size());
-                    mKnown[id].allocated = false;
+                    mIds.erase(GetHandle(id));
+                    KnownObjects<dawnFence>::Free(id);
                 }
 
             private:
-                std::vector<Data> mKnown;
+                //* Starts with the entry for the null object, that KnownObjects pre-allocates.
+                std::vector<FenceData> mFenceData = std::vector<FenceData>(1);
+                std::unordered_map<dawnFence, uint32_t> mIds;
         };
 
         void ForwardDeviceErrorToServer(const char* message, dawnCallbackUserdata userdata);
@@ -149,71 +283,249 @@ namespace dawn_wire {
 
         void ForwardBufferMapReadAsync(dawnBufferMapAsyncStatus status, const void* ptr, dawnCallbackUserdata userdata);
         void ForwardBufferMapWriteAsync(dawnBufferMapAsyncStatus status, void* ptr, dawnCallbackUserdata userdata);
+        void ForwardFenceCompletedValue(dawnFenceCompletionStatus status, dawnCallbackUserdata userdata);
 
-        // A really really simple implementation of the DeserializeAllocator. It's main feature
-        // is that it has some inline storage so as to avoid allocations for the majority of
-        // commands.
+        // The DeserializeAllocator of the server. It has some inline storage so as to avoid
+        // allocations for the majority of commands, and keeps the arenas it allocates for larger
+        // commands across Resets so that a steady stream of commands doesn't allocate at all.
+        // Arenas that stay unused for kResetsPerTrim Resets, or that are bigger than
+        // kMaxRetainedArenaSize, are freed.
         class ServerAllocator : public DeserializeAllocator {
             public:
+                // All allocations are aligned for the types of the deserialized commands.
+                static constexpr size_t kAlignment = 8;
+
                 ServerAllocator() {
-                    Reset();
+                    Rewind();
                 }
 
                 ~ServerAllocator() {
-                    Reset();
+                    for (const Arena& arena : mArenas) {
+                        free(arena.memory);
+                    }
                 }
 
                 void* GetSpace(size_t size) override {
                     // Return space in the current buffer if possible first.
-                    if (mRemainingSize >= size) {
-                        char* buffer = mCurrentBuffer;
-                        mCurrentBuffer += size;
-                        mRemainingSize -= size;
-                        return buffer;
+                    size_t padding = (kAlignment - mCurrentOffset % kAlignment) % kAlignment;
+                    if (mCurrentSize - mCurrentOffset >= padding &&
+                        mCurrentSize - mCurrentOffset - padding >= size) {
+                        char* space = mCurrentBuffer + mCurrentOffset + padding;
+                        mCurrentOffset += padding + size;
+                        return space;
                     }
 
-                    // Otherwise allocate a new buffer and try again.
-                    size_t allocationSize = std::max(size, size_t(2048));
-                    char* allocation = static_cast<char*>(malloc(allocationSize));
-                    if (allocation == nullptr) {
-                        return nullptr;
+                    // Otherwise move to the next retained arena, allocating it if needed. Arenas
+                    // that are too small for the allocation are replaced so that they don't
+                    // accumulate.
+                    if (mNextArena == mArenas.size()) {
+                        mArenas.push_back({nullptr, 0});
+                    }
+                    Arena* arena = &mArenas[mNextArena];
+                    if (arena->size < size) {
+                        size_t arenaSize = std::max(size, size_t(kMinArenaSize));
+                        char* memory = static_cast<char*>(malloc(arenaSize));
+                        if (memory == nullptr) {
+                            return nullptr;
+                        }
+
+                        free(arena->memory);
+                        arena->memory = memory;
+                        arena->size = arenaSize;
                     }
 
-                    mAllocations.push_back(allocation);
-                    mCurrentBuffer = allocation;
-                    mRemainingSize = allocationSize;
-                    return GetSpace(size);
+                    mNextArena++;
+                    mArenasUsedSinceTrim = std::max(mArenasUsedSinceTrim, mNextArena);
+
+                    // malloc'ed memory is aligned for all the types.
+                    mCurrentBuffer = arena->memory;
+                    mCurrentSize = arena->size;
+                    mCurrentOffset = size;
+                    return mCurrentBuffer;
                 }
 
                 void Reset() {
-                    for (auto allocation : mAllocations) {
-                        free(allocation);
+                    // Arenas used by a single huge command aren't worth keeping around.
+                    for (size_t i = 0; i < mNextArena; ++i) {
+                        if (mArenas[i].size > kMaxRetainedArenaSize) {
+                            free(mArenas[i].memory);
+                            mArenas[i] = {nullptr, 0};
+                        }
+                    }
+
+                    if (++mResetsSinceTrim == kResetsPerTrim) {
+                        for (size_t i = mArenasUsedSinceTrim; i < mArenas.size(); ++i) {
+                            free(mArenas[i].memory);
+                        }
+                        mArenas.resize(mArenasUsedSinceTrim);
+                        mArenasUsedSinceTrim = 0;
+                        mResetsSinceTrim = 0;
                     }
-                    mAllocations.clear();
 
+                    Rewind();
+                }
+
+            private:
+                static constexpr size_t kMinArenaSize = 2048;
+                static constexpr size_t kMaxRetainedArenaSize = 1024 * 1024;
+                static constexpr uint32_t kResetsPerTrim = 4096;
+
+                struct Arena {
+                    char* memory;
+                    size_t size;
+                };
+
+                void Rewind() {
                     // The initial buffer is the inline buffer so that some allocations can be skipped
                     mCurrentBuffer = mStaticBuffer;
-                    mRemainingSize = sizeof(mStaticBuffer);
+                    mCurrentSize = sizeof(mStaticBuffer);
+                    mCurrentOffset = 0;
+                    mNextArena = 0;
                 }
 
-            private:
-                size_t mRemainingSize = 0;
                 char* mCurrentBuffer = nullptr;
-                char mStaticBuffer[2048];
-                std::vector<char*> mAllocations;
+                size_t mCurrentSize = 0;
+                size_t mCurrentOffset = 0;
+                alignas(kAlignment) char mStaticBuffer[2048];
+
+                std::vector<Arena> mArenas;
+                size_t mNextArena = 0;
+                size_t mArenasUsedSinceTrim = 0;
+                uint32_t mResetsSinceTrim = 0;
+        };
+
+        //* The different types of objects, used to know in which KnownObjects to look up an ID.
+        enum class ObjectType : uint32_t {
+            {% for type in by_category["object"] %}
+                {{type.name.CamelCase()}},
+            {% endfor %}
+        };
+
+        // An object ID that needs to be resolved, and its handle written to `out`, before the
+        // command that contains it is executed.
+        struct ObjectIdFixup {
+            ObjectType type;
+            ObjectId id;
+            void* out;
+        };
+
+        // A command that has been deserialized but not executed yet. `cmd` points to the
+        // deserialized command, or directly in the command buffer for the fixed-size commands that
+        // don't need deserialization.
+        struct DecodedCommand {
+            WireCmd commandId;
+            const void* cmd;
+            const char* extraData;
+            size_t firstFixup;
+            size_t fixupCount;
+        };
+
+        // A group of consecutive commands that were decoded together, along with the memory they
+        // use. This is the unit of work passed from the decode stage to the execution stage.
+        struct DecodedChunk {
+            ServerAllocator allocator;
+            std::vector<DecodedCommand> commands;
+            std::vector<ObjectIdFixup> fixups;
+
+            template <typename T>
+            T* AllocateCommand() {
+                static_assert(alignof(T) <= ServerAllocator::kAlignment, "");
+                void* space = allocator.GetSpace(sizeof(T));
+                if (space == nullptr) {
+                    return nullptr;
+                }
+                return new (space) T;
+            }
+
+            void Reset() {
+                allocator.Reset();
+                commands.clear();
+                fixups.clear();
+            }
+        };
+
+        // Objects created or destroyed by a command change what the IDs in the following commands
+        // resolve to, so when decoding ahead of the execution, IDs are only recorded in the chunk.
+        // They are resolved right before the command using them is executed.
+        class DeferredIdResolver : public ObjectIdResolver {
+            public:
+                DeferredIdResolver(DecodedChunk* chunk) : mChunk(chunk) {
+                }
+
+                {% for type in by_category["object"] %}
+                    DeserializeResult GetFromId(ObjectId id, {{as_cType(type.name)}}* out) const override {
+                        mChunk->fixups.push_back({ObjectType::{{type.name.CamelCase()}}, id, out});
+                        return DeserializeResult::Success;
+                    }
+                {% endfor %}
+
+            private:
+                DecodedChunk* mChunk;
         };
 
-        class Server : public CommandHandler, public ObjectIdResolver {
+        // Adds the time spent in its scope to a counter, when timings are collected.
+        class ScopedTimer {
             public:
-                Server(dawnDevice device, const dawnProcTable& procs, CommandSerializer* serializer)
-                    : mProcs(procs), mSerializer(serializer) {
+                ScopedTimer(bool enabled, uint64_t* nanoseconds)
+                    : mNanoseconds(enabled ? nanoseconds : nullptr) {
+                    if (mNanoseconds != nullptr) {
+                        mStart = std::chrono::steady_clock::now();
+                    }
+                }
+                ~ScopedTimer() {
+                    if (mNanoseconds != nullptr) {
+                        auto elapsed = std::chrono::steady_clock::now() - mStart;
+                        *mNanoseconds += static_cast<uint64_t>(
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+                    }
+                }
+
+            private:
+                uint64_t* mNanoseconds;
+                std::chrono::steady_clock::time_point mStart;
+        };
+
+        //* Drops the replies of the server of a removed client.
+        class DroppingSerializer : public CommandSerializer {
+            public:
+                void* GetCmdSpace(size_t size) override {
+                    if (mBuffer.size() < size) {
+                        mBuffer.resize(size);
+                    }
+                    return mBuffer.data();
+                }
+                bool Flush() override {
+                    return true;
+                }
+
+            private:
+                std::vector<char> mBuffer;
+        };
+
+        class Server : public ServerCommandHandler, public ObjectIdResolver {
+            public:
+                Server(dawnDevice device, const dawnProcTable& procs, CommandSerializer* serializer, const ServerOptions& options)
+                    : mProcs(procs), mSerializer(serializer), mOptions(options) {
                     //* The client-server knowledge is bootstrapped with device 1.
-                    auto* deviceData = mKnownDevice.Allocate(1);
-                    deviceData->handle = device;
-                    deviceData->valid = true;
+                    mKnownDevice.Allocate(1);
+                    mKnownDevice.SetHandle(1, device);
+                    mKnownDevice.SetValid(1, true);
 
                     auto userdata = static_cast<dawnCallbackUserdata>(reinterpret_cast<intptr_t>(this));
                     procs.deviceSetErrorCallback(device, ForwardDeviceErrorToServer, userdata);
+
+                    mLastTickTime = std::chrono::steady_clock::now();
+                }
+
+                ~Server() {
+                    if (mDecodeThread.joinable()) {
+                        {
+                            std::lock_guard<std::mutex> lock(mDecodeMutex);
+                            mStopDecodeThread = true;
+                        }
+                        mDecodeCondition.notify_all();
+                        mDecodeThread.join();
+                    }
                 }
 
                 void OnDeviceError(const char* message) {
@@ -230,24 +542,23 @@ namespace dawn_wire {
                 {% for type in by_category["object"] if type.is_builder%}
                     {% set Type = type.name.CamelCase() %}
                     void On{{Type}}Error(dawnBuilderErrorStatus status, const char* message, uint32_t id, uint32_t serial) {
-                        auto* builder = mKnown{{Type}}.Get(id);
-
-                        if (builder == nullptr || builder->serial != serial) {
+                        if (!mKnown{{Type}}.IsAllocated(id) || mKnown{{Type}}.GetSerial(id) != serial) {
                             return;
                         }
 
                         if (status != DAWN_BUILDER_ERROR_STATUS_SUCCESS) {
-                            builder->valid = false;
+                            mKnown{{Type}}.SetValid(id, false);
                         }
 
                         if (status != DAWN_BUILDER_ERROR_STATUS_UNKNOWN) {
                             //* Unknown is the only status that can be returned without a call to GetResult
                             //* so we are guaranteed to have created an object.
-                            ASSERT(builder->builtObjectId != 0);
+                            const auto& builtObject = mKnown{{Type}}.GetBuiltObject(id);
+                            ASSERT(builtObject.id != 0);
 
                             Return{{Type}}ErrorCallbackCmd cmd;
-                            cmd.builtObjectId = builder->builtObjectId;
-                            cmd.builtObjectSerial = builder->builtObjectSerial;
+                            cmd.builtObjectId = builtObject.id;
+                            cmd.builtObjectSerial = builtObject.serial;
                             cmd.status = status;
                             cmd.messageStrlen = std::strlen(message);
 
@@ -267,6 +578,9 @@ namespace dawn_wire {
                     cmd.status = status;
                     cmd.dataLength = 0;
 
+                    ASSERT(mCounters.pendingMapRequestCount > 0);
+                    mCounters.pendingMapRequestCount--;
+
                     auto allocCmd = static_cast<ReturnBufferMapReadAsyncCallbackCmd*>(GetCmdSpace(sizeof(cmd)));
                     *allocCmd = cmd;
 
@@ -278,6 +592,7 @@ namespace dawn_wire {
                     }
 
                     delete data;
+                    OnCallbackReplyWritten();
                 }
 
                 void OnMapWriteAsyncCallback(dawnBufferMapAsyncStatus status, void* ptr, MapUserdata* data) {
@@ -287,84 +602,576 @@ namespace dawn_wire {
                     cmd.requestSerial = data->requestSerial;
                     cmd.status = status;
 
+                    ASSERT(mCounters.pendingMapRequestCount > 0);
+                    mCounters.pendingMapRequestCount--;
+
                     auto allocCmd = static_cast<ReturnBufferMapWriteAsyncCallbackCmd*>(GetCmdSpace(sizeof(cmd)));
                     *allocCmd = cmd;
 
-                    if (status == DAWN_BUFFER_MAP_ASYNC_STATUS_SUCCESS) {
-                        auto* selfData = mKnownBuffer.Get(data->bufferId);
-                        ASSERT(selfData != nullptr);
+                    //* The buffer can have been destroyed, or its objects released when the client
+                    //* was removed, while the backend kept it alive.
+                    if (status == DAWN_BUFFER_MAP_ASYNC_STATUS_SUCCESS &&
+                        mKnownBuffer.IsAllocated(data->bufferId) &&
+                        mKnownBuffer.GetSerial(data->bufferId) == data->bufferSerial) {
+                        mKnownBuffer.SetMappedData(data->bufferId, ptr, data->size);
+                    }
+
+                    delete data;
+                    OnCallbackReplyWritten();
+                }
+
+                //* The device calls the fence callbacks from its completion waiter thread. These are
+                //* queued and written on the thread of the server, in its next batch of commands,
+                //* FlushReplies or tick of the multi-client server.
+                void OnFenceCompletedValue(dawnFenceCompletionStatus status, FenceCompletionUserdata* data) {
+                    if (std::this_thread::get_id() != mServerThread.load()) {
+                        std::lock_guard<std::mutex> lock(mReportedFenceCompletionsMutex);
+                        mReportedFenceCompletions.push_back({status, data});
+                        return;
+                    }
+
+                    WriteFenceCompletedValue(status, data);
+                }
+
+                void WriteReportedFenceCompletions() {
+                    mServerThread = std::this_thread::get_id();
+
+                    std::vector<ReportedFenceCompletion> completions;
+                    {
+                        std::lock_guard<std::mutex> lock(mReportedFenceCompletionsMutex);
+                        completions.swap(mReportedFenceCompletions);
+                    }
+                    for (const ReportedFenceCompletion& completion : completions) {
+                        WriteFenceCompletedValue(completion.status, completion.data);
+                    }
+                }
 
-                        selfData->mappedData = ptr;
-                        selfData->mappedDataSize = data->size;
+                void WriteFenceCompletedValue(dawnFenceCompletionStatus status, FenceCompletionUserdata* data) {
+                    ASSERT(mCounters.pendingFenceCompletionCount > 0);
+                    mCounters.pendingFenceCompletionCount--;
+
+                    //* The other statuses are only seen when the device is lost or destroyed, and the
+                    //* client then calls its callbacks itself when it destroys the fence.
+                    //* Completions of values signaled on the same serial can be written out of
+                    //* order when some are reported from the completion waiter thread and queued.
+                    //* Values at or below the last one sent are already known to the client, and
+                    //* values of destroyed fences are ignored by it.
+                    if (status == DAWN_FENCE_COMPLETION_STATUS_SUCCESS &&
+                        mKnownFence.IsAllocated(data->fenceId) &&
+                        mKnownFence.GetSerial(data->fenceId) == data->fenceSerial &&
+                        data->value > mKnownFence.GetFenceData(data->fenceId)->sentCompletedValue) {
+                        mKnownFence.GetFenceData(data->fenceId)->sentCompletedValue = data->value;
+
+                        ReturnFenceUpdateCompletedValueCmd cmd;
+                        cmd.fenceId = data->fenceId;
+                        cmd.fenceSerial = data->fenceSerial;
+                        cmd.value = data->value;
+
+                        auto allocCmd = static_cast<ReturnFenceUpdateCompletedValueCmd*>(GetCmdSpace(sizeof(cmd)));
+                        *allocCmd = cmd;
                     }
 
                     delete data;
+                    OnCallbackReplyWritten();
+                }
+
+                //* Whether the backend still has to call callbacks of this server.
+                bool HasPendingCallbacks() const {
+                    return mCounters.pendingMapRequestCount > 0 ||
+                           mCounters.pendingFenceCompletionCount > 0;
                 }
 
                 const char* HandleCommands(const char* commands, size_t size) override {
-                    mProcs.deviceTick(mKnownDevice.Get(1)->handle);
-
-                    while (size >= sizeof(WireCmd)) {
-                        WireCmd cmdId = *reinterpret_cast<const WireCmd*>(commands);
-
-                        bool success = false;
-                        switch (cmdId) {
-                            {% for type in by_category["object"] %}
-                                {% for method in type.methods %}
-                                    {% set Suffix = as_MethodSuffix(type.name, method.name) %}
-                                    case WireCmd::{{Suffix}}:
-                                        success = Handle{{Suffix}}(&commands, &size);
+                    mCounters.batchCount++;
+
+                    mInHandleCommands = true;
+                    WriteReportedFenceCompletions();
+                    const char* result = HandleBatch(commands, size);
+                    mInHandleCommands = false;
+
+                    //* The rest of a batch that fails is dropped, so it counts as consumed too. A
+                    //* client blocked on the flow control would otherwise wait forever.
+                    mCounters.consumedBytes += size;
+                    if (mOptions.reportConsumedBytes) {
+                        ReportConsumedBytes();
+                    }
+
+                    MaybeFlushReplies();
+                    return result;
+                }
+
+                ServerCounters GetCounters() const override {
+                    return mCounters;
+                }
+
+                //* Used when the client is gone but the backend can still call callbacks.
+                void DropReplies() {
+                    mSerializer = &mDroppingSerializer;
+                }
+
+                //* Releases the objects the client didn't destroy before going away. The device is
+                //* released last, after the objects created from it.
+                void ReleaseKnownObjects() {
+                    {% for type in by_category["object"] if type.name.canonical_case() != "device" %}
+                        ReleaseAll(&mKnown{{type.name.CamelCase()}}, mProcs.{{as_varName(type.name, Name("release"))}});
+                    {% endfor %}
+                    ReleaseAll(&mKnownDevice, mProcs.deviceRelease);
+                }
+
+                void FlushReplies() override {
+                    WriteReportedFenceCompletions();
+
+                    if (mPendingReplyBytes == 0) {
+                        return;
+                    }
+
+                    mSerializer->Flush();
+                    mCounters.replyFlushCount++;
+                    mPendingReplyBytes = 0;
+                    mHasUrgentReplies = false;
+                }
+
+            private:
+                dawnProcTable mProcs;
+                CommandSerializer* mSerializer = nullptr;
+                DroppingSerializer mDroppingSerializer;
+                ServerOptions mOptions;
+
+                ServerCounters mCounters;
+                std::chrono::steady_clock::time_point mLastTickTime;
+
+                //* The thread that last used the server, on which callbacks are written directly.
+                std::atomic<std::thread::id> mServerThread{std::this_thread::get_id()};
+                struct ReportedFenceCompletion {
+                    dawnFenceCompletionStatus status;
+                    FenceCompletionUserdata* data;
+                };
+                std::mutex mReportedFenceCompletionsMutex;
+                std::vector<ReportedFenceCompletion> mReportedFenceCompletions;
+
+                //* Replies written since the last flush.
+                bool mInHandleCommands = false;
+                size_t mPendingReplyBytes = 0;
+                //* Map replies and credits aren't held for the coalescing window.
+                bool mHasUrgentReplies = false;
+                std::chrono::steady_clock::time_point mOldestPendingReplyTime;
+
+                const char* HandleBatch(const char* commands, size_t size) {
+                    if (ShouldTick()) {
+                        mProcs.deviceTick(mKnownDevice.GetHandle(1));
+                        mLastTickTime = std::chrono::steady_clock::now();
+                        mCounters.tickCount++;
+
+                        //* Send the map and fence replies before executing commands that could take a while.
+                        if (mHasUrgentReplies) {
+                            MaybeFlushReplies();
+                        }
+                    }
+
+                    if (mOptions.pipelinedDecodeMinBatchSize != 0 &&
+                        size >= mOptions.pipelinedDecodeMinBatchSize) {
+                        return HandleCommandsPipelined(commands, size);
+                    }
+
+                    while (size > 0) {
+                        mSerialChunk.Reset();
+
+                        bool decoded;
+                        {
+                            ScopedTimer timer(mOptions.collectTimings, &mCounters.decodeNanoseconds);
+                            decoded = DecodeCommand(&commands, &size, &mSerialChunk);
+                        }
+                        if (!decoded) {
+                            return nullptr;
+                        }
+
+                        ScopedTimer timer(mOptions.collectTimings, &mCounters.executeNanoseconds);
+                        if (!ExecuteChunk(mSerialChunk)) {
+                            return nullptr;
+                        }
+                    }
+
+                    return commands;
+                }
+
+                void ReportConsumedBytes() {
+                    ReturnBytesConsumedCmd cmd;
+                    cmd.bytesConsumed = mCounters.consumedBytes;
+
+                    auto allocCmd = static_cast<ReturnBytesConsumedCmd*>(GetCmdSpace(sizeof(cmd)));
+                    *allocCmd = cmd;
+
+                    //* The client can be blocked until it receives the credit.
+                    mHasUrgentReplies = true;
+                }
+
+                void OnCallbackReplyWritten() {
+                    mHasUrgentReplies = true;
+
+                    //* The backend can call callbacks outside of HandleCommands, for example
+                    //* when the embedder ticks the device itself.
+                    if (!mInHandleCommands) {
+                        MaybeFlushReplies();
+                    }
+                }
+
+                void MaybeFlushReplies() {
+                    if (mPendingReplyBytes == 0) {
+                        return;
+                    }
+
+                    switch (mOptions.replyFlushPolicy) {
+                        case ServerReplyFlushPolicy::Embedder:
+                            return;
+                        case ServerReplyFlushPolicy::EveryBatch:
+                            break;
+                        case ServerReplyFlushPolicy::CoalescingWindow:
+                            if (!mHasUrgentReplies &&
+                                mPendingReplyBytes < mOptions.replyCoalescingMaxBytes &&
+                                std::chrono::steady_clock::now() - mOldestPendingReplyTime <
+                                    std::chrono::microseconds(mOptions.replyCoalescingWindowMicroseconds)) {
+                                return;
+                            }
+                            break;
+                        default:
+                            UNREACHABLE();
+                    }
+
+                    FlushReplies();
+                }
+
+                bool ShouldTick() const {
+                    switch (mOptions.tickPolicy) {
+                        case ServerTickPolicy::EveryBatch:
+                            return true;
+                        case ServerTickPolicy::FixedInterval:
+                            return std::chrono::steady_clock::now() - mLastTickTime >=
+                                   std::chrono::milliseconds(mOptions.tickIntervalMilliseconds);
+                        case ServerTickPolicy::WhenPending:
+                            return HasPendingCallbacks();
+                        case ServerTickPolicy::Explicit:
+                            return false;
+                        default:
+                            UNREACHABLE();
+                            return true;
+                    }
+                }
+
+                //* Storage for the command being handled when it isn't decoded on the decode thread.
+                DecodedChunk mSerialChunk;
+
+                //* State shared between the decode thread and the thread executing the commands,
+                //* protected by mDecodeMutex.
+                static constexpr size_t kCommandsPerChunk = 256;
+                static constexpr size_t kMaxChunksInFlight = 4;
+                enum class DecodeState {
+                    Idle,
+                    Running,
+                    Finished,
+                    Failed,
+                };
+
+                std::thread mDecodeThread;
+                std::mutex mDecodeMutex;
+                std::condition_variable mDecodeCondition;
+                std::vector<std::unique_ptr<DecodedChunk>> mChunks;
+                std::vector<DecodedChunk*> mFreeChunks;
+                std::deque<DecodedChunk*> mDecodedChunks;
+                const char* mDecodeCommands = nullptr;
+                size_t mDecodeSize = 0;
+                DecodeState mDecodeState = DecodeState::Idle;
+                bool mAbortDecode = false;
+                bool mStopDecodeThread = false;
+
+                // Decodes the batch on the decode thread while this thread executes the chunks of
+                // commands as they become available. Commands are executed in order and execution
+                // stops at the first command that fails to decode or execute.
+                const char* HandleCommandsPipelined(const char* commands, size_t size) {
+                    if (!mDecodeThread.joinable()) {
+                        for (size_t i = 0; i < kMaxChunksInFlight; ++i) {
+                            mChunks.push_back(std::make_unique<DecodedChunk>());
+                            mFreeChunks.push_back(mChunks.back().get());
+                        }
+                        mDecodeThread = std::thread([this]() { DecodeThreadLoop(); });
+                    }
+
+                    {
+                        std::lock_guard<std::mutex> lock(mDecodeMutex);
+                        ASSERT(mDecodeState == DecodeState::Idle);
+                        mDecodeCommands = commands;
+                        mDecodeSize = size;
+                        mDecodeState = DecodeState::Running;
+                    }
+                    mDecodeCondition.notify_all();
+
+                    bool success = true;
+                    while (true) {
+                        DecodedChunk* chunk = nullptr;
+                        {
+                            std::unique_lock<std::mutex> lock(mDecodeMutex);
+                            mDecodeCondition.wait(lock, [this]() {
+                                return !mDecodedChunks.empty() || mDecodeState != DecodeState::Running;
+                            });
+
+                            //* The decode thread pushes its last chunk before it stops running.
+                            if (mDecodedChunks.empty()) {
+                                break;
+                            }
+                            chunk = mDecodedChunks.front();
+                            mDecodedChunks.pop_front();
+                        }
+
+                        if (success) {
+                            ScopedTimer timer(mOptions.collectTimings, &mCounters.executeNanoseconds);
+                            success = ExecuteChunk(*chunk);
+                        }
+                        chunk->Reset();
+
+                        {
+                            std::lock_guard<std::mutex> lock(mDecodeMutex);
+                            mFreeChunks.push_back(chunk);
+                            mAbortDecode = mAbortDecode || !success;
+                        }
+                        mDecodeCondition.notify_all();
+                    }
+
+                    std::lock_guard<std::mutex> lock(mDecodeMutex);
+                    success = success && mDecodeState == DecodeState::Finished;
+                    mDecodeState = DecodeState::Idle;
+                    mAbortDecode = false;
+
+                    if (!success) {
+                        return nullptr;
+                    }
+                    return commands + size;
+                }
+
+                void DecodeThreadLoop() {
+                    std::unique_lock<std::mutex> lock(mDecodeMutex);
+                    while (true) {
+                        mDecodeCondition.wait(lock, [this]() {
+                            return mStopDecodeThread || mDecodeState == DecodeState::Running;
+                        });
+                        if (mStopDecodeThread) {
+                            return;
+                        }
+
+                        const char* commands = mDecodeCommands;
+                        size_t size = mDecodeSize;
+                        bool success = true;
+
+                        while (success && size > 0) {
+                            mDecodeCondition.wait(lock, [this]() {
+                                return !mFreeChunks.empty() || mAbortDecode;
+                            });
+                            if (mAbortDecode) {
+                                break;
+                            }
+
+                            DecodedChunk* chunk = mFreeChunks.back();
+                            mFreeChunks.pop_back();
+
+                            //* The decode time is accumulated locally and added to the counters
+                            //* with the lock held.
+                            uint64_t decodeNanoseconds = 0;
+                            lock.unlock();
+                            {
+                                ScopedTimer timer(mOptions.collectTimings, &decodeNanoseconds);
+                                for (size_t i = 0; i < kCommandsPerChunk && size > 0; ++i) {
+                                    if (!DecodeCommand(&commands, &size, chunk)) {
+                                        success = false;
                                         break;
-                                {% endfor %}
-                                {% set Suffix = as_MethodSuffix(type.name, Name("destroy")) %}
+                                    }
+                                }
+                            }
+                            lock.lock();
+
+                            mCounters.decodeNanoseconds += decodeNanoseconds;
+                            mDecodedChunks.push_back(chunk);
+                            mDecodeCondition.notify_all();
+                        }
+
+                        mDecodeState = success ? DecodeState::Finished : DecodeState::Failed;
+                        mDecodeCondition.notify_all();
+                    }
+                }
+
+                // Decodes the command at the start of *commands in the chunk. This only touches the
+                // chunk and the commands so that it can run on the decode thread.
+                static bool DecodeCommand(const char** commands, size_t* size, DecodedChunk* chunk) {
+                    if (*size < sizeof(WireCmd)) {
+                        return false;
+                    }
+
+                    uint64_t startTime = GetStatisticsTimestamp();
+                    size_t startSize = *size;
+
+                    DecodedCommand decoded;
+                    decoded.commandId = *reinterpret_cast<const WireCmd*>(*commands);
+                    decoded.cmd = nullptr;
+                    decoded.extraData = nullptr;
+                    decoded.firstFixup = chunk->fixups.size();
+
+                    bool success = false;
+                    switch (decoded.commandId) {
+                        {% for type in by_category["object"] %}
+                            {% for method in type.methods %}
+                                {% set Suffix = as_MethodSuffix(type.name, method.name) %}
                                 case WireCmd::{{Suffix}}:
-                                    success = Handle{{Suffix}}(&commands, &size);
+                                    success = DecodeGeneratedCommand<{{Suffix}}Cmd>(commands, size, chunk, &decoded);
                                     break;
                             {% endfor %}
-                            case WireCmd::BufferMapAsync:
-                                success = HandleBufferMapAsync(&commands, &size);
-                                break;
-                            case WireCmd::BufferUpdateMappedDataCmd:
-                                success = HandleBufferUpdateMappedData(&commands, &size);
+                            {% set Suffix = as_MethodSuffix(type.name, Name("destroy")) %}
+                            case WireCmd::{{Suffix}}:
+                                success = DecodeDestroyCommand<{{Suffix}}Cmd>(commands, size, &decoded);
                                 break;
+                        {% endfor %}
+                        case WireCmd::BufferMapAsync:
+                            success = DecodeFixedSizeCommand<BufferMapAsyncCmd>(commands, size, &decoded);
+                            break;
+                        case WireCmd::BufferUpdateMappedDataCmd:
+                            success = DecodeBufferUpdateMappedData(commands, size, &decoded);
+                            break;
+
+                        default:
+                            success = false;
+                    }
 
-                            default:
-                                success = false;
-                        }
+                    if (!success) {
+                        return false;
+                    }
 
-                        if (!success) {
-                            return nullptr;
-                        }
-                        mAllocator.Reset();
+                    decoded.fixupCount = chunk->fixups.size() - decoded.firstFixup;
+                    chunk->commands.push_back(decoded);
+
+                    RecordServerDeserialize(decoded.commandId, startSize - *size, startTime);
+                    return true;
+                }
+
+                template <typename T>
+                static bool DecodeGeneratedCommand(const char** commands, size_t* size, DecodedChunk* chunk, DecodedCommand* decoded) {
+                    T* cmd = chunk->AllocateCommand<T>();
+                    if (cmd == nullptr) {
+                        return false;
                     }
 
-                    if (size != 0) {
-                        return nullptr;
+                    DeferredIdResolver resolver(chunk);
+                    if (cmd->Deserialize(commands, size, &chunk->allocator, resolver) != DeserializeResult::Success) {
+                        return false;
                     }
 
-                    return commands;
+                    decoded->cmd = cmd;
+                    return true;
                 }
 
-            private:
-                dawnProcTable mProcs;
-                CommandSerializer* mSerializer = nullptr;
+                template <typename T>
+                static bool DecodeFixedSizeCommand(const char** commands, size_t* size, DecodedCommand* decoded) {
+                    decoded->cmd = GetCommand<T>(commands, size);
+                    return decoded->cmd != nullptr;
+                }
+
+                template <typename T>
+                static bool DecodeDestroyCommand(const char** commands, size_t* size, DecodedCommand* decoded) {
+                    const auto* cmd = GetCommand<T>(commands, size);
+                    if (cmd == nullptr) {
+                        return false;
+                    }
 
-                ServerAllocator mAllocator;
+                    decoded->cmd = cmd;
+                    decoded->extraData = reinterpret_cast<const char*>(GetData<ObjectId>(commands, size, cmd->objectCount));
+                    return decoded->extraData != nullptr;
+                }
+
+                static bool DecodeBufferUpdateMappedData(const char** commands, size_t* size, DecodedCommand* decoded) {
+                    const auto* cmd = GetCommand<BufferUpdateMappedDataCmd>(commands, size);
+                    if (cmd == nullptr) {
+                        return false;
+                    }
+
+                    decoded->cmd = cmd;
+                    decoded->extraData = GetData<char>(commands, size, cmd->dataLength);
+                    return decoded->extraData != nullptr;
+                }
+
+                bool ExecuteChunk(const DecodedChunk& chunk) {
+                    for (const DecodedCommand& command : chunk.commands) {
+                        uint64_t startTime = GetStatisticsTimestamp();
+                        if (!ExecuteCommand(chunk, command)) {
+                            return false;
+                        }
+                        RecordServerExecute(command.commandId, startTime);
+                    }
+                    return true;
+                }
+
+                bool ExecuteCommand(const DecodedChunk& chunk, const DecodedCommand& command) {
+                    //* Resolve the IDs now that all the previous commands have been executed. Like
+                    //* the resolution in Deserialize, this stops at the first error object.
+                    DeserializeResult resolveResult = DeserializeResult::Success;
+                    for (size_t i = 0; i < command.fixupCount; ++i) {
+                        resolveResult = ResolveFixup(chunk.fixups[command.firstFixup + i]);
+                        if (resolveResult == DeserializeResult::FatalError) {
+                            return false;
+                        }
+                        if (resolveResult == DeserializeResult::ErrorObject) {
+                            break;
+                        }
+                    }
+
+                    switch (command.commandId) {
+                        {% for type in by_category["object"] %}
+                            {% for method in type.methods %}
+                                {% set Suffix = as_MethodSuffix(type.name, method.name) %}
+                                case WireCmd::{{Suffix}}:
+                                    return Handle{{Suffix}}(*static_cast<const {{Suffix}}Cmd*>(command.cmd), resolveResult);
+                            {% endfor %}
+                            {% set Suffix = as_MethodSuffix(type.name, Name("destroy")) %}
+                            case WireCmd::{{Suffix}}:
+                                return Handle{{Suffix}}(*static_cast<const {{Suffix}}Cmd*>(command.cmd),
+                                                        reinterpret_cast<const ObjectId*>(command.extraData));
+                        {% endfor %}
+                        case WireCmd::BufferMapAsync:
+                            return HandleBufferMapAsync(*static_cast<const BufferMapAsyncCmd*>(command.cmd));
+                        case WireCmd::BufferUpdateMappedDataCmd:
+                            return HandleBufferUpdateMappedData(*static_cast<const BufferUpdateMappedDataCmd*>(command.cmd), command.extraData);
+
+                        default:
+                            UNREACHABLE();
+                            return false;
+                    }
+                }
+
+                DeserializeResult ResolveFixup(const ObjectIdFixup& fixup) const {
+                    switch (fixup.type) {
+                        {% for type in by_category["object"] %}
+                            case ObjectType::{{type.name.CamelCase()}}:
+                                return GetFromId(fixup.id, static_cast<{{as_cType(type.name)}}*>(fixup.out));
+                        {% endfor %}
+                        default:
+                            UNREACHABLE();
+                            return DeserializeResult::FatalError;
+                    }
+                }
 
                 void* GetCmdSpace(size_t size) {
+                    if (mPendingReplyBytes == 0 &&
+                        mOptions.replyFlushPolicy == ServerReplyFlushPolicy::CoalescingWindow) {
+                        mOldestPendingReplyTime = std::chrono::steady_clock::now();
+                    }
+                    mPendingReplyBytes += size;
                     return mSerializer->GetCmdSpace(size);
                 }
 
                 // Implementation of the ObjectIdResolver interface
                 {% for type in by_category["object"] %}
                     DeserializeResult GetFromId(ObjectId id, {{as_cType(type.name)}}* out) const override {
-                        auto data = mKnown{{type.name.CamelCase()}}.Get(id);
-                        if (data == nullptr) {
+                        const auto& known = mKnown{{type.name.CamelCase()}};
+                        if (!known.IsAllocated(id)) {
                             return DeserializeResult::FatalError;
                         }
 
-                        *out = data->handle;
-                        if (data->valid) {
+                        *out = known.GetHandle(id);
+                        if (known.IsValid(id)) {
                             return DeserializeResult::Success;
                         } else {
                             return DeserializeResult::ErrorObject;
@@ -374,20 +1181,42 @@ namespace dawn_wire {
 
                 //* The list of known IDs for each object type.
                 {% for type in by_category["object"] %}
-                    KnownObjects<{{as_cType(type.name)}}> mKnown{{type.name.CamelCase()}};
+                    {% if type.is_builder %}
+                        KnownBuilders<{{as_cType(type.name)}}> mKnown{{type.name.CamelCase()}};
+                    {% elif type.name.canonical_case() == "buffer" %}
+                        KnownBuffers mKnown{{type.name.CamelCase()}};
+                    {% elif type.name.canonical_case() == "fence" %}
+                        KnownFences mKnown{{type.name.CamelCase()}};
+                    {% else %}
+                        KnownObjects<{{as_cType(type.name)}}> mKnown{{type.name.CamelCase()}};
+                    {% endif %}
                 {% endfor %}
 
+                template <typename Known, typename T>
+                static void ReleaseAll(Known* known, void (*release)(T)) {
+                    //* ID 0 is the null object.
+                    for (uint32_t id = 1; id < known->GetIdBound(); ++id) {
+                        if (!known->IsAllocated(id)) {
+                            continue;
+                        }
+                        if (known->IsValid(id)) {
+                            release(known->GetHandle(id));
+                        }
+                        known->Free(id);
+                    }
+                }
+
                 //* Helper function for the getting of the command data in command handlers.
                 //* Checks there is enough data left, updates the buffer / size and returns
                 //* the command (or nullptr for an error).
                 template <typename T>
                 static const T* GetData(const char** buffer, size_t* size, size_t count) {
-                    // TODO(cwallez@chromium.org): Check for overflow
-                    size_t totalSize = count * sizeof(T);
-                    if (*size < totalSize) {
+                    if (count > *size / sizeof(T)) {
                         return nullptr;
                     }
 
+                    size_t totalSize = count * sizeof(T);
+
                     const T* data = reinterpret_cast<const T*>(*buffer);
 
                     *buffer += totalSize;
@@ -403,14 +1232,58 @@ namespace dawn_wire {
                 {% set custom_pre_handler_commands = ["BufferUnmap"] %}
 
                 bool PreHandleBufferUnmap(const BufferUnmapCmd& cmd) {
-                    auto* selfData = mKnownBuffer.Get(cmd.selfId);
-                    ASSERT(selfData != nullptr);
+                    ASSERT(mKnownBuffer.IsAllocated(cmd.selfId));
+                    mKnownBuffer.ClearMappedData(cmd.selfId);
 
-                    selfData->mappedData = nullptr;
+                    return true;
+                }
+
+                //* Some commands need to update server-side state after they are executed
+                //* successfully. The PostHandle function is called with the command once the
+                //* backend procedure was called.
+                {% set custom_post_handler_commands = ["QueueCreateFence", "QueueSignal"] %}
+
+                bool PostHandleQueueCreateFence(const QueueCreateFenceCmd& cmd) {
+                    if (mKnownFence.IsValid(cmd.resultId)) {
+                        mKnownFence.SetFenceData(cmd.resultId, cmd.self, cmd.descriptor->initialValue);
+                    }
 
                     return true;
                 }
 
+                bool PostHandleQueueSignal(const QueueSignalCmd& cmd) {
+                    //* The client can send the null fence, for which the signal is an error.
+                    uint32_t fenceId = mKnownFence.GetId(cmd.fence);
+                    if (fenceId == 0) {
+                        return true;
+                    }
+
+                    //* Mirror the validation of the signal so that only the values that were
+                    //* signaled are waited on.
+                    KnownFences::FenceData* fenceData = mKnownFence.GetFenceData(fenceId);
+                    if (fenceData->queue != cmd.self || cmd.signalValue <= fenceData->signaledValue) {
+                        return true;
+                    }
+                    fenceData->signaledValue = cmd.signalValue;
+
+                    auto* data = new FenceCompletionUserdata;
+                    data->server = this;
+                    data->fenceId = fenceId;
+                    data->fenceSerial = mKnownFence.GetSerial(fenceId);
+                    data->value = cmd.signalValue;
+
+                    auto userdata = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(data));
+                    mCounters.pendingFenceCompletionCount++;
+                    mProcs.fenceOnCompletion(cmd.fence, cmd.signalValue, ForwardFenceCompletedValue, userdata);
+
+                    return true;
+                }
+
+                //* Arguments the server replaces with its own value instead of using the one sent
+                //* by the client. The wire client never blocks on WaitForIdle so the server only
+                //* ticks the device instead of letting a client stall it for an arbitrary timeout.
+                {% set server_overridden_arguments = {"DeviceWaitForIdle": {"timeout ns": "0"}} %}
+
                 //* Implementation of the command handlers
                 {% for type in by_category["object"] %}
                     {% for method in type.methods %}
@@ -418,14 +1291,7 @@ namespace dawn_wire {
 
                         //* The generic command handlers
 
-                        bool Handle{{Suffix}}(const char** commands, size_t* size) {
-                            {{Suffix}}Cmd cmd;
-                            DeserializeResult deserializeResult = cmd.Deserialize(commands, size, &mAllocator, *this);
-
-                            if (deserializeResult == DeserializeResult::FatalError) {
-                                return false;
-                            }
-
+                        bool Handle{{Suffix}}(const {{Suffix}}Cmd& cmd, DeserializeResult deserializeResult) {
                             {% if Suffix in custom_pre_handler_commands %}
                                 if (!PreHandle{{Suffix}}(cmd)) {
                                     return false;
@@ -433,33 +1299,32 @@ namespace dawn_wire {
                             {% endif %}
 
                             //* Unpack 'self'
-                            auto* selfData = mKnown{{type.name.CamelCase()}}.Get(cmd.selfId);
-                            ASSERT(selfData != nullptr);
+                            auto& selfKnown = mKnown{{type.name.CamelCase()}};
+                            ASSERT(selfKnown.IsAllocated(cmd.selfId));
 
                             //* In all cases allocate the object data as it will be refered-to by the client.
                             {% set return_type = method.return_type %}
                             {% set returns = return_type.name.canonical_case() != "void" %}
                             {% if returns %}
                                 {% set Type = method.return_type.name.CamelCase() %}
-                                auto* resultData = mKnown{{Type}}.Allocate(cmd.resultId);
-                                if (resultData == nullptr) {
+                                auto& resultKnown = mKnown{{Type}};
+                                if (!resultKnown.Allocate(cmd.resultId)) {
                                     return false;
                                 }
-                                resultData->serial = cmd.resultSerial;
+                                resultKnown.SetSerial(cmd.resultId, cmd.resultSerial);
 
                                 {% if type.is_builder %}
-                                    selfData->builtObjectId = cmd.resultId;
-                                    selfData->builtObjectSerial = cmd.resultSerial;
+                                    selfKnown.SetBuiltObject(cmd.selfId, cmd.resultId, cmd.resultSerial);
                                 {% endif %}
                             {% endif %}
 
                             //* After the data is allocated, apply the argument error propagation mechanism
                             if (deserializeResult == DeserializeResult::ErrorObject) {
                                 {% if type.is_builder %}
-                                    selfData->valid = false;
+                                    selfKnown.SetValid(cmd.selfId, false);
                                     //* If we are in GetResult, fake an error callback
                                     {% if returns %}
-                                        On{{type.name.CamelCase()}}Error(DAWN_BUILDER_ERROR_STATUS_ERROR, "Maybe monad", cmd.selfId, selfData->serial);
+                                        On{{type.name.CamelCase()}}Error(DAWN_BUILDER_ERROR_STATUS_ERROR, "Maybe monad", cmd.selfId, selfKnown.GetSerial(cmd.selfId));
                                     {% endif %}
                                 {% endif %}
                                 return true;
@@ -468,27 +1333,38 @@ namespace dawn_wire {
                             {% if returns %}
                                 auto result ={{" "}}
                             {%- endif %}
+                            {% set overrides = server_overridden_arguments.get(Suffix, {}) %}
                             mProcs.{{as_varName(type.name, method.name)}}(cmd.self
                                 {%- for arg in method.arguments -%}
-                                    , cmd.{{as_varName(arg.name)}}
+                                    {%- if arg.name.canonical_case() in overrides -%}
+                                        , {{overrides[arg.name.canonical_case()]}}
+                                    {%- else -%}
+                                        , cmd.{{as_varName(arg.name)}}
+                                    {%- endif -%}
                                 {%- endfor -%}
                             );
 
                             {% if returns %}
-                                resultData->handle = result;
-                                resultData->valid = result != nullptr;
+                                resultKnown.SetHandle(cmd.resultId, result);
+                                resultKnown.SetValid(cmd.resultId, result != nullptr);
 
                                 //* builders remember the ID of the object they built so that they can send it
                                 //* in the callback to the client.
                                 {% if return_type.is_builder %}
                                     if (result != nullptr) {
                                         uint64_t userdata1 = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(this));
-                                        uint64_t userdata2 = (uint64_t(resultData->serial) << uint64_t(32)) + cmd.resultId;
+                                        uint64_t userdata2 = (uint64_t(cmd.resultSerial) << uint64_t(32)) + cmd.resultId;
                                         mProcs.{{as_varName(return_type.name, Name("set error callback"))}}(result, Forward{{return_type.name.CamelCase()}}ToClient, userdata1, userdata2);
                                     }
                                 {% endif %}
                             {% endif %}
 
+                            {% if Suffix in custom_post_handler_commands %}
+                                if (!PostHandle{{Suffix}}(cmd)) {
+                                    return false;
+                                }
+                            {% endif %}
+
                             return true;
                         }
                     {% endfor %}
@@ -496,63 +1372,56 @@ namespace dawn_wire {
                     //* Handlers for the destruction of objects: clients do the tracking of the
                     //* reference / release and only send destroy on refcount = 0.
                     {% set Suffix = as_MethodSuffix(type.name, Name("destroy")) %}
-                    bool Handle{{Suffix}}(const char** commands, size_t* size) {
-                        const auto* cmd = GetCommand<{{Suffix}}Cmd>(commands, size);
-                        if (cmd == nullptr) {
-                            return false;
-                        }
+                    bool Handle{{Suffix}}(const {{Suffix}}Cmd& cmd, const ObjectId* objectIds) {
+                        auto& known = mKnown{{type.name.CamelCase()}};
 
-                        ObjectId objectId = cmd->objectId;
+                        for (uint32_t i = 0; i < cmd.objectCount; ++i) {
+                            ObjectId objectId = objectIds[i];
 
-                        //* ID 0 are reserved for nullptr and cannot be destroyed.
-                        if (objectId == 0) {
-                            return false;
-                        }
+                            //* ID 0 are reserved for nullptr and cannot be destroyed.
+                            if (objectId == 0) {
+                                return false;
+                            }
 
-                        auto* data = mKnown{{type.name.CamelCase()}}.Get(objectId);
-                        if (data == nullptr) {
-                            return false;
-                        }
+                            if (!known.IsAllocated(objectId)) {
+                                return false;
+                            }
 
-                        if (data->valid) {
-                            mProcs.{{as_varName(type.name, Name("release"))}}(data->handle);
-                        }
+                            if (known.IsValid(objectId)) {
+                                mProcs.{{as_varName(type.name, Name("release"))}}(known.GetHandle(objectId));
+                            }
 
-                        mKnown{{type.name.CamelCase()}}.Free(objectId);
+                            known.Free(objectId);
+                        }
                         return true;
                     }
                 {% endfor %}
 
-                bool HandleBufferMapAsync(const char** commands, size_t* size) {
+                bool HandleBufferMapAsync(const BufferMapAsyncCmd& cmd) {
                     //* These requests are just forwarded to the buffer, with userdata containing what the client
                     //* will require in the return command.
-                    const auto* cmd = GetCommand<BufferMapAsyncCmd>(commands, size);
-                    if (cmd == nullptr) {
-                        return false;
-                    }
+                    ObjectId bufferId = cmd.bufferId;
+                    uint32_t requestSerial = cmd.requestSerial;
+                    uint32_t requestSize = cmd.size;
+                    uint32_t requestStart = cmd.start;
+                    bool isWrite = cmd.isWrite;
 
-                    ObjectId bufferId = cmd->bufferId;
-                    uint32_t requestSerial = cmd->requestSerial;
-                    uint32_t requestSize = cmd->size;
-                    uint32_t requestStart = cmd->start;
-                    bool isWrite = cmd->isWrite;
-
-                    auto* buffer = mKnownBuffer.Get(bufferId);
-                    if (buffer == nullptr) {
+                    if (!mKnownBuffer.IsAllocated(bufferId)) {
                         return false;
                     }
 
                     auto* data = new MapUserdata;
                     data->server = this;
                     data->bufferId = bufferId;
-                    data->bufferSerial = buffer->serial;
+                    data->bufferSerial = mKnownBuffer.GetSerial(bufferId);
                     data->requestSerial = requestSerial;
                     data->size = requestSize;
                     data->isWrite = isWrite;
 
                     auto userdata = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(data));
+                    mCounters.pendingMapRequestCount++;
 
-                    if (!buffer->valid) {
+                    if (!mKnownBuffer.IsValid(bufferId)) {
                         //* Fake the buffer returning a failure, data will be freed in this call.
                         if (isWrite) {
                             ForwardBufferMapWriteAsync(DAWN_BUFFER_MAP_ASYNC_STATUS_ERROR, nullptr, userdata);
@@ -562,36 +1431,31 @@ namespace dawn_wire {
                         return true;
                     }
 
+                    dawnBuffer buffer = mKnownBuffer.GetHandle(bufferId);
                     if (isWrite) {
-                        mProcs.bufferMapWriteAsync(buffer->handle, requestStart, requestSize, ForwardBufferMapWriteAsync, userdata);
+                        mProcs.bufferMapWriteAsync(buffer, requestStart, requestSize, ForwardBufferMapWriteAsync, userdata);
                     } else {
-                        mProcs.bufferMapReadAsync(buffer->handle, requestStart, requestSize, ForwardBufferMapReadAsync, userdata);
+                        mProcs.bufferMapReadAsync(buffer, requestStart, requestSize, ForwardBufferMapReadAsync, userdata);
                     }
 
                     return true;
                 }
 
-                bool HandleBufferUpdateMappedData(const char** commands, size_t* size) {
-                    const auto* cmd = GetCommand<BufferUpdateMappedDataCmd>(commands, size);
-                    if (cmd == nullptr) {
-                        return false;
-                    }
-
-                    ObjectId bufferId = cmd->bufferId;
-                    size_t dataLength = cmd->dataLength;
+                bool HandleBufferUpdateMappedData(const BufferUpdateMappedDataCmd& cmd, const char* data) {
+                    ObjectId bufferId = cmd.bufferId;
+                    size_t dataLength = cmd.dataLength;
 
-                    auto* buffer = mKnownBuffer.Get(bufferId);
-                    if (buffer == nullptr || !buffer->valid || buffer->mappedData == nullptr ||
-                        buffer->mappedDataSize != dataLength) {
+                    if (!mKnownBuffer.IsAllocated(bufferId) || !mKnownBuffer.IsValid(bufferId)) {
                         return false;
                     }
 
-                    const char* data = GetData<char>(commands, size, dataLength);
-                    if (data == nullptr) {
+                    const auto* mappedData = mKnownBuffer.GetMappedData(bufferId);
+                    if (mappedData == nullptr || mappedData->data == nullptr ||
+                        mappedData->size != dataLength) {
                         return false;
                     }
 
-                    memcpy(buffer->mappedData, data, dataLength);
+                    memcpy(mappedData->data, data, dataLength);
 
                     return true;
                 }
@@ -620,10 +1484,275 @@ namespace dawn_wire {
             auto data = reinterpret_cast<MapUserdata*>(static_cast<uintptr_t>(userdata));
             data->server->OnMapWriteAsyncCallback(status, ptr, data);
         }
+
+        void ForwardFenceCompletedValue(dawnFenceCompletionStatus status, dawnCallbackUserdata userdata) {
+            auto data = reinterpret_cast<FenceCompletionUserdata*>(static_cast<uintptr_t>(userdata));
+            data->server->OnFenceCompletedValue(status, data);
+        }
+
+        class MultiClientServerImpl;
+
+        // A client of the multi-client server, with the queue of commands it sent and its own
+        // Server for its namespace of object IDs. The queue and the quota are protected by the
+        // mutex of the multi-client server.
+        class MultiplexedClient : public CommandHandler {
+            public:
+                MultiplexedClient(MultiClientServerImpl* owner, Server* server, size_t commandBytesPerTick)
+                    : server(server), commandBytesPerTick(commandBytesPerTick), mOwner(owner) {
+                }
+
+                const char* HandleCommands(const char* commands, size_t size) override;
+
+                std::unique_ptr<Server> server;
+                std::deque<std::vector<char>> queue;
+                size_t queuedBytes = 0;
+                size_t commandBytesPerTick;
+                //* The bytes the client can still execute this tick, negative when the last batch
+                //* went over the quota.
+                int64_t allowance = 0;
+                bool failed = false;
+
+            private:
+                MultiClientServerImpl* mOwner;
+        };
+
+        void ForwardDeviceErrorToMultiClientServer(const char* message, dawnCallbackUserdata userdata);
+
+        class MultiClientServerImpl : public MultiClientServer {
+            public:
+                MultiClientServerImpl(dawnDevice device, const dawnProcTable& procs, const ServerOptions& clientOptions)
+                    : mDevice(device), mProcs(procs), mClientOptions(clientOptions) {
+                    mClientOptions.tickPolicy = ServerTickPolicy::Explicit;
+                }
+
+                //* The clients still connected, or removed since the last Tick, are released like
+                //* in Tick. Then the device is waited on until it called the map and fence
+                //* callbacks of all the servers, that it still has pointers to.
+                ~MultiClientServerImpl() {
+                    mProcs.deviceSetErrorCallback(mDevice, nullptr, 0);
+
+                    for (const auto& client : mClients) {
+                        ReleaseClientServer(client.get());
+                    }
+                    for (const auto& client : mRemovedClients) {
+                        ReleaseClientServer(client.get());
+                    }
+                    mClients.clear();
+                    mRemovedClients.clear();
+
+                    while (!mRemovedServers.empty()) {
+                        mProcs.deviceWaitForIdle(mDevice, std::numeric_limits<uint64_t>::max());
+                        RemoveServersWithoutPendingCallbacks();
+                    }
+                }
+
+                CommandHandler* AddClient(CommandSerializer* serializer, size_t commandBytesPerTick) override {
+                    //* Each server owns a reference to the device for its ID 1, so that a client
+                    //* destroying its device only releases its own reference. It is released with
+                    //* the other objects of the client when it is removed.
+                    mProcs.deviceReference(mDevice);
+                    auto server = new Server(mDevice, mProcs, serializer, mClientOptions);
+
+                    //* Each server sets itself as the device error callback so put the multi-client
+                    //* server back in its place.
+                    auto userdata = static_cast<dawnCallbackUserdata>(reinterpret_cast<intptr_t>(this));
+                    mProcs.deviceSetErrorCallback(mDevice, ForwardDeviceErrorToMultiClientServer, userdata);
+
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    mClients.push_back(std::make_unique<MultiplexedClient>(this, server, commandBytesPerTick));
+                    return mClients.back().get();
+                }
+
+                //* The client can be executing commands in Tick on another thread, so it is only
+                //* destroyed at the start of the next Tick.
+                void RemoveClient(CommandHandler* handler) override {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    auto it = std::find_if(mClients.begin(), mClients.end(), [handler](const std::unique_ptr<MultiplexedClient>& client) {
+                        return client.get() == handler;
+                    });
+                    ASSERT(it != mClients.end());
+
+                    (*it)->failed = true;
+                    (*it)->queue.clear();
+                    (*it)->queuedBytes = 0;
+                    mRemovedClients.push_back(std::move(*it));
+                    mClients.erase(it);
+                }
+
+                size_t Tick() override {
+                    std::vector<std::unique_ptr<MultiplexedClient>> removedClients;
+                    {
+                        std::lock_guard<std::mutex> lock(mMutex);
+                        removedClients = std::move(mRemovedClients);
+                        mRemovedClients.clear();
+                    }
+                    for (const auto& client : removedClients) {
+                        ReleaseClientServer(client.get());
+                    }
+                    removedClients.clear();
+
+                    mProcs.deviceTick(mDevice);
+                    RemoveServersWithoutPendingCallbacks();
+
+                    std::vector<MultiplexedClient*> clients;
+                    {
+                        std::lock_guard<std::mutex> lock(mMutex);
+                        for (const auto& client : mClients) {
+                            //* Unused quota isn't carried over to the next tick, but going over the
+                            //* quota is.
+                            client->allowance = std::min(client->allowance, int64_t(0)) +
+                                                static_cast<int64_t>(client->commandBytesPerTick);
+                            clients.push_back(client.get());
+                        }
+                    }
+                    if (clients.empty()) {
+                        return 0;
+                    }
+
+                    //* Send the fence completions the device reported since the last tick, even to
+                    //* the clients that have no commands queued.
+                    for (MultiplexedClient* client : clients) {
+                        client->server->WriteReportedFenceCompletions();
+                    }
+
+                    //* Round robin over the clients, one batch at a time, starting with a different
+                    //* client each tick.
+                    size_t executedBytes = 0;
+                    bool executedBatch = true;
+                    while (executedBatch) {
+                        executedBatch = false;
+                        for (size_t i = 0; i < clients.size(); ++i) {
+                            MultiplexedClient* client = clients[(mFirstClient + i) % clients.size()];
+
+                            std::vector<char> batch;
+                            {
+                                std::lock_guard<std::mutex> lock(mMutex);
+                                if (client->queue.empty() || client->allowance <= 0) {
+                                    continue;
+                                }
+                                batch = std::move(client->queue.front());
+                                client->queue.pop_front();
+                                client->queuedBytes -= batch.size();
+                                client->allowance -= static_cast<int64_t>(batch.size());
+                            }
+
+                            mCurrentServer = client->server.get();
+                            bool success = client->server->HandleCommands(batch.data(), batch.size()) != nullptr;
+                            mCurrentServer = nullptr;
+
+                            if (!success) {
+                                std::lock_guard<std::mutex> lock(mMutex);
+                                client->failed = true;
+                                client->queue.clear();
+                                client->queuedBytes = 0;
+                            }
+
+                            executedBytes += batch.size();
+                            executedBatch = true;
+                        }
+                    }
+
+                    mFirstClient = (mFirstClient + 1) % clients.size();
+                    return executedBytes;
+                }
+
+                size_t GetClientQueuedBytes(const CommandHandler* client) const override {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    return static_cast<const MultiplexedClient*>(client)->queuedBytes;
+                }
+
+                ServerCounters GetClientCounters(const CommandHandler* client) const override {
+                    return static_cast<const MultiplexedClient*>(client)->server->GetCounters();
+                }
+
+                const char* QueueCommands(MultiplexedClient* client, const char* commands, size_t size) {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    if (client->failed) {
+                        return nullptr;
+                    }
+
+                    client->queue.emplace_back(commands, commands + size);
+                    client->queuedBytes += size;
+                    return commands + size;
+                }
+
+                //* Device errors go to the client whose commands produced them, or to all clients
+                //* when they happen outside of the execution of commands.
+                void OnDeviceError(const char* message) {
+                    if (mCurrentServer != nullptr) {
+                        mCurrentServer->OnDeviceError(message);
+                        return;
+                    }
+
+                    //* The lock isn't held while writing the replies because they can be flushed to
+                    //* a client that sends commands right away.
+                    std::vector<Server*> servers;
+                    {
+                        std::lock_guard<std::mutex> lock(mMutex);
+                        for (const auto& client : mClients) {
+                            servers.push_back(client->server.get());
+                        }
+                    }
+                    for (Server* server : servers) {
+                        server->OnDeviceError(message);
+                    }
+                }
+
+            private:
+                //* Releases the objects of a removed client. The backend still calls the map and
+                //* fence callbacks of its server, so the server is kept alive until they are all
+                //* called.
+                void ReleaseClientServer(MultiplexedClient* client) {
+                    std::unique_ptr<Server> server = std::move(client->server);
+                    server->DropReplies();
+                    server->ReleaseKnownObjects();
+                    if (server->HasPendingCallbacks()) {
+                        std::lock_guard<std::mutex> lock(mMutex);
+                        mRemovedServers.push_back(std::move(server));
+                    }
+                }
+
+                void RemoveServersWithoutPendingCallbacks() {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    for (const auto& server : mRemovedServers) {
+                        server->WriteReportedFenceCompletions();
+                    }
+                    mRemovedServers.erase(
+                        std::remove_if(mRemovedServers.begin(), mRemovedServers.end(), [](const std::unique_ptr<Server>& server) {
+                            return !server->HasPendingCallbacks();
+                        }),
+                        mRemovedServers.end());
+                }
+
+                dawnDevice mDevice;
+                dawnProcTable mProcs;
+                ServerOptions mClientOptions;
+
+                mutable std::mutex mMutex;
+                std::vector<std::unique_ptr<MultiplexedClient>> mClients;
+                //* Clients removed since the last Tick, that Tick can still be executing.
+                std::vector<std::unique_ptr<MultiplexedClient>> mRemovedClients;
+                std::vector<std::unique_ptr<Server>> mRemovedServers;
+                size_t mFirstClient = 0;
+                Server* mCurrentServer = nullptr;
+        };
+
+        const char* MultiplexedClient::HandleCommands(const char* commands, size_t size) {
+            return mOwner->QueueCommands(this, commands, size);
+        }
+
+        void ForwardDeviceErrorToMultiClientServer(const char* message, dawnCallbackUserdata userdata) {
+            auto server = reinterpret_cast<MultiClientServerImpl*>(static_cast<intptr_t>(userdata));
+            server->OnDeviceError(message);
+        }
+    }
+
+    ServerCommandHandler* NewServerCommandHandler(dawnDevice device, const dawnProcTable& procs, CommandSerializer* serializer, const ServerOptions& options) {
+        return new server::Server(device, procs, serializer, options);
     }
 
-    CommandHandler* NewServerCommandHandler(dawnDevice device, const dawnProcTable& procs, CommandSerializer* serializer) {
-        return new server::Server(device, procs, serializer);
+    MultiClientServer* NewMultiClientServer(dawnDevice device, const dawnProcTable& procs, const ServerOptions& clientOptions) {
+        return new server::MultiClientServerImpl(device, procs, clientOptions);
     }
 
 }  // namespace dawn_wire
@@ -72,6 +72,14 @@ void ProcTableAsClass::BufferMapWriteAsync(dawnBuffer self, uint32_t start, uint
     OnBufferMapWriteAsyncCallback(self, start, size, callback, userdata);
 }
 
+void ProcTableAsClass::FenceOnCompletion(dawnFence self, uint64_t value, dawnFenceOnCompletionCallback callback, dawnCallbackUserdata userdata) {
+    auto object = reinterpret_cast<ProcTableAsClass::Object*>(self);
+    object->fenceOnCompletionCallback = callback;
+    object->userdata1 = userdata;
+
+    OnFenceOnCompletionCallback(self, value, callback, userdata);
+}
+
 void ProcTableAsClass::CallDeviceErrorCallback(dawnDevice device, const char* message) {
     auto object = reinterpret_cast<ProcTableAsClass::Object*>(device);
     object->deviceErrorCallback(message, object->userdata1);
@@ -90,6 +98,11 @@ void ProcTableAsClass::CallMapWriteCallback(dawnBuffer buffer, dawnBufferMapAsyn
     object->mapWriteCallback(status, data, object->userdata1);
 }
 
+void ProcTableAsClass::CallFenceOnCompletionCallback(dawnFence fence, dawnFenceCompletionStatus status) {
+    auto object = reinterpret_cast<ProcTableAsClass::Object*>(fence);
+    object->fenceOnCompletionCallback(status, object->userdata1);
+}
+
 {% for type in by_category["object"] if type.is_builder %}
     void ProcTableAsClass::{{as_MethodSuffix(type.name, Name("set error callback"))}}({{as_cType(type.name)}} self, dawnBuilderErrorCallback callback, dawnCallbackUserdata userdata1, dawnCallbackUserdata userdata2) {
         auto object = reinterpret_cast<ProcTableAsClass::Object*>(self);
@@ -19,6 +19,7 @@
 #include "common/Serial.h"
 
 #include <cstdint>
+#include <utility>
 #include <vector>
 
 template <typename T>
@@ -120,7 +121,7 @@ void SerialQueue<T>::Enqueue(const T& value, Serial serial) {
     DAWN_ASSERT(Empty() || mStorage.back().first <= serial);
 
     if (Empty() || mStorage.back().first < serial) {
-        mStorage.emplace_back(SerialPair(serial, {}));
+        mStorage.emplace_back(serial, std::vector<T>());
     }
     mStorage.back().second.emplace_back(value);
 }
@@ -130,9 +131,9 @@ void SerialQueue<T>::Enqueue(T&& value, Serial serial) {
     DAWN_ASSERT(Empty() || mStorage.back().first <= serial);
 
     if (Empty() || mStorage.back().first < serial) {
-        mStorage.emplace_back(SerialPair(serial, {}));
+        mStorage.emplace_back(serial, std::vector<T>());
     }
-    mStorage.back().second.emplace_back(value);
+    mStorage.back().second.emplace_back(std::move(value));
 }
 
 template <typename T>
@@ -146,7 +147,7 @@ template <typename T>
 void SerialQueue<T>::Enqueue(std::vector<T>&& values, Serial serial) {
     DAWN_ASSERT(values.size() > 0);
     DAWN_ASSERT(Empty() || mStorage.back().first <= serial);
-    mStorage.emplace_back(SerialPair(serial, {values}));
+    mStorage.emplace_back(SerialPair(serial, std::move(values)));
 }
 
 template <typename T>
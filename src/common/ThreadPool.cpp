@@ -0,0 +1,160 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/ThreadPool.h"
+
+#include "common/Assert.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(uint32_t threadCount) : mThreadCount(threadCount) {
+    if (mThreadCount == 0) {
+        mThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    mSlices.reset(new Slice[mThreadCount]);
+    for (uint32_t i = 1; i < mThreadCount; ++i) {
+        mThreads.emplace_back(&ThreadPool::WorkerThread, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mLoopStarted.notify_all();
+
+    for (std::thread& thread : mThreads) {
+        thread.join();
+    }
+}
+
+uint32_t ThreadPool::GetThreadCount() const {
+    return mThreadCount;
+}
+
+void ThreadPool::ParallelFor(uint32_t count, const Task& task) {
+    if (count == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> parallelForLock(mParallelForMutex);
+
+    // Waking up the workers isn't worth it for a single iteration.
+    if (mThreads.empty() || count == 1) {
+        for (uint32_t i = 0; i < count; ++i) {
+            task(i, 0);
+        }
+        return;
+    }
+
+    for (uint32_t i = 0; i < mThreadCount; ++i) {
+        std::lock_guard<std::mutex> lock(mSlices[i].mutex);
+        mSlices[i].begin = static_cast<uint32_t>(uint64_t(count) * i / mThreadCount);
+        mSlices[i].end = static_cast<uint32_t>(uint64_t(count) * (i + 1) / mThreadCount);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTask = &task;
+        mRunningWorkers = static_cast<uint32_t>(mThreads.size());
+        mLoopSerial++;
+    }
+    mLoopStarted.notify_all();
+
+    RunIterations(0, task);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mLoopDone.wait(lock, [this] { return mRunningWorkers == 0; });
+    mTask = nullptr;
+}
+
+void ThreadPool::WorkerThread(uint32_t threadIndex) {
+    uint64_t lastLoopSerial = 0;
+
+    while (true) {
+        const Task* task = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mLoopStarted.wait(lock,
+                              [&] { return mStopping || mLoopSerial != lastLoopSerial; });
+            if (mStopping) {
+                return;
+            }
+            lastLoopSerial = mLoopSerial;
+            task = mTask;
+        }
+
+        RunIterations(threadIndex, *task);
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            ASSERT(mRunningWorkers > 0);
+            mRunningWorkers--;
+            if (mRunningWorkers != 0) {
+                continue;
+            }
+        }
+        mLoopDone.notify_one();
+    }
+}
+
+void ThreadPool::RunIterations(uint32_t threadIndex, const Task& task) {
+    uint32_t index;
+    while (TakeIteration(threadIndex, &index) ||
+           (StealIterations(threadIndex) && TakeIteration(threadIndex, &index))) {
+        task(index, threadIndex);
+    }
+}
+
+bool ThreadPool::TakeIteration(uint32_t threadIndex, uint32_t* index) {
+    Slice& slice = mSlices[threadIndex];
+    std::lock_guard<std::mutex> lock(slice.mutex);
+    if (slice.begin == slice.end) {
+        return false;
+    }
+    *index = slice.begin++;
+    return true;
+}
+
+bool ThreadPool::StealIterations(uint32_t threadIndex) {
+    // Look at the other threads starting with the next one so that the thieves spread out.
+    for (uint32_t i = 1; i < mThreadCount; ++i) {
+        Slice& victim = mSlices[(threadIndex + i) % mThreadCount];
+
+        uint32_t begin;
+        uint32_t end;
+        {
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            uint32_t remaining = victim.end - victim.begin;
+            if (remaining == 0) {
+                continue;
+            }
+
+            end = victim.end;
+            begin = victim.end - (remaining + 1) / 2;
+            victim.end = begin;
+        }
+
+        // Only this thread adds iterations to its own slice, and it is empty.
+        Slice& slice = mSlices[threadIndex];
+        std::lock_guard<std::mutex> lock(slice.mutex);
+        ASSERT(slice.begin == slice.end);
+        slice.begin = begin;
+        slice.end = end;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,76 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef COMMON_THREADPOOL_H_
+#define COMMON_THREADPOOL_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of threads running the iterations of parallel loops. Each thread starts with a
+// contiguous slice of the iterations and, when its slice is exhausted, steals the back half of the
+// slice of another thread so that loops with uneven iterations still keep all threads busy.
+class ThreadPool {
+  public:
+    // The thread calling ParallelFor takes part in the loop so threadCount - 1 threads are
+    // spawned. A threadCount of 0 uses one thread per hardware thread.
+    explicit ThreadPool(uint32_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool& other) = delete;
+    ThreadPool& operator=(const ThreadPool& other) = delete;
+
+    uint32_t GetThreadCount() const;
+
+    // Calls task(index, threadIndex) for each index in [0, count) and returns once all the calls
+    // are done. threadIndex is in [0, GetThreadCount()) and no two calls running at the same time
+    // have the same, so it can be used to index per-thread data. Calls to ParallelFor from
+    // different threads are serialized.
+    using Task = std::function<void(uint32_t index, uint32_t threadIndex)>;
+    void ParallelFor(uint32_t count, const Task& task);
+
+  private:
+    struct Slice {
+        std::mutex mutex;
+        uint32_t begin = 0;
+        uint32_t end = 0;
+    };
+
+    void WorkerThread(uint32_t threadIndex);
+    void RunIterations(uint32_t threadIndex, const Task& task);
+    bool TakeIteration(uint32_t threadIndex, uint32_t* index);
+    bool StealIterations(uint32_t threadIndex);
+
+    uint32_t mThreadCount;
+    std::unique_ptr<Slice[]> mSlices;
+    std::vector<std::thread> mThreads;
+
+    std::mutex mParallelForMutex;
+
+    // Protects the members below, that hand out the loops to the worker threads.
+    std::mutex mMutex;
+    std::condition_variable mLoopStarted;
+    std::condition_variable mLoopDone;
+    const Task* mTask = nullptr;
+    uint64_t mLoopSerial = 0;
+    uint32_t mRunningWorkers = 0;
+    bool mStopping = false;
+};
+
+#endif  // COMMON_THREADPOOL_H_
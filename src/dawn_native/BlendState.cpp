@@ -20,7 +20,12 @@ namespace dawn_native {
 
     // BlendStateBase
 
-    BlendStateBase::BlendStateBase(BlendStateBuilder* builder) : mBlendInfo(builder->mBlendInfo) {
+    BlendStateBase::BlendStateBase(BlendStateBuilder* builder)
+        : mDevice(builder->GetDevice()), mBlendInfo(builder->mBlendInfo) {
+    }
+
+    DeviceBase* BlendStateBase::GetDevice() const {
+        return mDevice;
     }
 
     const BlendStateBase::BlendInfo& BlendStateBase::GetBlendInfo() const {
@@ -40,9 +40,11 @@ namespace dawn_native {
             dawn::ColorWriteMask colorWriteMask = dawn::ColorWriteMask::All;
         };
 
+        DeviceBase* GetDevice() const;
         const BlendInfo& GetBlendInfo() const;
 
       private:
+        DeviceBase* mDevice;
         BlendInfo mBlendInfo;
     };
 
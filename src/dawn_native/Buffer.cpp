@@ -212,6 +212,10 @@ namespace dawn_native {
         : mBuffer(std::move(builder->mBuffer)), mSize(builder->mSize), mOffset(builder->mOffset) {
     }
 
+    DeviceBase* BufferViewBase::GetDevice() const {
+        return mBuffer->GetDevice();
+    }
+
     BufferBase* BufferViewBase::GetBuffer() {
         return mBuffer.Get();
     }
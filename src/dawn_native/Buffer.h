@@ -91,6 +91,7 @@ namespace dawn_native {
       public:
         BufferViewBase(BufferViewBuilder* builder);
 
+        DeviceBase* GetDevice() const;
         BufferBase* GetBuffer();
         uint32_t GetSize() const;
         uint32_t GetOffset() const;
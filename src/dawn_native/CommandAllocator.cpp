@@ -35,7 +35,7 @@ namespace dawn_native {
     CommandIterator::~CommandIterator() {
         ASSERT(mDataWasDestroyed);
 
-        if (!IsEmpty()) {
+        if (!IsEmpty() && mOwnsBlocks) {
             for (auto& block : mBlocks) {
                 free(block.block);
             }
@@ -74,6 +74,30 @@ namespace dawn_native {
         return *this;
     }
 
+    CommandIterator::CommandIterator(const CommandIterator& commands,
+                                     const CommandPosition& position)
+        : mBlocks(commands.mBlocks),
+          mEndOfBlock(EndOfBlock),
+          mDataWasDestroyed(true),
+          mOwnsBlocks(false) {
+        ASSERT(!commands.IsEmpty());
+        SetPosition(position);
+    }
+
+    CommandPosition CommandIterator::GetPosition() const {
+        CommandPosition position;
+        position.block = mCurrentBlock;
+        position.offset = static_cast<size_t>(mCurrentPtr - mBlocks[mCurrentBlock].block);
+        return position;
+    }
+
+    void CommandIterator::SetPosition(const CommandPosition& position) {
+        ASSERT(position.block < mBlocks.size());
+        ASSERT(position.offset + sizeof(uint32_t) <= mBlocks[position.block].size);
+        mCurrentBlock = position.block;
+        mCurrentPtr = mBlocks[position.block].block + position.offset;
+    }
+
     void CommandIterator::Reset() {
         mCurrentBlock = 0;
 
@@ -157,6 +181,14 @@ namespace dawn_native {
         ASSERT(mBlocks.empty());
     }
 
+    CommandPosition CommandAllocator::GetPosition() const {
+        ASSERT(!mBlocks.empty());
+        CommandPosition position;
+        position.block = mBlocks.size() - 1;
+        position.offset = static_cast<size_t>(mCurrentPtr - mBlocks.back().block);
+        return position;
+    }
+
     CommandBlocks&& CommandAllocator::AcquireBlocks() {
         ASSERT(mCurrentPtr != nullptr && mEndPtr != nullptr);
         ASSERT(IsPtrAligned(mCurrentPtr, alignof(uint32_t)));
@@ -57,6 +57,13 @@ namespace dawn_native {
     };
     using CommandBlocks = std::vector<BlockDef>;
 
+    // A position in the commands, used to iterate over a part of them, for example a single pass.
+    // It points before a command id, so iteration starts with the command recorded after it.
+    struct CommandPosition {
+        size_t block = 0;
+        size_t offset = 0;
+    };
+
     class CommandAllocator;
 
     // TODO(cwallez@chromium.org): prevent copy for both iterator and allocator
@@ -71,6 +78,14 @@ namespace dawn_native {
         CommandIterator(CommandAllocator&& allocator);
         CommandIterator& operator=(CommandAllocator&& allocator);
 
+        // Creates an iterator over the commands of |commands| that starts at |position|. It
+        // doesn't own the commands so several of them can iterate on different threads while
+        // |commands| is alive and not iterated.
+        CommandIterator(const CommandIterator& commands, const CommandPosition& position);
+
+        CommandPosition GetPosition() const;
+        void SetPosition(const CommandPosition& position);
+
         template <typename E>
         bool NextCommandId(E* commandId) {
             return NextCommandId(reinterpret_cast<uint32_t*>(commandId));
@@ -102,6 +117,7 @@ namespace dawn_native {
         // Used to avoid a special case for empty iterators.
         uint32_t mEndOfBlock;
         bool mDataWasDestroyed = false;
+        bool mOwnsBlocks = true;
     };
 
     class CommandAllocator {
@@ -122,6 +138,10 @@ namespace dawn_native {
             return reinterpret_cast<T*>(AllocateData(sizeof(T) * count, alignof(T)));
         }
 
+        // Returns the position after the last allocation, at least one command must have been
+        // allocated.
+        CommandPosition GetPosition() const;
+
       private:
         friend CommandIterator;
         CommandBlocks&& AcquireBlocks();
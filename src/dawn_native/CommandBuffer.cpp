@@ -14,12 +14,14 @@
 
 #include "dawn_native/CommandBuffer.h"
 
+#include "common/ThreadPool.h"
 #include "dawn_native/BindGroup.h"
 #include "dawn_native/Buffer.h"
 #include "dawn_native/CommandBufferStateTracker.h"
 #include "dawn_native/Commands.h"
 #include "dawn_native/ComputePipeline.h"
 #include "dawn_native/Device.h"
+#include "dawn_native/ErrorData.h"
 #include "dawn_native/InputState.h"
 #include "dawn_native/PipelineLayout.h"
 #include "dawn_native/RenderPipeline.h"
@@ -27,6 +29,7 @@
 
 #include <cstring>
 #include <map>
+#include <memory>
 
 namespace dawn_native {
 
@@ -271,6 +274,194 @@ namespace dawn_native {
             }
         }
 
+        MaybeError ValidateComputePass(CommandIterator* commands, PassResourceUsage* usage) {
+            PassResourceUsageTracker usageTracker;
+            CommandBufferStateTracker persistentState;
+
+            Command type;
+            while (commands->NextCommandId(&type)) {
+                switch (type) {
+                    case Command::EndComputePass: {
+                        commands->NextCommand<EndComputePassCmd>();
+
+                        DAWN_TRY(usageTracker.ValidateUsages(PassType::Compute));
+                        *usage = usageTracker.AcquireResourceUsage();
+                        return {};
+                    } break;
+
+                    case Command::Dispatch: {
+                        commands->NextCommand<DispatchCmd>();
+                        DAWN_TRY(persistentState.ValidateCanDispatch());
+                    } break;
+
+                    case Command::SetComputePipeline: {
+                        SetComputePipelineCmd* cmd = commands->NextCommand<SetComputePipelineCmd>();
+                        ComputePipelineBase* pipeline = cmd->pipeline.Get();
+                        persistentState.SetComputePipeline(pipeline);
+                    } break;
+
+                    case Command::SetPushConstants: {
+                        SetPushConstantsCmd* cmd = commands->NextCommand<SetPushConstantsCmd>();
+                        commands->NextData<uint32_t>(cmd->count);
+                        // Validation of count and offset has already been done when the command was
+                        // recorded because it impacts the size of an allocation in the
+                        // CommandAllocator.
+                        if (cmd->stages & ~dawn::ShaderStageBit::Compute) {
+                            return DAWN_VALIDATION_ERROR(
+                                "SetPushConstants stage must be compute or 0 in compute passes");
+                        }
+                    } break;
+
+                    case Command::SetBindGroup: {
+                        SetBindGroupCmd* cmd = commands->NextCommand<SetBindGroupCmd>();
+
+                        TrackBindGroupResourceUsage(cmd->group.Get(), &usageTracker);
+                        persistentState.SetBindGroup(cmd->index, cmd->group.Get());
+                    } break;
+
+                    default:
+                        return DAWN_VALIDATION_ERROR("Command disallowed inside a compute pass");
+                }
+            }
+
+            return DAWN_VALIDATION_ERROR("Unfinished compute pass");
+        }
+
+        MaybeError ValidateRenderPass(CommandIterator* commands,
+                                      RenderPassDescriptorBase* renderPass,
+                                      PassResourceUsage* usage) {
+            PassResourceUsageTracker usageTracker;
+            CommandBufferStateTracker persistentState;
+
+            // Track usage of the render pass attachments
+            for (uint32_t i : IterateBitSet(renderPass->GetColorAttachmentMask())) {
+                TextureBase* texture = renderPass->GetColorAttachment(i).view->GetTexture();
+                usageTracker.TextureUsedAs(texture, dawn::TextureUsageBit::OutputAttachment);
+            }
+
+            if (renderPass->HasDepthStencilAttachment()) {
+                TextureBase* texture = renderPass->GetDepthStencilAttachment().view->GetTexture();
+                usageTracker.TextureUsedAs(texture, dawn::TextureUsageBit::OutputAttachment);
+            }
+
+            Command type;
+            while (commands->NextCommandId(&type)) {
+                switch (type) {
+                    case Command::EndRenderPass: {
+                        commands->NextCommand<EndRenderPassCmd>();
+
+                        DAWN_TRY(usageTracker.ValidateUsages(PassType::Render));
+                        *usage = usageTracker.AcquireResourceUsage();
+                        return {};
+                    } break;
+
+                    case Command::DrawArrays: {
+                        commands->NextCommand<DrawArraysCmd>();
+                        DAWN_TRY(persistentState.ValidateCanDrawArrays());
+                    } break;
+
+                    case Command::DrawElements: {
+                        commands->NextCommand<DrawElementsCmd>();
+                        DAWN_TRY(persistentState.ValidateCanDrawElements());
+                    } break;
+
+                    case Command::SetRenderPipeline: {
+                        SetRenderPipelineCmd* cmd = commands->NextCommand<SetRenderPipelineCmd>();
+                        RenderPipelineBase* pipeline = cmd->pipeline.Get();
+
+                        if (!pipeline->IsCompatibleWith(renderPass)) {
+                            return DAWN_VALIDATION_ERROR(
+                                "Pipeline is incompatible with this render pass");
+                        }
+
+                        persistentState.SetRenderPipeline(pipeline);
+                    } break;
+
+                    case Command::SetPushConstants: {
+                        SetPushConstantsCmd* cmd = commands->NextCommand<SetPushConstantsCmd>();
+                        commands->NextData<uint32_t>(cmd->count);
+                        // Validation of count and offset has already been done when the command was
+                        // recorded because it impacts the size of an allocation in the
+                        // CommandAllocator.
+                        if (cmd->stages &
+                            ~(dawn::ShaderStageBit::Vertex | dawn::ShaderStageBit::Fragment)) {
+                            return DAWN_VALIDATION_ERROR(
+                                "SetPushConstants stage must be a subset of (vertex|fragment) in "
+                                "render passes");
+                        }
+                    } break;
+
+                    case Command::SetStencilReference: {
+                        commands->NextCommand<SetStencilReferenceCmd>();
+                    } break;
+
+                    case Command::SetBlendColor: {
+                        commands->NextCommand<SetBlendColorCmd>();
+                    } break;
+
+                    case Command::SetScissorRect: {
+                        commands->NextCommand<SetScissorRectCmd>();
+                    } break;
+
+                    case Command::SetBindGroup: {
+                        SetBindGroupCmd* cmd = commands->NextCommand<SetBindGroupCmd>();
+
+                        TrackBindGroupResourceUsage(cmd->group.Get(), &usageTracker);
+                        persistentState.SetBindGroup(cmd->index, cmd->group.Get());
+                    } break;
+
+                    case Command::SetIndexBuffer: {
+                        SetIndexBufferCmd* cmd = commands->NextCommand<SetIndexBufferCmd>();
+
+                        usageTracker.BufferUsedAs(cmd->buffer.Get(), dawn::BufferUsageBit::Index);
+                        persistentState.SetIndexBuffer();
+                    } break;
+
+                    case Command::SetVertexBuffers: {
+                        SetVertexBuffersCmd* cmd = commands->NextCommand<SetVertexBuffersCmd>();
+                        auto buffers = commands->NextData<Ref<BufferBase>>(cmd->count);
+                        commands->NextData<uint32_t>(cmd->count);
+
+                        for (uint32_t i = 0; i < cmd->count; ++i) {
+                            usageTracker.BufferUsedAs(buffers[i].Get(),
+                                                      dawn::BufferUsageBit::Vertex);
+                        }
+                        persistentState.SetVertexBuffer(cmd->startSlot, cmd->count);
+                    } break;
+
+                    default:
+                        return DAWN_VALIDATION_ERROR("Command disallowed inside a render pass");
+                }
+            }
+
+            return DAWN_VALIDATION_ERROR("Unfinished render pass");
+        }
+
+        struct PassValidationResult {
+            std::unique_ptr<ErrorData> error;
+            PassResourceUsage usage;
+            // The position after the end of the pass, where the validation of the commands
+            // outside of passes continues.
+            CommandPosition end;
+        };
+
+        // Validates the pass that starts at |start|. Only the commands of the pass are touched so
+        // that passes can be validated on several threads at the same time.
+        void ValidatePass(const CommandIterator& allCommands,
+                          const CommandPosition& start,
+                          RenderPassDescriptorBase* renderPass,
+                          PassValidationResult* result) {
+            CommandIterator commands(allCommands, start);
+
+            MaybeError error = renderPass != nullptr
+                                   ? ValidateRenderPass(&commands, renderPass, &result->usage)
+                                   : ValidateComputePass(&commands, &result->usage);
+            if (error.IsError()) {
+                result->error.reset(error.AcquireError());
+            }
+            result->end = commands.GetPosition();
+        }
+
     }  // namespace
 
     // CommandBuffer
@@ -325,17 +516,47 @@ namespace dawn_native {
         MoveToIterator();
         mIterator.Reset();
 
+        // The passes of large command buffers are validated in parallel before the walk over the
+        // commands below. The walk uses the results in order so the error returned is the same as
+        // with serial validation, and the passes of smaller command buffers are validated when the
+        // walk reaches them.
+        std::vector<PassValidationResult> passResults(mPasses.size());
+        bool validatedInParallel = mPasses.size() >= kMinPassCountForParallelValidation;
+        if (validatedInParallel) {
+            ThreadPool* threadPool = mDevice->GetValidationThreadPool();
+            threadPool->ParallelFor(static_cast<uint32_t>(mPasses.size()),
+                                    [&](uint32_t index, uint32_t) {
+                                        ValidatePass(mIterator, mPasses[index].start,
+                                                     mPasses[index].renderPass,
+                                                     &passResults[index]);
+                                    });
+        }
+
+        size_t passIndex = 0;
         Command type;
         while (mIterator.NextCommandId(&type)) {
             switch (type) {
-                case Command::BeginComputePass: {
-                    mIterator.NextCommand<BeginComputePassCmd>();
-                    DAWN_TRY(ValidateComputePass());
-                } break;
-
+                case Command::BeginComputePass:
                 case Command::BeginRenderPass: {
-                    BeginRenderPassCmd* cmd = mIterator.NextCommand<BeginRenderPassCmd>();
-                    DAWN_TRY(ValidateRenderPass(cmd->info.Get()));
+                    if (type == Command::BeginComputePass) {
+                        mIterator.NextCommand<BeginComputePassCmd>();
+                    } else {
+                        mIterator.NextCommand<BeginRenderPassCmd>();
+                    }
+
+                    ASSERT(passIndex < mPasses.size());
+                    PassValidationResult* result = &passResults[passIndex];
+                    if (!validatedInParallel) {
+                        ValidatePass(mIterator, mPasses[passIndex].start,
+                                     mPasses[passIndex].renderPass, result);
+                    }
+                    passIndex++;
+
+                    if (result->error != nullptr) {
+                        return result->error.release();
+                    }
+                    mPassResourceUsages.push_back(std::move(result->usage));
+                    mIterator.SetPosition(result->end);
                 } break;
 
                 case Command::CopyBufferToBuffer: {
@@ -396,176 +617,18 @@ namespace dawn_native {
         return {};
     }
 
-    MaybeError CommandBufferBuilder::ValidateComputePass() {
-        PassResourceUsageTracker usageTracker;
-        CommandBufferStateTracker persistentState;
-
-        Command type;
-        while (mIterator.NextCommandId(&type)) {
-            switch (type) {
-                case Command::EndComputePass: {
-                    mIterator.NextCommand<EndComputePassCmd>();
-
-                    DAWN_TRY(usageTracker.ValidateUsages(PassType::Compute));
-                    mPassResourceUsages.push_back(usageTracker.AcquireResourceUsage());
-                    return {};
-                } break;
-
-                case Command::Dispatch: {
-                    mIterator.NextCommand<DispatchCmd>();
-                    DAWN_TRY(persistentState.ValidateCanDispatch());
-                } break;
-
-                case Command::SetComputePipeline: {
-                    SetComputePipelineCmd* cmd = mIterator.NextCommand<SetComputePipelineCmd>();
-                    ComputePipelineBase* pipeline = cmd->pipeline.Get();
-                    persistentState.SetComputePipeline(pipeline);
-                } break;
-
-                case Command::SetPushConstants: {
-                    SetPushConstantsCmd* cmd = mIterator.NextCommand<SetPushConstantsCmd>();
-                    mIterator.NextData<uint32_t>(cmd->count);
-                    // Validation of count and offset has already been done when the command was
-                    // recorded because it impacts the size of an allocation in the
-                    // CommandAllocator.
-                    if (cmd->stages & ~dawn::ShaderStageBit::Compute) {
-                        return DAWN_VALIDATION_ERROR(
-                            "SetPushConstants stage must be compute or 0 in compute passes");
-                    }
-                } break;
-
-                case Command::SetBindGroup: {
-                    SetBindGroupCmd* cmd = mIterator.NextCommand<SetBindGroupCmd>();
-
-                    TrackBindGroupResourceUsage(cmd->group.Get(), &usageTracker);
-                    persistentState.SetBindGroup(cmd->index, cmd->group.Get());
-                } break;
-
-                default:
-                    return DAWN_VALIDATION_ERROR("Command disallowed inside a compute pass");
-            }
-        }
-
-        return DAWN_VALIDATION_ERROR("Unfinished compute pass");
-    }
-
-    MaybeError CommandBufferBuilder::ValidateRenderPass(RenderPassDescriptorBase* renderPass) {
-        PassResourceUsageTracker usageTracker;
-        CommandBufferStateTracker persistentState;
-
-        // Track usage of the render pass attachments
-        for (uint32_t i : IterateBitSet(renderPass->GetColorAttachmentMask())) {
-            TextureBase* texture = renderPass->GetColorAttachment(i).view->GetTexture();
-            usageTracker.TextureUsedAs(texture, dawn::TextureUsageBit::OutputAttachment);
-        }
-
-        if (renderPass->HasDepthStencilAttachment()) {
-            TextureBase* texture = renderPass->GetDepthStencilAttachment().view->GetTexture();
-            usageTracker.TextureUsedAs(texture, dawn::TextureUsageBit::OutputAttachment);
-        }
-
-        Command type;
-        while (mIterator.NextCommandId(&type)) {
-            switch (type) {
-                case Command::EndRenderPass: {
-                    mIterator.NextCommand<EndRenderPassCmd>();
-
-                    DAWN_TRY(usageTracker.ValidateUsages(PassType::Render));
-                    mPassResourceUsages.push_back(usageTracker.AcquireResourceUsage());
-                    return {};
-                } break;
-
-                case Command::DrawArrays: {
-                    mIterator.NextCommand<DrawArraysCmd>();
-                    DAWN_TRY(persistentState.ValidateCanDrawArrays());
-                } break;
-
-                case Command::DrawElements: {
-                    mIterator.NextCommand<DrawElementsCmd>();
-                    DAWN_TRY(persistentState.ValidateCanDrawElements());
-                } break;
-
-                case Command::SetRenderPipeline: {
-                    SetRenderPipelineCmd* cmd = mIterator.NextCommand<SetRenderPipelineCmd>();
-                    RenderPipelineBase* pipeline = cmd->pipeline.Get();
-
-                    if (!pipeline->IsCompatibleWith(renderPass)) {
-                        return DAWN_VALIDATION_ERROR(
-                            "Pipeline is incompatible with this render pass");
-                    }
-
-                    persistentState.SetRenderPipeline(pipeline);
-                } break;
-
-                case Command::SetPushConstants: {
-                    SetPushConstantsCmd* cmd = mIterator.NextCommand<SetPushConstantsCmd>();
-                    mIterator.NextData<uint32_t>(cmd->count);
-                    // Validation of count and offset has already been done when the command was
-                    // recorded because it impacts the size of an allocation in the
-                    // CommandAllocator.
-                    if (cmd->stages &
-                        ~(dawn::ShaderStageBit::Vertex | dawn::ShaderStageBit::Fragment)) {
-                        return DAWN_VALIDATION_ERROR(
-                            "SetPushConstants stage must be a subset of (vertex|fragment) in "
-                            "render passes");
-                    }
-                } break;
-
-                case Command::SetStencilReference: {
-                    mIterator.NextCommand<SetStencilReferenceCmd>();
-                } break;
-
-                case Command::SetBlendColor: {
-                    mIterator.NextCommand<SetBlendColorCmd>();
-                } break;
-
-                case Command::SetScissorRect: {
-                    mIterator.NextCommand<SetScissorRectCmd>();
-                } break;
-
-                case Command::SetBindGroup: {
-                    SetBindGroupCmd* cmd = mIterator.NextCommand<SetBindGroupCmd>();
-
-                    TrackBindGroupResourceUsage(cmd->group.Get(), &usageTracker);
-                    persistentState.SetBindGroup(cmd->index, cmd->group.Get());
-                } break;
-
-                case Command::SetIndexBuffer: {
-                    SetIndexBufferCmd* cmd = mIterator.NextCommand<SetIndexBufferCmd>();
-
-                    usageTracker.BufferUsedAs(cmd->buffer.Get(), dawn::BufferUsageBit::Index);
-                    persistentState.SetIndexBuffer();
-                } break;
-
-                case Command::SetVertexBuffers: {
-                    SetVertexBuffersCmd* cmd = mIterator.NextCommand<SetVertexBuffersCmd>();
-                    auto buffers = mIterator.NextData<Ref<BufferBase>>(cmd->count);
-                    mIterator.NextData<uint32_t>(cmd->count);
-
-                    for (uint32_t i = 0; i < cmd->count; ++i) {
-                        usageTracker.BufferUsedAs(buffers[i].Get(), dawn::BufferUsageBit::Vertex);
-                    }
-                    persistentState.SetVertexBuffer(cmd->startSlot, cmd->count);
-                } break;
-
-                default:
-                    return DAWN_VALIDATION_ERROR("Command disallowed inside a render pass");
-            }
-        }
-
-        return DAWN_VALIDATION_ERROR("Unfinished render pass");
-    }
-
     // Implementation of the API's command recording methods
 
     void CommandBufferBuilder::BeginComputePass() {
         mAllocator.Allocate<BeginComputePassCmd>(Command::BeginComputePass);
+        mPasses.push_back({mAllocator.GetPosition(), nullptr});
     }
 
     void CommandBufferBuilder::BeginRenderPass(RenderPassDescriptorBase* info) {
         BeginRenderPassCmd* cmd = mAllocator.Allocate<BeginRenderPassCmd>(Command::BeginRenderPass);
         new (cmd) BeginRenderPassCmd;
         cmd->info = info;
+        mPasses.push_back({mAllocator.GetPosition(), info});
     }
 
     void CommandBufferBuilder::CopyBufferToBuffer(BufferBase* source,
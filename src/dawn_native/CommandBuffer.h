@@ -39,6 +39,10 @@ namespace dawn_native {
 
     class CommandBufferBuilder;
 
+    // Passes are only validated in parallel when there are enough of them to make up for the cost
+    // of waking the validation threads.
+    static constexpr size_t kMinPassCountForParallelValidation = 8;
+
     class CommandBufferBase : public RefCounted {
       public:
         CommandBufferBase(CommandBufferBuilder* builder);
@@ -136,9 +140,6 @@ namespace dawn_native {
         CommandBufferBase* GetResultImpl() override;
         void MoveToIterator();
 
-        MaybeError ValidateComputePass();
-        MaybeError ValidateRenderPass(RenderPassDescriptorBase* renderPass);
-
         CommandAllocator mAllocator;
         CommandIterator mIterator;
         bool mWasMovedToIterator = false;
@@ -146,6 +147,15 @@ namespace dawn_native {
         bool mWerePassUsagesAcquired = false;
 
         std::vector<PassResourceUsage> mPassResourceUsages;
+
+        // The passes are recorded with the position of their first command so that they can be
+        // validated independently of each other.
+        struct PassInfo {
+            CommandPosition start;
+            // nullptr for compute passes.
+            RenderPassDescriptorBase* renderPass;
+        };
+        std::vector<PassInfo> mPasses;
     };
 
 }  // namespace dawn_native
@@ -0,0 +1,52 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dawn_native/DeferredDeletionQueue.h"
+
+#include "common/Assert.h"
+
+#include <cstddef>
+
+namespace dawn_native {
+
+    DeferredDeletionQueue::DeferredDeletionQueue(DeviceBase* device) : mDevice(device) {
+    }
+
+    DeferredDeletionQueue::~DeferredDeletionQueue() {
+        ASSERT(Empty());
+    }
+
+    void DeferredDeletionQueue::Enqueue(DestroyFunction destroy, uint64_t handle, Serial serial) {
+        ASSERT(Empty() || mDeletions.back().serial <= serial);
+        mDeletions.push_back({serial, destroy, handle});
+    }
+
+    void DeferredDeletionQueue::Tick(Serial completedSerial) {
+        // Each deletion is copied before its destroy function runs because the function can
+        // enqueue more deletions, which can reallocate the array.
+        size_t deletedCount = 0;
+        while (deletedCount < mDeletions.size() &&
+               mDeletions[deletedCount].serial <= completedSerial) {
+            Deletion deletion = mDeletions[deletedCount];
+            deletion.destroy(mDevice, deletion.handle);
+            deletedCount++;
+        }
+        mDeletions.erase(mDeletions.begin(), mDeletions.begin() + deletedCount);
+    }
+
+    bool DeferredDeletionQueue::Empty() const {
+        return mDeletions.empty();
+    }
+
+}  // namespace dawn_native
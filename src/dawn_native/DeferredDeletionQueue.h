@@ -0,0 +1,59 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DAWNNATIVE_DEFERREDDELETIONQUEUE_H_
+#define DAWNNATIVE_DEFERREDDELETIONQUEUE_H_
+
+#include "common/Serial.h"
+#include "dawn_native/Forward.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace dawn_native {
+
+    // Holds the backend objects that can only be destroyed once the GPU is done with the commands
+    // of a serial. An object is recorded as a 64-bit handle and the function destroying it, so
+    // that the objects of all types are kept in a single array and destroyed in one pass over it.
+    // Objects are destroyed in the order they are enqueued, so an object must be enqueued before
+    // the objects it depends on, for example a VkBuffer before the VkDeviceMemory bound to it.
+    class DeferredDeletionQueue {
+      public:
+        using DestroyFunction = void (*)(DeviceBase* device, uint64_t handle);
+
+        DeferredDeletionQueue(DeviceBase* device);
+        ~DeferredDeletionQueue();
+
+        // The serial must be given in (not strictly) increasing order.
+        void Enqueue(DestroyFunction destroy, uint64_t handle, Serial serial);
+
+        // Destroys all the objects enqueued with a serial up to completedSerial.
+        void Tick(Serial completedSerial);
+
+        bool Empty() const;
+
+      private:
+        struct Deletion {
+            Serial serial;
+            DestroyFunction destroy;
+            uint64_t handle;
+        };
+
+        DeviceBase* mDevice;
+        std::vector<Deletion> mDeletions;
+    };
+
+}  // namespace dawn_native
+
+#endif  // DAWNNATIVE_DEFERREDDELETIONQUEUE_H_
@@ -21,7 +21,13 @@ namespace dawn_native {
     // DepthStencilStateBase
 
     DepthStencilStateBase::DepthStencilStateBase(DepthStencilStateBuilder* builder)
-        : mDepthInfo(builder->mDepthInfo), mStencilInfo(builder->mStencilInfo) {
+        : mDevice(builder->GetDevice()),
+          mDepthInfo(builder->mDepthInfo),
+          mStencilInfo(builder->mStencilInfo) {
+    }
+
+    DeviceBase* DepthStencilStateBase::GetDevice() const {
+        return mDevice;
     }
 
     bool DepthStencilStateBase::StencilTestEnabled() const {
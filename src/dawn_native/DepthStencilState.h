@@ -46,11 +46,13 @@ namespace dawn_native {
             uint32_t writeMask = 0xff;
         };
 
+        DeviceBase* GetDevice() const;
         bool StencilTestEnabled() const;
         const DepthInfo& GetDepth() const;
         const StencilInfo& GetStencil() const;
 
       private:
+        DeviceBase* mDevice;
         DepthInfo mDepthInfo;
         StencilInfo mStencilInfo;
     };
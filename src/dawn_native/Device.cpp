@@ -14,6 +14,7 @@
 
 #include "dawn_native/Device.h"
 
+#include "common/ThreadPool.h"
 #include "dawn_native/BindGroup.h"
 #include "dawn_native/BindGroupLayout.h"
 #include "dawn_native/BlendState.h"
@@ -32,10 +33,32 @@
 #include "dawn_native/SwapChain.h"
 #include "dawn_native/Texture.h"
 
+#include <algorithm>
 #include <unordered_set>
 
 namespace dawn_native {
 
+    namespace {
+
+        void RunCallbacksUpTo(SerialQueue<std::function<void()>>* queue, Serial serial) {
+            if (queue->Empty() || queue->FirstSerial() > serial) {
+                return;
+            }
+
+            // The callbacks are taken out of the queue first because they can add new ones.
+            std::vector<std::function<void()>> callbacks;
+            for (auto& callback : queue->IterateUpTo(serial)) {
+                callbacks.push_back(std::move(callback));
+            }
+            queue->ClearUpTo(serial);
+
+            for (auto& callback : callbacks) {
+                callback();
+            }
+        }
+
+    }  // anonymous namespace
+
     // DeviceBase::Caches
 
     // The caches are unordered_sets of pointers with special hash and compare functions
@@ -49,14 +72,18 @@ namespace dawn_native {
 
     // DeviceBase
 
-    DeviceBase::DeviceBase() {
+    DeviceBase::DeviceBase() : mDeferredDeletions(this) {
         mCaches = std::make_unique<DeviceBase::Caches>();
     }
 
     DeviceBase::~DeviceBase() {
+        // The backends stop the thread before destroying what it waits on.
+        ASSERT(!mCompletionWaiter.joinable());
     }
 
     void DeviceBase::HandleError(const char* message) {
+        // Errors can be produced by builders recording without the device locked.
+        std::lock_guard<std::recursive_mutex> lock(mMutex);
         if (mErrorCallback) {
             mErrorCallback(message, mErrorUserdata);
         }
@@ -72,6 +99,16 @@ namespace dawn_native {
         return this;
     }
 
+    std::recursive_mutex& DeviceBase::GetMutex() {
+        return mMutex;
+    }
+
+    ThreadPool* DeviceBase::GetValidationThreadPool() {
+        std::call_once(mValidationThreadPoolCreated,
+                       [this]() { mValidationThreadPool = std::make_unique<ThreadPool>(); });
+        return mValidationThreadPool.get();
+    }
+
     ResultOrError<BindGroupLayoutBase*> DeviceBase::GetOrCreateBindGroupLayout(
         const BindGroupLayoutDescriptor* descriptor) {
         BindGroupLayoutBase blueprint(this, descriptor, true);
@@ -196,22 +233,156 @@ namespace dawn_native {
     // Other Device API methods
 
     void DeviceBase::Tick() {
+        CheckPassedSerials();
         TickImpl();
+        mDeferredDeletions.Tick(mCompletedSerial);
+        RunCompletionCallbacks();
+    }
+
+    void DeviceBase::WaitForIdle(uint64_t timeoutNs) {
+        // Ticking submits the commands recorded so far. The pending serial isn't submitted if it
+        // has no commands, in which case waiting for the last submitted serial is enough.
+        Serial serial = GetPendingCommandSerial();
+        Tick();
+        if (!WaitForSerial(std::min(serial, mLastSubmittedSerial), timeoutNs)) {
+            return;
+        }
+
+        // Now that the GPU is idle, ticking completes the pending serial if it had no commands
+        // and calls the callbacks of the completed operations.
+        Tick();
     }
 
     void DeviceBase::Reference() {
         ASSERT(mRefCount != 0);
-        mRefCount++;
+        mRefCount.fetch_add(1, std::memory_order_relaxed);
     }
 
     void DeviceBase::Release() {
         ASSERT(mRefCount != 0);
-        mRefCount--;
-        if (mRefCount == 0) {
+        if (mRefCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
             delete this;
         }
     }
 
+    // Serial tracking
+
+    Serial DeviceBase::GetCompletedCommandSerial() const {
+        return mCompletedSerial;
+    }
+
+    Serial DeviceBase::GetLastSubmittedCommandSerial() const {
+        return mLastSubmittedSerial;
+    }
+
+    Serial DeviceBase::GetPendingCommandSerial() const {
+        return mLastSubmittedSerial + 1;
+    }
+
+    void DeviceBase::AddCompletionCallback(Serial serial, std::function<void()> callback) {
+        mCompletionCallbacks.Enqueue(std::move(callback), serial);
+    }
+
+    void DeviceBase::AddEagerCompletionCallback(Serial serial, std::function<void()> callback) {
+        mEagerCompletionCallbacks.Enqueue(std::move(callback), serial);
+
+        if (!mCompletionWaiter.joinable()) {
+            mCompletionWaiter = std::thread(&DeviceBase::CompletionWaiterThread, this);
+        }
+        mCompletionWaiterCondition.notify_one();
+    }
+
+    void DeviceBase::DeleteWhenUnused(DeferredDeletionQueue::DestroyFunction destroy,
+                                      uint64_t handle) {
+        mDeferredDeletions.Enqueue(destroy, handle, GetPendingCommandSerial());
+    }
+
+    bool DeviceBase::WaitForSerial(Serial serial, uint64_t timeoutNs) {
+        ASSERT(serial <= mLastSubmittedSerial);
+
+        CheckPassedSerials();
+        if (serial <= mCompletedSerial) {
+            return true;
+        }
+
+        bool completed = WaitForSerialImpl(serial, timeoutNs);
+        CheckPassedSerials();
+        ASSERT(!completed || serial <= mCompletedSerial);
+        return completed;
+    }
+
+    void DeviceBase::IncrementLastSubmittedCommandSerial() {
+        mLastSubmittedSerial++;
+        mCompletionWaiterCondition.notify_one();
+    }
+
+    void DeviceBase::AssumeCommandsComplete() {
+        mLastSubmittedSerial++;
+        mCompletedSerial = mLastSubmittedSerial;
+        mCompletionWaiterCondition.notify_one();
+    }
+
+    void DeviceBase::StopCompletionWaiter() {
+        if (!mCompletionWaiter.joinable()) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::recursive_mutex> lock(mMutex);
+            mCompletionWaiterStopping = true;
+        }
+        mCompletionWaiterCondition.notify_one();
+        mCompletionWaiter.join();
+    }
+
+    void DeviceBase::CompletionWaiterThread() {
+        std::unique_lock<std::recursive_mutex> lock(mMutex);
+        while (true) {
+            // Only the submitted serials can be waited for, the submission of the others wakes
+            // the thread up.
+            mCompletionWaiterCondition.wait(lock, [this] {
+                return mCompletionWaiterStopping ||
+                       (!mEagerCompletionCallbacks.Empty() &&
+                        mEagerCompletionCallbacks.FirstSerial() <= mLastSubmittedSerial);
+            });
+            if (mCompletionWaiterStopping) {
+                return;
+            }
+
+            Serial serial = mEagerCompletionCallbacks.FirstSerial();
+            CheckPassedSerials();
+            if (serial > mCompletedSerial) {
+                // The device can be used while the GPU is waited for. Submitted serials always
+                // complete so StopCompletionWaiter only has to wait for the end of the wait.
+                lock.unlock();
+                WaitForSerialImpl(serial, kInfiniteTimeout);
+                lock.lock();
+                CheckPassedSerials();
+            }
+
+            RunEagerCompletionCallbacks();
+        }
+    }
+
+    void DeviceBase::CheckPassedSerials() {
+        Serial completedSerial = CheckAndUpdateCompletedSerials();
+        ASSERT(completedSerial <= mLastSubmittedSerial);
+
+        // The serials completed by AssumeCommandsComplete aren't known by the backends.
+        if (completedSerial > mCompletedSerial) {
+            mCompletedSerial = completedSerial;
+        }
+    }
+
+    void DeviceBase::RunCompletionCallbacks() {
+        RunEagerCompletionCallbacks();
+        RunCallbacksUpTo(&mCompletionCallbacks, mCompletedSerial);
+    }
+
+    void DeviceBase::RunEagerCompletionCallbacks() {
+        RunCallbacksUpTo(&mEagerCompletionCallbacks, mCompletedSerial);
+    }
+
     // Implementation details of object creation
 
     MaybeError DeviceBase::CreateBindGroupLayoutInternal(
@@ -15,16 +15,30 @@
 #ifndef DAWNNATIVE_DEVICEBASE_H_
 #define DAWNNATIVE_DEVICEBASE_H_
 
+#include "common/Serial.h"
+#include "common/SerialQueue.h"
+#include "dawn_native/DeferredDeletionQueue.h"
 #include "dawn_native/Error.h"
 #include "dawn_native/Forward.h"
 #include "dawn_native/RefCounted.h"
 
 #include "dawn_native/dawn_platform.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <thread>
+
+class ThreadPool;
 
 namespace dawn_native {
 
+    // The timeout that makes DeviceBase::WaitForSerial wait until the serial completes.
+    static constexpr uint64_t kInfiniteTimeout = std::numeric_limits<uint64_t>::max();
+
     using ErrorCallback = void (*)(const char* errorMessage, void* userData);
 
     class DeviceBase {
@@ -45,6 +59,17 @@ namespace dawn_native {
         // Used by autogenerated code, returns itself
         DeviceBase* GetDevice();
 
+        // The autogenerated entry points lock this mutex so that the device can be used from
+        // several threads. The recording methods of CommandBufferBuilder don't lock it: they only
+        // touch the builder and the reference counts of objects, so independent command buffers
+        // can be recorded in parallel. GetResult locks it to create the command buffer. The mutex
+        // is recursive because callbacks called with it locked can use the API again.
+        std::recursive_mutex& GetMutex();
+
+        // The threads validating the passes of large command buffers in parallel, created the
+        // first time they are needed. Safe to call without the device mutex.
+        ThreadPool* GetValidationThreadPool();
+
         virtual BindGroupBase* CreateBindGroup(BindGroupBuilder* builder) = 0;
         virtual BlendStateBase* CreateBlendState(BlendStateBuilder* builder) = 0;
         virtual BufferViewBase* CreateBufferView(BufferViewBuilder* builder) = 0;
@@ -60,6 +85,31 @@ namespace dawn_native {
 
         virtual void TickImpl() = 0;
 
+        // The GPU work is tracked with increasing serials. The commands recorded by the backend
+        // are part of the pending serial, that becomes the last submitted serial when they are
+        // submitted. The completed serial is the last one the GPU is done with, it is updated at
+        // the start of each Tick.
+        Serial GetCompletedCommandSerial() const;
+        Serial GetLastSubmittedCommandSerial() const;
+        Serial GetPendingCommandSerial() const;
+
+        // Calls the callback in a Tick once the serial completed. Callbacks are called in the
+        // order of their serials, and of their registration for the same serial.
+        void AddCompletionCallback(Serial serial, std::function<void()> callback);
+        // Calls the callback as soon as the serial completed, without waiting for a Tick. The
+        // callback is called with the device mutex locked, from the completion waiter thread or
+        // from a Tick if it sees the completion first. The thread is started on the first call.
+        void AddEagerCompletionCallback(Serial serial, std::function<void()> callback);
+
+        // Destroys a backend object in a Tick once the GPU is done with the pending serial. See
+        // DeferredDeletionQueue for the order in which objects are destroyed.
+        void DeleteWhenUnused(DeferredDeletionQueue::DestroyFunction destroy, uint64_t handle);
+
+        // Blocks until the GPU is done with the commands of a submitted serial, or until
+        // timeoutNs nanoseconds passed. Returns whether the serial completed. The completion
+        // callbacks are left to the next Tick, or to the completion waiter thread.
+        bool WaitForSerial(Serial serial, uint64_t timeoutNs);
+
         // Many Dawn objects are completely immutable once created which means that if two
         // builders are given the same arguments, they can return the same object. Reusing
         // objects will help make comparisons between objects by a single pointer comparison.
@@ -97,15 +147,40 @@ namespace dawn_native {
         TextureBase* CreateTexture(const TextureDescriptor* descriptor);
 
         void Tick();
+        void WaitForIdle(uint64_t timeoutNs);
         void SetErrorCallback(dawn::DeviceErrorCallback callback, dawn::CallbackUserdata userdata);
         void Reference();
         void Release();
 
+        // Updates the completed serial from the backend without waiting for the GPU or calling
+        // the completion callbacks. Called at the start of Tick and when the application queries
+        // the progress of the GPU.
+        void CheckPassedSerials();
+
         BufferBuilder* CreateBufferBuilderForTesting() {
             return nullptr;
         }
 
+      protected:
+        // Called by the backends once they submitted the commands of the pending serial.
+        void IncrementLastSubmittedCommandSerial();
+        // Completes the pending serial without waiting for the GPU. Used when no GPU work is in
+        // flight so that the operations waiting for the pending serial don't wait forever, and
+        // when the device is destroyed.
+        void AssumeCommandsComplete();
+        // Stops the completion waiter thread. Called by the backends at the start of their
+        // destructor, before the state used by WaitForSerialImpl is destroyed.
+        void StopCompletionWaiter();
+
       private:
+        // Returns the last serial the GPU is done with.
+        virtual Serial CheckAndUpdateCompletedSerials() = 0;
+        // Blocks until the GPU is done with a submitted serial that isn't completed yet, using the
+        // wait primitive of the backend. Returns false if the timeout expired first. The completion
+        // waiter thread calls it without the device mutex, concurrently with the other methods of
+        // the device, so the serial can be completed by the time it is called.
+        virtual bool WaitForSerialImpl(Serial serial, uint64_t timeoutNs) = 0;
+
         virtual ResultOrError<BindGroupLayoutBase*> CreateBindGroupLayoutImpl(
             const BindGroupLayoutDescriptor* descriptor) = 0;
         virtual ResultOrError<BufferBase*> CreateBufferImpl(const BufferDescriptor* descriptor) = 0;
@@ -135,15 +210,34 @@ namespace dawn_native {
         MaybeError CreateTextureInternal(TextureBase** result, const TextureDescriptor* descriptor);
 
         void ConsumeError(ErrorData* error);
+        void RunCompletionCallbacks();
+        void RunEagerCompletionCallbacks();
+        void CompletionWaiterThread();
 
         // The object caches aren't exposed in the header as they would require a lot of
-        // additional includes.
+        // additional includes. They are protected by mMutex like the rest of the device state.
         struct Caches;
         std::unique_ptr<Caches> mCaches;
 
+        Serial mCompletedSerial = 0;
+        Serial mLastSubmittedSerial = 0;
+        SerialQueue<std::function<void()>> mCompletionCallbacks;
+        SerialQueue<std::function<void()>> mEagerCompletionCallbacks;
+        DeferredDeletionQueue mDeferredDeletions;
+
         dawn::DeviceErrorCallback mErrorCallback = nullptr;
         dawn::CallbackUserdata mErrorUserdata = 0;
-        uint32_t mRefCount = 1;
+        std::atomic<uint32_t> mRefCount{1};
+        std::recursive_mutex mMutex;
+
+        // Waits for the serial of the first eager completion callback once it is submitted. It
+        // waits on mMutex for the callbacks and submissions, and without it for the GPU.
+        std::thread mCompletionWaiter;
+        std::condition_variable_any mCompletionWaiterCondition;
+        bool mCompletionWaiterStopping = false;
+
+        std::once_flag mValidationThreadPoolCreated;
+        std::unique_ptr<ThreadPool> mValidationThreadPool;
     };
 
 }  // namespace dawn_native
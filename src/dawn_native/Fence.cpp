@@ -0,0 +1,139 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dawn_native/Fence.h"
+
+#include "dawn_native/Device.h"
+#include "dawn_native/Queue.h"
+
+#include <vector>
+
+namespace dawn_native {
+
+    MaybeError ValidateFenceDescriptor(DeviceBase*, const FenceDescriptor* descriptor) {
+        if (descriptor->nextInChain != nullptr) {
+            return DAWN_VALIDATION_ERROR("nextInChain must be nullptr");
+        }
+
+        return {};
+    }
+
+    // FenceBase
+
+    FenceBase::FenceBase(QueueBase* queue, const FenceDescriptor* descriptor)
+        : mDevice(queue->GetDevice()),
+          mQueue(queue),
+          mSignalValue(descriptor->initialValue),
+          mCompletedValue(descriptor->initialValue) {
+    }
+
+    FenceBase::~FenceBase() {
+        // The pending signals keep the fence alive so the requests can only remain if the device
+        // is destroyed before the GPU is done with them.
+        for (auto& request : mRequests) {
+            request.second.callback(DAWN_FENCE_COMPLETION_STATUS_UNKNOWN,
+                                    request.second.userdata);
+        }
+        mRequests.clear();
+    }
+
+    DeviceBase* FenceBase::GetDevice() const {
+        return mDevice;
+    }
+
+    QueueBase* FenceBase::GetQueue() {
+        return mQueue.Get();
+    }
+
+    uint64_t FenceBase::GetSignaledValue() const {
+        return mSignalValue;
+    }
+
+    uint64_t FenceBase::GetCompletedValue() {
+        // Query the GPU progress so that the value is up to date even if the device wasn't ticked.
+        mDevice->CheckPassedSerials();
+        UpdateCompletedValue();
+        return mCompletedValue;
+    }
+
+    void FenceBase::OnCompletion(uint64_t value,
+                                 dawnFenceOnCompletionCallback callback,
+                                 dawnCallbackUserdata userdata) {
+        if (mDevice->ConsumedError(ValidateOnCompletion(value))) {
+            callback(DAWN_FENCE_COMPLETION_STATUS_ERROR, userdata);
+            return;
+        }
+
+        if (value <= mCompletedValue) {
+            callback(DAWN_FENCE_COMPLETION_STATUS_SUCCESS, userdata);
+            return;
+        }
+
+        OnCompletionData request;
+        request.callback = callback;
+        request.userdata = userdata;
+        mRequests.emplace(value, request);
+    }
+
+    void FenceBase::SetSignaledValue(uint64_t signalValue) {
+        ASSERT(signalValue > mSignalValue);
+        mSignalValue = signalValue;
+
+        // The commands submitted before the signal are all part of the last submitted serial.
+        Serial serial = mDevice->GetLastSubmittedCommandSerial();
+        mSignalsInFlight.Enqueue(signalValue, serial);
+
+        mDevice->CheckPassedSerials();
+        if (serial <= mDevice->GetCompletedCommandSerial()) {
+            UpdateCompletedValue();
+            return;
+        }
+
+        Ref<FenceBase> fence = this;
+        mDevice->AddEagerCompletionCallback(serial, [fence]() mutable {
+            fence->UpdateCompletedValue();
+            fence->CallCompletedCallbacks();
+        });
+    }
+
+    MaybeError FenceBase::ValidateOnCompletion(uint64_t value) const {
+        if (value > mSignalValue) {
+            return DAWN_VALIDATION_ERROR("Value greater than fence signaled value");
+        }
+        return {};
+    }
+
+    void FenceBase::UpdateCompletedValue() {
+        Serial completedSerial = mDevice->GetCompletedCommandSerial();
+        for (uint64_t value : mSignalsInFlight.IterateUpTo(completedSerial)) {
+            mCompletedValue = value;
+        }
+        mSignalsInFlight.ClearUpTo(completedSerial);
+    }
+
+    void FenceBase::CallCompletedCallbacks() {
+        // The requests are taken out first because the callbacks can make new ones.
+        std::vector<OnCompletionData> completedRequests;
+        auto end = mRequests.upper_bound(mCompletedValue);
+        for (auto it = mRequests.begin(); it != end; ++it) {
+            completedRequests.push_back(it->second);
+        }
+        mRequests.erase(mRequests.begin(), end);
+
+        for (const OnCompletionData& request : completedRequests) {
+            request.callback(DAWN_FENCE_COMPLETION_STATUS_SUCCESS, request.userdata);
+        }
+    }
+
+}  // namespace dawn_native
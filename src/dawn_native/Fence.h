@@ -0,0 +1,79 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DAWNNATIVE_FENCE_H_
+#define DAWNNATIVE_FENCE_H_
+
+#include "common/Serial.h"
+#include "common/SerialQueue.h"
+#include "dawn_native/Error.h"
+#include "dawn_native/Forward.h"
+#include "dawn_native/RefCounted.h"
+
+#include "dawn_native/dawn_platform.h"
+
+#include <map>
+
+namespace dawn_native {
+
+    MaybeError ValidateFenceDescriptor(DeviceBase* device, const FenceDescriptor* descriptor);
+
+    // A fence is signaled with increasing values by its queue. It takes a value once the GPU is
+    // done with the commands that were submitted before the value was signaled. The OnCompletion
+    // callbacks don't wait for a Tick: they are called from a thread of the device, with the
+    // device mutex locked, as soon as the GPU is done.
+    class FenceBase : public RefCounted {
+      public:
+        FenceBase(QueueBase* queue, const FenceDescriptor* descriptor);
+        ~FenceBase();
+
+        DeviceBase* GetDevice() const;
+        QueueBase* GetQueue();
+        uint64_t GetSignaledValue() const;
+
+        // Dawn API
+        uint64_t GetCompletedValue();
+        void OnCompletion(uint64_t value,
+                          dawnFenceOnCompletionCallback callback,
+                          dawnCallbackUserdata userdata);
+
+      protected:
+        friend class QueueBase;
+        // Called by the queue when it signals the fence after the commands of the pending serial.
+        void SetSignaledValue(uint64_t signalValue);
+
+      private:
+        MaybeError ValidateOnCompletion(uint64_t value) const;
+
+        // Takes the values signaled up to the completed serial of the device.
+        void UpdateCompletedValue();
+        void CallCompletedCallbacks();
+
+        struct OnCompletionData {
+            dawnFenceOnCompletionCallback callback = nullptr;
+            dawnCallbackUserdata userdata = 0;
+        };
+
+        DeviceBase* mDevice;
+        Ref<QueueBase> mQueue;
+        uint64_t mSignalValue;
+        uint64_t mCompletedValue;
+        SerialQueue<uint64_t> mSignalsInFlight;
+        // Requests are ordered by value, then by the order in which they were made.
+        std::multimap<uint64_t, OnCompletionData> mRequests;
+    };
+
+}  // namespace dawn_native
+
+#endif  // DAWNNATIVE_FENCE_H_
@@ -35,6 +35,7 @@ namespace dawn_native {
     class CommandBufferBuilder;
     class DepthStencilStateBase;
     class DepthStencilStateBuilder;
+    class FenceBase;
     class InputStateBase;
     class InputStateBuilder;
     class PipelineLayoutBase;
@@ -84,13 +84,17 @@ namespace dawn_native {
 
     // InputStateBase
 
-    InputStateBase::InputStateBase(InputStateBuilder* builder) {
+    InputStateBase::InputStateBase(InputStateBuilder* builder) : mDevice(builder->GetDevice()) {
         mAttributesSetMask = builder->mAttributesSetMask;
         mAttributeInfos = builder->mAttributeInfos;
         mInputsSetMask = builder->mInputsSetMask;
         mInputInfos = builder->mInputInfos;
     }
 
+    DeviceBase* InputStateBase::GetDevice() const {
+        return mDevice;
+    }
+
     const std::bitset<kMaxVertexAttributes>& InputStateBase::GetAttributesSetMask() const {
         return mAttributesSetMask;
     }
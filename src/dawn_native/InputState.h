@@ -47,12 +47,14 @@ namespace dawn_native {
             dawn::InputStepMode stepMode;
         };
 
+        DeviceBase* GetDevice() const;
         const std::bitset<kMaxVertexAttributes>& GetAttributesSetMask() const;
         const AttributeInfo& GetAttribute(uint32_t location) const;
         const std::bitset<kMaxVertexInputs>& GetInputsSetMask() const;
         const InputInfo& GetInput(uint32_t slot) const;
 
       private:
+        DeviceBase* mDevice;
         std::bitset<kMaxVertexAttributes> mAttributesSetMask;
         std::array<AttributeInfo, kMaxVertexAttributes> mAttributeInfos;
         std::bitset<kMaxVertexInputs> mInputsSetMask;
@@ -16,6 +16,7 @@
 
 #include "dawn_native/CommandBuffer.h"
 #include "dawn_native/Device.h"
+#include "dawn_native/Fence.h"
 
 namespace dawn_native {
 
@@ -28,6 +29,22 @@ namespace dawn_native {
         return mDevice;
     }
 
+    FenceBase* QueueBase::CreateFence(const FenceDescriptor* descriptor) {
+        if (mDevice->ConsumedError(ValidateFenceDescriptor(mDevice, descriptor))) {
+            return nullptr;
+        }
+
+        return new FenceBase(this, descriptor);
+    }
+
+    void QueueBase::Signal(FenceBase* fence, uint64_t signalValue) {
+        if (mDevice->ConsumedError(ValidateSignal(fence, signalValue))) {
+            return;
+        }
+
+        fence->SetSignaledValue(signalValue);
+    }
+
     void QueueBase::Submit(uint32_t numCommands, CommandBufferBase* const* commands) {
         if (mDevice->ConsumedError(ValidateSubmit(numCommands, commands))) {
             return;
@@ -36,6 +53,17 @@ namespace dawn_native {
         SubmitImpl(numCommands, commands);
     }
 
+    MaybeError QueueBase::ValidateSignal(FenceBase* fence, uint64_t signalValue) {
+        if (fence->GetQueue() != this) {
+            return DAWN_VALIDATION_ERROR(
+                "Fence must be signaled on the queue on which it was created");
+        }
+        if (signalValue <= fence->GetSignaledValue()) {
+            return DAWN_VALIDATION_ERROR("Fence value less than or equal to signaled value");
+        }
+        return {};
+    }
+
     MaybeError QueueBase::ValidateSubmit(uint32_t, CommandBufferBase* const*) {
         return {};
     }
@@ -31,11 +31,14 @@ namespace dawn_native {
         DeviceBase* GetDevice();
 
         // Dawn API
+        FenceBase* CreateFence(const FenceDescriptor* descriptor);
+        void Signal(FenceBase* fence, uint64_t signalValue);
         void Submit(uint32_t numCommands, CommandBufferBase* const* commands);
 
       private:
         virtual void SubmitImpl(uint32_t numCommands, CommandBufferBase* const* commands) = 0;
 
+        MaybeError ValidateSignal(FenceBase* fence, uint64_t signalValue);
         MaybeError ValidateSubmit(uint32_t numCommands, CommandBufferBase* const* commands);
 
         DeviceBase* mDevice;
@@ -27,16 +27,17 @@ namespace dawn_native {
     void RefCounted::ReferenceInternal() {
         ASSERT(mInternalRefs != 0);
 
+        // The caller already holds a reference, so no ordering is needed to increment the count.
         // TODO(cwallez@chromium.org): what to do on overflow?
-        mInternalRefs++;
+        mInternalRefs.fetch_add(1, std::memory_order_relaxed);
     }
 
     void RefCounted::ReleaseInternal() {
         ASSERT(mInternalRefs != 0);
 
-        mInternalRefs--;
-
-        if (mInternalRefs == 0) {
+        // The release has to be ordered after the uses of the object on this thread, and the
+        // deletion after the releases on all the other threads.
+        if (mInternalRefs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
             ASSERT(mExternalRefs == 0);
             // TODO(cwallez@chromium.org): would this work with custom allocators?
             delete this;
@@ -55,21 +56,18 @@ namespace dawn_native {
         ASSERT(mInternalRefs != 0);
 
         // mExternalRefs != 0 counts as one internal ref.
-        if (mExternalRefs == 0) {
+        // TODO(cwallez@chromium.org): what to do on overflow?
+        if (mExternalRefs.fetch_add(1, std::memory_order_relaxed) == 0) {
             ReferenceInternal();
         }
-
-        // TODO(cwallez@chromium.org): what to do on overflow?
-        mExternalRefs++;
     }
 
     void RefCounted::Release() {
         ASSERT(mInternalRefs != 0);
         ASSERT(mExternalRefs != 0);
 
-        mExternalRefs--;
         // mExternalRefs != 0 counts as one internal ref.
-        if (mExternalRefs == 0) {
+        if (mExternalRefs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
             ReleaseInternal();
         }
     }
@@ -15,6 +15,7 @@
 #ifndef DAWNNATIVE_REFCOUNTED_H_
 #define DAWNNATIVE_REFCOUNTED_H_
 
+#include <atomic>
 #include <cstdint>
 
 namespace dawn_native {
@@ -35,8 +36,10 @@ namespace dawn_native {
         void Release();
 
       protected:
-        uint32_t mExternalRefs = 1;
-        uint32_t mInternalRefs = 1;
+        // The counts are atomic so that objects can be referenced and released on several
+        // threads, for example when command buffers using them are recorded in parallel.
+        std::atomic<uint32_t> mExternalRefs{1};
+        std::atomic<uint32_t> mInternalRefs{1};
     };
 
     template <typename T>
@@ -34,7 +34,11 @@ namespace dawn_native {
 
     // SamplerBase
 
-    SamplerBase::SamplerBase(DeviceBase*, const SamplerDescriptor*) {
+    SamplerBase::SamplerBase(DeviceBase* device, const SamplerDescriptor*) : mDevice(device) {
+    }
+
+    DeviceBase* SamplerBase::GetDevice() const {
+        return mDevice;
     }
 
 }  // namespace dawn_native
@@ -29,6 +29,11 @@ namespace dawn_native {
     class SamplerBase : public RefCounted {
       public:
         SamplerBase(DeviceBase* device, const SamplerDescriptor* descriptor);
+
+        DeviceBase* GetDevice() const;
+
+      private:
+        DeviceBase* mDevice;
     };
 
 }  // namespace dawn_native
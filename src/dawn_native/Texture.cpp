@@ -135,6 +135,10 @@ namespace dawn_native {
     TextureViewBase::TextureViewBase(TextureViewBuilder* builder) : mTexture(builder->mTexture) {
     }
 
+    DeviceBase* TextureViewBase::GetDevice() const {
+        return mTexture->GetDevice();
+    }
+
     const TextureBase* TextureViewBase::GetTexture() const {
         return mTexture.Get();
     }
@@ -70,6 +70,7 @@ namespace dawn_native {
       public:
         TextureViewBase(TextureViewBuilder* builder);
 
+        DeviceBase* GetDevice() const;
         const TextureBase* GetTexture() const;
         TextureBase* GetTexture();
 
@@ -30,7 +30,7 @@ namespace dawn_native { namespace d3d12 {
         // If there are no free allocators, get the oldest serial in flight and wait on it
         if (mFreeAllocators.none()) {
             const uint64_t firstSerial = mInFlightCommandAllocators.FirstSerial();
-            device->WaitForSerial(firstSerial);
+            device->WaitForSerial(firstSerial, kInfiniteTimeout);
             Tick(firstSerial);
         }
 
@@ -52,7 +52,7 @@ namespace dawn_native { namespace d3d12 {
         // Enqueue the command allocator. It will be scheduled for reset after the next
         // ExecuteCommandLists
         mInFlightCommandAllocators.Enqueue({mCommandAllocators[firstFreeIndex], firstFreeIndex},
-                                           device->GetSerial());
+                                           device->GetPendingCommandSerial());
 
         return mCommandAllocators[firstFreeIndex];
     }
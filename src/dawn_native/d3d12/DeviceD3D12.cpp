@@ -40,6 +40,8 @@
 #include "dawn_native/d3d12/SwapChainD3D12.h"
 #include "dawn_native/d3d12/TextureD3D12.h"
 
+#include <chrono>
+
 namespace dawn_native { namespace d3d12 {
 
     dawnDevice CreateDevice() {
@@ -113,6 +115,12 @@ namespace dawn_native { namespace d3d12 {
             return nullptr;
         }
 
+        // Destroy function for the deferred deletion queue, the handle is a COM object on which
+        // the device holds a reference.
+        void ReleaseComObject(DeviceBase*, uint64_t handle) {
+            reinterpret_cast<IUnknown*>(static_cast<uintptr_t>(handle))->Release();
+        }
+
     }  // anonymous namespace
 
     Device::Device() {
@@ -139,10 +147,8 @@ namespace dawn_native { namespace d3d12 {
         queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
         ASSERT_SUCCESS(mD3d12Device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&mCommandQueue)));
 
-        ASSERT_SUCCESS(
-            mD3d12Device->CreateFence(mSerial, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&mFence)));
-        mFenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-        ASSERT(mFenceEvent != nullptr);
+        ASSERT_SUCCESS(mD3d12Device->CreateFence(GetLastSubmittedCommandSerial(),
+                                                 D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&mFence)));
 
         // Initialize backend services
         mCommandAllocatorManager = std::make_unique<CommandAllocatorManager>(this);
@@ -155,13 +161,20 @@ namespace dawn_native { namespace d3d12 {
     }
 
     Device::~Device() {
-        const uint64_t currentSerial = GetSerial();
+        StopCompletionWaiter();
+
+        // Wait for all in-flight commands to finish executing, then call tick one last time so
+        // resources are cleaned up
         NextSerial();
-        WaitForSerial(currentSerial);  // Wait for all in-flight commands to finish executing
-        TickImpl();                    // Call tick one last time so resources are cleaned up
+        WaitForSerial(GetLastSubmittedCommandSerial(), kInfiniteTimeout);
+        Tick();
 
-        ASSERT(mUsedComObjectRefs.Empty());
         ASSERT(mPendingCommands.commandList == nullptr);
+
+        for (HANDLE fenceEvent : mFenceEvents) {
+            CloseHandle(fenceEvent);
+        }
+        mFenceEvents.clear();
     }
 
     ComPtr<IDXGIFactory4> Device::GetFactory() {
@@ -221,34 +234,75 @@ namespace dawn_native { namespace d3d12 {
 
     void Device::TickImpl() {
         // Perform cleanup operations to free unused objects
-        const uint64_t lastCompletedSerial = mFence->GetCompletedValue();
-        mResourceAllocator->Tick(lastCompletedSerial);
+        const uint64_t lastCompletedSerial = GetCompletedCommandSerial();
         mCommandAllocatorManager->Tick(lastCompletedSerial);
         mDescriptorHeapAllocator->Tick(lastCompletedSerial);
         mMapRequestTracker->Tick(lastCompletedSerial);
-        mUsedComObjectRefs.ClearUpTo(lastCompletedSerial);
         ExecuteCommandLists({});
         NextSerial();
     }
 
-    uint64_t Device::GetSerial() const {
-        return mSerial;
+    Serial Device::CheckAndUpdateCompletedSerials() {
+        return mFence->GetCompletedValue();
     }
 
     void Device::NextSerial() {
-        ASSERT_SUCCESS(mCommandQueue->Signal(mFence.Get(), mSerial++));
+        ASSERT_SUCCESS(mCommandQueue->Signal(mFence.Get(), GetPendingCommandSerial()));
+        IncrementLastSubmittedCommandSerial();
     }
 
-    void Device::WaitForSerial(uint64_t serial) {
-        const uint64_t lastCompletedSerial = mFence->GetCompletedValue();
-        if (lastCompletedSerial < serial) {
-            ASSERT_SUCCESS(mFence->SetEventOnCompletion(serial, mFenceEvent));
-            WaitForSingleObject(mFenceEvent, INFINITE);
+    bool Device::WaitForSerialImpl(Serial serial, uint64_t timeoutNs) {
+        HANDLE fenceEvent = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mFenceEventsMutex);
+            if (!mFenceEvents.empty()) {
+                fenceEvent = mFenceEvents.back();
+                mFenceEvents.pop_back();
+            }
         }
+        if (fenceEvent == nullptr) {
+            fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+            ASSERT(fenceEvent != nullptr);
+        }
+
+        // The event is auto-reset and the completions registered by earlier waits that timed out
+        // can still signal it, so a wake up doesn't mean the serial completed. Wait again for the
+        // rest of the timeout until the fence reaches the serial.
+        auto start = std::chrono::steady_clock::now();
+        bool completed = true;
+        while (mFence->GetCompletedValue() < serial) {
+            // Round the timeout up to milliseconds so that a short timeout still waits a bit, and
+            // keep it below INFINITE unless the wait is really meant to be infinite.
+            DWORD timeoutMs = INFINITE;
+            if (timeoutNs != kInfiniteTimeout) {
+                uint64_t elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now() - start)
+                                         .count();
+                if (elapsedNs >= timeoutNs) {
+                    completed = false;
+                    break;
+                }
+                uint64_t remainingNs = timeoutNs - elapsedNs;
+                uint64_t roundedMs = remainingNs / 1000000 + (remainingNs % 1000000 != 0 ? 1 : 0);
+                timeoutMs = roundedMs < INFINITE ? static_cast<DWORD>(roundedMs) : INFINITE - 1;
+            }
+
+            ResetEvent(fenceEvent);
+            ASSERT_SUCCESS(mFence->SetEventOnCompletion(serial, fenceEvent));
+            DWORD result = WaitForSingleObject(fenceEvent, timeoutMs);
+            ASSERT(result == WAIT_OBJECT_0 || result == WAIT_TIMEOUT);
+        }
+
+        std::lock_guard<std::mutex> lock(mFenceEventsMutex);
+        mFenceEvents.push_back(fenceEvent);
+        return completed;
     }
 
     void Device::ReferenceUntilUnused(ComPtr<IUnknown> object) {
-        mUsedComObjectRefs.Enqueue(object, mSerial);
+        // The reference is moved to the deferred deletion queue that releases it when the GPU is
+        // done with the pending serial.
+        uintptr_t reference = reinterpret_cast<uintptr_t>(object.Detach());
+        DeleteWhenUnused(ReleaseComObject, static_cast<uint64_t>(reference));
     }
 
     void Device::ExecuteCommandLists(std::initializer_list<ID3D12CommandList*> commandLists) {
@@ -17,12 +17,13 @@
 
 #include "dawn_native/dawn_platform.h"
 
-#include "common/SerialQueue.h"
 #include "dawn_native/Device.h"
 #include "dawn_native/d3d12/Forward.h"
 #include "dawn_native/d3d12/d3d12_platform.h"
 
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace dawn_native { namespace d3d12 {
 
@@ -68,9 +69,7 @@ namespace dawn_native { namespace d3d12 {
         void OpenCommandList(ComPtr<ID3D12GraphicsCommandList>* commandList);
         ComPtr<ID3D12GraphicsCommandList> GetPendingCommandList();
 
-        uint64_t GetSerial() const;
         void NextSerial();
-        void WaitForSerial(uint64_t serial);
 
         void ReferenceUntilUnused(ComPtr<IUnknown> object);
 
@@ -89,14 +88,18 @@ namespace dawn_native { namespace d3d12 {
         ResultOrError<ShaderModuleBase*> CreateShaderModuleImpl(
             const ShaderModuleDescriptor* descriptor) override;
         ResultOrError<TextureBase*> CreateTextureImpl(const TextureDescriptor* descriptor) override;
+        Serial CheckAndUpdateCompletedSerials() override;
+        bool WaitForSerialImpl(Serial serial, uint64_t timeoutNs) override;
 
         // Keep mFunctions as the first member so that in the destructor it is freed. Otherwise the
         // D3D12 DLLs are unloaded before we are done using it.
         std::unique_ptr<PlatformFunctions> mFunctions;
 
-        uint64_t mSerial = 0;
         ComPtr<ID3D12Fence> mFence;
-        HANDLE mFenceEvent;
+        // The events WaitForSerialImpl waits on. Each wait takes its own event since the
+        // completion waiter can wait at the same time as the thread using the device.
+        std::mutex mFenceEventsMutex;
+        std::vector<HANDLE> mFenceEvents;
 
         ComPtr<IDXGIFactory4> mFactory;
         ComPtr<IDXGIAdapter1> mHardwareAdapter;
@@ -108,8 +111,6 @@ namespace dawn_native { namespace d3d12 {
             bool open = false;
         } mPendingCommands;
 
-        SerialQueue<ComPtr<IUnknown>> mUsedComObjectRefs;
-
         std::unique_ptr<CommandAllocatorManager> mCommandAllocatorManager;
         std::unique_ptr<DescriptorHeapAllocator> mDescriptorHeapAllocator;
         std::unique_ptr<MapRequestTracker> mMapRequestTracker;
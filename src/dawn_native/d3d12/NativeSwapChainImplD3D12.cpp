@@ -95,7 +95,7 @@ namespace dawn_native { namespace d3d12 {
 
         // TODO(cwallez@chromium.org) Currently we force the CPU to wait for the GPU to be finished
         // with the buffer. Ideally the synchronization should be all done on the GPU.
-        mDevice->WaitForSerial(mBufferSerials[mCurrentBuffer]);
+        mDevice->WaitForSerial(mBufferSerials[mCurrentBuffer], kInfiniteTimeout);
 
         return DAWN_SWAP_CHAIN_NO_ERROR;
     }
@@ -107,7 +107,7 @@ namespace dawn_native { namespace d3d12 {
         // TODO(cwallez@chromium.org): Make the serial ticking implicit.
         mDevice->NextSerial();
 
-        mBufferSerials[mCurrentBuffer] = mDevice->GetSerial();
+        mBufferSerials[mCurrentBuffer] = mDevice->GetPendingCommandSerial();
         return DAWN_SWAP_CHAIN_NO_ERROR;
     }
 
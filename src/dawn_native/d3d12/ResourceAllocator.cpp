@@ -67,11 +67,7 @@ namespace dawn_native { namespace d3d12 {
     void ResourceAllocator::Release(ComPtr<ID3D12Resource> resource) {
         // Resources may still be in use on the GPU. Enqueue them so that we hold onto them until
         // GPU execution has completed
-        mReleasedResources.Enqueue(resource, mDevice->GetSerial());
-    }
-
-    void ResourceAllocator::Tick(uint64_t lastCompletedSerial) {
-        mReleasedResources.ClearUpTo(lastCompletedSerial);
+        mDevice->ReferenceUntilUnused(resource);
     }
 
 }}  // namespace dawn_native::d3d12
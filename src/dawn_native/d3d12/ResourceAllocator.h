@@ -17,8 +17,6 @@
 
 #include "dawn_native/d3d12/d3d12_platform.h"
 
-#include "common/SerialQueue.h"
-
 namespace dawn_native { namespace d3d12 {
 
     class Device;
@@ -31,12 +29,9 @@ namespace dawn_native { namespace d3d12 {
                                         const D3D12_RESOURCE_DESC& resourceDescriptor,
                                         D3D12_RESOURCE_STATES initialUsage);
         void Release(ComPtr<ID3D12Resource> resource);
-        void Tick(uint64_t lastCompletedSerial);
 
       private:
         Device* mDevice;
-
-        SerialQueue<ComPtr<ID3D12Resource>> mReleasedResources;
     };
 
 }}  // namespace dawn_native::d3d12
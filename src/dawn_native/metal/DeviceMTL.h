@@ -24,7 +24,10 @@
 #import <Metal/Metal.h>
 #import <QuartzCore/CAMetalLayer.h>
 
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <type_traits>
 
 namespace dawn_native { namespace metal {
@@ -55,7 +58,6 @@ namespace dawn_native { namespace metal {
 
         id<MTLCommandBuffer> GetPendingCommandBuffer();
         void SubmitPendingCommandBuffer();
-        Serial GetPendingCommandSerial();
 
         MapRequestTracker* GetMapTracker() const;
         ResourceUploader* GetResourceUploader() const;
@@ -73,6 +75,8 @@ namespace dawn_native { namespace metal {
         ResultOrError<ShaderModuleBase*> CreateShaderModuleImpl(
             const ShaderModuleDescriptor* descriptor) override;
         ResultOrError<TextureBase*> CreateTextureImpl(const TextureDescriptor* descriptor) override;
+        Serial CheckAndUpdateCompletedSerials() override;
+        bool WaitForSerialImpl(Serial serial, uint64_t timeoutNs) override;
 
         void OnCompletedHandler();
 
@@ -81,8 +85,11 @@ namespace dawn_native { namespace metal {
         std::unique_ptr<MapRequestTracker> mMapTracker;
         std::unique_ptr<ResourceUploader> mResourceUploader;
 
-        Serial mFinishedCommandSerial = 0;
-        Serial mPendingCommandSerial = 1;
+        // Updated by the completion handlers of the command buffers, on another thread. The
+        // handlers notify the condition variable so that WaitForSerialImpl can block on it.
+        std::atomic<Serial> mFinishedCommandSerial;
+        std::mutex mFinishedCommandSerialMutex;
+        std::condition_variable mFinishedCommandSerialCondition;
         id<MTLCommandBuffer> mPendingCommands = nil;
     };
 
@@ -33,7 +33,7 @@
 #include "dawn_native/metal/SwapChainMTL.h"
 #include "dawn_native/metal/TextureMTL.h"
 
-#include <unistd.h>
+#include <chrono>
 
 namespace dawn_native { namespace metal {
 
@@ -46,20 +46,21 @@ namespace dawn_native { namespace metal {
     Device::Device(id<MTLDevice> mtlDevice)
         : mMtlDevice(mtlDevice),
           mMapTracker(new MapRequestTracker(this)),
-          mResourceUploader(new ResourceUploader(this)) {
+          mResourceUploader(new ResourceUploader(this)),
+          mFinishedCommandSerial(0) {
         [mMtlDevice retain];
         mCommandQueue = [mMtlDevice newCommandQueue];
     }
 
     Device::~Device() {
+        StopCompletionWaiter();
+
         // Wait for all commands to be finished so we can free resources SubmitPendingCommandBuffer
         // may not increment the pendingCommandSerial if there are no pending commands, so we can't
         // store the pendingSerial before SubmitPendingCommandBuffer then wait for it to be passed.
-        // Instead we submit and wait for the serial before the next pendingCommandSerial.
+        // Instead we submit and wait for the last submitted serial.
         SubmitPendingCommandBuffer();
-        while (mFinishedCommandSerial != mPendingCommandSerial - 1) {
-            usleep(100);
-        }
+        WaitForSerial(GetLastSubmittedCommandSerial(), kInfiniteTimeout);
         Tick();
 
         [mPendingCommands release];
@@ -136,12 +137,33 @@ namespace dawn_native { namespace metal {
     }
 
     void Device::TickImpl() {
-        mResourceUploader->Tick(mFinishedCommandSerial);
-        mMapTracker->Tick(mFinishedCommandSerial);
+        Serial completedSerial = GetCompletedCommandSerial();
+        mResourceUploader->Tick(completedSerial);
+        mMapTracker->Tick(completedSerial);
+
+        // Code above might have added GPU work, submit it. When no GPU work is happening, the
+        // serial is incremented anyway so that the operations waiting for it can complete.
+        if (mPendingCommands != nil) {
+            SubmitPendingCommandBuffer();
+        } else if (completedSerial == GetLastSubmittedCommandSerial()) {
+            AssumeCommandsComplete();
+        }
+    }
 
-        // Code above might have added GPU work, submit it. This also makes sure
-        // that even when no GPU work is happening, the serial number keeps incrementing.
-        SubmitPendingCommandBuffer();
+    Serial Device::CheckAndUpdateCompletedSerials() {
+        return mFinishedCommandSerial;
+    }
+
+    bool Device::WaitForSerialImpl(Serial serial, uint64_t timeoutNs) {
+        std::unique_lock<std::mutex> lock(mFinishedCommandSerialMutex);
+        auto isCompleted = [this, serial] { return mFinishedCommandSerial >= serial; };
+
+        if (timeoutNs == kInfiniteTimeout) {
+            mFinishedCommandSerialCondition.wait(lock, isCompleted);
+            return true;
+        }
+        return mFinishedCommandSerialCondition.wait_for(
+            lock, std::chrono::nanoseconds(timeoutNs), isCompleted);
     }
 
     id<MTLDevice> Device::GetMTLDevice() {
@@ -165,24 +187,19 @@ namespace dawn_native { namespace metal {
         // so this-> works as expected. However it is unclear how members are captured, (are they
         // captured using this-> or by value?) so we make a copy of the pendingCommandSerial on the
         // stack.
-        Serial pendingSerial = mPendingCommandSerial;
+        Serial pendingSerial = GetPendingCommandSerial();
         [mPendingCommands addCompletedHandler:^(id<MTLCommandBuffer>) {
-            this->mFinishedCommandSerial = pendingSerial;
+            {
+                std::lock_guard<std::mutex> lock(this->mFinishedCommandSerialMutex);
+                this->mFinishedCommandSerial = pendingSerial;
+            }
+            this->mFinishedCommandSerialCondition.notify_all();
         }];
 
         [mPendingCommands commit];
         [mPendingCommands release];
         mPendingCommands = nil;
-        mPendingCommandSerial++;
-    }
-
-    uint64_t Device::GetPendingCommandSerial() {
-        // If this is called, then it means some piece of code somewhere will wait for this serial
-        // to complete. Make sure the pending command buffer is created so that it is on the worst
-        // case enqueued on the next Tick() and eventually increments the serial. Otherwise if no
-        // GPU work happens we could be waiting for this serial forever.
-        GetPendingCommandBuffer();
-        return mPendingCommandSerial;
+        IncrementLastSubmittedCommandSerial();
     }
 
     MapRequestTracker* Device::GetMapTracker() const {
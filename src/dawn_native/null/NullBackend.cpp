@@ -14,23 +14,53 @@
 
 #include "dawn_native/null/NullBackend.h"
 
+#include "common/BitSetIterator.h"
+#include "common/ThreadPool.h"
 #include "dawn_native/Commands.h"
 #include "dawn_native/NullBackend.h"
+#include "dawn_native/null/Rasterizer.h"
 
 #include <spirv-cross/spirv_cross.hpp>
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
 namespace dawn_native { namespace null {
 
     dawnDevice CreateDevice() {
         return reinterpret_cast<dawnDevice>(new Device);
     }
 
+    dawnDevice CreateDevice(const SimulatedQueueDescriptor& queueDescriptor) {
+        return reinterpret_cast<dawnDevice>(new Device(queueDescriptor));
+    }
+
     // Device
 
-    Device::Device() {
+    Device::Device() : mSimulatedCompletedSerial(0) {
+    }
+
+    Device::Device(const SimulatedQueueDescriptor& queueDescriptor)
+        : mSimulatedCompletedSerial(0), mSimulateQueue(true), mQueueDescriptor(queueDescriptor) {
+        mQueueThread = std::thread(&Device::SimulatedQueueThread, this);
     }
 
     Device::~Device() {
+        if (mSimulateQueue) {
+            // Stopping the queue also makes WaitForSerialImpl return so that the completion
+            // waiter can be stopped without waiting for the latency of the submissions.
+            {
+                std::lock_guard<std::mutex> lock(mQueueMutex);
+                mQueueStopping = true;
+            }
+            mQueueCondition.notify_one();
+            mCompletionCondition.notify_all();
+            StopCompletionWaiter();
+            mQueueThread.join();
+        } else {
+            StopCompletionWaiter();
+        }
     }
 
     BindGroupBase* Device::CreateBindGroup(BindGroupBuilder* builder) {
@@ -81,12 +111,7 @@ namespace dawn_native { namespace null {
     }
     ResultOrError<ShaderModuleBase*> Device::CreateShaderModuleImpl(
         const ShaderModuleDescriptor* descriptor) {
-        auto module = new ShaderModule(this, descriptor);
-
-        spirv_cross::Compiler compiler(descriptor->code, descriptor->codeSize);
-        module->ExtractSpirvInfo(compiler);
-
-        return module;
+        return new ShaderModule(this, descriptor);
     }
     SwapChainBase* Device::CreateSwapChain(SwapChainBuilder* builder) {
         return new SwapChain(builder);
@@ -99,34 +124,93 @@ namespace dawn_native { namespace null {
     }
 
     void Device::TickImpl() {
+        // If there's no work in flight the serial is still incremented so that the operations
+        // waiting for the pending serial complete.
+        if (GetCompletedCommandSerial() == GetLastSubmittedCommandSerial()) {
+            AssumeCommandsComplete();
+        }
     }
 
-    void Device::AddPendingOperation(std::unique_ptr<PendingOperation> operation) {
-        mPendingOperations.emplace_back(std::move(operation));
+    Serial Device::CheckAndUpdateCompletedSerials() {
+        if (!mSimulateQueue) {
+            return GetLastSubmittedCommandSerial();
+        }
+        return mSimulatedCompletedSerial;
     }
-    std::vector<std::unique_ptr<PendingOperation>> Device::AcquirePendingOperations() {
-        return std::move(mPendingOperations);
+
+    bool Device::WaitForSerialImpl(Serial serial, uint64_t timeoutNs) {
+        // Without a simulated queue the submitted serials are always completed.
+        ASSERT(mSimulateQueue);
+
+        std::unique_lock<std::mutex> lock(mQueueMutex);
+        auto isCompleted = [this, serial] { return mSimulatedCompletedSerial >= serial; };
+        if (timeoutNs == kInfiniteTimeout) {
+            mCompletionCondition.wait(lock, [&] { return isCompleted() || mQueueStopping; });
+            return isCompleted();
+        }
+        return mCompletionCondition.wait_for(lock, std::chrono::nanoseconds(timeoutNs),
+                                             isCompleted);
     }
 
-    // Buffer
+    void Device::SubmitPendingCommands(uint32_t commandBufferCount) {
+        IncrementLastSubmittedCommandSerial();
+        if (!mSimulateQueue) {
+            // The submission is already complete, CheckAndUpdateCompletedSerials reports it and
+            // the operations waiting for it complete at the next Tick.
+            return;
+        }
 
-    struct BufferMapReadOperation : PendingOperation {
-        virtual void Execute() {
-            buffer->MapReadOperationCompleted(serial, ptr, isWrite);
+        auto now = std::chrono::steady_clock::now();
+        auto startTime = std::max(now + std::chrono::nanoseconds(mQueueDescriptor.latencyNs),
+                                  mLastCompletionTime);
+        mLastCompletionTime =
+            startTime + std::chrono::nanoseconds(mQueueDescriptor.nsPerCommandBuffer) *
+                            commandBufferCount;
+
+        {
+            std::lock_guard<std::mutex> lock(mQueueMutex);
+            mInFlightSubmissions.push_back({GetLastSubmittedCommandSerial(), mLastCompletionTime});
+        }
+        mQueueCondition.notify_one();
+    }
+
+    void Device::SimulatedQueueThread() {
+        std::unique_lock<std::mutex> lock(mQueueMutex);
+        while (true) {
+            mQueueCondition.wait(
+                lock, [this] { return mQueueStopping || !mInFlightSubmissions.empty(); });
+            if (mQueueStopping) {
+                return;
+            }
+
+            // Submissions are only added at the back so the front one stays the same while the
+            // lock is released by the wait.
+            InFlightSubmission submission = mInFlightSubmissions.front();
+            if (mQueueCondition.wait_until(lock, submission.completionTime,
+                                           [this] { return mQueueStopping; })) {
+                return;
+            }
+
+            mInFlightSubmissions.pop_front();
+            mSimulatedCompletedSerial = submission.serial;
+            mCompletionCondition.notify_all();
         }
+    }
+
+    ThreadPool* Device::GetThreadPool() {
+        if (mThreadPool == nullptr) {
+            mThreadPool = std::make_unique<ThreadPool>();
+        }
+        return mThreadPool.get();
+    }
 
-        Ref<Buffer> buffer;
-        void* ptr;
-        uint32_t serial;
-        bool isWrite;
-    };
+    // Buffer
 
     Buffer::Buffer(Device* device, const BufferDescriptor* descriptor)
         : BufferBase(device, descriptor) {
-        if (GetUsage() & (dawn::BufferUsageBit::TransferDst | dawn::BufferUsageBit::MapRead |
-                          dawn::BufferUsageBit::MapWrite)) {
-            mBackingData = std::unique_ptr<char[]>(new char[GetSize()]);
-        }
+        // All buffers have storage since any of them can be the source of a copy. It is zeroed so
+        // that the results of the null backend are deterministic.
+        mBackingData = std::unique_ptr<char[]>(new char[GetSize()]());
     }
 
     Buffer::~Buffer() {
@@ -140,6 +224,10 @@ namespace dawn_native { namespace null {
         }
     }
 
+    uint8_t* Buffer::GetBackingData() {
+        return reinterpret_cast<uint8_t*>(mBackingData.get());
+    }
+
     void Buffer::SetSubDataImpl(uint32_t start, uint32_t count, const uint8_t* data) {
         ASSERT(start + count <= GetSize());
         ASSERT(mBackingData);
@@ -158,13 +246,13 @@ namespace dawn_native { namespace null {
         ASSERT(start + count <= GetSize());
         ASSERT(mBackingData);
 
-        auto operation = new BufferMapReadOperation;
-        operation->buffer = this;
-        operation->ptr = mBackingData.get() + start;
-        operation->serial = serial;
-        operation->isWrite = isWrite;
-
-        ToBackend(GetDevice())->AddPendingOperation(std::unique_ptr<PendingOperation>(operation));
+        // The map completes after the commands submitted before it, like on a GPU.
+        Ref<Buffer> buffer = this;
+        void* ptr = mBackingData.get() + start;
+        auto completion = [buffer, serial, ptr, isWrite]() mutable {
+            buffer->MapReadOperationCompleted(serial, ptr, isWrite);
+        };
+        GetDevice()->AddCompletionCallback(GetDevice()->GetPendingCommandSerial(), completion);
     }
 
     void Buffer::UnmapImpl() {
@@ -180,6 +268,357 @@ namespace dawn_native { namespace null {
         FreeCommands(&mCommands);
     }
 
+    namespace {
+
+        // Copies rows of rowBytes bytes between two pitched layouts, in a single memcpy when
+        // the rows are contiguous in both.
+        void CopyRows(uint8_t* dst,
+                      uint32_t dstRowPitch,
+                      const uint8_t* src,
+                      uint32_t srcRowPitch,
+                      uint32_t rowBytes,
+                      uint32_t rowCount) {
+            if (rowCount == 0) {
+                return;
+            }
+
+            if (dstRowPitch == rowBytes && srcRowPitch == rowBytes) {
+                memcpy(dst, src, size_t(rowBytes) * rowCount);
+                return;
+            }
+
+            for (uint32_t row = 0; row < rowCount; ++row) {
+                memcpy(dst + size_t(row) * dstRowPitch, src + size_t(row) * srcRowPitch,
+                       rowBytes);
+            }
+        }
+
+        // The validation of buffer sizes for texture copies only accounts for width bytes in the
+        // last row instead of width texels, so the last row is clamped to the end of the buffer.
+        uint32_t ClampedLastRowBytes(const BufferCopyLocation& location,
+                                     uint32_t rowPitch,
+                                     uint32_t rowBytes,
+                                     uint32_t rowCount) {
+            uint64_t lastRowOffset = location.offset + uint64_t(rowPitch) * (rowCount - 1);
+            uint64_t bufferSize = location.buffer->GetSize();
+            if (lastRowOffset >= bufferSize) {
+                return 0;
+            }
+            return static_cast<uint32_t>(std::min<uint64_t>(rowBytes, bufferSize - lastRowOffset));
+        }
+
+        // Copies between a buffer and a texture in the direction given by toTexture.
+        void CopyBufferTexture(BufferCopyLocation& bufferLocation,
+                               TextureCopyLocation& textureLocation,
+                               uint32_t rowPitch,
+                               bool toTexture) {
+            Texture* texture = ToBackend(textureLocation.texture.Get());
+            uint32_t texelSize = TextureFormatPixelSize(texture->GetFormat());
+            uint32_t rowBytes = textureLocation.width * texelSize;
+            uint32_t rowCount = textureLocation.height;
+            if (rowCount == 0 || rowBytes == 0) {
+                return;
+            }
+
+            uint32_t textureRowPitch = texture->GetRowPitch(textureLocation.level);
+            uint8_t* textureData =
+                texture->GetSubresourceData(textureLocation.level, textureLocation.slice) +
+                size_t(textureLocation.y) * textureRowPitch + size_t(textureLocation.x) * texelSize;
+            uint8_t* bufferData =
+                ToBackend(bufferLocation.buffer.Get())->GetBackingData() + bufferLocation.offset;
+
+            uint32_t lastRowBytes =
+                ClampedLastRowBytes(bufferLocation, rowPitch, rowBytes, rowCount);
+            size_t lastRowTextureOffset = size_t(rowCount - 1) * textureRowPitch;
+            size_t lastRowBufferOffset = size_t(rowCount - 1) * rowPitch;
+
+            if (toTexture) {
+                CopyRows(textureData, textureRowPitch, bufferData, rowPitch, rowBytes,
+                         rowCount - 1);
+                memcpy(textureData + lastRowTextureOffset, bufferData + lastRowBufferOffset,
+                       lastRowBytes);
+            } else {
+                CopyRows(bufferData, rowPitch, textureData, textureRowPitch, rowBytes,
+                         rowCount - 1);
+                memcpy(bufferData + lastRowBufferOffset, textureData + lastRowTextureOffset,
+                       lastRowBytes);
+            }
+        }
+
+        // Gathers the memory of the uniform and storage buffers of the bind groups. Other
+        // bindings can't be used by the interpreter.
+        ShaderBindings GetShaderBindings(const std::array<BindGroup*, kMaxBindGroups>& groups) {
+            ShaderBindings bindings;
+            for (uint32_t index = 0; index < kMaxBindGroups; ++index) {
+                BindGroup* group = groups[index];
+                if (group == nullptr) {
+                    continue;
+                }
+
+                const auto& layout = group->GetLayout()->GetBindingInfo();
+                for (uint32_t binding : IterateBitSet(layout.mask)) {
+                    if (layout.types[binding] != dawn::BindingType::UniformBuffer &&
+                        layout.types[binding] != dawn::BindingType::StorageBuffer) {
+                        continue;
+                    }
+
+                    BufferViewBase* view = group->GetBindingAsBufferView(binding);
+                    ShaderBindings::Buffer* buffer = &bindings.buffers[index][binding];
+                    buffer->data =
+                        ToBackend(view->GetBuffer())->GetBackingData() + view->GetOffset();
+                    buffer->size = view->GetSize();
+                }
+            }
+            return bindings;
+        }
+
+    }  // anonymous namespace
+
+    void CommandBuffer::Execute() {
+        Command type;
+        while (mCommands.NextCommandId(&type)) {
+            switch (type) {
+                case Command::BeginComputePass: {
+                    mCommands.NextCommand<BeginComputePassCmd>();
+                    ExecuteComputePass();
+                } break;
+
+                case Command::BeginRenderPass: {
+                    BeginRenderPassCmd* cmd = mCommands.NextCommand<BeginRenderPassCmd>();
+                    ExecuteRenderPass(ToBackend(cmd->info.Get()));
+                } break;
+
+                case Command::CopyBufferToBuffer: {
+                    CopyBufferToBufferCmd* copy = mCommands.NextCommand<CopyBufferToBufferCmd>();
+                    auto& src = copy->source;
+                    auto& dst = copy->destination;
+
+                    // memmove because the source and destination can be the same buffer.
+                    memmove(ToBackend(dst.buffer)->GetBackingData() + dst.offset,
+                            ToBackend(src.buffer)->GetBackingData() + src.offset, copy->size);
+                } break;
+
+                case Command::CopyBufferToTexture: {
+                    CopyBufferToTextureCmd* copy = mCommands.NextCommand<CopyBufferToTextureCmd>();
+                    CopyBufferTexture(copy->source, copy->destination, copy->rowPitch, true);
+                } break;
+
+                case Command::CopyTextureToBuffer: {
+                    CopyTextureToBufferCmd* copy = mCommands.NextCommand<CopyTextureToBufferCmd>();
+                    CopyBufferTexture(copy->destination, copy->source, copy->rowPitch, false);
+                } break;
+
+                default: { SkipCommand(&mCommands, type); } break;
+            }
+        }
+    }
+
+    void CommandBuffer::ExecuteComputePass() {
+        ComputePipeline* lastPipeline = nullptr;
+        std::array<BindGroup*, kMaxBindGroups> bindGroups = {};
+        std::array<uint32_t, kMaxPushConstants> pushConstants = {};
+
+        Command type;
+        while (mCommands.NextCommandId(&type)) {
+            switch (type) {
+                case Command::EndComputePass: {
+                    mCommands.NextCommand<EndComputePassCmd>();
+                    return;
+                }
+
+                case Command::Dispatch: {
+                    DispatchCmd* dispatch = mCommands.NextCommand<DispatchCmd>();
+
+                    ShaderBindings bindings = GetShaderBindings(bindGroups);
+                    bindings.pushConstants = pushConstants.data();
+                    lastPipeline->Dispatch(bindings, dispatch->x, dispatch->y, dispatch->z);
+                } break;
+
+                case Command::SetComputePipeline: {
+                    SetComputePipelineCmd* cmd = mCommands.NextCommand<SetComputePipelineCmd>();
+                    lastPipeline = ToBackend(cmd->pipeline).Get();
+                } break;
+
+                case Command::SetPushConstants: {
+                    SetPushConstantsCmd* cmd = mCommands.NextCommand<SetPushConstantsCmd>();
+                    uint32_t* values = mCommands.NextData<uint32_t>(cmd->count);
+
+                    if (cmd->stages & dawn::ShaderStageBit::Compute) {
+                        memcpy(&pushConstants[cmd->offset], values, cmd->count * sizeof(uint32_t));
+                    }
+                } break;
+
+                case Command::SetBindGroup: {
+                    SetBindGroupCmd* cmd = mCommands.NextCommand<SetBindGroupCmd>();
+                    bindGroups[cmd->index] = ToBackend(cmd->group.Get());
+                } break;
+
+                default: { UNREACHABLE(); } break;
+            }
+        }
+
+        // EndComputePass should have been called
+        UNREACHABLE();
+    }
+
+    void CommandBuffer::ExecuteRenderPass(RenderPassDescriptor* renderPass) {
+        Rasterizer rasterizer(ToBackend(GetDevice()), renderPass);
+
+        // The scissor defaults to the whole attachments and the blend color to zero.
+        DrawState state;
+        state.scissorWidth = rasterizer.GetWidth();
+        state.scissorHeight = rasterizer.GetHeight();
+        std::array<BindGroup*, kMaxBindGroups> bindGroups = {};
+        PerStage<std::array<uint32_t, kMaxPushConstants>> pushConstants;
+        for (dawn::ShaderStage stage : IterateStages(kAllStages)) {
+            pushConstants[stage].fill(0);
+        }
+
+        auto PrepareBindings = [&]() {
+            state.vertexBindings = GetShaderBindings(bindGroups);
+            state.vertexBindings.pushConstants = pushConstants[dawn::ShaderStage::Vertex].data();
+            state.fragmentBindings = GetShaderBindings(bindGroups);
+            state.fragmentBindings.pushConstants =
+                pushConstants[dawn::ShaderStage::Fragment].data();
+        };
+
+        Command type;
+        while (mCommands.NextCommandId(&type)) {
+            switch (type) {
+                case Command::EndRenderPass: {
+                    mCommands.NextCommand<EndRenderPassCmd>();
+                    return;
+                }
+
+                case Command::DrawArrays: {
+                    DrawArraysCmd* draw = mCommands.NextCommand<DrawArraysCmd>();
+                    PrepareBindings();
+                    rasterizer.DrawArrays(state, draw->vertexCount, draw->instanceCount,
+                                          draw->firstVertex, draw->firstInstance);
+                } break;
+
+                case Command::DrawElements: {
+                    DrawElementsCmd* draw = mCommands.NextCommand<DrawElementsCmd>();
+                    PrepareBindings();
+                    rasterizer.DrawElements(state, draw->indexCount, draw->instanceCount,
+                                            draw->firstIndex, draw->firstInstance);
+                } break;
+
+                case Command::SetRenderPipeline: {
+                    SetRenderPipelineCmd* cmd = mCommands.NextCommand<SetRenderPipelineCmd>();
+                    state.pipeline = ToBackend(cmd->pipeline).Get();
+                } break;
+
+                case Command::SetPushConstants: {
+                    SetPushConstantsCmd* cmd = mCommands.NextCommand<SetPushConstantsCmd>();
+                    uint32_t* values = mCommands.NextData<uint32_t>(cmd->count);
+
+                    for (dawn::ShaderStage stage : IterateStages(cmd->stages)) {
+                        memcpy(&pushConstants[stage][cmd->offset], values,
+                               cmd->count * sizeof(uint32_t));
+                    }
+                } break;
+
+                case Command::SetStencilReference: {
+                    SetStencilReferenceCmd* cmd = mCommands.NextCommand<SetStencilReferenceCmd>();
+                    state.stencilReference = cmd->reference;
+                } break;
+
+                case Command::SetScissorRect: {
+                    SetScissorRectCmd* cmd = mCommands.NextCommand<SetScissorRectCmd>();
+                    state.scissorX = cmd->x;
+                    state.scissorY = cmd->y;
+                    state.scissorWidth = cmd->width;
+                    state.scissorHeight = cmd->height;
+                } break;
+
+                case Command::SetBlendColor: {
+                    SetBlendColorCmd* cmd = mCommands.NextCommand<SetBlendColorCmd>();
+                    state.blendColor = {{cmd->r, cmd->g, cmd->b, cmd->a}};
+                } break;
+
+                case Command::SetBindGroup: {
+                    SetBindGroupCmd* cmd = mCommands.NextCommand<SetBindGroupCmd>();
+                    bindGroups[cmd->index] = ToBackend(cmd->group.Get());
+                } break;
+
+                case Command::SetIndexBuffer: {
+                    SetIndexBufferCmd* cmd = mCommands.NextCommand<SetIndexBufferCmd>();
+                    Buffer* buffer = ToBackend(cmd->buffer.Get());
+                    state.indexBuffer.data = buffer->GetBackingData() + cmd->offset;
+                    state.indexBuffer.size = buffer->GetSize() - cmd->offset;
+                } break;
+
+                case Command::SetVertexBuffers: {
+                    SetVertexBuffersCmd* cmd = mCommands.NextCommand<SetVertexBuffersCmd>();
+                    auto buffers = mCommands.NextData<Ref<BufferBase>>(cmd->count);
+                    auto offsets = mCommands.NextData<uint32_t>(cmd->count);
+
+                    for (uint32_t i = 0; i < cmd->count; ++i) {
+                        Buffer* buffer = ToBackend(buffers[i].Get());
+                        DrawState::Buffer* vertexBuffer = &state.vertexBuffers[cmd->startSlot + i];
+                        vertexBuffer->data = buffer->GetBackingData() + offsets[i];
+                        vertexBuffer->size = buffer->GetSize() - offsets[i];
+                    }
+                } break;
+
+                default: { UNREACHABLE(); } break;
+            }
+        }
+
+        // EndRenderPass should have been called
+        UNREACHABLE();
+    }
+
+    // ComputePipeline
+
+    ComputePipeline::ComputePipeline(Device* device, const ComputePipelineDescriptor* descriptor)
+        : ComputePipelineBase(device, descriptor) {
+        // The pipeline is still valid when the interpreter doesn't support the module, its
+        // dispatches produce a device error instead.
+        mProgram = SpirvProgram::Create(ToBackend(descriptor->module)->GetSpirv(),
+                                        dawn::ShaderStage::Compute, descriptor->entryPoint,
+                                        &mProgramError);
+    }
+
+    ComputePipeline::~ComputePipeline() {
+    }
+
+    void ComputePipeline::Dispatch(const ShaderBindings& bindings,
+                                   uint32_t x,
+                                   uint32_t y,
+                                   uint32_t z) {
+        if (mProgram == nullptr) {
+            GetDevice()->HandleError(
+                ("The null backend can't run the compute shader: " + mProgramError).c_str());
+            return;
+        }
+
+        ThreadPool* threadPool = ToBackend(GetDevice())->GetThreadPool();
+        if (mWorkgroupStates.empty()) {
+            for (uint32_t i = 0; i < threadPool->GetThreadCount(); ++i) {
+                mWorkgroupStates.push_back(mProgram->CreateWorkgroupState());
+            }
+        }
+
+        // The workgroups are numbered linearly, in chunks that fit ParallelFor's count.
+        std::array<uint32_t, 3> workgroupCount = {{x, y, z}};
+        uint64_t totalCount = uint64_t(x) * y * z;
+        constexpr uint64_t kMaxChunkSize = std::numeric_limits<uint32_t>::max();
+
+        for (uint64_t first = 0; first < totalCount; first += kMaxChunkSize) {
+            uint32_t chunkSize = static_cast<uint32_t>(std::min(totalCount - first, kMaxChunkSize));
+            threadPool->ParallelFor(chunkSize, [&](uint32_t index, uint32_t threadIndex) {
+                uint64_t workgroup = first + index;
+                std::array<uint32_t, 3> workgroupId = {
+                    {static_cast<uint32_t>(workgroup % x), static_cast<uint32_t>(workgroup / x % y),
+                     static_cast<uint32_t>(workgroup / (uint64_t(x) * y))}};
+                mProgram->RunWorkgroup(mWorkgroupStates[threadIndex].get(), bindings, workgroupId,
+                                       workgroupCount);
+            });
+        }
+    }
+
     // Queue
 
     Queue::Queue(Device* device) : QueueBase(device) {
@@ -188,14 +627,108 @@ namespace dawn_native { namespace null {
     Queue::~Queue() {
     }
 
-    void Queue::SubmitImpl(uint32_t, CommandBufferBase* const*) {
-        auto operations = ToBackend(GetDevice())->AcquirePendingOperations();
+    void Queue::SubmitImpl(uint32_t numCommands, CommandBufferBase* const* commands) {
+        // The commands run immediately, only their completion is delayed by a simulated queue.
+        for (uint32_t i = 0; i < numCommands; ++i) {
+            ToBackend(commands[i])->Execute();
+        }
+
+        ToBackend(GetDevice())->SubmitPendingCommands(numCommands);
+    }
+
+    // RenderPipeline
+
+    RenderPipeline::RenderPipeline(RenderPipelineBuilder* builder) : RenderPipelineBase(builder) {
+        // Like compute pipelines, render pipelines stay valid when the interpreter doesn't
+        // support their shaders or the rasterizer their topology.
+        for (dawn::ShaderStage stage : IterateStages(GetStageMask())) {
+            const auto& stageInfo = builder->GetStageInfo(stage);
+            std::string error;
+            mPrograms[stage] = SpirvProgram::Create(ToBackend(stageInfo.module)->GetSpirv(),
+                                                    stage, stageInfo.entryPoint, &error);
+            if (mPrograms[stage] == nullptr && mUnsupportedReason.empty()) {
+                const char* stageName = stage == dawn::ShaderStage::Vertex ? "vertex" : "fragment";
+                mUnsupportedReason =
+                    std::string("The null backend can't run the ") + stageName + " shader: " + error;
+            }
+        }
 
-        for (auto& operation : operations) {
-            operation->Execute();
+        dawn::PrimitiveTopology topology = GetPrimitiveTopology();
+        if (mUnsupportedReason.empty() && topology != dawn::PrimitiveTopology::TriangleList &&
+            topology != dawn::PrimitiveTopology::TriangleStrip) {
+            mUnsupportedReason = "The null backend only draws triangle lists and strips";
         }
+    }
+
+    RenderPipeline::~RenderPipeline() {
+    }
+
+    const SpirvProgram* RenderPipeline::GetProgram(dawn::ShaderStage stage) const {
+        return mPrograms[stage].get();
+    }
+
+    const std::string& RenderPipeline::GetUnsupportedReason() const {
+        return mUnsupportedReason;
+    }
+
+    void RenderPipeline::PrepareStates(uint32_t threadCount) {
+        for (dawn::ShaderStage stage : IterateStages(GetStageMask())) {
+            if (mPrograms[stage] == nullptr) {
+                continue;
+            }
+            while (mStates[stage].size() < threadCount) {
+                mStates[stage].push_back(mPrograms[stage]->CreateWorkgroupState());
+            }
+        }
+    }
+
+    SpirvWorkgroupState* RenderPipeline::GetState(dawn::ShaderStage stage, uint32_t threadIndex) {
+        return mStates[stage][threadIndex].get();
+    }
+
+    // Texture
+
+    Texture::Texture(Device* device, const TextureDescriptor* descriptor)
+        : TextureBase(device, descriptor) {
+        mLevelOffsets.resize(GetNumMipLevels());
+        for (uint32_t level = 0; level < GetNumMipLevels(); ++level) {
+            mLevelOffsets[level] = mLayerSize;
+            mLayerSize += size_t(GetRowPitch(level)) * GetLevelHeight(level) * GetDepth();
+        }
+
+        mBackingData = std::unique_ptr<uint8_t[]>(new uint8_t[mLayerSize * GetArrayLayers()]());
+    }
+
+    Texture::~Texture() {
+    }
+
+    uint8_t* Texture::GetSubresourceData(uint32_t level, uint32_t slice) {
+        ASSERT(level < GetNumMipLevels() && slice < GetArrayLayers());
+        return mBackingData.get() + mLayerSize * slice + mLevelOffsets[level];
+    }
+
+    uint32_t Texture::GetRowPitch(uint32_t level) const {
+        return std::max(GetWidth() >> level, 1u) * TextureFormatPixelSize(GetFormat());
+    }
+
+    uint32_t Texture::GetLevelHeight(uint32_t level) const {
+        return std::max(GetHeight() >> level, 1u);
+    }
+
+    // ShaderModule
+
+    ShaderModule::ShaderModule(Device* device, const ShaderModuleDescriptor* descriptor)
+        : ShaderModuleBase(device, descriptor) {
+        mSpirv.assign(descriptor->code, descriptor->code + descriptor->codeSize);
+        spirv_cross::Compiler compiler(mSpirv);
+        ExtractSpirvInfo(compiler);
+    }
+
+    ShaderModule::~ShaderModule() {
+    }
 
-        operations.clear();
+    const std::vector<uint32_t>& ShaderModule::GetSpirv() const {
+        return mSpirv;
     }
 
     // SwapChain
@@ -15,8 +15,10 @@
 #ifndef DAWNNATIVE_NULL_NULLBACKEND_H_
 #define DAWNNATIVE_NULL_NULLBACKEND_H_
 
+#include "dawn_native/NullBackend.h"
 #include "dawn_native/dawn_platform.h"
 
+#include "common/Serial.h"
 #include "dawn_native/BindGroup.h"
 #include "dawn_native/BindGroupLayout.h"
 #include "dawn_native/BlendState.h"
@@ -35,6 +37,17 @@
 #include "dawn_native/SwapChain.h"
 #include "dawn_native/Texture.h"
 #include "dawn_native/ToBackend.h"
+#include "dawn_native/null/SpirvInterpreter.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class ThreadPool;
 
 namespace dawn_native { namespace null {
 
@@ -44,18 +57,18 @@ namespace dawn_native { namespace null {
     class Buffer;
     using BufferView = BufferViewBase;
     class CommandBuffer;
-    using ComputePipeline = ComputePipelineBase;
+    class ComputePipeline;
     using DepthStencilState = DepthStencilStateBase;
     class Device;
     using InputState = InputStateBase;
     using PipelineLayout = PipelineLayoutBase;
     class Queue;
     using RenderPassDescriptor = RenderPassDescriptorBase;
-    using RenderPipeline = RenderPipelineBase;
+    class RenderPipeline;
     using Sampler = SamplerBase;
-    using ShaderModule = ShaderModuleBase;
+    class ShaderModule;
     class SwapChain;
-    using Texture = TextureBase;
+    class Texture;
     using TextureView = TextureViewBase;
 
     struct NullBackendTraits {
@@ -85,14 +98,11 @@ namespace dawn_native { namespace null {
         return ToBackendBase<NullBackendTraits>(common);
     }
 
-    struct PendingOperation {
-        virtual ~PendingOperation() = default;
-        virtual void Execute() = 0;
-    };
-
     class Device : public DeviceBase {
       public:
         Device();
+        // Creates a device with a simulated queue, see SimulatedQueueDescriptor.
+        Device(const SimulatedQueueDescriptor& queueDescriptor);
         ~Device();
 
         BindGroupBase* CreateBindGroup(BindGroupBuilder* builder) override;
@@ -109,8 +119,13 @@ namespace dawn_native { namespace null {
 
         void TickImpl() override;
 
-        void AddPendingOperation(std::unique_ptr<PendingOperation> operation);
-        std::vector<std::unique_ptr<PendingOperation>> AcquirePendingOperations();
+        // Called by the queue after running the commands of a submission. Without a simulated
+        // queue the submission completes immediately.
+        void SubmitPendingCommands(uint32_t commandBufferCount);
+
+        // The threads running the workgroups of dispatches and the vertices and tiles of draws,
+        // created on the first dispatch or draw.
+        ThreadPool* GetThreadPool();
 
       private:
         ResultOrError<BindGroupLayoutBase*> CreateBindGroupLayoutImpl(
@@ -126,7 +141,28 @@ namespace dawn_native { namespace null {
             const ShaderModuleDescriptor* descriptor) override;
         ResultOrError<TextureBase*> CreateTextureImpl(const TextureDescriptor* descriptor) override;
 
-        std::vector<std::unique_ptr<PendingOperation>> mPendingOperations;
+        Serial CheckAndUpdateCompletedSerials() override;
+        bool WaitForSerialImpl(Serial serial, uint64_t timeoutNs) override;
+        void SimulatedQueueThread();
+
+        std::unique_ptr<ThreadPool> mThreadPool;
+
+        // The simulated queue completes the in-flight submissions in order on its thread.
+        struct InFlightSubmission {
+            Serial serial;
+            std::chrono::steady_clock::time_point completionTime;
+        };
+        std::atomic<Serial> mSimulatedCompletedSerial;
+        bool mSimulateQueue = false;
+        SimulatedQueueDescriptor mQueueDescriptor;
+        std::chrono::steady_clock::time_point mLastCompletionTime;
+        std::thread mQueueThread;
+        std::mutex mQueueMutex;
+        std::condition_variable mQueueCondition;
+        // Notified by the queue thread when it completes a submission.
+        std::condition_variable mCompletionCondition;
+        std::deque<InFlightSubmission> mInFlightSubmissions;
+        bool mQueueStopping = false;
     };
 
     class Buffer : public BufferBase {
@@ -136,6 +172,8 @@ namespace dawn_native { namespace null {
 
         void MapReadOperationCompleted(uint32_t serial, void* ptr, bool isWrite);
 
+        uint8_t* GetBackingData();
+
       private:
         void SetSubDataImpl(uint32_t start, uint32_t count, const uint8_t* data) override;
         void MapReadAsyncImpl(uint32_t serial, uint32_t start, uint32_t count) override;
@@ -152,10 +190,32 @@ namespace dawn_native { namespace null {
         CommandBuffer(CommandBufferBuilder* builder);
         ~CommandBuffer();
 
+        // Runs the copies, the dispatches and the draws on the CPU backing stores of the buffers
+        // and textures.
+        void Execute();
+
       private:
+        void ExecuteComputePass();
+        void ExecuteRenderPass(RenderPassDescriptor* renderPass);
+
         CommandIterator mCommands;
     };
 
+    class ComputePipeline : public ComputePipelineBase {
+      public:
+        ComputePipeline(Device* device, const ComputePipelineDescriptor* descriptor);
+        ~ComputePipeline();
+
+        // Runs the x * y * z workgroups on the device's thread pool. Shaders using SPIR-V that
+        // the interpreter doesn't support produce a device error instead.
+        void Dispatch(const ShaderBindings& bindings, uint32_t x, uint32_t y, uint32_t z);
+
+      private:
+        std::unique_ptr<SpirvProgram> mProgram;
+        std::string mProgramError;
+        std::vector<std::unique_ptr<SpirvWorkgroupState>> mWorkgroupStates;
+    };
+
     class Queue : public QueueBase {
       public:
         Queue(Device* device);
@@ -165,6 +225,58 @@ namespace dawn_native { namespace null {
         void SubmitImpl(uint32_t numCommands, CommandBufferBase* const* commands) override;
     };
 
+    class RenderPipeline : public RenderPipelineBase {
+      public:
+        RenderPipeline(RenderPipelineBuilder* builder);
+        ~RenderPipeline();
+
+        // The programs of the vertex and fragment stages. They are nullptr when the interpreter
+        // doesn't support the shader.
+        const SpirvProgram* GetProgram(dawn::ShaderStage stage) const;
+
+        // Why the pipeline can't be drawn with, or an empty string when it can. Draws with such a
+        // pipeline produce a device error instead.
+        const std::string& GetUnsupportedReason() const;
+
+        // Each thread of the pool runs the invocations of the stages with its own states. They
+        // are created by PrepareStates before the first draw starts using the pool.
+        void PrepareStates(uint32_t threadCount);
+        SpirvWorkgroupState* GetState(dawn::ShaderStage stage, uint32_t threadIndex);
+
+      private:
+        PerStage<std::unique_ptr<SpirvProgram>> mPrograms;
+        PerStage<std::vector<std::unique_ptr<SpirvWorkgroupState>>> mStates;
+        std::string mUnsupportedReason;
+    };
+
+    class Texture : public TextureBase {
+      public:
+        Texture(Device* device, const TextureDescriptor* descriptor);
+        ~Texture();
+
+        // Each array layer is stored as its mip levels one after the other, each of them with
+        // tightly packed rows.
+        uint8_t* GetSubresourceData(uint32_t level, uint32_t slice);
+        uint32_t GetRowPitch(uint32_t level) const;
+        uint32_t GetLevelHeight(uint32_t level) const;
+
+      private:
+        std::vector<size_t> mLevelOffsets;
+        size_t mLayerSize = 0;
+        std::unique_ptr<uint8_t[]> mBackingData;
+    };
+
+    class ShaderModule : public ShaderModuleBase {
+      public:
+        ShaderModule(Device* device, const ShaderModuleDescriptor* descriptor);
+        ~ShaderModule();
+
+        const std::vector<uint32_t>& GetSpirv() const;
+
+      private:
+        std::vector<uint32_t> mSpirv;
+    };
+
     class SwapChain : public SwapChainBase {
       public:
         SwapChain(SwapChainBuilder* builder);
@@ -0,0 +1,905 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dawn_native/null/Rasterizer.h"
+
+#include "common/BitSetIterator.h"
+#include "common/ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace dawn_native { namespace null {
+
+    namespace {
+
+        // The framebuffer is split in square tiles of kTileSize pixels that are rasterized in
+        // parallel.
+        constexpr uint32_t kTileSize = 16;
+
+        // The edge functions of kQuadWidth pixels of a row are evaluated together, in loops that
+        // the compiler can vectorize.
+        constexpr uint32_t kQuadWidth = 4;
+
+        // Vertices are snapped to 1 / 256th of a pixel.
+        constexpr int64_t kSubpixelBits = 8;
+        constexpr int64_t kSubpixelScale = int64_t(1) << kSubpixelBits;
+
+        // Triangles are clipped to a guard band this many times larger than the viewport, which
+        // keeps the fixed point coordinates and the edge functions from overflowing.
+        constexpr float kGuardBand = 16.0f;
+
+        float AsFloat(uint32_t word) {
+            float value;
+            memcpy(&value, &word, sizeof(value));
+            return value;
+        }
+
+        uint32_t FromFloat(float value) {
+            uint32_t word;
+            memcpy(&word, &value, sizeof(word));
+            return word;
+        }
+
+        float Saturate(float value) {
+            // Written so that NaN becomes 0.
+            return value > 0.0f ? std::min(value, 1.0f) : 0.0f;
+        }
+
+        uint8_t FloatToUnorm8(float value) {
+            return static_cast<uint8_t>(Saturate(value) * 255.0f + 0.5f);
+        }
+
+        bool IsUintFormat(dawn::TextureFormat format) {
+            switch (format) {
+                case dawn::TextureFormat::R8G8B8A8Uint:
+                case dawn::TextureFormat::R8G8Uint:
+                case dawn::TextureFormat::R8Uint:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        // Returns the byte of a texel holding a channel, red to alpha, or -1 when the color
+        // format doesn't have it. All the color formats have 8-bit channels.
+        int32_t ChannelByte(dawn::TextureFormat format, uint32_t channel) {
+            switch (format) {
+                case dawn::TextureFormat::R8G8B8A8Unorm:
+                case dawn::TextureFormat::R8G8B8A8Uint:
+                    return static_cast<int32_t>(channel);
+                case dawn::TextureFormat::R8G8Unorm:
+                case dawn::TextureFormat::R8G8Uint:
+                    return channel < 2 ? static_cast<int32_t>(channel) : -1;
+                case dawn::TextureFormat::R8Unorm:
+                case dawn::TextureFormat::R8Uint:
+                    return channel == 0 ? 0 : -1;
+                case dawn::TextureFormat::B8G8R8A8Unorm: {
+                    constexpr int32_t kBgraBytes[4] = {2, 1, 0, 3};
+                    return kBgraBytes[channel];
+                }
+                default:
+                    UNREACHABLE();
+            }
+        }
+
+        void FillAttachment(uint8_t* data,
+                            uint32_t rowPitch,
+                            uint32_t width,
+                            uint32_t height,
+                            const uint8_t* texel,
+                            uint32_t texelSize) {
+            for (uint32_t y = 0; y < height; ++y) {
+                uint8_t* row = data + size_t(y) * rowPitch;
+                for (uint32_t x = 0; x < width; ++x) {
+                    memcpy(row + size_t(x) * texelSize, texel, texelSize);
+                }
+            }
+        }
+
+        bool IsFloatVertexFormat(dawn::VertexFormat format) {
+            switch (format) {
+                case dawn::VertexFormat::FloatR32G32B32A32:
+                case dawn::VertexFormat::FloatR32G32B32:
+                case dawn::VertexFormat::FloatR32G32:
+                case dawn::VertexFormat::FloatR32:
+                case dawn::VertexFormat::UnormR8G8B8A8:
+                case dawn::VertexFormat::UnormR8G8:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        // Reads an attribute as the shader sees it, with the components missing from the format
+        // being (0, 0, 0, 1). Attributes outside of the vertex buffer have the default value too,
+        // like with robust buffer access.
+        void FetchAttribute(const DrawState::Buffer& buffer,
+                            uint64_t offset,
+                            dawn::VertexFormat format,
+                            ShaderInterface::Location* value) {
+            bool isFloat = IsFloatVertexFormat(format);
+            *value = {{0, 0, 0, isFloat ? FromFloat(1.0f) : 1u}};
+
+            size_t componentSize = VertexFormatComponentSize(format);
+            if (buffer.data == nullptr || offset + VertexFormatSize(format) > buffer.size) {
+                return;
+            }
+
+            const uint8_t* data = buffer.data + offset;
+            for (uint32_t i = 0; i < VertexFormatNumComponents(format); ++i) {
+                const uint8_t* component = data + i * componentSize;
+                switch (componentSize) {
+                    case sizeof(uint32_t):
+                        memcpy(&(*value)[i], component, sizeof(uint32_t));
+                        break;
+                    case sizeof(uint16_t): {
+                        uint16_t word;
+                        memcpy(&word, component, sizeof(word));
+                        (*value)[i] = word;
+                    } break;
+                    case sizeof(uint8_t):
+                        (*value)[i] = FromFloat(component[0] / 255.0f);
+                        break;
+                    default:
+                        UNREACHABLE();
+                }
+            }
+        }
+
+        template <typename T>
+        bool Compare(dawn::CompareFunction function, T a, T b) {
+            switch (function) {
+                case dawn::CompareFunction::Never:
+                    return false;
+                case dawn::CompareFunction::Less:
+                    return a < b;
+                case dawn::CompareFunction::LessEqual:
+                    return a <= b;
+                case dawn::CompareFunction::Greater:
+                    return a > b;
+                case dawn::CompareFunction::GreaterEqual:
+                    return a >= b;
+                case dawn::CompareFunction::Equal:
+                    return a == b;
+                case dawn::CompareFunction::NotEqual:
+                    return a != b;
+                case dawn::CompareFunction::Always:
+                    return true;
+                default:
+                    UNREACHABLE();
+            }
+        }
+
+        uint8_t ApplyStencilOperation(dawn::StencilOperation operation,
+                                      uint8_t value,
+                                      uint8_t reference) {
+            switch (operation) {
+                case dawn::StencilOperation::Keep:
+                    return value;
+                case dawn::StencilOperation::Zero:
+                    return 0;
+                case dawn::StencilOperation::Replace:
+                    return reference;
+                case dawn::StencilOperation::Invert:
+                    return static_cast<uint8_t>(~value);
+                case dawn::StencilOperation::IncrementClamp:
+                    return value == 0xFF ? value : static_cast<uint8_t>(value + 1);
+                case dawn::StencilOperation::DecrementClamp:
+                    return value == 0 ? value : static_cast<uint8_t>(value - 1);
+                case dawn::StencilOperation::IncrementWrap:
+                    return static_cast<uint8_t>(value + 1);
+                case dawn::StencilOperation::DecrementWrap:
+                    return static_cast<uint8_t>(value - 1);
+                default:
+                    UNREACHABLE();
+            }
+        }
+
+        float GetBlendFactor(dawn::BlendFactor factor,
+                             uint32_t channel,
+                             const std::array<float, 4>& src,
+                             const std::array<float, 4>& dst,
+                             const std::array<float, 4>& constant) {
+            switch (factor) {
+                case dawn::BlendFactor::Zero:
+                    return 0.0f;
+                case dawn::BlendFactor::One:
+                    return 1.0f;
+                case dawn::BlendFactor::SrcColor:
+                    return src[channel];
+                case dawn::BlendFactor::OneMinusSrcColor:
+                    return 1.0f - src[channel];
+                case dawn::BlendFactor::SrcAlpha:
+                    return src[3];
+                case dawn::BlendFactor::OneMinusSrcAlpha:
+                    return 1.0f - src[3];
+                case dawn::BlendFactor::DstColor:
+                    return dst[channel];
+                case dawn::BlendFactor::OneMinusDstColor:
+                    return 1.0f - dst[channel];
+                case dawn::BlendFactor::DstAlpha:
+                    return dst[3];
+                case dawn::BlendFactor::OneMinusDstAlpha:
+                    return 1.0f - dst[3];
+                case dawn::BlendFactor::SrcAlphaSaturated:
+                    return channel == 3 ? 1.0f : std::min(src[3], 1.0f - dst[3]);
+                case dawn::BlendFactor::BlendColor:
+                    return constant[channel];
+                case dawn::BlendFactor::OneMinusBlendColor:
+                    return 1.0f - constant[channel];
+                default:
+                    UNREACHABLE();
+            }
+        }
+
+        float Blend(const BlendStateBase::BlendInfo::BlendOpFactor& blend,
+                    uint32_t channel,
+                    const std::array<float, 4>& src,
+                    const std::array<float, 4>& dst,
+                    const std::array<float, 4>& constant) {
+            float srcTerm =
+                src[channel] * GetBlendFactor(blend.srcFactor, channel, src, dst, constant);
+            float dstTerm =
+                dst[channel] * GetBlendFactor(blend.dstFactor, channel, src, dst, constant);
+            switch (blend.operation) {
+                case dawn::BlendOperation::Add:
+                    return srcTerm + dstTerm;
+                case dawn::BlendOperation::Subtract:
+                    return srcTerm - dstTerm;
+                case dawn::BlendOperation::ReverseSubtract:
+                    return dstTerm - srcTerm;
+                // Min and max ignore the factors.
+                case dawn::BlendOperation::Min:
+                    return std::min(src[channel], dst[channel]);
+                case dawn::BlendOperation::Max:
+                    return std::max(src[channel], dst[channel]);
+                default:
+                    UNREACHABLE();
+            }
+        }
+
+    }  // anonymous namespace
+
+    Rasterizer::Rasterizer(Device* device, RenderPassDescriptor* renderPass)
+        : mThreadPool(device->GetThreadPool()),
+          mWidth(renderPass->GetWidth()),
+          mHeight(renderPass->GetHeight()),
+          mColorAttachmentsSet(renderPass->GetColorAttachmentMask()),
+          mHasDepthStencilAttachment(renderPass->HasDepthStencilAttachment()) {
+        // The attachments are the first level and layer of their texture.
+        for (uint32_t i : IterateBitSet(mColorAttachmentsSet)) {
+            RenderPassColorAttachmentInfo& info = renderPass->GetColorAttachment(i);
+            Texture* texture = ToBackend(info.view->GetTexture());
+            Attachment* attachment = &mColorAttachments[i];
+            attachment->data = texture->GetSubresourceData(0, 0);
+            attachment->rowPitch = texture->GetRowPitch(0);
+            attachment->format = texture->GetFormat();
+
+            if (info.loadOp != dawn::LoadOp::Clear) {
+                continue;
+            }
+
+            std::array<uint8_t, 4> texel = {};
+            for (uint32_t channel = 0; channel < 4; ++channel) {
+                int32_t byte = ChannelByte(attachment->format, channel);
+                if (byte < 0) {
+                    continue;
+                }
+                float value = info.clearColor[channel];
+                texel[byte] = IsUintFormat(attachment->format)
+                                  ? static_cast<uint8_t>(std::min(std::max(value, 0.0f), 255.0f))
+                                  : FloatToUnorm8(value);
+            }
+            FillAttachment(attachment->data, attachment->rowPitch, mWidth, mHeight, texel.data(),
+                           TextureFormatPixelSize(attachment->format));
+        }
+
+        // The depth is stored as a float followed by the stencil in a byte.
+        if (mHasDepthStencilAttachment) {
+            RenderPassDepthStencilAttachmentInfo& info =
+                renderPass->GetDepthStencilAttachment();
+            Texture* texture = ToBackend(info.view->GetTexture());
+            mDepthStencilAttachment.data = texture->GetSubresourceData(0, 0);
+            mDepthStencilAttachment.rowPitch = texture->GetRowPitch(0);
+            mDepthStencilAttachment.format = texture->GetFormat();
+            ASSERT(TextureFormatPixelSize(mDepthStencilAttachment.format) == 8);
+
+            bool clearDepth = info.depthLoadOp == dawn::LoadOp::Clear;
+            bool clearStencil = info.stencilLoadOp == dawn::LoadOp::Clear;
+            for (uint32_t y = 0; y < mHeight && (clearDepth || clearStencil); ++y) {
+                uint8_t* row =
+                    mDepthStencilAttachment.data + size_t(y) * mDepthStencilAttachment.rowPitch;
+                for (uint32_t x = 0; x < mWidth; ++x) {
+                    uint8_t* texel = row + size_t(x) * 8;
+                    if (clearDepth) {
+                        memcpy(texel, &info.clearDepth, sizeof(float));
+                    }
+                    if (clearStencil) {
+                        texel[4] = static_cast<uint8_t>(info.clearStencil);
+                    }
+                }
+            }
+        }
+
+        mTilesPerRow = (mWidth + kTileSize - 1) / kTileSize;
+        mTilesPerColumn = (mHeight + kTileSize - 1) / kTileSize;
+        mTileTriangles.resize(size_t(mTilesPerRow) * mTilesPerColumn);
+    }
+
+    Rasterizer::~Rasterizer() {
+    }
+
+    uint32_t Rasterizer::GetWidth() const {
+        return mWidth;
+    }
+
+    uint32_t Rasterizer::GetHeight() const {
+        return mHeight;
+    }
+
+    void Rasterizer::DrawArrays(const DrawState& state,
+                                uint32_t vertexCount,
+                                uint32_t instanceCount,
+                                uint32_t firstVertex,
+                                uint32_t firstInstance) {
+        mIndices.resize(vertexCount);
+        mRestarts.assign(vertexCount, false);
+        for (uint32_t i = 0; i < vertexCount; ++i) {
+            mIndices[i] = firstVertex + i;
+        }
+        Draw(state, instanceCount, firstInstance);
+    }
+
+    void Rasterizer::DrawElements(const DrawState& state,
+                                  uint32_t indexCount,
+                                  uint32_t instanceCount,
+                                  uint32_t firstIndex,
+                                  uint32_t firstInstance) {
+        dawn::IndexFormat format = state.pipeline->GetIndexFormat();
+        size_t indexSize = IndexFormatSize(format);
+        uint32_t restartIndex = format == dawn::IndexFormat::Uint16 ? 0xFFFF : 0xFFFFFFFF;
+
+        // Indices outside of the index buffer are 0, like with robust buffer access.
+        mIndices.resize(indexCount);
+        mRestarts.resize(indexCount);
+        for (uint32_t i = 0; i < indexCount; ++i) {
+            uint64_t offset = (uint64_t(firstIndex) + i) * indexSize;
+            uint32_t index = 0;
+            if (state.indexBuffer.data != nullptr && offset + indexSize <= state.indexBuffer.size) {
+                if (format == dawn::IndexFormat::Uint16) {
+                    uint16_t shortIndex;
+                    memcpy(&shortIndex, state.indexBuffer.data + offset, sizeof(shortIndex));
+                    index = shortIndex;
+                } else {
+                    memcpy(&index, state.indexBuffer.data + offset, sizeof(index));
+                }
+            }
+            mIndices[i] = index;
+            mRestarts[i] = index == restartIndex;
+        }
+        Draw(state, instanceCount, firstInstance);
+    }
+
+    void Rasterizer::Draw(const DrawState& state, uint32_t instanceCount, uint32_t firstInstance) {
+        RenderPipeline* pipeline = state.pipeline;
+        const std::string& unsupportedReason = pipeline->GetUnsupportedReason();
+        if (!unsupportedReason.empty()) {
+            pipeline->GetDevice()->HandleError(unsupportedReason.c_str());
+            return;
+        }
+        pipeline->PrepareStates(mThreadPool->GetThreadCount());
+
+        // The instances are drawn one after the other, each of them with its vertices shaded in
+        // parallel and then its triangles rasterized in parallel.
+        mVertices.resize(mIndices.size());
+        for (uint32_t instance = 0; instance < instanceCount; ++instance) {
+            uint32_t instanceIndex = firstInstance + instance;
+            mThreadPool->ParallelFor(static_cast<uint32_t>(mIndices.size()),
+                                     [&](uint32_t vertex, uint32_t threadIndex) {
+                                         RunVertexShader(state, vertex, instanceIndex,
+                                                         threadIndex);
+                                     });
+
+            AssembleTriangles(state);
+            BinTriangles();
+            mThreadPool->ParallelFor(static_cast<uint32_t>(mActiveTiles.size()),
+                                     [&](uint32_t tile, uint32_t threadIndex) {
+                                         RasterizeTile(state, tile, threadIndex);
+                                     });
+        }
+    }
+
+    void Rasterizer::RunVertexShader(const DrawState& state,
+                                     uint32_t vertex,
+                                     uint32_t instanceIndex,
+                                     uint32_t threadIndex) {
+        RenderPipeline* pipeline = state.pipeline;
+        const SpirvProgram* program = pipeline->GetProgram(dawn::ShaderStage::Vertex);
+
+        ShaderInterface interface;
+        interface.vertexIndex = mIndices[vertex];
+        interface.instanceIndex = instanceIndex;
+
+        InputStateBase* inputState = pipeline->GetInputState();
+        for (uint32_t location : IterateBitSet(inputState->GetAttributesSetMask() &
+                                               program->GetInputLocations())) {
+            const InputStateBase::AttributeInfo& attribute = inputState->GetAttribute(location);
+            const InputStateBase::InputInfo& input = inputState->GetInput(attribute.bindingSlot);
+
+            uint32_t element = input.stepMode == dawn::InputStepMode::Vertex
+                                   ? interface.vertexIndex
+                                   : interface.instanceIndex;
+            uint64_t offset = uint64_t(element) * input.stride + attribute.offset;
+            FetchAttribute(state.vertexBuffers[attribute.bindingSlot], offset, attribute.format,
+                           &interface.inputs[location]);
+        }
+
+        program->RunInvocation(pipeline->GetState(dawn::ShaderStage::Vertex, threadIndex),
+                               state.vertexBindings, &interface);
+
+        mVertices[vertex].position = interface.position;
+        mVertices[vertex].outputs = interface.outputs;
+    }
+
+    void Rasterizer::AssembleTriangles(const DrawState& state) {
+        mClippedVertices.clear();
+        mTriangles.clear();
+        uint32_t count = static_cast<uint32_t>(mIndices.size());
+
+        if (state.pipeline->GetPrimitiveTopology() == dawn::PrimitiveTopology::TriangleList) {
+            for (uint32_t i = 0; i + 2 < count; i += 3) {
+                ClipTriangle(state, i, i + 1, i + 2, i);
+            }
+            return;
+        }
+
+        // Strips start again after restart indices. Every other triangle of a strip swaps two of
+        // its vertices so that all the triangles have the same winding.
+        uint32_t stripStart = 0;
+        for (uint32_t i = 0; i < count; ++i) {
+            if (mRestarts[i]) {
+                stripStart = i + 1;
+                continue;
+            }
+
+            uint32_t position = i - stripStart;
+            if (position < 2) {
+                continue;
+            }
+            if (position % 2 == 0) {
+                ClipTriangle(state, i - 2, i - 1, i, i - 2);
+            } else {
+                ClipTriangle(state, i - 2, i, i - 1, i - 2);
+            }
+        }
+    }
+
+    void Rasterizer::ClipTriangle(const DrawState& state,
+                                  uint32_t v0,
+                                  uint32_t v1,
+                                  uint32_t v2,
+                                  uint32_t provokingVertex) {
+        // The clip planes are the near and far planes, and the guard band. A point is inside a
+        // plane when the dot product of the plane and its position is positive.
+        constexpr float kPlanes[6][4] = {
+            {0.0f, 0.0f, 1.0f, 0.0f},        {0.0f, 0.0f, -1.0f, 1.0f},
+            {1.0f, 0.0f, 0.0f, kGuardBand},  {-1.0f, 0.0f, 0.0f, kGuardBand},
+            {0.0f, 1.0f, 0.0f, kGuardBand},  {0.0f, -1.0f, 0.0f, kGuardBand},
+        };
+        auto Distance = [&](const Vertex& vertex, uint32_t plane) {
+            const std::array<float, 4>& position = vertex.position;
+            return kPlanes[plane][0] * position[0] + kPlanes[plane][1] * position[1] +
+                   kPlanes[plane][2] * position[2] + kPlanes[plane][3] * position[3];
+        };
+
+        // The flat outputs come from the provoking vertex even when it is clipped away.
+        uint32_t provoking = static_cast<uint32_t>(mClippedVertices.size());
+        mClippedVertices.push_back(mVertices[provokingVertex]);
+
+        std::vector<Vertex> polygon = {mVertices[v0], mVertices[v1], mVertices[v2]};
+        bool allInside = true;
+        for (uint32_t plane = 0; plane < 6; ++plane) {
+            for (const Vertex& vertex : polygon) {
+                allInside = allInside && Distance(vertex, plane) >= 0.0f;
+            }
+        }
+
+        if (!allInside) {
+            std::vector<Vertex> clipped;
+            for (uint32_t plane = 0; plane < 6 && !polygon.empty(); ++plane) {
+                clipped.clear();
+                for (size_t i = 0; i < polygon.size(); ++i) {
+                    const Vertex& current = polygon[i];
+                    const Vertex& next = polygon[(i + 1) % polygon.size()];
+                    float currentDistance = Distance(current, plane);
+                    float nextDistance = Distance(next, plane);
+
+                    if (currentDistance >= 0.0f) {
+                        clipped.push_back(current);
+                    }
+                    if ((currentDistance > 0.0f && nextDistance < 0.0f) ||
+                        (currentDistance < 0.0f && nextDistance > 0.0f)) {
+                        // All the outputs are interpolated as floats, the flat ones are taken
+                        // from the provoking vertex instead.
+                        float t = currentDistance / (currentDistance - nextDistance);
+                        Vertex vertex;
+                        for (uint32_t c = 0; c < 4; ++c) {
+                            vertex.position[c] =
+                                current.position[c] + t * (next.position[c] - current.position[c]);
+                        }
+                        for (uint32_t location = 0; location < kMaxShaderLocations; ++location) {
+                            for (uint32_t c = 0; c < 4; ++c) {
+                                float a = AsFloat(current.outputs[location][c]);
+                                float b = AsFloat(next.outputs[location][c]);
+                                vertex.outputs[location][c] = FromFloat(a + t * (b - a));
+                            }
+                        }
+                        clipped.push_back(vertex);
+                    }
+                }
+                std::swap(polygon, clipped);
+            }
+        }
+
+        // The clipped polygon is convex and drawn as a fan.
+        uint32_t first = static_cast<uint32_t>(mClippedVertices.size());
+        mClippedVertices.insert(mClippedVertices.end(), polygon.begin(), polygon.end());
+        for (uint32_t i = 1; i + 1 < polygon.size(); ++i) {
+            SetupTriangle(state, first, first + i, first + i + 1, provoking);
+        }
+    }
+
+    void Rasterizer::SetupTriangle(const DrawState& state,
+                                   uint32_t v0,
+                                   uint32_t v1,
+                                   uint32_t v2,
+                                   uint32_t provokingVertex) {
+        Triangle triangle;
+        triangle.vertices = {{v0, v1, v2}};
+        triangle.provokingVertex = provokingVertex;
+
+        // Clip space is mapped to the whole framebuffer with -1 at its top and left.
+        std::array<int64_t, 3> x;
+        std::array<int64_t, 3> y;
+        for (uint32_t i = 0; i < 3; ++i) {
+            const std::array<float, 4>& position = mClippedVertices[triangle.vertices[i]].position;
+            if (!(position[3] > 0.0f)) {
+                return;
+            }
+            float invW = 1.0f / position[3];
+            float screenX = (position[0] * invW * 0.5f + 0.5f) * mWidth;
+            float screenY = (position[1] * invW * 0.5f + 0.5f) * mHeight;
+            x[i] = std::llround(screenX * kSubpixelScale);
+            y[i] = std::llround(screenY * kSubpixelScale);
+            triangle.depth[i] = Saturate(position[2] * invW);
+            triangle.invW[i] = invW;
+        }
+
+        // Triangles are front facing when they are counter-clockwise with Y up, like in the
+        // other backends, and are reordered to have a positive area.
+        int64_t area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+        if (area == 0) {
+            return;
+        }
+        triangle.frontFacing = area > 0;
+        if (area < 0) {
+            std::swap(x[1], x[2]);
+            std::swap(y[1], y[2]);
+            std::swap(triangle.vertices[1], triangle.vertices[2]);
+            std::swap(triangle.depth[1], triangle.depth[2]);
+            std::swap(triangle.invW[1], triangle.invW[2]);
+            area = -area;
+        }
+        triangle.area = area;
+
+        for (uint32_t i = 0; i < 3; ++i) {
+            uint32_t a = (i + 1) % 3;
+            uint32_t b = (i + 2) % 3;
+            int64_t dx = x[b] - x[a];
+            int64_t dy = y[b] - y[a];
+
+            // Pixels exactly on an edge are only covered by the triangle on the right or below
+            // it, the top-left rule, so that triangles sharing the edge don't both cover them.
+            bool isTopLeft = dy < 0 || (dy == 0 && dx > 0);
+            triangle.edgeA[i] = -dy;
+            triangle.edgeB[i] = dx;
+            triangle.edgeBias[i] = isTopLeft ? 0 : -1;
+            triangle.edgeC[i] = dy * x[a] - dx * y[a] + triangle.edgeBias[i];
+        }
+
+        // The bounding box of the triangle, in pixels, clipped to the scissor.
+        int64_t scissorMinX = std::min(state.scissorX, mWidth);
+        int64_t scissorMinY = std::min(state.scissorY, mHeight);
+        int64_t scissorMaxX = std::min<int64_t>(int64_t(state.scissorX) + state.scissorWidth,
+                                                mWidth) - 1;
+        int64_t scissorMaxY = std::min<int64_t>(int64_t(state.scissorY) + state.scissorHeight,
+                                                mHeight) - 1;
+        auto ToPixel = [](int64_t coordinate) { return coordinate / kSubpixelScale; };
+        triangle.minX = static_cast<int32_t>(
+            std::max(scissorMinX, ToPixel(*std::min_element(x.begin(), x.end()))));
+        triangle.minY = static_cast<int32_t>(
+            std::max(scissorMinY, ToPixel(*std::min_element(y.begin(), y.end()))));
+        triangle.maxX = static_cast<int32_t>(
+            std::min(scissorMaxX, ToPixel(*std::max_element(x.begin(), x.end()))));
+        triangle.maxY = static_cast<int32_t>(
+            std::min(scissorMaxY, ToPixel(*std::max_element(y.begin(), y.end()))));
+        if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+            return;
+        }
+
+        mTriangles.push_back(triangle);
+    }
+
+    void Rasterizer::BinTriangles() {
+        for (uint32_t tile : mActiveTiles) {
+            mTileTriangles[tile].clear();
+        }
+        mActiveTiles.clear();
+
+        for (uint32_t i = 0; i < mTriangles.size(); ++i) {
+            const Triangle& triangle = mTriangles[i];
+            for (uint32_t tileY = triangle.minY / kTileSize; tileY <= triangle.maxY / kTileSize;
+                 ++tileY) {
+                for (uint32_t tileX = triangle.minX / kTileSize;
+                     tileX <= triangle.maxX / kTileSize; ++tileX) {
+                    uint32_t tile = tileY * mTilesPerRow + tileX;
+                    if (!TileOverlapsTriangle(triangle, tile)) {
+                        continue;
+                    }
+                    if (mTileTriangles[tile].empty()) {
+                        mActiveTiles.push_back(tile);
+                    }
+                    mTileTriangles[tile].push_back(i);
+                }
+            }
+        }
+    }
+
+    bool Rasterizer::TileOverlapsTriangle(const Triangle& triangle, uint32_t tile) const {
+        // The tile is outside of the triangle if an edge function is negative at the center of
+        // the tile's pixel where the function is the largest.
+        int64_t tileX = int64_t(tile % mTilesPerRow) * kTileSize;
+        int64_t tileY = int64_t(tile / mTilesPerRow) * kTileSize;
+        int64_t minX = tileX * kSubpixelScale + kSubpixelScale / 2;
+        int64_t minY = tileY * kSubpixelScale + kSubpixelScale / 2;
+        int64_t maxX = minX + (kTileSize - 1) * kSubpixelScale;
+        int64_t maxY = minY + (kTileSize - 1) * kSubpixelScale;
+
+        for (uint32_t i = 0; i < 3; ++i) {
+            int64_t x = triangle.edgeA[i] > 0 ? maxX : minX;
+            int64_t y = triangle.edgeB[i] > 0 ? maxY : minY;
+            if (triangle.edgeA[i] * x + triangle.edgeB[i] * y + triangle.edgeC[i] < 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void Rasterizer::RasterizeTile(const DrawState& state, uint32_t index, uint32_t threadIndex) {
+        uint32_t tile = mActiveTiles[index];
+        int32_t tileMinX = static_cast<int32_t>(tile % mTilesPerRow * kTileSize);
+        int32_t tileMinY = static_cast<int32_t>(tile / mTilesPerRow * kTileSize);
+
+        for (uint32_t triangleIndex : mTileTriangles[tile]) {
+            const Triangle& triangle = mTriangles[triangleIndex];
+            int32_t minX = std::max(triangle.minX, tileMinX);
+            int32_t minY = std::max(triangle.minY, tileMinY);
+            int32_t maxX = std::min<int32_t>(triangle.maxX, tileMinX + kTileSize - 1);
+            int32_t maxY = std::min<int32_t>(triangle.maxY, tileMinY + kTileSize - 1);
+
+            for (int32_t y = minY; y <= maxY; ++y) {
+                int64_t sampleY = int64_t(y) * kSubpixelScale + kSubpixelScale / 2;
+                for (int32_t x = minX; x <= maxX; x += kQuadWidth) {
+                    int64_t sampleX = int64_t(x) * kSubpixelScale + kSubpixelScale / 2;
+
+                    std::array<std::array<int64_t, kQuadWidth>, 3> edges;
+                    std::array<bool, kQuadWidth> covered;
+                    for (uint32_t lane = 0; lane < kQuadWidth; ++lane) {
+                        covered[lane] = x + static_cast<int32_t>(lane) <= maxX;
+                    }
+                    for (uint32_t i = 0; i < 3; ++i) {
+                        int64_t rowValue = triangle.edgeB[i] * sampleY + triangle.edgeC[i];
+                        for (uint32_t lane = 0; lane < kQuadWidth; ++lane) {
+                            edges[i][lane] =
+                                triangle.edgeA[i] * (sampleX + lane * kSubpixelScale) + rowValue;
+                            covered[lane] = covered[lane] && edges[i][lane] >= 0;
+                        }
+                    }
+
+                    for (uint32_t lane = 0; lane < kQuadWidth; ++lane) {
+                        if (!covered[lane]) {
+                            continue;
+                        }
+                        std::array<float, 3> barycentrics;
+                        for (uint32_t i = 0; i < 3; ++i) {
+                            barycentrics[i] = float(edges[i][lane] - triangle.edgeBias[i]) /
+                                              float(triangle.area);
+                        }
+                        ShadePixel(state, triangle, x + static_cast<int32_t>(lane), y,
+                                   barycentrics, threadIndex);
+                    }
+                }
+            }
+        }
+    }
+
+    void Rasterizer::ShadePixel(const DrawState& state,
+                                const Triangle& triangle,
+                                int32_t x,
+                                int32_t y,
+                                const std::array<float, 3>& barycentrics,
+                                uint32_t threadIndex) {
+        RenderPipeline* pipeline = state.pipeline;
+        const SpirvProgram* program = pipeline->GetProgram(dawn::ShaderStage::Fragment);
+
+        float depth = 0.0f;
+        float invW = 0.0f;
+        std::array<float, 3> perspectiveWeights;
+        for (uint32_t i = 0; i < 3; ++i) {
+            depth += barycentrics[i] * triangle.depth[i];
+            perspectiveWeights[i] = barycentrics[i] * triangle.invW[i];
+            invW += perspectiveWeights[i];
+        }
+        for (uint32_t i = 0; i < 3; ++i) {
+            perspectiveWeights[i] /= invW;
+        }
+
+        // The depth and stencil tests run before the shader unless the shader can change their
+        // outcome.
+        bool lateTests = program->WritesFragDepth() || program->CanDiscard();
+        if (!lateTests && !DepthStencilTest(state, triangle, x, y, depth)) {
+            return;
+        }
+
+        ShaderInterface interface;
+        interface.fragCoord = {{x + 0.5f, y + 0.5f, depth, invW}};
+        interface.frontFacing = triangle.frontFacing;
+        for (uint32_t location : IterateBitSet(program->GetInputLocations())) {
+            if (program->GetFlatInputLocations()[location]) {
+                interface.inputs[location] =
+                    mClippedVertices[triangle.provokingVertex].outputs[location];
+                continue;
+            }
+            for (uint32_t c = 0; c < 4; ++c) {
+                float value = 0.0f;
+                for (uint32_t i = 0; i < 3; ++i) {
+                    const Vertex& vertex = mClippedVertices[triangle.vertices[i]];
+                    value += perspectiveWeights[i] * AsFloat(vertex.outputs[location][c]);
+                }
+                interface.inputs[location][c] = FromFloat(value);
+            }
+        }
+
+        program->RunInvocation(pipeline->GetState(dawn::ShaderStage::Fragment, threadIndex),
+                               state.fragmentBindings, &interface);
+        if (interface.discarded) {
+            return;
+        }
+
+        if (lateTests) {
+            if (program->WritesFragDepth()) {
+                depth = Saturate(interface.fragDepth);
+            }
+            if (!DepthStencilTest(state, triangle, x, y, depth)) {
+                return;
+            }
+        }
+
+        WriteColors(state, x, y, interface);
+    }
+
+    bool Rasterizer::DepthStencilTest(const DrawState& state,
+                                      const Triangle& triangle,
+                                      int32_t x,
+                                      int32_t y,
+                                      float depth) {
+        if (!mHasDepthStencilAttachment) {
+            return true;
+        }
+
+        DepthStencilStateBase* depthStencilState = state.pipeline->GetDepthStencilState();
+        const DepthStencilStateBase::DepthInfo& depthInfo = depthStencilState->GetDepth();
+        const DepthStencilStateBase::StencilInfo& stencilInfo = depthStencilState->GetStencil();
+        const DepthStencilStateBase::StencilFaceInfo& face =
+            triangle.frontFacing ? stencilInfo.front : stencilInfo.back;
+        bool stencilTestEnabled = depthStencilState->StencilTestEnabled();
+
+        uint8_t* texel = mDepthStencilAttachment.data +
+                         size_t(y) * mDepthStencilAttachment.rowPitch + size_t(x) * 8;
+        float storedDepth;
+        memcpy(&storedDepth, texel, sizeof(float));
+        uint8_t stencil = texel[4];
+        uint8_t reference = static_cast<uint8_t>(state.stencilReference);
+
+        bool stencilPass =
+            !stencilTestEnabled || Compare(face.compareFunction, reference & stencilInfo.readMask,
+                                           stencil & stencilInfo.readMask);
+        bool depthPass = stencilPass && Compare(depthInfo.compareFunction, depth, storedDepth);
+
+        if (stencilTestEnabled) {
+            dawn::StencilOperation operation = !stencilPass ? face.stencilFail
+                                               : !depthPass ? face.depthFail
+                                                            : face.depthStencilPass;
+            uint8_t value = ApplyStencilOperation(operation, stencil, reference);
+            texel[4] = static_cast<uint8_t>((stencil & ~stencilInfo.writeMask) |
+                                            (value & stencilInfo.writeMask));
+        }
+        if (depthPass && depthInfo.depthWriteEnabled) {
+            memcpy(texel, &depth, sizeof(float));
+        }
+        return depthPass;
+    }
+
+    void Rasterizer::WriteColors(const DrawState& state,
+                                 int32_t x,
+                                 int32_t y,
+                                 const ShaderInterface& interface) {
+        std::array<float, 4> constant;
+        for (uint32_t c = 0; c < 4; ++c) {
+            constant[c] = Saturate(state.blendColor[c]);
+        }
+
+        for (uint32_t i : IterateBitSet(mColorAttachmentsSet)) {
+            const Attachment& attachment = mColorAttachments[i];
+            uint8_t* texel = attachment.data + size_t(y) * attachment.rowPitch +
+                             size_t(x) * TextureFormatPixelSize(attachment.format);
+            const BlendStateBase::BlendInfo& blend =
+                state.pipeline->GetBlendState(i)->GetBlendInfo();
+            uint32_t writeMask = static_cast<uint32_t>(blend.colorWriteMask);
+            const ShaderInterface::Location& output = interface.outputs[i];
+
+            // Integer formats aren't blended, their values are truncated to the channels.
+            if (IsUintFormat(attachment.format)) {
+                for (uint32_t c = 0; c < 4; ++c) {
+                    int32_t byte = ChannelByte(attachment.format, c);
+                    if (byte >= 0 && (writeMask & (1u << c)) != 0) {
+                        texel[byte] = static_cast<uint8_t>(output[c]);
+                    }
+                }
+                continue;
+            }
+
+            std::array<float, 4> color;
+            for (uint32_t c = 0; c < 4; ++c) {
+                color[c] = Saturate(AsFloat(output[c]));
+            }
+
+            if (blend.blendEnabled) {
+                std::array<float, 4> dst = {{0.0f, 0.0f, 0.0f, 1.0f}};
+                for (uint32_t c = 0; c < 4; ++c) {
+                    int32_t byte = ChannelByte(attachment.format, c);
+                    if (byte >= 0) {
+                        dst[c] = texel[byte] / 255.0f;
+                    }
+                }
+
+                std::array<float, 4> src = color;
+                for (uint32_t c = 0; c < 4; ++c) {
+                    const auto& blendOpFactor = c < 3 ? blend.colorBlend : blend.alphaBlend;
+                    color[c] = Blend(blendOpFactor, c, src, dst, constant);
+                }
+            }
+
+            for (uint32_t c = 0; c < 4; ++c) {
+                int32_t byte = ChannelByte(attachment.format, c);
+                if (byte >= 0 && (writeMask & (1u << c)) != 0) {
+                    texel[byte] = FloatToUnorm8(color[c]);
+                }
+            }
+        }
+    }
+
+}}  // namespace dawn_native::null
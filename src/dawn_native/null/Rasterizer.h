@@ -0,0 +1,171 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DAWNNATIVE_NULL_RASTERIZER_H_
+#define DAWNNATIVE_NULL_RASTERIZER_H_
+
+#include "dawn_native/null/NullBackend.h"
+
+#include <array>
+#include <bitset>
+#include <vector>
+
+namespace dawn_native { namespace null {
+
+    // The state set by the commands of a render pass that is used by the draws.
+    struct DrawState {
+        struct Buffer {
+            const uint8_t* data = nullptr;
+            uint32_t size = 0;
+        };
+
+        RenderPipeline* pipeline = nullptr;
+        ShaderBindings vertexBindings;
+        ShaderBindings fragmentBindings;
+        std::array<Buffer, kMaxVertexInputs> vertexBuffers;
+        Buffer indexBuffer;
+
+        uint32_t scissorX = 0;
+        uint32_t scissorY = 0;
+        uint32_t scissorWidth = 0;
+        uint32_t scissorHeight = 0;
+        std::array<float, 4> blendColor = {};
+        uint32_t stencilReference = 0;
+    };
+
+    // Draws triangles in the attachments of a render pass on the CPU. The triangles of a draw are
+    // binned in screen tiles that are rasterized in parallel on the device's thread pool. Each
+    // tile processes its triangles in order so the result doesn't depend on the scheduling of
+    // the threads. Point and line topologies aren't supported and their draws are skipped.
+    class Rasterizer {
+      public:
+        // Runs the load operations of the attachments.
+        Rasterizer(Device* device, RenderPassDescriptor* renderPass);
+        ~Rasterizer();
+
+        uint32_t GetWidth() const;
+        uint32_t GetHeight() const;
+
+        void DrawArrays(const DrawState& state,
+                        uint32_t vertexCount,
+                        uint32_t instanceCount,
+                        uint32_t firstVertex,
+                        uint32_t firstInstance);
+        void DrawElements(const DrawState& state,
+                          uint32_t indexCount,
+                          uint32_t instanceCount,
+                          uint32_t firstIndex,
+                          uint32_t firstInstance);
+
+      private:
+        struct Attachment {
+            uint8_t* data = nullptr;
+            uint32_t rowPitch = 0;
+            dawn::TextureFormat format;
+        };
+
+        // A vertex in clip space with the outputs of the vertex shader.
+        struct Vertex {
+            std::array<float, 4> position;
+            std::array<ShaderInterface::Location, kMaxShaderLocations> outputs;
+        };
+
+        // A triangle ready to be rasterized, with its vertices in the framebuffer in fixed point
+        // and the edge functions of its edges. The vertices are in the order that makes the area
+        // positive.
+        struct Triangle {
+            // The edge function of the edge opposite to vertex i is
+            // edgeA[i] * x + edgeB[i] * y + edgeC[i] with x and y in fixed point. It is positive
+            // inside the triangle and biased so that pixels on edges that aren't top or left
+            // edges are outside.
+            std::array<int64_t, 3> edgeA;
+            std::array<int64_t, 3> edgeB;
+            std::array<int64_t, 3> edgeC;
+            std::array<int64_t, 3> edgeBias;
+            int64_t area;
+
+            std::array<float, 3> depth;
+            std::array<float, 3> invW;
+            // The indices of the vertices in mClippedVertices, and of the vertex providing the
+            // values of the flat outputs.
+            std::array<uint32_t, 3> vertices;
+            uint32_t provokingVertex;
+            bool frontFacing;
+
+            // The pixels covered by the bounding box of the triangle, clipped to the scissor.
+            int32_t minX;
+            int32_t minY;
+            int32_t maxX;
+            int32_t maxY;
+        };
+
+        void Draw(const DrawState& state, uint32_t instanceCount, uint32_t firstInstance);
+        void RunVertexShader(const DrawState& state,
+                             uint32_t vertex,
+                             uint32_t instanceIndex,
+                             uint32_t threadIndex);
+        void AssembleTriangles(const DrawState& state);
+        void ClipTriangle(const DrawState& state,
+                          uint32_t v0,
+                          uint32_t v1,
+                          uint32_t v2,
+                          uint32_t provokingVertex);
+        void SetupTriangle(const DrawState& state,
+                           uint32_t v0,
+                           uint32_t v1,
+                           uint32_t v2,
+                           uint32_t provokingVertex);
+        void BinTriangles();
+        void RasterizeTile(const DrawState& state, uint32_t tile, uint32_t threadIndex);
+        bool TileOverlapsTriangle(const Triangle& triangle, uint32_t tile) const;
+        void ShadePixel(const DrawState& state,
+                        const Triangle& triangle,
+                        int32_t x,
+                        int32_t y,
+                        const std::array<float, 3>& barycentrics,
+                        uint32_t threadIndex);
+        bool DepthStencilTest(const DrawState& state,
+                              const Triangle& triangle,
+                              int32_t x,
+                              int32_t y,
+                              float depth);
+        void WriteColors(const DrawState& state,
+                         int32_t x,
+                         int32_t y,
+                         const ShaderInterface& interface);
+
+        ThreadPool* mThreadPool;
+        uint32_t mWidth;
+        uint32_t mHeight;
+        std::bitset<kMaxColorAttachments> mColorAttachmentsSet;
+        std::array<Attachment, kMaxColorAttachments> mColorAttachments;
+        bool mHasDepthStencilAttachment = false;
+        Attachment mDepthStencilAttachment;
+
+        uint32_t mTilesPerRow;
+        uint32_t mTilesPerColumn;
+
+        // The per-draw data, kept to reuse their allocations.
+        std::vector<uint32_t> mIndices;
+        std::vector<bool> mRestarts;
+        std::vector<Vertex> mVertices;
+        std::vector<Vertex> mClippedVertices;
+        std::vector<Triangle> mTriangles;
+        std::vector<std::vector<uint32_t>> mTileTriangles;
+        std::vector<uint32_t> mActiveTiles;
+    };
+
+}}  // namespace dawn_native::null
+
+#endif  // DAWNNATIVE_NULL_RASTERIZER_H_
@@ -0,0 +1,2454 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dawn_native/null/SpirvInterpreter.h"
+
+#include "common/Assert.h"
+
+#include <spirv-cross/GLSL.std.450.h>
+#include <spirv-cross/spirv.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace dawn_native { namespace null {
+
+    namespace {
+
+        bool Fail(std::string* error, std::string message) {
+            *error = std::move(message);
+            return false;
+        }
+
+        std::string ReadString(const uint32_t* words, uint32_t wordCount) {
+            std::string result;
+            for (uint32_t i = 0; i < wordCount; ++i) {
+                for (uint32_t byte = 0; byte < 4; ++byte) {
+                    char c = static_cast<char>((words[i] >> (8 * byte)) & 0xFF);
+                    if (c == '\0') {
+                        return result;
+                    }
+                    result.push_back(c);
+                }
+            }
+            return result;
+        }
+
+        // The number of words of the literal string starting at words, including its terminator.
+        uint32_t StringWordCount(const uint32_t* words, uint32_t wordCount) {
+            for (uint32_t i = 0; i < wordCount; ++i) {
+                if ((words[i] & 0xFF000000) == 0) {
+                    return i + 1;
+                }
+            }
+            return wordCount;
+        }
+
+        float AsFloat(uint32_t word) {
+            float value;
+            memcpy(&value, &word, sizeof(value));
+            return value;
+        }
+
+        uint32_t FromFloat(float value) {
+            uint32_t word;
+            memcpy(&word, &value, sizeof(word));
+            return word;
+        }
+
+        int32_t AsInt(uint32_t word) {
+            int32_t value;
+            memcpy(&value, &word, sizeof(value));
+            return value;
+        }
+
+        uint32_t FromInt(int32_t value) {
+            uint32_t word;
+            memcpy(&word, &value, sizeof(word));
+            return word;
+        }
+
+        template <typename F>
+        void ComponentWise(uint32_t* result, const uint32_t* a, uint32_t count, F f) {
+            for (uint32_t i = 0; i < count; ++i) {
+                result[i] = f(a[i]);
+            }
+        }
+
+        template <typename F>
+        void ComponentWise(uint32_t* result,
+                           const uint32_t* a,
+                           const uint32_t* b,
+                           uint32_t count,
+                           F f) {
+            for (uint32_t i = 0; i < count; ++i) {
+                result[i] = f(a[i], b[i]);
+            }
+        }
+
+        template <typename F>
+        void ComponentWise(uint32_t* result,
+                           const uint32_t* a,
+                           const uint32_t* b,
+                           const uint32_t* c,
+                           uint32_t count,
+                           F f) {
+            for (uint32_t i = 0; i < count; ++i) {
+                result[i] = f(a[i], b[i], c[i]);
+            }
+        }
+
+        // Helpers to write the floating-point operations on the float values of the words.
+        template <typename F>
+        void FloatWise(uint32_t* result, const uint32_t* a, uint32_t count, F f) {
+            ComponentWise(result, a, count, [&](uint32_t x) { return FromFloat(f(AsFloat(x))); });
+        }
+
+        template <typename F>
+        void FloatWise(uint32_t* result,
+                       const uint32_t* a,
+                       const uint32_t* b,
+                       uint32_t count,
+                       F f) {
+            ComponentWise(result, a, b, count, [&](uint32_t x, uint32_t y) {
+                return FromFloat(f(AsFloat(x), AsFloat(y)));
+            });
+        }
+
+        template <typename F>
+        void FloatWise(uint32_t* result,
+                       const uint32_t* a,
+                       const uint32_t* b,
+                       const uint32_t* c,
+                       uint32_t count,
+                       F f) {
+            ComponentWise(result, a, b, c, count, [&](uint32_t x, uint32_t y, uint32_t z) {
+                return FromFloat(f(AsFloat(x), AsFloat(y), AsFloat(z)));
+            });
+        }
+
+        float Dot(const uint32_t* a, const uint32_t* b, uint32_t count) {
+            float result = 0.0f;
+            for (uint32_t i = 0; i < count; ++i) {
+                result += AsFloat(a[i]) * AsFloat(b[i]);
+            }
+            return result;
+        }
+
+        // Conversions of out of range floats are undefined in C++ so they saturate instead.
+        uint32_t FloatToUint(float value) {
+            if (!(value > -1.0f)) {
+                return 0;
+            }
+            if (value >= 4294967296.0f) {
+                return std::numeric_limits<uint32_t>::max();
+            }
+            return static_cast<uint32_t>(value);
+        }
+
+        int32_t FloatToInt(float value) {
+            if (std::isnan(value)) {
+                return 0;
+            }
+            if (value >= 2147483648.0f) {
+                return std::numeric_limits<int32_t>::max();
+            }
+            if (value < -2147483648.0f) {
+                return std::numeric_limits<int32_t>::min();
+            }
+            return static_cast<int32_t>(value);
+        }
+
+        // Division by zero and overflowing divisions are undefined in SPIR-V but trap on the CPU.
+        uint32_t SignedDivide(uint32_t a, uint32_t b) {
+            if (b == 0 || (AsInt(a) == std::numeric_limits<int32_t>::min() && AsInt(b) == -1)) {
+                return b == 0 ? 0 : a;
+            }
+            return FromInt(AsInt(a) / AsInt(b));
+        }
+
+        uint32_t SignedRemainder(uint32_t a, uint32_t b) {
+            if (b == 0 || AsInt(b) == -1) {
+                return 0;
+            }
+            return FromInt(AsInt(a) % AsInt(b));
+        }
+
+        uint32_t BitFieldMask(uint32_t count) {
+            return static_cast<uint32_t>((uint64_t(1) << std::min(count, 32u)) - 1);
+        }
+
+        uint32_t BitReverse(uint32_t value) {
+            uint32_t result = 0;
+            for (uint32_t i = 0; i < 32; ++i) {
+                result = (result << 1) | ((value >> i) & 1);
+            }
+            return result;
+        }
+
+        uint32_t BitCount(uint32_t value) {
+            uint32_t count = 0;
+            for (; value != 0; value &= value - 1) {
+                count++;
+            }
+            return count;
+        }
+
+        // Atomics on the same address are serialized by one of a few mutexes chosen by address.
+        std::mutex* GetAtomicMutex(const void* address) {
+            static constexpr size_t kMutexCount = 64;
+            static std::mutex* mutexes = new std::mutex[kMutexCount];
+            return &mutexes[(reinterpret_cast<uintptr_t>(address) >> 2) % kMutexCount];
+        }
+
+        bool HasNoResult(uint32_t opcode) {
+            switch (opcode) {
+                case spv::OpStore:
+                case spv::OpCopyMemory:
+                case spv::OpControlBarrier:
+                case spv::OpAtomicStore:
+                case spv::OpBranch:
+                case spv::OpBranchConditional:
+                case spv::OpSwitch:
+                case spv::OpKill:
+                case spv::OpReturn:
+                case spv::OpReturnValue:
+                case spv::OpUnreachable:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        // The instructions that can appear in functions and that Run implements.
+        bool IsSupportedInstruction(uint32_t opcode) {
+            switch (opcode) {
+                case spv::OpExtInst:
+                case spv::OpFunctionCall:
+                case spv::OpVariable:
+                case spv::OpLoad:
+                case spv::OpStore:
+                case spv::OpCopyMemory:
+                case spv::OpAccessChain:
+                case spv::OpInBoundsAccessChain:
+                case spv::OpArrayLength:
+                case spv::OpVectorExtractDynamic:
+                case spv::OpVectorInsertDynamic:
+                case spv::OpVectorShuffle:
+                case spv::OpCompositeConstruct:
+                case spv::OpCompositeExtract:
+                case spv::OpCompositeInsert:
+                case spv::OpCopyObject:
+                case spv::OpTranspose:
+                case spv::OpConvertFToU:
+                case spv::OpConvertFToS:
+                case spv::OpConvertSToF:
+                case spv::OpConvertUToF:
+                case spv::OpUConvert:
+                case spv::OpSConvert:
+                case spv::OpFConvert:
+                case spv::OpBitcast:
+                case spv::OpSNegate:
+                case spv::OpFNegate:
+                case spv::OpIAdd:
+                case spv::OpFAdd:
+                case spv::OpISub:
+                case spv::OpFSub:
+                case spv::OpIMul:
+                case spv::OpFMul:
+                case spv::OpUDiv:
+                case spv::OpSDiv:
+                case spv::OpFDiv:
+                case spv::OpUMod:
+                case spv::OpSRem:
+                case spv::OpSMod:
+                case spv::OpFRem:
+                case spv::OpFMod:
+                case spv::OpVectorTimesScalar:
+                case spv::OpMatrixTimesScalar:
+                case spv::OpVectorTimesMatrix:
+                case spv::OpMatrixTimesVector:
+                case spv::OpMatrixTimesMatrix:
+                case spv::OpOuterProduct:
+                case spv::OpDot:
+                case spv::OpAny:
+                case spv::OpAll:
+                case spv::OpIsNan:
+                case spv::OpIsInf:
+                case spv::OpLogicalEqual:
+                case spv::OpLogicalNotEqual:
+                case spv::OpLogicalOr:
+                case spv::OpLogicalAnd:
+                case spv::OpLogicalNot:
+                case spv::OpSelect:
+                case spv::OpIEqual:
+                case spv::OpINotEqual:
+                case spv::OpUGreaterThan:
+                case spv::OpSGreaterThan:
+                case spv::OpUGreaterThanEqual:
+                case spv::OpSGreaterThanEqual:
+                case spv::OpULessThan:
+                case spv::OpSLessThan:
+                case spv::OpULessThanEqual:
+                case spv::OpSLessThanEqual:
+                case spv::OpFOrdEqual:
+                case spv::OpFUnordEqual:
+                case spv::OpFOrdNotEqual:
+                case spv::OpFUnordNotEqual:
+                case spv::OpFOrdLessThan:
+                case spv::OpFUnordLessThan:
+                case spv::OpFOrdGreaterThan:
+                case spv::OpFUnordGreaterThan:
+                case spv::OpFOrdLessThanEqual:
+                case spv::OpFUnordLessThanEqual:
+                case spv::OpFOrdGreaterThanEqual:
+                case spv::OpFUnordGreaterThanEqual:
+                case spv::OpShiftRightLogical:
+                case spv::OpShiftRightArithmetic:
+                case spv::OpShiftLeftLogical:
+                case spv::OpBitwiseOr:
+                case spv::OpBitwiseXor:
+                case spv::OpBitwiseAnd:
+                case spv::OpNot:
+                case spv::OpBitFieldInsert:
+                case spv::OpBitFieldSExtract:
+                case spv::OpBitFieldUExtract:
+                case spv::OpBitReverse:
+                case spv::OpBitCount:
+                case spv::OpControlBarrier:
+                case spv::OpAtomicLoad:
+                case spv::OpAtomicStore:
+                case spv::OpAtomicExchange:
+                case spv::OpAtomicCompareExchange:
+                case spv::OpAtomicIIncrement:
+                case spv::OpAtomicIDecrement:
+                case spv::OpAtomicIAdd:
+                case spv::OpAtomicISub:
+                case spv::OpAtomicSMin:
+                case spv::OpAtomicUMin:
+                case spv::OpAtomicSMax:
+                case spv::OpAtomicUMax:
+                case spv::OpAtomicAnd:
+                case spv::OpAtomicOr:
+                case spv::OpAtomicXor:
+                case spv::OpPhi:
+                case spv::OpLabel:
+                case spv::OpBranch:
+                case spv::OpBranchConditional:
+                case spv::OpSwitch:
+                case spv::OpKill:
+                case spv::OpReturn:
+                case spv::OpReturnValue:
+                case spv::OpUnreachable:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        bool IsSupportedGlslInstruction(uint32_t instruction) {
+            switch (instruction) {
+                case GLSLstd450Round:
+                case GLSLstd450RoundEven:
+                case GLSLstd450Trunc:
+                case GLSLstd450FAbs:
+                case GLSLstd450SAbs:
+                case GLSLstd450FSign:
+                case GLSLstd450SSign:
+                case GLSLstd450Floor:
+                case GLSLstd450Ceil:
+                case GLSLstd450Fract:
+                case GLSLstd450Radians:
+                case GLSLstd450Degrees:
+                case GLSLstd450Sin:
+                case GLSLstd450Cos:
+                case GLSLstd450Tan:
+                case GLSLstd450Asin:
+                case GLSLstd450Acos:
+                case GLSLstd450Atan:
+                case GLSLstd450Sinh:
+                case GLSLstd450Cosh:
+                case GLSLstd450Tanh:
+                case GLSLstd450Atan2:
+                case GLSLstd450Pow:
+                case GLSLstd450Exp:
+                case GLSLstd450Log:
+                case GLSLstd450Exp2:
+                case GLSLstd450Log2:
+                case GLSLstd450Sqrt:
+                case GLSLstd450InverseSqrt:
+                case GLSLstd450FMin:
+                case GLSLstd450UMin:
+                case GLSLstd450SMin:
+                case GLSLstd450FMax:
+                case GLSLstd450UMax:
+                case GLSLstd450SMax:
+                case GLSLstd450FClamp:
+                case GLSLstd450UClamp:
+                case GLSLstd450SClamp:
+                case GLSLstd450FMix:
+                case GLSLstd450Step:
+                case GLSLstd450SmoothStep:
+                case GLSLstd450Fma:
+                case GLSLstd450Length:
+                case GLSLstd450Distance:
+                case GLSLstd450Cross:
+                case GLSLstd450Normalize:
+                case GLSLstd450FaceForward:
+                case GLSLstd450Reflect:
+                case GLSLstd450NMin:
+                case GLSLstd450NMax:
+                case GLSLstd450NClamp:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        bool IsSupportedBuiltIn(uint32_t executionModel, uint32_t storageClass, uint32_t builtIn) {
+            bool isInput = storageClass == spv::StorageClassInput;
+            switch (executionModel) {
+                case spv::ExecutionModelGLCompute:
+                    switch (builtIn) {
+                        case spv::BuiltInNumWorkgroups:
+                        case spv::BuiltInWorkgroupSize:
+                        case spv::BuiltInWorkgroupId:
+                        case spv::BuiltInLocalInvocationId:
+                        case spv::BuiltInGlobalInvocationId:
+                        case spv::BuiltInLocalInvocationIndex:
+                            return isInput;
+                        default:
+                            return false;
+                    }
+
+                case spv::ExecutionModelVertex:
+                    switch (builtIn) {
+                        case spv::BuiltInVertexIndex:
+                        case spv::BuiltInInstanceIndex:
+                            return isInput;
+                        // Only the position is used by the rasterizer, the other outputs of
+                        // gl_PerVertex are written but ignored.
+                        case spv::BuiltInPosition:
+                        case spv::BuiltInPointSize:
+                        case spv::BuiltInClipDistance:
+                        case spv::BuiltInCullDistance:
+                            return !isInput;
+                        default:
+                            return false;
+                    }
+
+                case spv::ExecutionModelFragment:
+                    switch (builtIn) {
+                        case spv::BuiltInFragCoord:
+                        case spv::BuiltInFrontFacing:
+                            return isInput;
+                        case spv::BuiltInFragDepth:
+                            return !isInput;
+                        default:
+                            return false;
+                    }
+
+                default:
+                    return false;
+            }
+        }
+
+        uint32_t GetExecutionModel(dawn::ShaderStage stage) {
+            switch (stage) {
+                case dawn::ShaderStage::Vertex:
+                    return spv::ExecutionModelVertex;
+                case dawn::ShaderStage::Fragment:
+                    return spv::ExecutionModelFragment;
+                case dawn::ShaderStage::Compute:
+                    return spv::ExecutionModelGLCompute;
+                default:
+                    UNREACHABLE();
+            }
+        }
+
+        constexpr uint32_t kNoDecoration = std::numeric_limits<uint32_t>::max();
+
+    }  // anonymous namespace
+
+    // The decorations needed to interpret the module, gathered before the types are declared.
+    struct SpirvProgram::Decorations {
+        std::unordered_map<uint32_t, uint32_t> arrayStrides;
+        std::unordered_map<uint32_t, uint32_t> builtIns;
+        std::unordered_map<uint32_t, uint32_t> groups;
+        std::unordered_map<uint32_t, uint32_t> bindings;
+        std::unordered_map<uint32_t, uint32_t> locations;
+        std::unordered_map<uint32_t, uint32_t> flats;
+        std::map<std::pair<uint32_t, uint32_t>, uint32_t> memberBuiltIns;
+        std::map<std::pair<uint32_t, uint32_t>, uint32_t> memberOffsets;
+        std::map<std::pair<uint32_t, uint32_t>, uint32_t> matrixStrides;
+
+        static uint32_t Find(const std::unordered_map<uint32_t, uint32_t>& map, uint32_t id) {
+            auto it = map.find(id);
+            return it == map.end() ? kNoDecoration : it->second;
+        }
+        static uint32_t Find(const std::map<std::pair<uint32_t, uint32_t>, uint32_t>& map,
+                             uint32_t id,
+                             uint32_t member) {
+            auto it = map.find({id, member});
+            return it == map.end() ? kNoDecoration : it->second;
+        }
+    };
+
+    // SpirvProgram
+
+    std::unique_ptr<SpirvProgram> SpirvProgram::Create(const std::vector<uint32_t>& code,
+                                                       dawn::ShaderStage stage,
+                                                       const std::string& entryPoint,
+                                                       std::string* error) {
+        std::unique_ptr<SpirvProgram> program(new SpirvProgram);
+        if (!program->Parse(code, GetExecutionModel(stage), entryPoint, error)) {
+            return nullptr;
+        }
+        return program;
+    }
+
+    SpirvProgram::SpirvProgram() {
+    }
+
+    SpirvProgram::~SpirvProgram() {
+    }
+
+    const std::array<uint32_t, 3>& SpirvProgram::GetLocalSize() const {
+        return mLocalSize;
+    }
+
+    const std::bitset<kMaxShaderLocations>& SpirvProgram::GetInputLocations() const {
+        return mInputLocations;
+    }
+
+    const std::bitset<kMaxShaderLocations>& SpirvProgram::GetOutputLocations() const {
+        return mOutputLocations;
+    }
+
+    const std::bitset<kMaxShaderLocations>& SpirvProgram::GetFlatInputLocations() const {
+        return mFlatInputLocations;
+    }
+
+    bool SpirvProgram::WritesFragDepth() const {
+        return mWritesFragDepth;
+    }
+
+    bool SpirvProgram::CanDiscard() const {
+        return mHasKill;
+    }
+
+    bool SpirvProgram::Parse(const std::vector<uint32_t>& code,
+                             uint32_t executionModel,
+                             const std::string& entryPoint,
+                             std::string* error) {
+        if (code.size() < 5 || code[0] != spv::MagicNumber) {
+            return Fail(error, "Invalid SPIR-V header");
+        }
+        mExecutionModel = executionModel;
+
+        uint32_t bound = code[3];
+        mTypes.resize(bound);
+        mIdTypes.resize(bound, 0);
+        mRegisterOffsets.resize(bound, 0);
+        mVariableOffsets.resize(bound, 0);
+        mLabels.resize(bound, 0);
+        mFunctions.resize(bound);
+
+        Decorations decorations;
+        std::unordered_map<uint32_t, std::array<uint32_t, 3>> localSizes;
+        uint32_t workgroupSizeConstant = 0;
+        Function* function = nullptr;
+
+        auto CheckId = [bound](uint32_t id) { return id != 0 && id < bound; };
+
+        for (size_t i = 5; i < code.size();) {
+            uint32_t wordCount = code[i] >> 16;
+            uint32_t opcode = code[i] & 0xFFFF;
+            if (wordCount == 0 || i + wordCount > code.size()) {
+                return Fail(error, "Invalid SPIR-V instruction size");
+            }
+            const uint32_t* words = &code[i + 1];
+            uint32_t count = wordCount - 1;
+            i += wordCount;
+
+            // The instructions declaring types and values all have their result in the first
+            // two words so check them once. Other instructions can't reference ids out of the
+            // bound either since they are validated by SPIRV-Tools on module creation.
+            switch (opcode) {
+                case spv::OpTypeVoid:
+                case spv::OpTypeBool:
+                case spv::OpTypeInt:
+                case spv::OpTypeFloat:
+                case spv::OpTypeVector:
+                case spv::OpTypeMatrix:
+                case spv::OpTypeArray:
+                case spv::OpTypeRuntimeArray:
+                case spv::OpTypeStruct:
+                case spv::OpTypePointer:
+                case spv::OpTypeFunction:
+                case spv::OpLabel:
+                case spv::OpExtInstImport:
+                    if (count < 1 || !CheckId(words[0])) {
+                        return Fail(error, "Invalid SPIR-V result id");
+                    }
+                    break;
+                case spv::OpNop:
+                case spv::OpSource:
+                case spv::OpSourceContinued:
+                case spv::OpSourceExtension:
+                case spv::OpName:
+                case spv::OpMemberName:
+                case spv::OpString:
+                case spv::OpLine:
+                case spv::OpNoLine:
+                case spv::OpModuleProcessed:
+                case spv::OpCapability:
+                case spv::OpExtension:
+                case spv::OpMemoryModel:
+                case spv::OpEntryPoint:
+                case spv::OpExecutionMode:
+                case spv::OpDecorate:
+                case spv::OpMemberDecorate:
+                case spv::OpSelectionMerge:
+                case spv::OpLoopMerge:
+                case spv::OpMemoryBarrier:
+                case spv::OpFunctionEnd:
+                    break;
+                default:
+                    if (!HasNoResult(opcode) &&
+                        (count < 2 || !CheckId(words[0]) || !CheckId(words[1]))) {
+                        return Fail(error, "Invalid SPIR-V result id");
+                    }
+                    break;
+            }
+
+            switch (opcode) {
+                // Debug instructions and the structured control flow hints aren't needed to run
+                // the program. Memory barriers are no-ops since the invocations of a workgroup
+                // run on the same thread.
+                case spv::OpNop:
+                case spv::OpSource:
+                case spv::OpSourceContinued:
+                case spv::OpSourceExtension:
+                case spv::OpName:
+                case spv::OpMemberName:
+                case spv::OpString:
+                case spv::OpLine:
+                case spv::OpNoLine:
+                case spv::OpModuleProcessed:
+                case spv::OpCapability:
+                case spv::OpExtension:
+                case spv::OpMemoryModel:
+                case spv::OpSelectionMerge:
+                case spv::OpLoopMerge:
+                case spv::OpMemoryBarrier:
+                    break;
+
+                case spv::OpExtInstImport: {
+                    if (ReadString(words + 1, count - 1) != "GLSL.std.450") {
+                        return Fail(error, "Unsupported extended instruction set");
+                    }
+                    mGlslInstructionSet = words[0];
+                } break;
+
+                case spv::OpEntryPoint: {
+                    if (count < 3) {
+                        return Fail(error, "Invalid OpEntryPoint");
+                    }
+                    if (words[0] == mExecutionModel &&
+                        ReadString(words + 2, count - 2) == entryPoint) {
+                        mEntryFunction = words[1];
+                    }
+                } break;
+
+                case spv::OpExecutionMode: {
+                    if (count >= 5 && words[1] == spv::ExecutionModeLocalSize) {
+                        localSizes[words[0]] = {{words[2], words[3], words[4]}};
+                    }
+                } break;
+
+                case spv::OpDecorate: {
+                    if (count < 2) {
+                        return Fail(error, "Invalid OpDecorate");
+                    }
+                    uint32_t value = count >= 3 ? words[2] : 0;
+                    switch (words[1]) {
+                        case spv::DecorationArrayStride:
+                            decorations.arrayStrides[words[0]] = value;
+                            break;
+                        case spv::DecorationBuiltIn:
+                            decorations.builtIns[words[0]] = value;
+                            break;
+                        case spv::DecorationDescriptorSet:
+                            decorations.groups[words[0]] = value;
+                            break;
+                        case spv::DecorationBinding:
+                            decorations.bindings[words[0]] = value;
+                            break;
+                        case spv::DecorationLocation:
+                            decorations.locations[words[0]] = value;
+                            break;
+                        case spv::DecorationFlat:
+                            decorations.flats[words[0]] = 1;
+                            break;
+                        default:
+                            break;
+                    }
+                } break;
+
+                case spv::OpMemberDecorate: {
+                    if (count < 3) {
+                        return Fail(error, "Invalid OpMemberDecorate");
+                    }
+                    uint32_t value = count >= 4 ? words[3] : 0;
+                    switch (words[2]) {
+                        case spv::DecorationBuiltIn:
+                            decorations.memberBuiltIns[{words[0], words[1]}] = value;
+                            break;
+                        case spv::DecorationOffset:
+                            decorations.memberOffsets[{words[0], words[1]}] = value;
+                            break;
+                        case spv::DecorationMatrixStride:
+                            decorations.matrixStrides[{words[0], words[1]}] = value;
+                            break;
+                        case spv::DecorationRowMajor:
+                            return Fail(error, "Row major matrices aren't supported");
+                        default:
+                            break;
+                    }
+                } break;
+
+                case spv::OpTypeVoid:
+                case spv::OpTypeBool:
+                case spv::OpTypeInt:
+                case spv::OpTypeFloat:
+                case spv::OpTypeVector:
+                case spv::OpTypeMatrix:
+                case spv::OpTypeArray:
+                case spv::OpTypeRuntimeArray:
+                case spv::OpTypeStruct:
+                case spv::OpTypePointer:
+                case spv::OpTypeFunction: {
+                    if (!AddType(opcode, words[0], words + 1, count - 1, decorations, error)) {
+                        return false;
+                    }
+                } break;
+
+                case spv::OpConstantTrue:
+                case spv::OpConstantFalse:
+                case spv::OpSpecConstantTrue:
+                case spv::OpSpecConstantFalse:
+                case spv::OpConstant:
+                case spv::OpSpecConstant:
+                case spv::OpConstantComposite:
+                case spv::OpSpecConstantComposite:
+                case spv::OpConstantNull:
+                case spv::OpUndef: {
+                    // Specialization constants aren't exposed in the API so they keep their
+                    // default values.
+                    uint32_t type = words[0];
+                    uint32_t id = words[1];
+                    if (mTypes[type].kind == TypeKind::Pointer) {
+                        return Fail(error, "Pointer constants aren't supported");
+                    }
+                    AllocateRegisters(id, type);
+                    uint32_t* registers = &mConstantRegisters[mRegisterOffsets[id]];
+
+                    switch (opcode) {
+                        case spv::OpConstantTrue:
+                        case spv::OpSpecConstantTrue:
+                            registers[0] = 1;
+                            break;
+                        case spv::OpConstant:
+                        case spv::OpSpecConstant:
+                            if (count != 3) {
+                                return Fail(error, "Only 32-bit constants are supported");
+                            }
+                            registers[0] = words[2];
+                            break;
+                        case spv::OpConstantComposite:
+                        case spv::OpSpecConstantComposite: {
+                            uint32_t offset = 0;
+                            for (uint32_t c = 2; c < count; ++c) {
+                                uint32_t constituentCount = mTypes[mIdTypes[words[c]]].wordCount;
+                                if (offset + constituentCount > mTypes[type].wordCount) {
+                                    return Fail(error, "Invalid composite constant");
+                                }
+                                std::copy_n(&mConstantRegisters[mRegisterOffsets[words[c]]],
+                                            constituentCount, &registers[offset]);
+                                offset += constituentCount;
+                            }
+                        } break;
+                        default:
+                            break;
+                    }
+
+                    if (Decorations::Find(decorations.builtIns, id) ==
+                        spv::BuiltInWorkgroupSize) {
+                        workgroupSizeConstant = id;
+                    }
+                } break;
+
+                case spv::OpVariable: {
+                    uint32_t pointerType = words[0];
+                    uint32_t id = words[1];
+                    if (count < 3 || mTypes[pointerType].kind != TypeKind::Pointer) {
+                        return Fail(error, "Invalid OpVariable");
+                    }
+                    mIdTypes[id] = pointerType;
+
+                    Variable variable;
+                    variable.id = id;
+                    variable.storageClass = words[2];
+                    variable.type = mTypes[pointerType].elementType;
+                    variable.offset = 0;
+                    variable.initializer = count >= 4 ? words[3] : 0;
+                    variable.builtIn = Decorations::Find(decorations.builtIns, id);
+                    variable.builtInOffset = 0;
+                    variable.location = Decorations::Find(decorations.locations, id);
+                    variable.group = Decorations::Find(decorations.groups, id);
+                    variable.binding = Decorations::Find(decorations.bindings, id);
+
+                    switch (variable.storageClass) {
+                        case spv::StorageClassUniform:
+                        case spv::StorageClassStorageBuffer:
+                            if (variable.group >= kMaxBindGroups ||
+                                variable.binding >= kMaxBindingsPerGroup) {
+                                return Fail(error, "Invalid buffer binding");
+                            }
+                            break;
+                        case spv::StorageClassInput:
+                        case spv::StorageClassOutput:
+                            if (!AddInterfaceVariable(&variable, decorations, error)) {
+                                return false;
+                            }
+                            // Fallthrough
+                        case spv::StorageClassPrivate:
+                        case spv::StorageClassFunction:
+                            variable.offset = mInvocationMemorySize;
+                            mInvocationMemorySize += mTypes[variable.type].size;
+                            break;
+                        case spv::StorageClassWorkgroup:
+                            variable.offset = mWorkgroupMemorySize;
+                            mWorkgroupMemorySize += mTypes[variable.type].size;
+                            break;
+                        case spv::StorageClassPushConstant:
+                            break;
+                        default:
+                            return Fail(error, "Unsupported storage class");
+                    }
+                    mVariableOffsets[id] = variable.offset;
+
+                    if (function == nullptr) {
+                        mGlobalVariables.push_back(variable);
+                    } else {
+                        if (variable.storageClass != spv::StorageClassFunction) {
+                            return Fail(error, "Invalid OpVariable in a function");
+                        }
+                        mInstructions.push_back({opcode, pointerType, id,
+                                                 static_cast<uint32_t>(mOperands.size()),
+                                                 count - 2});
+                        mOperands.insert(mOperands.end(), words + 2, words + count);
+                    }
+                } break;
+
+                case spv::OpFunction: {
+                    function = &mFunctions[words[1]];
+                    function->firstInstruction = static_cast<uint32_t>(mInstructions.size());
+                } break;
+
+                case spv::OpFunctionParameter: {
+                    if (function == nullptr) {
+                        return Fail(error, "Invalid OpFunctionParameter");
+                    }
+                    mIdTypes[words[1]] = words[0];
+                    AllocateRegisters(words[1], words[0]);
+                    function->parameters.push_back(words[1]);
+                } break;
+
+                case spv::OpFunctionEnd: {
+                    function = nullptr;
+                } break;
+
+                case spv::OpLabel: {
+                    if (function == nullptr) {
+                        return Fail(error, "Invalid OpLabel");
+                    }
+                    mLabels[words[0]] = static_cast<uint32_t>(mInstructions.size());
+                    mInstructions.push_back({opcode, 0, words[0], 0, 0});
+                } break;
+
+                default: {
+                    if (function == nullptr || !IsSupportedInstruction(opcode)) {
+                        return Fail(error, "Unsupported SPIR-V instruction " +
+                                               std::to_string(opcode));
+                    }
+
+                    Instruction instruction = {opcode, 0, 0, 0, 0};
+                    const uint32_t* operands = words;
+                    if (!HasNoResult(opcode)) {
+                        instruction.resultType = words[0];
+                        instruction.result = words[1];
+                        operands += 2;
+
+                        const Type& resultType = mTypes[instruction.resultType];
+                        bool producesPointer = opcode == spv::OpAccessChain ||
+                                               opcode == spv::OpInBoundsAccessChain ||
+                                               opcode == spv::OpCopyObject;
+                        if ((resultType.kind == TypeKind::Pointer) != producesPointer &&
+                            opcode != spv::OpCopyObject) {
+                            return Fail(error, "Variable pointers aren't supported");
+                        }
+                        mIdTypes[instruction.result] = instruction.resultType;
+                        AllocateRegisters(instruction.result, instruction.resultType);
+                    }
+                    instruction.firstOperand = static_cast<uint32_t>(mOperands.size());
+                    instruction.operandCount = static_cast<uint32_t>(words + count - operands);
+                    mOperands.insert(mOperands.end(), operands, words + count);
+
+                    if (opcode == spv::OpExtInst &&
+                        (instruction.operandCount < 2 || operands[0] != mGlslInstructionSet ||
+                         !IsSupportedGlslInstruction(operands[1]))) {
+                        return Fail(error, "Unsupported extended instruction");
+                    }
+                    if (opcode == spv::OpControlBarrier) {
+                        mHasBarriers = true;
+                    }
+                    if (opcode == spv::OpKill) {
+                        mHasKill = true;
+                    }
+
+                    mInstructions.push_back(instruction);
+                } break;
+            }
+        }
+
+        if (mEntryFunction == 0) {
+            return Fail(error, "Entry point \"" + entryPoint + "\" not found");
+        }
+        if (mExecutionModel != spv::ExecutionModelGLCompute) {
+            return true;
+        }
+
+        auto localSize = localSizes.find(mEntryFunction);
+        if (localSize != localSizes.end()) {
+            mLocalSize = localSize->second;
+        }
+        if (workgroupSizeConstant != 0) {
+            std::copy_n(&mConstantRegisters[mRegisterOffsets[workgroupSizeConstant]], 3,
+                        mLocalSize.begin());
+        }
+        if (mLocalSize[0] == 0 || mLocalSize[1] == 0 || mLocalSize[2] == 0) {
+            return Fail(error, "Invalid workgroup size");
+        }
+
+        return true;
+    }
+
+    bool SpirvProgram::AddType(uint32_t opcode,
+                               uint32_t id,
+                               const uint32_t* operands,
+                               uint32_t operandCount,
+                               const Decorations& decorations,
+                               std::string* error) {
+        Type type;
+        auto GetStride = [&](uint32_t naturalStride) {
+            uint32_t stride = Decorations::Find(decorations.arrayStrides, id);
+            return stride == kNoDecoration ? naturalStride : stride;
+        };
+
+        switch (opcode) {
+            case spv::OpTypeVoid:
+                type.kind = TypeKind::Void;
+                break;
+
+            case spv::OpTypeBool:
+                type.kind = TypeKind::Bool;
+                type.size = 4;
+                type.wordCount = 1;
+                break;
+
+            case spv::OpTypeInt:
+            case spv::OpTypeFloat:
+                if (operandCount < 1 || operands[0] != 32) {
+                    return Fail(error, "Only 32-bit scalars are supported");
+                }
+                type.kind = opcode == spv::OpTypeInt ? TypeKind::Int : TypeKind::Float;
+                type.isSigned = opcode == spv::OpTypeInt && operandCount >= 2 && operands[1] != 0;
+                type.size = 4;
+                type.wordCount = 1;
+                break;
+
+            case spv::OpTypeVector:
+            case spv::OpTypeMatrix: {
+                if (operandCount < 2) {
+                    return Fail(error, "Invalid vector or matrix type");
+                }
+                const Type& element = mTypes[operands[0]];
+                type.kind = opcode == spv::OpTypeVector ? TypeKind::Vector : TypeKind::Matrix;
+                type.elementType = operands[0];
+                type.count = operands[1];
+                type.stride = element.size;
+                type.size = element.size * type.count;
+                type.wordCount = element.wordCount * type.count;
+            } break;
+
+            case spv::OpTypeArray:
+            case spv::OpTypeRuntimeArray: {
+                if (operandCount < 1) {
+                    return Fail(error, "Invalid array type");
+                }
+                const Type& element = mTypes[operands[0]];
+                type.kind =
+                    opcode == spv::OpTypeArray ? TypeKind::Array : TypeKind::RuntimeArray;
+                type.elementType = operands[0];
+                type.stride = GetStride(element.size);
+                if (opcode == spv::OpTypeArray) {
+                    if (operandCount < 2 || mTypes[mIdTypes[operands[1]]].wordCount != 1) {
+                        return Fail(error, "Invalid array length");
+                    }
+                    type.count = mConstantRegisters[mRegisterOffsets[operands[1]]];
+                    type.size = type.stride * type.count;
+                    type.wordCount = element.wordCount * type.count;
+                }
+            } break;
+
+            case spv::OpTypeStruct: {
+                type.kind = TypeKind::Struct;
+                uint32_t naturalOffset = 0;
+                for (uint32_t member = 0; member < operandCount; ++member) {
+                    uint32_t memberType = operands[member];
+                    uint32_t matrixStride =
+                        Decorations::Find(decorations.matrixStrides, id, member);
+                    if (matrixStride != kNoDecoration) {
+                        memberType = AddMatrixStride(memberType, matrixStride);
+                    }
+
+                    uint32_t offset = Decorations::Find(decorations.memberOffsets, id, member);
+                    if (offset == kNoDecoration) {
+                        offset = naturalOffset;
+                    }
+                    const Type& memberInfo = mTypes[memberType];
+                    naturalOffset = offset + memberInfo.size;
+
+                    type.memberTypes.push_back(memberType);
+                    type.memberOffsets.push_back(offset);
+                    type.size = std::max(type.size, naturalOffset);
+                    type.wordCount += memberInfo.wordCount;
+                }
+            } break;
+
+            case spv::OpTypePointer:
+                if (operandCount < 2) {
+                    return Fail(error, "Invalid pointer type");
+                }
+                type.kind = TypeKind::Pointer;
+                type.storageClass = operands[0];
+                type.elementType = operands[1];
+                break;
+
+            case spv::OpTypeFunction:
+                type.kind = TypeKind::Function;
+                break;
+
+            default:
+                UNREACHABLE();
+        }
+
+        mTypes[id] = std::move(type);
+        return true;
+    }
+
+    bool SpirvProgram::AddInterfaceVariable(Variable* variable,
+                                            const Decorations& decorations,
+                                            std::string* error) {
+        const Type& type = mTypes[variable->type];
+
+        // Builtins can be grouped in blocks like gl_PerVertex, with a builtin on each member.
+        if (type.kind == TypeKind::Struct) {
+            for (uint32_t member = 0; member < type.memberTypes.size(); ++member) {
+                uint32_t builtIn =
+                    Decorations::Find(decorations.memberBuiltIns, variable->type, member);
+                if (!IsSupportedBuiltIn(mExecutionModel, variable->storageClass, builtIn)) {
+                    return Fail(error, "Unsupported input or output block");
+                }
+                if (builtIn == spv::BuiltInPosition) {
+                    variable->builtIn = builtIn;
+                    variable->builtInOffset = type.memberOffsets[member];
+                }
+            }
+            return true;
+        }
+
+        if (variable->builtIn != kNoDecoration) {
+            if (!IsSupportedBuiltIn(mExecutionModel, variable->storageClass, variable->builtIn)) {
+                return Fail(error, "Unsupported builtin variable");
+            }
+            if (variable->builtIn == spv::BuiltInFragDepth) {
+                mWritesFragDepth = true;
+            }
+            return true;
+        }
+
+        // The other inputs and outputs are the scalars and vectors at the locations of the
+        // interface between the stages.
+        bool isScalarOrVector = type.kind == TypeKind::Int || type.kind == TypeKind::Float ||
+                                (type.kind == TypeKind::Vector && type.count <= 4);
+        if (mExecutionModel == spv::ExecutionModelGLCompute || !isScalarOrVector ||
+            variable->location >= kMaxShaderLocations) {
+            return Fail(error, "Unsupported input or output variable");
+        }
+
+        if (variable->storageClass == spv::StorageClassInput) {
+            mInputLocations.set(variable->location);
+            if (Decorations::Find(decorations.flats, variable->id) != kNoDecoration) {
+                mFlatInputLocations.set(variable->location);
+            }
+        } else {
+            mOutputLocations.set(variable->location);
+        }
+        return true;
+    }
+
+    uint32_t SpirvProgram::AddMatrixStride(uint32_t type, uint32_t matrixStride) {
+        // The stride of a matrix is a decoration of the struct member so a copy of the type is
+        // made, with the stride, for the layout of the member.
+        Type layoutType = mTypes[type];
+        switch (layoutType.kind) {
+            case TypeKind::Matrix:
+                layoutType.stride = matrixStride;
+                layoutType.size = matrixStride * layoutType.count;
+                break;
+
+            case TypeKind::Array:
+            case TypeKind::RuntimeArray:
+                layoutType.elementType = AddMatrixStride(layoutType.elementType, matrixStride);
+                break;
+
+            default:
+                return type;
+        }
+
+        mTypes.push_back(std::move(layoutType));
+        return static_cast<uint32_t>(mTypes.size() - 1);
+    }
+
+    void SpirvProgram::AllocateRegisters(uint32_t id, uint32_t type) {
+        // All the registers of the program are allocated upfront, SPIR-V forbids recursion so
+        // each id has a single live value per invocation. The constants are stored in the initial
+        // value of the registers.
+        mRegisterOffsets[id] = static_cast<uint32_t>(mConstantRegisters.size());
+        mIdTypes[id] = type;
+        mConstantRegisters.resize(mConstantRegisters.size() + mTypes[type].wordCount, 0);
+    }
+
+    std::unique_ptr<SpirvWorkgroupState> SpirvProgram::CreateWorkgroupState() const {
+        std::unique_ptr<SpirvWorkgroupState> state(new SpirvWorkgroupState);
+
+        // Without barriers the invocations run one after the other so they can share registers.
+        size_t invocationCount = 1;
+        if (mHasBarriers) {
+            invocationCount = size_t(mLocalSize[0]) * mLocalSize[1] * mLocalSize[2];
+        }
+
+        state->mInvocations.resize(invocationCount);
+        for (Invocation& invocation : state->mInvocations) {
+            invocation.registers = mConstantRegisters;
+            invocation.pointers.resize(mIdTypes.size());
+            invocation.memory.resize(mInvocationMemorySize);
+        }
+        state->mWorkgroupMemory.resize(mWorkgroupMemorySize);
+
+        return state;
+    }
+
+    void SpirvProgram::RunWorkgroup(SpirvWorkgroupState* state,
+                                    const ShaderBindings& bindings,
+                                    const std::array<uint32_t, 3>& workgroupId,
+                                    const std::array<uint32_t, 3>& workgroupCount) const {
+        std::fill(state->mWorkgroupMemory.begin(), state->mWorkgroupMemory.end(), 0);
+        uint8_t* workgroupMemory = state->mWorkgroupMemory.data();
+
+        if (!mHasBarriers) {
+            Invocation* invocation = &state->mInvocations[0];
+            for (uint32_t z = 0; z < mLocalSize[2]; ++z) {
+                for (uint32_t y = 0; y < mLocalSize[1]; ++y) {
+                    for (uint32_t x = 0; x < mLocalSize[0]; ++x) {
+                        StartInvocation(invocation, bindings, {{x, y, z}}, workgroupId,
+                                        workgroupCount, workgroupMemory, nullptr);
+                        bool done = Run(invocation, &state->mScratch);
+                        ASSERT(done);
+                    }
+                }
+            }
+            return;
+        }
+
+        // Each invocation runs until the next barrier, or its end, in turn.
+        size_t index = 0;
+        for (uint32_t z = 0; z < mLocalSize[2]; ++z) {
+            for (uint32_t y = 0; y < mLocalSize[1]; ++y) {
+                for (uint32_t x = 0; x < mLocalSize[0]; ++x) {
+                    StartInvocation(&state->mInvocations[index++], bindings, {{x, y, z}},
+                                    workgroupId, workgroupCount, workgroupMemory, nullptr);
+                }
+            }
+        }
+
+        bool allDone;
+        do {
+            allDone = true;
+            for (Invocation& invocation : state->mInvocations) {
+                if (!invocation.done) {
+                    invocation.done = Run(&invocation, &state->mScratch);
+                    allDone = allDone && invocation.done;
+                }
+            }
+        } while (!allDone);
+    }
+
+    void SpirvProgram::RunInvocation(SpirvWorkgroupState* state,
+                                     const ShaderBindings& bindings,
+                                     ShaderInterface* interface) const {
+        Invocation* invocation = &state->mInvocations[0];
+        StartInvocation(invocation, bindings, {{0, 0, 0}}, {{0, 0, 0}}, {{1, 1, 1}}, nullptr,
+                        interface);
+        bool done = Run(invocation, &state->mScratch);
+        ASSERT(done);
+
+        interface->discarded = invocation->killed;
+        for (const Variable& variable : mGlobalVariables) {
+            if (variable.storageClass != spv::StorageClassOutput) {
+                continue;
+            }
+
+            const uint8_t* memory = invocation->memory.data() + variable.offset;
+            if (variable.location != kNoDecoration) {
+                memcpy(interface->outputs[variable.location].data(), memory,
+                       std::min<size_t>(mTypes[variable.type].size,
+                                        sizeof(ShaderInterface::Location)));
+            } else if (variable.builtIn == spv::BuiltInPosition) {
+                memcpy(interface->position.data(), memory + variable.builtInOffset,
+                       sizeof(interface->position));
+            } else if (variable.builtIn == spv::BuiltInFragDepth) {
+                memcpy(&interface->fragDepth, memory, sizeof(float));
+            }
+        }
+    }
+
+    void SpirvProgram::StartInvocation(Invocation* invocation,
+                                       const ShaderBindings& bindings,
+                                       const std::array<uint32_t, 3>& localId,
+                                       const std::array<uint32_t, 3>& workgroupId,
+                                       const std::array<uint32_t, 3>& workgroupCount,
+                                       uint8_t* workgroupMemory,
+                                       const ShaderInterface* interface) const {
+        std::fill(invocation->memory.begin(), invocation->memory.end(), 0);
+
+        for (const Variable& variable : mGlobalVariables) {
+            Pointer* pointer = &invocation->pointers[variable.id];
+            pointer->type = variable.type;
+            pointer->offset = 0;
+            pointer->size = mTypes[variable.type].size;
+
+            switch (variable.storageClass) {
+                case spv::StorageClassUniform:
+                case spv::StorageClassStorageBuffer: {
+                    const ShaderBindings::Buffer& buffer =
+                        bindings.buffers[variable.group][variable.binding];
+                    pointer->base = buffer.data;
+                    pointer->size = buffer.data == nullptr ? 0 : buffer.size;
+                } break;
+
+                case spv::StorageClassPushConstant:
+                    pointer->base = reinterpret_cast<uint8_t*>(bindings.pushConstants);
+                    pointer->size = bindings.pushConstants == nullptr
+                                        ? 0
+                                        : kMaxPushConstants * sizeof(uint32_t);
+                    break;
+
+                case spv::StorageClassWorkgroup:
+                    pointer->base = workgroupMemory + variable.offset;
+                    break;
+
+                case spv::StorageClassInput: {
+                    pointer->base = invocation->memory.data() + variable.offset;
+
+                    if (variable.location != kNoDecoration) {
+                        memcpy(pointer->base, interface->inputs[variable.location].data(),
+                               std::min<size_t>(pointer->size, sizeof(ShaderInterface::Location)));
+                        break;
+                    }
+
+                    std::array<uint32_t, 4> value = {};
+                    for (uint32_t i = 0; i < 3; ++i) {
+                        switch (variable.builtIn) {
+                            case spv::BuiltInNumWorkgroups:
+                                value[i] = workgroupCount[i];
+                                break;
+                            case spv::BuiltInWorkgroupSize:
+                                value[i] = mLocalSize[i];
+                                break;
+                            case spv::BuiltInWorkgroupId:
+                                value[i] = workgroupId[i];
+                                break;
+                            case spv::BuiltInLocalInvocationId:
+                                value[i] = localId[i];
+                                break;
+                            case spv::BuiltInGlobalInvocationId:
+                                value[i] = workgroupId[i] * mLocalSize[i] + localId[i];
+                                break;
+                            case spv::BuiltInLocalInvocationIndex:
+                                value[0] = (localId[2] * mLocalSize[1] + localId[1]) *
+                                               mLocalSize[0] +
+                                           localId[0];
+                                break;
+                            case spv::BuiltInVertexIndex:
+                                value[0] = interface->vertexIndex;
+                                break;
+                            case spv::BuiltInInstanceIndex:
+                                value[0] = interface->instanceIndex;
+                                break;
+                            case spv::BuiltInFragCoord:
+                                memcpy(value.data(), interface->fragCoord.data(), sizeof(value));
+                                break;
+                            case spv::BuiltInFrontFacing:
+                                value[0] = interface->frontFacing ? 1 : 0;
+                                break;
+                            default:
+                                UNREACHABLE();
+                        }
+                    }
+                    memcpy(pointer->base, value.data(),
+                           std::min<size_t>(pointer->size, sizeof(value)));
+                } break;
+
+                case spv::StorageClassOutput:
+                    pointer->base = invocation->memory.data() + variable.offset;
+                    break;
+
+                case spv::StorageClassPrivate:
+                    pointer->base = invocation->memory.data() + variable.offset;
+                    if (variable.initializer != 0) {
+                        Store(variable.type, pointer->base,
+                              &invocation->registers[mRegisterOffsets[variable.initializer]]);
+                    }
+                    break;
+
+                default:
+                    UNREACHABLE();
+            }
+        }
+
+        invocation->callStack.clear();
+        invocation->instruction = mFunctions[mEntryFunction].firstInstruction;
+        invocation->currentBlock = 0;
+        invocation->previousBlock = 0;
+        invocation->done = false;
+        invocation->killed = false;
+    }
+
+    void SpirvProgram::Load(uint32_t typeId, const uint8_t* memory, uint32_t* words) const {
+        const Type& type = mTypes[typeId];
+        switch (type.kind) {
+            case TypeKind::Bool:
+            case TypeKind::Int:
+            case TypeKind::Float:
+                memcpy(words, memory, sizeof(uint32_t));
+                break;
+
+            case TypeKind::Vector:
+                memcpy(words, memory, type.count * sizeof(uint32_t));
+                break;
+
+            case TypeKind::Matrix:
+            case TypeKind::Array: {
+                uint32_t elementWordCount = mTypes[type.elementType].wordCount;
+                for (uint32_t i = 0; i < type.count; ++i) {
+                    Load(type.elementType, memory + size_t(i) * type.stride,
+                         words + i * elementWordCount);
+                }
+            } break;
+
+            case TypeKind::Struct:
+                for (size_t i = 0; i < type.memberTypes.size(); ++i) {
+                    Load(type.memberTypes[i], memory + type.memberOffsets[i], words);
+                    words += mTypes[type.memberTypes[i]].wordCount;
+                }
+                break;
+
+            default:
+                UNREACHABLE();
+        }
+    }
+
+    void SpirvProgram::Store(uint32_t typeId, uint8_t* memory, const uint32_t* words) const {
+        const Type& type = mTypes[typeId];
+        switch (type.kind) {
+            case TypeKind::Bool:
+            case TypeKind::Int:
+            case TypeKind::Float:
+                memcpy(memory, words, sizeof(uint32_t));
+                break;
+
+            case TypeKind::Vector:
+                memcpy(memory, words, type.count * sizeof(uint32_t));
+                break;
+
+            case TypeKind::Matrix:
+            case TypeKind::Array: {
+                uint32_t elementWordCount = mTypes[type.elementType].wordCount;
+                for (uint32_t i = 0; i < type.count; ++i) {
+                    Store(type.elementType, memory + size_t(i) * type.stride,
+                          words + i * elementWordCount);
+                }
+            } break;
+
+            case TypeKind::Struct:
+                for (size_t i = 0; i < type.memberTypes.size(); ++i) {
+                    Store(type.memberTypes[i], memory + type.memberOffsets[i], words);
+                    words += mTypes[type.memberTypes[i]].wordCount;
+                }
+                break;
+
+            default:
+                UNREACHABLE();
+        }
+    }
+
+    bool SpirvProgram::Run(Invocation* invocation, std::vector<uint32_t>* scratch) const {
+        auto Registers = [&](uint32_t id) { return &invocation->registers[mRegisterOffsets[id]]; };
+        auto WordCount = [&](uint32_t id) { return mTypes[mIdTypes[id]].wordCount; };
+        auto InBounds = [&](const Pointer& pointer) {
+            uint64_t size = mTypes[pointer.type].size;
+            return pointer.base != nullptr && pointer.offset <= pointer.size &&
+                   size <= pointer.size - pointer.offset;
+        };
+        auto Jump = [&](uint32_t label) {
+            invocation->previousBlock = invocation->currentBlock;
+            invocation->instruction = mLabels[label];
+        };
+
+        while (true) {
+            const Instruction& instruction = mInstructions[invocation->instruction++];
+            const uint32_t* operands = &mOperands[instruction.firstOperand];
+            uint32_t* result = instruction.result == 0 ? nullptr : Registers(instruction.result);
+            uint32_t count = mTypes[instruction.resultType].wordCount;
+            auto Operand = [&](uint32_t i) { return Registers(operands[i]); };
+
+            switch (instruction.opcode) {
+                case spv::OpLabel:
+                    invocation->currentBlock = instruction.result;
+                    break;
+
+                case spv::OpBranch:
+                    Jump(operands[0]);
+                    break;
+
+                case spv::OpBranchConditional:
+                    Jump(Operand(0)[0] != 0 ? operands[1] : operands[2]);
+                    break;
+
+                case spv::OpSwitch: {
+                    uint32_t selector = Operand(0)[0];
+                    uint32_t target = operands[1];
+                    for (uint32_t i = 2; i + 1 < instruction.operandCount; i += 2) {
+                        if (operands[i] == selector) {
+                            target = operands[i + 1];
+                            break;
+                        }
+                    }
+                    Jump(target);
+                } break;
+
+                case spv::OpPhi: {
+                    // All the phis at the start of a block read their values before any of them
+                    // is written, as if they ran in parallel.
+                    uint32_t first = invocation->instruction - 1;
+                    uint32_t last = first;
+                    scratch->clear();
+                    for (; last < mInstructions.size() &&
+                           mInstructions[last].opcode == spv::OpPhi;
+                         ++last) {
+                        const Instruction& phi = mInstructions[last];
+                        const uint32_t* pairs = &mOperands[phi.firstOperand];
+                        uint32_t phiCount = mTypes[phi.resultType].wordCount;
+
+                        size_t offset = scratch->size();
+                        scratch->resize(offset + phiCount, 0);
+                        for (uint32_t i = 0; i + 1 < phi.operandCount; i += 2) {
+                            if (pairs[i + 1] == invocation->previousBlock) {
+                                std::copy_n(Registers(pairs[i]), phiCount, &(*scratch)[offset]);
+                                break;
+                            }
+                        }
+                    }
+
+                    size_t offset = 0;
+                    for (uint32_t i = first; i < last; ++i) {
+                        const Instruction& phi = mInstructions[i];
+                        uint32_t phiCount = mTypes[phi.resultType].wordCount;
+                        std::copy_n(&(*scratch)[offset], phiCount, Registers(phi.result));
+                        offset += phiCount;
+                    }
+                    invocation->instruction = last;
+                } break;
+
+                case spv::OpReturn:
+                case spv::OpReturnValue: {
+                    if (invocation->callStack.empty()) {
+                        return true;
+                    }
+                    SpirvWorkgroupState::CallFrame frame = invocation->callStack.back();
+                    invocation->callStack.pop_back();
+
+                    if (instruction.opcode == spv::OpReturnValue) {
+                        std::copy_n(Operand(0), WordCount(operands[0]), Registers(frame.result));
+                    }
+                    invocation->instruction = frame.returnInstruction;
+                    invocation->currentBlock = frame.currentBlock;
+                    invocation->previousBlock = frame.previousBlock;
+                } break;
+
+                case spv::OpKill:
+                    invocation->killed = true;
+                    return true;
+
+                case spv::OpUnreachable:
+                    return true;
+
+                case spv::OpControlBarrier:
+                    return false;
+
+                case spv::OpFunctionCall: {
+                    const Function& function = mFunctions[operands[0]];
+                    for (size_t i = 0; i < function.parameters.size(); ++i) {
+                        uint32_t parameter = function.parameters[i];
+                        uint32_t argument = operands[i + 1];
+                        if (mTypes[mIdTypes[parameter]].kind == TypeKind::Pointer) {
+                            invocation->pointers[parameter] = invocation->pointers[argument];
+                        } else {
+                            std::copy_n(Registers(argument), WordCount(argument),
+                                        Registers(parameter));
+                        }
+                    }
+
+                    invocation->callStack.push_back({invocation->instruction, instruction.result,
+                                                     invocation->currentBlock,
+                                                     invocation->previousBlock});
+                    invocation->instruction = function.firstInstruction;
+                } break;
+
+                case spv::OpVariable: {
+                    Pointer* pointer = &invocation->pointers[instruction.result];
+                    pointer->type = mTypes[instruction.resultType].elementType;
+                    pointer->base =
+                        invocation->memory.data() + mVariableOffsets[instruction.result];
+                    pointer->size = mTypes[pointer->type].size;
+                    pointer->offset = 0;
+
+                    memset(pointer->base, 0, pointer->size);
+                    if (instruction.operandCount >= 2) {
+                        Store(pointer->type, pointer->base, Operand(1));
+                    }
+                } break;
+
+                case spv::OpLoad: {
+                    const Pointer& pointer = invocation->pointers[operands[0]];
+                    if (InBounds(pointer)) {
+                        Load(pointer.type, pointer.base + pointer.offset, result);
+                    } else {
+                        std::fill_n(result, count, 0);
+                    }
+                } break;
+
+                case spv::OpStore: {
+                    const Pointer& pointer = invocation->pointers[operands[0]];
+                    if (InBounds(pointer)) {
+                        Store(pointer.type, pointer.base + pointer.offset, Operand(1));
+                    }
+                } break;
+
+                case spv::OpCopyMemory: {
+                    const Pointer& target = invocation->pointers[operands[0]];
+                    const Pointer& source = invocation->pointers[operands[1]];
+                    if (InBounds(target) && InBounds(source)) {
+                        scratch->resize(mTypes[source.type].wordCount);
+                        Load(source.type, source.base + source.offset, scratch->data());
+                        Store(target.type, target.base + target.offset, scratch->data());
+                    }
+                } break;
+
+                case spv::OpAccessChain:
+                case spv::OpInBoundsAccessChain: {
+                    Pointer pointer = invocation->pointers[operands[0]];
+                    for (uint32_t i = 1; i < instruction.operandCount; ++i) {
+                        const Type& type = mTypes[pointer.type];
+                        uint32_t index = Operand(i)[0];
+                        bool isSigned = mTypes[mIdTypes[operands[i]]].isSigned;
+                        uint64_t wideIndex = isSigned ? static_cast<uint64_t>(int64_t(AsInt(index)))
+                                                      : uint64_t(index);
+
+                        switch (type.kind) {
+                            case TypeKind::Struct:
+                                if (index >= type.memberTypes.size()) {
+                                    pointer.size = 0;
+                                    break;
+                                }
+                                pointer.offset += type.memberOffsets[index];
+                                pointer.type = type.memberTypes[index];
+                                break;
+
+                            case TypeKind::Vector:
+                            case TypeKind::Matrix:
+                            case TypeKind::Array:
+                            case TypeKind::RuntimeArray:
+                                pointer.offset += wideIndex * type.stride;
+                                pointer.type = type.elementType;
+                                break;
+
+                            default:
+                                pointer.size = 0;
+                                break;
+                        }
+                    }
+                    invocation->pointers[instruction.result] = pointer;
+                } break;
+
+                case spv::OpArrayLength: {
+                    const Pointer& pointer = invocation->pointers[operands[0]];
+                    const Type& structType = mTypes[pointer.type];
+                    uint32_t member = operands[1];
+                    result[0] = 0;
+                    if (member < structType.memberTypes.size()) {
+                        uint64_t begin = pointer.offset + structType.memberOffsets[member];
+                        uint32_t stride = mTypes[structType.memberTypes[member]].stride;
+                        if (pointer.base != nullptr && begin < pointer.size && stride != 0) {
+                            result[0] = static_cast<uint32_t>(
+                                std::min<uint64_t>((pointer.size - begin) / stride,
+                                                   std::numeric_limits<uint32_t>::max()));
+                        }
+                    }
+                } break;
+
+                case spv::OpCopyObject:
+                    if (mTypes[instruction.resultType].kind == TypeKind::Pointer) {
+                        invocation->pointers[instruction.result] =
+                            invocation->pointers[operands[0]];
+                    } else {
+                        std::copy_n(Operand(0), count, result);
+                    }
+                    break;
+
+                case spv::OpUConvert:
+                case spv::OpSConvert:
+                case spv::OpFConvert:
+                case spv::OpBitcast:
+                    std::copy_n(Operand(0), count, result);
+                    break;
+
+                case spv::OpCompositeConstruct: {
+                    uint32_t offset = 0;
+                    for (uint32_t i = 0; i < instruction.operandCount; ++i) {
+                        uint32_t constituentCount = WordCount(operands[i]);
+                        std::copy_n(Operand(i), constituentCount, result + offset);
+                        offset += constituentCount;
+                    }
+                } break;
+
+                case spv::OpCompositeExtract:
+                case spv::OpCompositeInsert: {
+                    bool isInsert = instruction.opcode == spv::OpCompositeInsert;
+                    uint32_t composite = operands[isInsert ? 1 : 0];
+                    uint32_t type = mIdTypes[composite];
+                    uint32_t offset = 0;
+                    for (uint32_t i = isInsert ? 2 : 1; i < instruction.operandCount; ++i) {
+                        const Type& compositeType = mTypes[type];
+                        uint32_t index = operands[i];
+                        if (compositeType.kind == TypeKind::Struct) {
+                            for (uint32_t member = 0; member < index; ++member) {
+                                offset += mTypes[compositeType.memberTypes[member]].wordCount;
+                            }
+                            type = compositeType.memberTypes[index];
+                        } else {
+                            type = compositeType.elementType;
+                            offset += index * mTypes[type].wordCount;
+                        }
+                    }
+
+                    if (isInsert) {
+                        std::copy_n(Operand(1), count, result);
+                        std::copy_n(Operand(0), mTypes[type].wordCount, result + offset);
+                    } else {
+                        std::copy_n(Operand(0) + offset, count, result);
+                    }
+                } break;
+
+                case spv::OpVectorExtractDynamic: {
+                    uint32_t index = Operand(1)[0];
+                    result[0] = index < WordCount(operands[0]) ? Operand(0)[index] : 0;
+                } break;
+
+                case spv::OpVectorInsertDynamic: {
+                    uint32_t index = Operand(2)[0];
+                    std::copy_n(Operand(0), count, result);
+                    if (index < count) {
+                        result[index] = Operand(1)[0];
+                    }
+                } break;
+
+                case spv::OpVectorShuffle: {
+                    uint32_t firstCount = WordCount(operands[0]);
+                    uint32_t secondCount = WordCount(operands[1]);
+                    for (uint32_t i = 0; i < count; ++i) {
+                        uint32_t component = operands[2 + i];
+                        if (component < firstCount) {
+                            result[i] = Operand(0)[component];
+                        } else if (component - firstCount < secondCount) {
+                            result[i] = Operand(1)[component - firstCount];
+                        } else {
+                            result[i] = 0;
+                        }
+                    }
+                } break;
+
+                case spv::OpTranspose: {
+                    const Type& type = mTypes[instruction.resultType];
+                    uint32_t rows = type.count;
+                    uint32_t columns = mTypes[type.elementType].count;
+                    const uint32_t* matrix = Operand(0);
+                    for (uint32_t column = 0; column < columns; ++column) {
+                        for (uint32_t row = 0; row < rows; ++row) {
+                            result[row * columns + column] = matrix[column * rows + row];
+                        }
+                    }
+                } break;
+
+                case spv::OpConvertFToU:
+                    ComponentWise(result, Operand(0), count,
+                                  [](uint32_t a) { return FloatToUint(AsFloat(a)); });
+                    break;
+                case spv::OpConvertFToS:
+                    ComponentWise(result, Operand(0), count,
+                                  [](uint32_t a) { return FromInt(FloatToInt(AsFloat(a))); });
+                    break;
+                case spv::OpConvertSToF:
+                    ComponentWise(result, Operand(0), count, [](uint32_t a) {
+                        return FromFloat(static_cast<float>(AsInt(a)));
+                    });
+                    break;
+                case spv::OpConvertUToF:
+                    ComponentWise(result, Operand(0), count,
+                                  [](uint32_t a) { return FromFloat(static_cast<float>(a)); });
+                    break;
+
+                case spv::OpSNegate:
+                    ComponentWise(result, Operand(0), count, [](uint32_t a) { return 0u - a; });
+                    break;
+                case spv::OpFNegate:
+                    FloatWise(result, Operand(0), count, [](float a) { return -a; });
+                    break;
+                case spv::OpNot:
+                    ComponentWise(result, Operand(0), count, [](uint32_t a) { return ~a; });
+                    break;
+
+                case spv::OpIAdd:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) { return a + b; });
+                    break;
+                case spv::OpISub:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) { return a - b; });
+                    break;
+                case spv::OpIMul:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) { return a * b; });
+                    break;
+                case spv::OpUDiv:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) { return b == 0 ? 0 : a / b; });
+                    break;
+                case spv::OpUMod:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) { return b == 0 ? 0 : a % b; });
+                    break;
+                case spv::OpSDiv:
+                    ComponentWise(result, Operand(0), Operand(1), count, SignedDivide);
+                    break;
+                case spv::OpSRem:
+                    ComponentWise(result, Operand(0), Operand(1), count, SignedRemainder);
+                    break;
+                case spv::OpSMod:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) {
+                                      int32_t remainder = AsInt(SignedRemainder(a, b));
+                                      if (remainder != 0 && ((remainder < 0) != (AsInt(b) < 0))) {
+                                          remainder += AsInt(b);
+                                      }
+                                      return FromInt(remainder);
+                                  });
+                    break;
+
+                case spv::OpFAdd:
+                    FloatWise(result, Operand(0), Operand(1), count,
+                              [](float a, float b) { return a + b; });
+                    break;
+                case spv::OpFSub:
+                    FloatWise(result, Operand(0), Operand(1), count,
+                              [](float a, float b) { return a - b; });
+                    break;
+                case spv::OpFMul:
+                    FloatWise(result, Operand(0), Operand(1), count,
+                              [](float a, float b) { return a * b; });
+                    break;
+                case spv::OpFDiv:
+                    FloatWise(result, Operand(0), Operand(1), count,
+                              [](float a, float b) { return a / b; });
+                    break;
+                case spv::OpFRem:
+                    FloatWise(result, Operand(0), Operand(1), count,
+                              [](float a, float b) { return std::fmod(a, b); });
+                    break;
+                case spv::OpFMod:
+                    FloatWise(result, Operand(0), Operand(1), count,
+                              [](float a, float b) { return a - b * std::floor(a / b); });
+                    break;
+
+                case spv::OpVectorTimesScalar:
+                case spv::OpMatrixTimesScalar: {
+                    float scalar = AsFloat(Operand(1)[0]);
+                    FloatWise(result, Operand(0), count, [scalar](float a) { return a * scalar; });
+                } break;
+
+                case spv::OpDot:
+                    result[0] = FromFloat(Dot(Operand(0), Operand(1), WordCount(operands[0])));
+                    break;
+
+                case spv::OpMatrixTimesVector: {
+                    const uint32_t* matrix = Operand(0);
+                    const uint32_t* vector = Operand(1);
+                    uint32_t columns = WordCount(operands[1]);
+                    for (uint32_t row = 0; row < count; ++row) {
+                        float sum = 0.0f;
+                        for (uint32_t column = 0; column < columns; ++column) {
+                            sum += AsFloat(matrix[column * count + row]) * AsFloat(vector[column]);
+                        }
+                        result[row] = FromFloat(sum);
+                    }
+                } break;
+
+                case spv::OpVectorTimesMatrix: {
+                    const uint32_t* vector = Operand(0);
+                    const uint32_t* matrix = Operand(1);
+                    uint32_t rows = WordCount(operands[0]);
+                    for (uint32_t column = 0; column < count; ++column) {
+                        result[column] = FromFloat(Dot(vector, matrix + column * rows, rows));
+                    }
+                } break;
+
+                case spv::OpMatrixTimesMatrix: {
+                    const Type& resultType = mTypes[instruction.resultType];
+                    const uint32_t* left = Operand(0);
+                    const uint32_t* right = Operand(1);
+                    uint32_t rows = mTypes[resultType.elementType].count;
+                    uint32_t inner = mTypes[mIdTypes[operands[0]]].count;
+                    for (uint32_t column = 0; column < resultType.count; ++column) {
+                        for (uint32_t row = 0; row < rows; ++row) {
+                            float sum = 0.0f;
+                            for (uint32_t k = 0; k < inner; ++k) {
+                                sum += AsFloat(left[k * rows + row]) *
+                                       AsFloat(right[column * inner + k]);
+                            }
+                            result[column * rows + row] = FromFloat(sum);
+                        }
+                    }
+                } break;
+
+                case spv::OpOuterProduct: {
+                    const uint32_t* left = Operand(0);
+                    const uint32_t* right = Operand(1);
+                    uint32_t rows = WordCount(operands[0]);
+                    uint32_t columns = WordCount(operands[1]);
+                    for (uint32_t column = 0; column < columns; ++column) {
+                        for (uint32_t row = 0; row < rows; ++row) {
+                            result[column * rows + row] =
+                                FromFloat(AsFloat(left[row]) * AsFloat(right[column]));
+                        }
+                    }
+                } break;
+
+                case spv::OpAny:
+                case spv::OpAll: {
+                    bool isAny = instruction.opcode == spv::OpAny;
+                    const uint32_t* vector = Operand(0);
+                    result[0] = isAny ? 0 : 1;
+                    for (uint32_t i = 0; i < WordCount(operands[0]); ++i) {
+                        if ((vector[i] != 0) == isAny) {
+                            result[0] = isAny ? 1 : 0;
+                            break;
+                        }
+                    }
+                } break;
+
+                case spv::OpIsNan:
+                    ComponentWise(result, Operand(0), count,
+                                  [](uint32_t a) -> uint32_t { return std::isnan(AsFloat(a)); });
+                    break;
+                case spv::OpIsInf:
+                    ComponentWise(result, Operand(0), count,
+                                  [](uint32_t a) -> uint32_t { return std::isinf(AsFloat(a)); });
+                    break;
+
+                case spv::OpLogicalEqual:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) -> uint32_t { return a == b; });
+                    break;
+                case spv::OpLogicalNotEqual:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) -> uint32_t { return a != b; });
+                    break;
+                case spv::OpLogicalOr:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) { return a | b; });
+                    break;
+                case spv::OpLogicalAnd:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) { return a & b; });
+                    break;
+                case spv::OpLogicalNot:
+                    ComponentWise(result, Operand(0), count, [](uint32_t a) { return a ^ 1u; });
+                    break;
+
+                case spv::OpSelect: {
+                    const uint32_t* condition = Operand(0);
+                    if (WordCount(operands[0]) == 1) {
+                        std::copy_n(condition[0] != 0 ? Operand(1) : Operand(2), count, result);
+                    } else {
+                        ComponentWise(result, condition, Operand(1), Operand(2), count,
+                                      [](uint32_t c, uint32_t a, uint32_t b) {
+                                          return c != 0 ? a : b;
+                                      });
+                    }
+                } break;
+
+                case spv::OpIEqual:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) -> uint32_t { return a == b; });
+                    break;
+                case spv::OpINotEqual:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) -> uint32_t { return a != b; });
+                    break;
+                case spv::OpUGreaterThan:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) -> uint32_t { return a > b; });
+                    break;
+                case spv::OpSGreaterThan:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) -> uint32_t {
+                                      return AsInt(a) > AsInt(b);
+                                  });
+                    break;
+                case spv::OpUGreaterThanEqual:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) -> uint32_t { return a >= b; });
+                    break;
+                case spv::OpSGreaterThanEqual:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) -> uint32_t {
+                                      return AsInt(a) >= AsInt(b);
+                                  });
+                    break;
+                case spv::OpULessThan:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) -> uint32_t { return a < b; });
+                    break;
+                case spv::OpSLessThan:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) -> uint32_t {
+                                      return AsInt(a) < AsInt(b);
+                                  });
+                    break;
+                case spv::OpULessThanEqual:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) -> uint32_t { return a <= b; });
+                    break;
+                case spv::OpSLessThanEqual:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) -> uint32_t {
+                                      return AsInt(a) <= AsInt(b);
+                                  });
+                    break;
+
+                // The C++ comparisons are ordered, the unordered ones are also true with NaNs.
+                case spv::OpFOrdEqual:
+                case spv::OpFUnordEqual:
+                case spv::OpFOrdNotEqual:
+                case spv::OpFUnordNotEqual:
+                case spv::OpFOrdLessThan:
+                case spv::OpFUnordLessThan:
+                case spv::OpFOrdGreaterThan:
+                case spv::OpFUnordGreaterThan:
+                case spv::OpFOrdLessThanEqual:
+                case spv::OpFUnordLessThanEqual:
+                case spv::OpFOrdGreaterThanEqual:
+                case spv::OpFUnordGreaterThanEqual: {
+                    uint32_t opcode = instruction.opcode;
+                    ComponentWise(
+                        result, Operand(0), Operand(1), count,
+                        [opcode](uint32_t x, uint32_t y) -> uint32_t {
+                            float a = AsFloat(x);
+                            float b = AsFloat(y);
+                            bool unordered = std::isnan(a) || std::isnan(b);
+                            switch (opcode) {
+                                case spv::OpFOrdEqual:
+                                    return a == b;
+                                case spv::OpFUnordEqual:
+                                    return unordered || a == b;
+                                case spv::OpFOrdNotEqual:
+                                    return !unordered && a != b;
+                                case spv::OpFUnordNotEqual:
+                                    return a != b;
+                                case spv::OpFOrdLessThan:
+                                    return a < b;
+                                case spv::OpFUnordLessThan:
+                                    return unordered || a < b;
+                                case spv::OpFOrdGreaterThan:
+                                    return a > b;
+                                case spv::OpFUnordGreaterThan:
+                                    return unordered || a > b;
+                                case spv::OpFOrdLessThanEqual:
+                                    return a <= b;
+                                case spv::OpFUnordLessThanEqual:
+                                    return unordered || a <= b;
+                                case spv::OpFOrdGreaterThanEqual:
+                                    return a >= b;
+                                default:
+                                    return unordered || a >= b;
+                            }
+                        });
+                } break;
+
+                // Shifts by 32 or more are undefined so they are wrapped like on most GPUs.
+                case spv::OpShiftRightLogical:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) { return a >> (b & 31); });
+                    break;
+                case spv::OpShiftRightArithmetic:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) {
+                                      return FromInt(AsInt(a) >> (b & 31));
+                                  });
+                    break;
+                case spv::OpShiftLeftLogical:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) { return a << (b & 31); });
+                    break;
+                case spv::OpBitwiseOr:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) { return a | b; });
+                    break;
+                case spv::OpBitwiseXor:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) { return a ^ b; });
+                    break;
+                case spv::OpBitwiseAnd:
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [](uint32_t a, uint32_t b) { return a & b; });
+                    break;
+
+                case spv::OpBitFieldInsert: {
+                    uint32_t offset = std::min(Operand(2)[0], 32u);
+                    uint32_t mask = static_cast<uint32_t>(uint64_t(BitFieldMask(Operand(3)[0]))
+                                                          << offset);
+                    ComponentWise(result, Operand(0), Operand(1), count,
+                                  [offset, mask](uint32_t base, uint32_t insert) {
+                                      uint32_t shifted =
+                                          static_cast<uint32_t>(uint64_t(insert) << offset);
+                                      return (base & ~mask) | (shifted & mask);
+                                  });
+                } break;
+
+                case spv::OpBitFieldSExtract:
+                case spv::OpBitFieldUExtract: {
+                    uint32_t offset = std::min(Operand(1)[0], 32u);
+                    uint32_t bits = std::min(Operand(2)[0], 32u - offset);
+                    bool isSigned = instruction.opcode == spv::OpBitFieldSExtract;
+                    ComponentWise(result, Operand(0), count, [=](uint32_t base) {
+                        uint32_t field =
+                            static_cast<uint32_t>(uint64_t(base) >> offset) & BitFieldMask(bits);
+                        if (isSigned && bits != 0 && (field >> (bits - 1)) != 0) {
+                            field |= ~BitFieldMask(bits);
+                        }
+                        return field;
+                    });
+                } break;
+
+                case spv::OpBitReverse:
+                    ComponentWise(result, Operand(0), count, BitReverse);
+                    break;
+                case spv::OpBitCount:
+                    ComponentWise(result, Operand(0), count, BitCount);
+                    break;
+
+                case spv::OpExtInst:
+                    RunExtInst(result, instruction.resultType, operands[1], operands + 2,
+                               *invocation);
+                    break;
+
+                case spv::OpAtomicLoad:
+                case spv::OpAtomicStore:
+                case spv::OpAtomicExchange:
+                case spv::OpAtomicCompareExchange:
+                case spv::OpAtomicIIncrement:
+                case spv::OpAtomicIDecrement:
+                case spv::OpAtomicIAdd:
+                case spv::OpAtomicISub:
+                case spv::OpAtomicSMin:
+                case spv::OpAtomicUMin:
+                case spv::OpAtomicSMax:
+                case spv::OpAtomicUMax:
+                case spv::OpAtomicAnd:
+                case spv::OpAtomicOr:
+                case spv::OpAtomicXor:
+                    RunAtomic(instruction, operands, invocation);
+                    break;
+
+                default:
+                    UNREACHABLE();
+            }
+        }
+    }
+
+    void SpirvProgram::RunExtInst(uint32_t* result,
+                                  uint32_t resultType,
+                                  uint32_t extInstruction,
+                                  const uint32_t* arguments,
+                                  const Invocation& invocation) const {
+        auto Argument = [&](uint32_t i) {
+            return &invocation.registers[mRegisterOffsets[arguments[i]]];
+        };
+        uint32_t count = mTypes[resultType].wordCount;
+        uint32_t argumentCount = mTypes[mIdTypes[arguments[0]]].wordCount;
+
+        switch (extInstruction) {
+            case GLSLstd450Round:
+                FloatWise(result, Argument(0), count, [](float x) { return std::round(x); });
+                break;
+            case GLSLstd450RoundEven:
+                FloatWise(result, Argument(0), count, [](float x) { return std::nearbyint(x); });
+                break;
+            case GLSLstd450Trunc:
+                FloatWise(result, Argument(0), count, [](float x) { return std::trunc(x); });
+                break;
+            case GLSLstd450FAbs:
+                FloatWise(result, Argument(0), count, [](float x) { return std::fabs(x); });
+                break;
+            case GLSLstd450SAbs:
+                ComponentWise(result, Argument(0), count, [](uint32_t x) {
+                    return AsInt(x) < 0 ? 0u - x : x;
+                });
+                break;
+            case GLSLstd450FSign:
+                FloatWise(result, Argument(0), count, [](float x) {
+                    return x > 0.0f ? 1.0f : (x < 0.0f ? -1.0f : 0.0f);
+                });
+                break;
+            case GLSLstd450SSign:
+                ComponentWise(result, Argument(0), count, [](uint32_t x) {
+                    return FromInt(AsInt(x) > 0 ? 1 : (AsInt(x) < 0 ? -1 : 0));
+                });
+                break;
+            case GLSLstd450Floor:
+                FloatWise(result, Argument(0), count, [](float x) { return std::floor(x); });
+                break;
+            case GLSLstd450Ceil:
+                FloatWise(result, Argument(0), count, [](float x) { return std::ceil(x); });
+                break;
+            case GLSLstd450Fract:
+                FloatWise(result, Argument(0), count, [](float x) { return x - std::floor(x); });
+                break;
+            case GLSLstd450Radians:
+                FloatWise(result, Argument(0), count,
+                          [](float x) { return x * 0.017453292519943295f; });
+                break;
+            case GLSLstd450Degrees:
+                FloatWise(result, Argument(0), count,
+                          [](float x) { return x * 57.29577951308232f; });
+                break;
+            case GLSLstd450Sin:
+                FloatWise(result, Argument(0), count, [](float x) { return std::sin(x); });
+                break;
+            case GLSLstd450Cos:
+                FloatWise(result, Argument(0), count, [](float x) { return std::cos(x); });
+                break;
+            case GLSLstd450Tan:
+                FloatWise(result, Argument(0), count, [](float x) { return std::tan(x); });
+                break;
+            case GLSLstd450Asin:
+                FloatWise(result, Argument(0), count, [](float x) { return std::asin(x); });
+                break;
+            case GLSLstd450Acos:
+                FloatWise(result, Argument(0), count, [](float x) { return std::acos(x); });
+                break;
+            case GLSLstd450Atan:
+                FloatWise(result, Argument(0), count, [](float x) { return std::atan(x); });
+                break;
+            case GLSLstd450Sinh:
+                FloatWise(result, Argument(0), count, [](float x) { return std::sinh(x); });
+                break;
+            case GLSLstd450Cosh:
+                FloatWise(result, Argument(0), count, [](float x) { return std::cosh(x); });
+                break;
+            case GLSLstd450Tanh:
+                FloatWise(result, Argument(0), count, [](float x) { return std::tanh(x); });
+                break;
+            case GLSLstd450Atan2:
+                FloatWise(result, Argument(0), Argument(1), count,
+                          [](float y, float x) { return std::atan2(y, x); });
+                break;
+            case GLSLstd450Pow:
+                FloatWise(result, Argument(0), Argument(1), count,
+                          [](float x, float y) { return std::pow(x, y); });
+                break;
+            case GLSLstd450Exp:
+                FloatWise(result, Argument(0), count, [](float x) { return std::exp(x); });
+                break;
+            case GLSLstd450Log:
+                FloatWise(result, Argument(0), count, [](float x) { return std::log(x); });
+                break;
+            case GLSLstd450Exp2:
+                FloatWise(result, Argument(0), count, [](float x) { return std::exp2(x); });
+                break;
+            case GLSLstd450Log2:
+                FloatWise(result, Argument(0), count, [](float x) { return std::log2(x); });
+                break;
+            case GLSLstd450Sqrt:
+                FloatWise(result, Argument(0), count, [](float x) { return std::sqrt(x); });
+                break;
+            case GLSLstd450InverseSqrt:
+                FloatWise(result, Argument(0), count,
+                          [](float x) { return 1.0f / std::sqrt(x); });
+                break;
+            case GLSLstd450FMin:
+            case GLSLstd450NMin:
+                FloatWise(result, Argument(0), Argument(1), count,
+                          [](float x, float y) { return std::fmin(x, y); });
+                break;
+            case GLSLstd450FMax:
+            case GLSLstd450NMax:
+                FloatWise(result, Argument(0), Argument(1), count,
+                          [](float x, float y) { return std::fmax(x, y); });
+                break;
+            case GLSLstd450UMin:
+                ComponentWise(result, Argument(0), Argument(1), count,
+                              [](uint32_t x, uint32_t y) { return std::min(x, y); });
+                break;
+            case GLSLstd450UMax:
+                ComponentWise(result, Argument(0), Argument(1), count,
+                              [](uint32_t x, uint32_t y) { return std::max(x, y); });
+                break;
+            case GLSLstd450SMin:
+                ComponentWise(result, Argument(0), Argument(1), count,
+                              [](uint32_t x, uint32_t y) {
+                                  return FromInt(std::min(AsInt(x), AsInt(y)));
+                              });
+                break;
+            case GLSLstd450SMax:
+                ComponentWise(result, Argument(0), Argument(1), count,
+                              [](uint32_t x, uint32_t y) {
+                                  return FromInt(std::max(AsInt(x), AsInt(y)));
+                              });
+                break;
+            case GLSLstd450FClamp:
+            case GLSLstd450NClamp:
+                FloatWise(result, Argument(0), Argument(1), Argument(2), count,
+                          [](float x, float low, float high) {
+                              return std::fmin(std::fmax(x, low), high);
+                          });
+                break;
+            case GLSLstd450UClamp:
+                ComponentWise(result, Argument(0), Argument(1), Argument(2), count,
+                              [](uint32_t x, uint32_t low, uint32_t high) {
+                                  return std::min(std::max(x, low), high);
+                              });
+                break;
+            case GLSLstd450SClamp:
+                ComponentWise(result, Argument(0), Argument(1), Argument(2), count,
+                              [](uint32_t x, uint32_t low, uint32_t high) {
+                                  return FromInt(
+                                      std::min(std::max(AsInt(x), AsInt(low)), AsInt(high)));
+                              });
+                break;
+            case GLSLstd450FMix:
+                FloatWise(result, Argument(0), Argument(1), Argument(2), count,
+                          [](float x, float y, float a) { return x * (1.0f - a) + y * a; });
+                break;
+            case GLSLstd450Step:
+                FloatWise(result, Argument(0), Argument(1), count,
+                          [](float edge, float x) { return x < edge ? 0.0f : 1.0f; });
+                break;
+            case GLSLstd450SmoothStep:
+                FloatWise(result, Argument(0), Argument(1), Argument(2), count,
+                          [](float edge0, float edge1, float x) {
+                              float t = std::fmin(std::fmax((x - edge0) / (edge1 - edge0), 0.0f),
+                                                  1.0f);
+                              return t * t * (3.0f - 2.0f * t);
+                          });
+                break;
+            case GLSLstd450Fma:
+                FloatWise(result, Argument(0), Argument(1), Argument(2), count,
+                          [](float a, float b, float c) { return a * b + c; });
+                break;
+
+            case GLSLstd450Length: {
+                const uint32_t* x = Argument(0);
+                result[0] = FromFloat(std::sqrt(Dot(x, x, argumentCount)));
+            } break;
+
+            case GLSLstd450Distance: {
+                std::array<uint32_t, 4> difference;
+                FloatWise(difference.data(), Argument(0), Argument(1), argumentCount,
+                          [](float a, float b) { return a - b; });
+                result[0] = FromFloat(
+                    std::sqrt(Dot(difference.data(), difference.data(), argumentCount)));
+            } break;
+
+            case GLSLstd450Cross: {
+                const uint32_t* a = Argument(0);
+                const uint32_t* b = Argument(1);
+                for (uint32_t i = 0; i < 3; ++i) {
+                    uint32_t j = (i + 1) % 3;
+                    uint32_t k = (i + 2) % 3;
+                    result[i] =
+                        FromFloat(AsFloat(a[j]) * AsFloat(b[k]) - AsFloat(a[k]) * AsFloat(b[j]));
+                }
+            } break;
+
+            case GLSLstd450Normalize: {
+                const uint32_t* x = Argument(0);
+                float length = std::sqrt(Dot(x, x, count));
+                FloatWise(result, x, count, [length](float a) { return a / length; });
+            } break;
+
+            case GLSLstd450FaceForward: {
+                float sign = Dot(Argument(2), Argument(1), count) < 0.0f ? 1.0f : -1.0f;
+                FloatWise(result, Argument(0), count, [sign](float n) { return n * sign; });
+            } break;
+
+            case GLSLstd450Reflect: {
+                const uint32_t* incident = Argument(0);
+                const uint32_t* normal = Argument(1);
+                float scale = 2.0f * Dot(normal, incident, count);
+                FloatWise(result, incident, normal, count,
+                          [scale](float i, float n) { return i - scale * n; });
+            } break;
+
+            default:
+                UNREACHABLE();
+        }
+    }
+
+    void SpirvProgram::RunAtomic(const Instruction& instruction,
+                                 const uint32_t* operands,
+                                 Invocation* invocation) const {
+        auto Registers = [&](uint32_t id) { return &invocation->registers[mRegisterOffsets[id]]; };
+
+        const Pointer& pointer = invocation->pointers[operands[0]];
+        uint32_t* result = instruction.result == 0 ? nullptr : Registers(instruction.result);
+        if (pointer.base == nullptr || pointer.offset > pointer.size ||
+            pointer.size - pointer.offset < sizeof(uint32_t)) {
+            if (result != nullptr) {
+                result[0] = 0;
+            }
+            return;
+        }
+
+        uint8_t* address = pointer.base + pointer.offset;
+        std::lock_guard<std::mutex> lock(*GetAtomicMutex(address));
+
+        uint32_t original;
+        memcpy(&original, address, sizeof(original));
+
+        // The value operand comes after the pointer, the scope and the memory semantics, and
+        // after a second memory semantics for OpAtomicCompareExchange.
+        uint32_t value = 0;
+        if (instruction.operandCount >= 4) {
+            bool isCompareExchange = instruction.opcode == spv::OpAtomicCompareExchange;
+            value = Registers(operands[isCompareExchange ? 4 : 3])[0];
+        }
+
+        uint32_t updated = original;
+        switch (instruction.opcode) {
+            case spv::OpAtomicLoad:
+                break;
+            case spv::OpAtomicStore:
+            case spv::OpAtomicExchange:
+                updated = value;
+                break;
+            case spv::OpAtomicCompareExchange:
+                if (original == Registers(operands[5])[0]) {
+                    updated = value;
+                }
+                break;
+            case spv::OpAtomicIIncrement:
+                updated = original + 1;
+                break;
+            case spv::OpAtomicIDecrement:
+                updated = original - 1;
+                break;
+            case spv::OpAtomicIAdd:
+                updated = original + value;
+                break;
+            case spv::OpAtomicISub:
+                updated = original - value;
+                break;
+            case spv::OpAtomicSMin:
+                updated = FromInt(std::min(AsInt(original), AsInt(value)));
+                break;
+            case spv::OpAtomicUMin:
+                updated = std::min(original, value);
+                break;
+            case spv::OpAtomicSMax:
+                updated = FromInt(std::max(AsInt(original), AsInt(value)));
+                break;
+            case spv::OpAtomicUMax:
+                updated = std::max(original, value);
+                break;
+            case spv::OpAtomicAnd:
+                updated = original & value;
+                break;
+            case spv::OpAtomicOr:
+                updated = original | value;
+                break;
+            case spv::OpAtomicXor:
+                updated = original ^ value;
+                break;
+            default:
+                UNREACHABLE();
+        }
+
+        memcpy(address, &updated, sizeof(updated));
+        if (result != nullptr) {
+            result[0] = original;
+        }
+    }
+
+}}  // namespace dawn_native::null
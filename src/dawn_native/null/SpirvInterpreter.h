@@ -0,0 +1,276 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DAWNNATIVE_NULL_SPIRVINTERPRETER_H_
+#define DAWNNATIVE_NULL_SPIRVINTERPRETER_H_
+
+#include "common/Constants.h"
+#include "dawn_native/dawn_platform.h"
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dawn_native { namespace null {
+
+    // The CPU memory of the buffers and push constants bound for a dispatch.
+    struct ShaderBindings {
+        struct Buffer {
+            uint8_t* data = nullptr;
+            uint32_t size = 0;
+        };
+        std::array<std::array<Buffer, kMaxBindingsPerGroup>, kMaxBindGroups> buffers;
+        uint32_t* pushConstants = nullptr;
+    };
+
+    // The number of locations of the inputs and outputs of vertex and fragment shaders.
+    static constexpr uint32_t kMaxShaderLocations = kMaxVertexAttributes;
+
+    // The inputs and outputs of an invocation of a vertex or fragment shader. Each location holds
+    // up to four 32-bit components.
+    struct ShaderInterface {
+        using Location = std::array<uint32_t, 4>;
+        std::array<Location, kMaxShaderLocations> inputs = {};
+        std::array<Location, kMaxShaderLocations> outputs = {};
+
+        // The builtins read by the shader.
+        uint32_t vertexIndex = 0;
+        uint32_t instanceIndex = 0;
+        std::array<float, 4> fragCoord = {};
+        bool frontFacing = true;
+
+        // The builtins written by the shader, and whether the fragment was discarded.
+        std::array<float, 4> position = {};
+        float fragDepth = 0.0f;
+        bool discarded = false;
+    };
+
+    class SpirvProgram;
+
+    // The registers and memory of the invocations of a workgroup, or of a single vertex or
+    // fragment invocation. They are reused for all the workgroups or invocations a thread runs so
+    // each thread running a program needs its own.
+    class SpirvWorkgroupState {
+      private:
+        friend class SpirvProgram;
+
+        // A pointer keeps the memory it points into so that accesses out of it are discarded.
+        struct Pointer {
+            uint8_t* base = nullptr;
+            uint64_t size = 0;
+            uint64_t offset = 0;
+            uint32_t type = 0;
+        };
+
+        struct CallFrame {
+            uint32_t returnInstruction;
+            uint32_t result;
+            uint32_t currentBlock;
+            uint32_t previousBlock;
+        };
+
+        struct Invocation {
+            std::vector<uint32_t> registers;
+            std::vector<Pointer> pointers;
+            std::vector<uint8_t> memory;
+            std::vector<CallFrame> callStack;
+            uint32_t instruction = 0;
+            uint32_t currentBlock = 0;
+            uint32_t previousBlock = 0;
+            bool done = false;
+            bool killed = false;
+        };
+
+        std::vector<Invocation> mInvocations;
+        std::vector<uint8_t> mWorkgroupMemory;
+        std::vector<uint32_t> mScratch;
+    };
+
+    // An entry point of a SPIR-V module decoded to be interpreted on the CPU. The subset of SPIR-V
+    // used by shaders working on buffers is supported: 32-bit scalars and the composites made of
+    // them, uniform and storage buffers, push constants, workgroup memory, barriers and atomics,
+    // and most of GLSL.std.450. Vertex and fragment shaders can also use scalar and vector inputs
+    // and outputs at locations and the builtins of ShaderInterface.
+    class SpirvProgram {
+      public:
+        // Returns nullptr and sets error if the module uses something that isn't supported.
+        static std::unique_ptr<SpirvProgram> Create(const std::vector<uint32_t>& code,
+                                                    dawn::ShaderStage stage,
+                                                    const std::string& entryPoint,
+                                                    std::string* error);
+        ~SpirvProgram();
+
+        const std::array<uint32_t, 3>& GetLocalSize() const;
+
+        // The locations of the inputs and outputs of a vertex or fragment shader. Flat inputs
+        // aren't interpolated.
+        const std::bitset<kMaxShaderLocations>& GetInputLocations() const;
+        const std::bitset<kMaxShaderLocations>& GetOutputLocations() const;
+        const std::bitset<kMaxShaderLocations>& GetFlatInputLocations() const;
+
+        // Whether the fragment shader writes its depth or can discard the fragment, in which case
+        // the depth and stencil tests must wait for the shader to run.
+        bool WritesFragDepth() const;
+        bool CanDiscard() const;
+
+        std::unique_ptr<SpirvWorkgroupState> CreateWorkgroupState() const;
+
+        // Runs all the invocations of a workgroup. Workgroups can run concurrently with
+        // different states.
+        void RunWorkgroup(SpirvWorkgroupState* state,
+                          const ShaderBindings& bindings,
+                          const std::array<uint32_t, 3>& workgroupId,
+                          const std::array<uint32_t, 3>& workgroupCount) const;
+
+        // Runs a single invocation of a vertex or fragment shader.
+        void RunInvocation(SpirvWorkgroupState* state,
+                           const ShaderBindings& bindings,
+                           ShaderInterface* interface) const;
+
+      private:
+        using Invocation = SpirvWorkgroupState::Invocation;
+        using Pointer = SpirvWorkgroupState::Pointer;
+
+        enum class TypeKind {
+            Void,
+            Bool,
+            Int,
+            Float,
+            Vector,
+            Matrix,
+            Array,
+            RuntimeArray,
+            Struct,
+            Pointer,
+            Function,
+        };
+
+        struct Type {
+            TypeKind kind = TypeKind::Void;
+            bool isSigned = false;
+            // The component of vectors, the column of matrices, the element of arrays and the
+            // pointee of pointers.
+            uint32_t elementType = 0;
+            uint32_t count = 0;
+            uint32_t storageClass = 0;
+            std::vector<uint32_t> memberTypes;
+            std::vector<uint32_t> memberOffsets;
+            // The array stride or the matrix column stride, in bytes.
+            uint32_t stride = 0;
+            // The size in memory, in bytes, and in registers, in words.
+            uint32_t size = 0;
+            uint32_t wordCount = 0;
+        };
+
+        struct Instruction {
+            uint32_t opcode;
+            uint32_t resultType;
+            uint32_t result;
+            uint32_t firstOperand;
+            uint32_t operandCount;
+        };
+
+        struct Function {
+            uint32_t firstInstruction = 0;
+            std::vector<uint32_t> parameters;
+        };
+
+        struct Variable {
+            uint32_t id;
+            uint32_t storageClass;
+            uint32_t type;
+            uint32_t offset;
+            uint32_t initializer;
+            uint32_t builtIn;
+            // The offset of the builtin in the variable, for builtins that are struct members.
+            uint32_t builtInOffset;
+            uint32_t location;
+            uint32_t group;
+            uint32_t binding;
+        };
+
+        struct Decorations;
+
+        SpirvProgram();
+
+        bool Parse(const std::vector<uint32_t>& code,
+                   uint32_t executionModel,
+                   const std::string& entryPoint,
+                   std::string* error);
+        bool AddType(uint32_t opcode,
+                     uint32_t id,
+                     const uint32_t* operands,
+                     uint32_t operandCount,
+                     const Decorations& decorations,
+                     std::string* error);
+        bool AddInterfaceVariable(Variable* variable,
+                                  const Decorations& decorations,
+                                  std::string* error);
+        uint32_t AddMatrixStride(uint32_t type, uint32_t matrixStride);
+        void AllocateRegisters(uint32_t id, uint32_t type);
+
+        void StartInvocation(Invocation* invocation,
+                             const ShaderBindings& bindings,
+                             const std::array<uint32_t, 3>& localId,
+                             const std::array<uint32_t, 3>& workgroupId,
+                             const std::array<uint32_t, 3>& workgroupCount,
+                             uint8_t* workgroupMemory,
+                             const ShaderInterface* interface) const;
+        // Returns false when the invocation stops at a barrier, true when it is done.
+        bool Run(Invocation* invocation, std::vector<uint32_t>* scratch) const;
+        void RunExtInst(uint32_t* result,
+                        uint32_t resultType,
+                        uint32_t instruction,
+                        const uint32_t* arguments,
+                        const Invocation& invocation) const;
+        void RunAtomic(const Instruction& instruction,
+                       const uint32_t* operands,
+                       Invocation* invocation) const;
+
+        void Load(uint32_t type, const uint8_t* memory, uint32_t* words) const;
+        void Store(uint32_t type, uint8_t* memory, const uint32_t* words) const;
+
+        std::vector<Type> mTypes;
+        std::vector<uint32_t> mIdTypes;
+        std::vector<uint32_t> mRegisterOffsets;
+        std::vector<uint32_t> mConstantRegisters;
+        std::vector<uint32_t> mVariableOffsets;
+
+        std::vector<Instruction> mInstructions;
+        std::vector<uint32_t> mOperands;
+        std::vector<uint32_t> mLabels;
+        std::vector<Function> mFunctions;
+        std::vector<Variable> mGlobalVariables;
+
+        uint32_t mInvocationMemorySize = 0;
+        uint32_t mWorkgroupMemorySize = 0;
+        uint32_t mExecutionModel = 0;
+        uint32_t mEntryFunction = 0;
+        uint32_t mGlslInstructionSet = 0;
+        std::array<uint32_t, 3> mLocalSize = {{1, 1, 1}};
+        bool mHasBarriers = false;
+
+        std::bitset<kMaxShaderLocations> mInputLocations;
+        std::bitset<kMaxShaderLocations> mOutputLocations;
+        std::bitset<kMaxShaderLocations> mFlatInputLocations;
+        bool mWritesFragDepth = false;
+        bool mHasKill = false;
+    };
+
+}}  // namespace dawn_native::null
+
+#endif  // DAWNNATIVE_NULL_SPIRVINTERPRETER_H_
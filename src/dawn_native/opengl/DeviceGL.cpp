@@ -107,6 +107,19 @@ namespace dawn_native { namespace opengl {
     }
 
     void Device::TickImpl() {
+        // The GL driver synchronizes with the CPU itself, so the operations waiting for the
+        // pending serial can complete at each tick.
+        AssumeCommandsComplete();
+    }
+
+    Serial Device::CheckAndUpdateCompletedSerials() {
+        return GetLastSubmittedCommandSerial();
+    }
+
+    bool Device::WaitForSerialImpl(Serial, uint64_t) {
+        // The submitted serials are always completed so there is never anything to wait for.
+        UNREACHABLE();
+        return true;
     }
 
 }}  // namespace dawn_native::opengl
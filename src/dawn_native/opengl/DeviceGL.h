@@ -59,6 +59,8 @@ namespace dawn_native { namespace opengl {
         ResultOrError<ShaderModuleBase*> CreateShaderModuleImpl(
             const ShaderModuleDescriptor* descriptor) override;
         ResultOrError<TextureBase*> CreateTextureImpl(const TextureDescriptor* descriptor) override;
+        Serial CheckAndUpdateCompletedSerials() override;
+        bool WaitForSerialImpl(Serial serial, uint64_t timeoutNs) override;
     };
 
 }}  // namespace dawn_native::opengl
@@ -90,10 +90,9 @@ namespace dawn_native { namespace vulkan {
         copy.size = size;
         mDevice->fn.CmdCopyBuffer(commands, stagingBuffer, buffer, 1, &copy);
 
-        // TODO(cwallez@chromium.org): Buffers must be deleted before the memory.
-        // This happens to work for now, but is fragile.
-        mDevice->GetMemoryAllocator()->Free(&allocation);
+        // Buffers must be deleted before the memory.
         mDevice->GetFencedDeleter()->DeleteWhenUnused(stagingBuffer);
+        mDevice->GetMemoryAllocator()->Free(&allocation);
     }
 
     void BufferUploader::Tick(Serial) {
@@ -140,12 +140,13 @@ namespace dawn_native { namespace vulkan {
     Buffer::~Buffer() {
         Device* device = ToBackend(GetDevice());
 
-        device->GetMemoryAllocator()->Free(&mMemoryAllocation);
-
+        // The buffer is given to the deleter first so that it is destroyed before its memory.
         if (mHandle != VK_NULL_HANDLE) {
             device->GetFencedDeleter()->DeleteWhenUnused(mHandle);
             mHandle = VK_NULL_HANDLE;
         }
+
+        device->GetMemoryAllocator()->Free(&mMemoryAllocation);
     }
 
     void Buffer::OnMapReadCommandSerialFinished(uint32_t mapSerial, const void* data) {
@@ -252,7 +253,7 @@ namespace dawn_native { namespace vulkan {
         request.data = data;
         request.isWrite = isWrite;
 
-        mInflightRequests.Enqueue(std::move(request), mDevice->GetSerial());
+        mInflightRequests.Enqueue(std::move(request), mDevice->GetPendingCommandSerial());
     }
 
     void MapRequestTracker::Tick(Serial finishedSerial) {
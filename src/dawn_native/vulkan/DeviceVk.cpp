@@ -41,6 +41,7 @@
 
 #include <spirv-cross/spirv_cross.hpp>
 
+#include <algorithm>
 #include <iostream>
 
 #if DAWN_PLATFORM_LINUX
@@ -154,19 +155,22 @@ namespace dawn_native { namespace vulkan {
     }
 
     Device::~Device() {
+        StopCompletionWaiter();
+
         // Immediately forget about all pending commands so we don't try to submit them in Tick
         FreeCommands(&mPendingCommands);
 
         if (fn.QueueWaitIdle(mQueue) != VK_SUCCESS) {
             ASSERT(false);
         }
-        CheckPassedFences();
+        CheckPassedSerials();
         ASSERT(mFencesInFlight.empty());
+        ASSERT(mFencesToReset.empty());
 
         // Some operations might have been started since the last submit and waiting
         // on a serial that doesn't have a corresponding fence enqueued. Force all
         // operations to look as if they were completed (because they were).
-        mCompletedSerial = mNextSerial;
+        AssumeCommandsComplete();
         Tick();
 
         ASSERT(mCommandsInFlight.Empty());
@@ -271,22 +275,19 @@ namespace dawn_native { namespace vulkan {
     }
 
     void Device::TickImpl() {
-        CheckPassedFences();
         RecycleCompletedCommands();
 
-        mMapRequestTracker->Tick(mCompletedSerial);
-        mBufferUploader->Tick(mCompletedSerial);
-        mMemoryAllocator->Tick(mCompletedSerial);
-
-        mDeleter->Tick(mCompletedSerial);
+        Serial completedSerial = GetCompletedCommandSerial();
+        mMapRequestTracker->Tick(completedSerial);
+        mBufferUploader->Tick(completedSerial);
+        mMemoryAllocator->Tick(completedSerial);
 
         if (mPendingCommands.pool != VK_NULL_HANDLE) {
             SubmitPendingCommands();
-        } else if (mCompletedSerial == mNextSerial - 1) {
+        } else if (completedSerial == GetLastSubmittedCommandSerial()) {
             // If there's no GPU work in flight we still need to artificially increment the serial
             // so that CPU operations waiting on GPU completion can know they don't have to wait.
-            mCompletedSerial++;
-            mNextSerial++;
+            AssumeCommandsComplete();
         }
     }
 
@@ -334,10 +335,6 @@ namespace dawn_native { namespace vulkan {
         return mRenderPassCache.get();
     }
 
-    Serial Device::GetSerial() const {
-        return mNextSerial;
-    }
-
     VkCommandBuffer Device::GetPendingCommandBuffer() {
         if (mPendingCommands.pool == VK_NULL_HANDLE) {
             mPendingCommands = GetUnusedCommands();
@@ -384,16 +381,19 @@ namespace dawn_native { namespace vulkan {
             ASSERT(false);
         }
 
-        mCommandsInFlight.Enqueue(mPendingCommands, mNextSerial);
+        mCommandsInFlight.Enqueue(mPendingCommands, GetPendingCommandSerial());
         mPendingCommands = CommandPoolAndBuffer();
-        mFencesInFlight.emplace(fence, mNextSerial);
+        {
+            std::lock_guard<std::mutex> lock(mFencesMutex);
+            mFencesInFlight.emplace_back(fence, GetPendingCommandSerial());
+        }
 
         for (VkSemaphore semaphore : mWaitSemaphores) {
             mDeleter->DeleteWhenUnused(semaphore);
         }
         mWaitSemaphores.clear();
 
-        mNextSerial++;
+        IncrementLastSubmittedCommandSerial();
     }
 
     void Device::AddWaitSemaphore(VkSemaphore semaphore) {
@@ -599,7 +599,39 @@ namespace dawn_native { namespace vulkan {
         return fence;
     }
 
-    void Device::CheckPassedFences() {
+    bool Device::WaitForSerialImpl(Serial serial, uint64_t timeoutNs) {
+        // Serials that aren't completed were all submitted with a fence, and the fences are in
+        // the order of their serials. The fence is marked as waited on so that it isn't reset and
+        // reused while the lock is released for the wait.
+        VkFence fence = VK_NULL_HANDLE;
+        {
+            std::lock_guard<std::mutex> lock(mFencesMutex);
+            for (const auto& fenceAndSerial : mFencesInFlight) {
+                if (fenceAndSerial.second >= serial) {
+                    fence = fenceAndSerial.first;
+                    break;
+                }
+            }
+
+            // The serial completed since the completion waiter checked it.
+            if (fence == VK_NULL_HANDLE) {
+                return true;
+            }
+            mWaitedFences.push_back(fence);
+        }
+
+        VkResult result = fn.WaitForFences(mVkDevice, 1, &fence, VK_TRUE, timeoutNs);
+        ASSERT(result == VK_SUCCESS || result == VK_TIMEOUT);
+
+        std::lock_guard<std::mutex> lock(mFencesMutex);
+        mWaitedFences.erase(std::find(mWaitedFences.begin(), mWaitedFences.end(), fence));
+        return result == VK_SUCCESS;
+    }
+
+    Serial Device::CheckAndUpdateCompletedSerials() {
+        std::lock_guard<std::mutex> lock(mFencesMutex);
+
+        Serial completedSerial = GetCompletedCommandSerial();
         while (!mFencesInFlight.empty()) {
             VkFence fence = mFencesInFlight.front().first;
             Serial fenceSerial = mFencesInFlight.front().second;
@@ -610,19 +642,32 @@ namespace dawn_native { namespace vulkan {
             // Fence are added in order, so we can stop searching as soon
             // as we see one that's not ready.
             if (result == VK_NOT_READY) {
-                return;
+                break;
+            }
+
+            mFencesToReset.push_back(fence);
+            mFencesInFlight.pop_front();
+
+            ASSERT(fenceSerial > completedSerial);
+            completedSerial = fenceSerial;
+        }
+
+        std::vector<VkFence> waitedFences;
+        for (VkFence fence : mFencesToReset) {
+            if (std::find(mWaitedFences.begin(), mWaitedFences.end(), fence) !=
+                mWaitedFences.end()) {
+                waitedFences.push_back(fence);
+                continue;
             }
 
             if (fn.ResetFences(mVkDevice, 1, &fence) != VK_SUCCESS) {
                 ASSERT(false);
             }
             mUnusedFences.push_back(fence);
-
-            mFencesInFlight.pop();
-
-            ASSERT(fenceSerial > mCompletedSerial);
-            mCompletedSerial = fenceSerial;
         }
+        mFencesToReset = std::move(waitedFences);
+
+        return completedSerial;
     }
 
     Device::CommandPoolAndBuffer Device::GetUnusedCommands() {
@@ -660,13 +705,13 @@ namespace dawn_native { namespace vulkan {
     }
 
     void Device::RecycleCompletedCommands() {
-        for (auto& commands : mCommandsInFlight.IterateUpTo(mCompletedSerial)) {
+        for (auto& commands : mCommandsInFlight.IterateUpTo(GetCompletedCommandSerial())) {
             if (fn.ResetCommandPool(mVkDevice, commands.pool, 0) != VK_SUCCESS) {
                 ASSERT(false);
             }
             mUnusedCommands.push_back(commands);
         }
-        mCommandsInFlight.ClearUpTo(mCompletedSerial);
+        mCommandsInFlight.ClearUpTo(GetCompletedCommandSerial());
     }
 
     void Device::FreeCommands(CommandPoolAndBuffer* commands) {
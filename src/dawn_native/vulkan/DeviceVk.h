@@ -25,8 +25,9 @@
 #include "dawn_native/vulkan/VulkanFunctions.h"
 #include "dawn_native/vulkan/VulkanInfo.h"
 
+#include <deque>
 #include <memory>
-#include <queue>
+#include <mutex>
 
 namespace dawn_native { namespace vulkan {
 
@@ -57,8 +58,6 @@ namespace dawn_native { namespace vulkan {
         MemoryAllocator* GetMemoryAllocator() const;
         RenderPassCache* GetRenderPassCache() const;
 
-        Serial GetSerial() const;
-
         VkCommandBuffer GetPendingCommandBuffer();
         void SubmitPendingCommands();
         void AddWaitSemaphore(VkSemaphore semaphore);
@@ -91,6 +90,8 @@ namespace dawn_native { namespace vulkan {
         ResultOrError<ShaderModuleBase*> CreateShaderModuleImpl(
             const ShaderModuleDescriptor* descriptor) override;
         ResultOrError<TextureBase*> CreateTextureImpl(const TextureDescriptor* descriptor) override;
+        Serial CheckAndUpdateCompletedSerials() override;
+        bool WaitForSerialImpl(Serial serial, uint64_t timeoutNs) override;
 
         bool CreateInstance(VulkanGlobalKnobs* usedKnobs,
                             const std::vector<const char*>& requiredExtensions);
@@ -131,16 +132,19 @@ namespace dawn_native { namespace vulkan {
         std::unique_ptr<RenderPassCache> mRenderPassCache;
 
         VkFence GetUnusedFence();
-        void CheckPassedFences();
 
-        // We track which operations are in flight on the GPU with an increasing serial.
-        // This works only because we have a single queue. Each submit to a queue is associated
-        // to a serial and a fence, such that when the fence is "ready" we know the operations
-        // have finished.
-        std::queue<std::pair<VkFence, Serial>> mFencesInFlight;
+        // The serials of the operations in flight on the GPU are tracked by DeviceBase. This
+        // works only because we have a single queue. Each submit to a queue is associated to a
+        // serial and a fence, such that when the fence is "ready" we know the operations have
+        // finished.
+        // The completion waiter calls WaitForSerialImpl without the device mutex, so the fences
+        // in flight and the fences it waits on are protected by mFencesMutex. A completed fence
+        // isn't reset while it is waited on, it stays in mFencesToReset until the wait is over.
+        std::mutex mFencesMutex;
+        std::deque<std::pair<VkFence, Serial>> mFencesInFlight;
+        std::vector<VkFence> mWaitedFences;
+        std::vector<VkFence> mFencesToReset;
         std::vector<VkFence> mUnusedFences;
-        Serial mNextSerial = 1;
-        Serial mCompletedSerial = 0;
 
         struct CommandPoolAndBuffer {
             VkCommandPool pool = VK_NULL_HANDLE;
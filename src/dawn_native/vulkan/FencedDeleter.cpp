@@ -18,156 +18,154 @@
 
 namespace dawn_native { namespace vulkan {
 
-    FencedDeleter::FencedDeleter(Device* device) : mDevice(device) {
-    }
+    namespace {
+
+        // The destroy functions of the DeferredDeletionQueue, that rebuild the Vulkan handle
+        // from its 64-bit value.
+
+        void DestroyBuffer(DeviceBase* device, uint64_t handle) {
+            Device* vkDevice = ToBackend(device);
+            VkBuffer buffer = VkBuffer::CreateFromU64(handle);
+            vkDevice->fn.DestroyBuffer(vkDevice->GetVkDevice(), buffer, nullptr);
+        }
+
+        void DestroyDescriptorPool(DeviceBase* device, uint64_t handle) {
+            Device* vkDevice = ToBackend(device);
+            VkDescriptorPool pool = VkDescriptorPool::CreateFromU64(handle);
+            vkDevice->fn.DestroyDescriptorPool(vkDevice->GetVkDevice(), pool, nullptr);
+        }
+
+        void DestroyMemory(DeviceBase* device, uint64_t handle) {
+            Device* vkDevice = ToBackend(device);
+            VkDeviceMemory memory = VkDeviceMemory::CreateFromU64(handle);
+            vkDevice->fn.FreeMemory(vkDevice->GetVkDevice(), memory, nullptr);
+        }
+
+        void DestroyFramebuffer(DeviceBase* device, uint64_t handle) {
+            Device* vkDevice = ToBackend(device);
+            VkFramebuffer framebuffer = VkFramebuffer::CreateFromU64(handle);
+            vkDevice->fn.DestroyFramebuffer(vkDevice->GetVkDevice(), framebuffer, nullptr);
+        }
+
+        void DestroyImage(DeviceBase* device, uint64_t handle) {
+            Device* vkDevice = ToBackend(device);
+            VkImage image = VkImage::CreateFromU64(handle);
+            vkDevice->fn.DestroyImage(vkDevice->GetVkDevice(), image, nullptr);
+        }
+
+        void DestroyImageView(DeviceBase* device, uint64_t handle) {
+            Device* vkDevice = ToBackend(device);
+            VkImageView view = VkImageView::CreateFromU64(handle);
+            vkDevice->fn.DestroyImageView(vkDevice->GetVkDevice(), view, nullptr);
+        }
+
+        void DestroyPipeline(DeviceBase* device, uint64_t handle) {
+            Device* vkDevice = ToBackend(device);
+            VkPipeline pipeline = VkPipeline::CreateFromU64(handle);
+            vkDevice->fn.DestroyPipeline(vkDevice->GetVkDevice(), pipeline, nullptr);
+        }
+
+        void DestroyPipelineLayout(DeviceBase* device, uint64_t handle) {
+            Device* vkDevice = ToBackend(device);
+            VkPipelineLayout layout = VkPipelineLayout::CreateFromU64(handle);
+            vkDevice->fn.DestroyPipelineLayout(vkDevice->GetVkDevice(), layout, nullptr);
+        }
+
+        void DestroyRenderPass(DeviceBase* device, uint64_t handle) {
+            Device* vkDevice = ToBackend(device);
+            VkRenderPass renderPass = VkRenderPass::CreateFromU64(handle);
+            vkDevice->fn.DestroyRenderPass(vkDevice->GetVkDevice(), renderPass, nullptr);
+        }
+
+        void DestroySampler(DeviceBase* device, uint64_t handle) {
+            Device* vkDevice = ToBackend(device);
+            VkSampler sampler = VkSampler::CreateFromU64(handle);
+            vkDevice->fn.DestroySampler(vkDevice->GetVkDevice(), sampler, nullptr);
+        }
+
+        void DestroySemaphore(DeviceBase* device, uint64_t handle) {
+            Device* vkDevice = ToBackend(device);
+            VkSemaphore semaphore = VkSemaphore::CreateFromU64(handle);
+            vkDevice->fn.DestroySemaphore(vkDevice->GetVkDevice(), semaphore, nullptr);
+        }
+
+        void DestroyShaderModule(DeviceBase* device, uint64_t handle) {
+            Device* vkDevice = ToBackend(device);
+            VkShaderModule module = VkShaderModule::CreateFromU64(handle);
+            vkDevice->fn.DestroyShaderModule(vkDevice->GetVkDevice(), module, nullptr);
+        }
+
+        void DestroySurface(DeviceBase* device, uint64_t handle) {
+            Device* vkDevice = ToBackend(device);
+            VkSurfaceKHR surface = VkSurfaceKHR::CreateFromU64(handle);
+            vkDevice->fn.DestroySurfaceKHR(vkDevice->GetInstance(), surface, nullptr);
+        }
+
+        void DestroySwapChain(DeviceBase* device, uint64_t handle) {
+            Device* vkDevice = ToBackend(device);
+            VkSwapchainKHR swapChain = VkSwapchainKHR::CreateFromU64(handle);
+            vkDevice->fn.DestroySwapchainKHR(vkDevice->GetVkDevice(), swapChain, nullptr);
+        }
 
-    FencedDeleter::~FencedDeleter() {
-        ASSERT(mBuffersToDelete.Empty());
-        ASSERT(mDescriptorPoolsToDelete.Empty());
-        ASSERT(mFramebuffersToDelete.Empty());
-        ASSERT(mImagesToDelete.Empty());
-        ASSERT(mImageViewsToDelete.Empty());
-        ASSERT(mMemoriesToDelete.Empty());
-        ASSERT(mPipelinesToDelete.Empty());
-        ASSERT(mPipelineLayoutsToDelete.Empty());
-        ASSERT(mRenderPassesToDelete.Empty());
-        ASSERT(mSamplersToDelete.Empty());
-        ASSERT(mSemaphoresToDelete.Empty());
-        ASSERT(mShaderModulesToDelete.Empty());
-        ASSERT(mSurfacesToDelete.Empty());
-        ASSERT(mSwapChainsToDelete.Empty());
+    }  // anonymous namespace
+
+    FencedDeleter::FencedDeleter(Device* device) : mDevice(device) {
     }
 
     void FencedDeleter::DeleteWhenUnused(VkBuffer buffer) {
-        mBuffersToDelete.Enqueue(buffer, mDevice->GetSerial());
+        mDevice->DeleteWhenUnused(DestroyBuffer, buffer.GetU64());
     }
 
     void FencedDeleter::DeleteWhenUnused(VkDescriptorPool pool) {
-        mDescriptorPoolsToDelete.Enqueue(pool, mDevice->GetSerial());
+        mDevice->DeleteWhenUnused(DestroyDescriptorPool, pool.GetU64());
     }
 
     void FencedDeleter::DeleteWhenUnused(VkDeviceMemory memory) {
-        mMemoriesToDelete.Enqueue(memory, mDevice->GetSerial());
+        mDevice->DeleteWhenUnused(DestroyMemory, memory.GetU64());
     }
 
     void FencedDeleter::DeleteWhenUnused(VkFramebuffer framebuffer) {
-        mFramebuffersToDelete.Enqueue(framebuffer, mDevice->GetSerial());
+        mDevice->DeleteWhenUnused(DestroyFramebuffer, framebuffer.GetU64());
     }
 
     void FencedDeleter::DeleteWhenUnused(VkImage image) {
-        mImagesToDelete.Enqueue(image, mDevice->GetSerial());
+        mDevice->DeleteWhenUnused(DestroyImage, image.GetU64());
     }
 
     void FencedDeleter::DeleteWhenUnused(VkImageView view) {
-        mImageViewsToDelete.Enqueue(view, mDevice->GetSerial());
+        mDevice->DeleteWhenUnused(DestroyImageView, view.GetU64());
     }
 
     void FencedDeleter::DeleteWhenUnused(VkPipeline pipeline) {
-        mPipelinesToDelete.Enqueue(pipeline, mDevice->GetSerial());
+        mDevice->DeleteWhenUnused(DestroyPipeline, pipeline.GetU64());
     }
 
     void FencedDeleter::DeleteWhenUnused(VkPipelineLayout layout) {
-        mPipelineLayoutsToDelete.Enqueue(layout, mDevice->GetSerial());
+        mDevice->DeleteWhenUnused(DestroyPipelineLayout, layout.GetU64());
     }
 
     void FencedDeleter::DeleteWhenUnused(VkRenderPass renderPass) {
-        mRenderPassesToDelete.Enqueue(renderPass, mDevice->GetSerial());
+        mDevice->DeleteWhenUnused(DestroyRenderPass, renderPass.GetU64());
     }
 
     void FencedDeleter::DeleteWhenUnused(VkSampler sampler) {
-        mSamplersToDelete.Enqueue(sampler, mDevice->GetSerial());
+        mDevice->DeleteWhenUnused(DestroySampler, sampler.GetU64());
     }
 
     void FencedDeleter::DeleteWhenUnused(VkSemaphore semaphore) {
-        mSemaphoresToDelete.Enqueue(semaphore, mDevice->GetSerial());
+        mDevice->DeleteWhenUnused(DestroySemaphore, semaphore.GetU64());
     }
 
     void FencedDeleter::DeleteWhenUnused(VkShaderModule module) {
-        mShaderModulesToDelete.Enqueue(module, mDevice->GetSerial());
+        mDevice->DeleteWhenUnused(DestroyShaderModule, module.GetU64());
     }
 
     void FencedDeleter::DeleteWhenUnused(VkSurfaceKHR surface) {
-        mSurfacesToDelete.Enqueue(surface, mDevice->GetSerial());
+        mDevice->DeleteWhenUnused(DestroySurface, surface.GetU64());
     }
 
     void FencedDeleter::DeleteWhenUnused(VkSwapchainKHR swapChain) {
-        mSwapChainsToDelete.Enqueue(swapChain, mDevice->GetSerial());
-    }
-
-    void FencedDeleter::Tick(Serial completedSerial) {
-        VkDevice vkDevice = mDevice->GetVkDevice();
-        VkInstance instance = mDevice->GetInstance();
-
-        // Buffers and images must be deleted before memories because it is invalid to free memory
-        // that still have resources bound to it.
-        for (VkBuffer buffer : mBuffersToDelete.IterateUpTo(completedSerial)) {
-            mDevice->fn.DestroyBuffer(vkDevice, buffer, nullptr);
-        }
-        mBuffersToDelete.ClearUpTo(completedSerial);
-        for (VkImage image : mImagesToDelete.IterateUpTo(completedSerial)) {
-            mDevice->fn.DestroyImage(vkDevice, image, nullptr);
-        }
-        mImagesToDelete.ClearUpTo(completedSerial);
-
-        for (VkDeviceMemory memory : mMemoriesToDelete.IterateUpTo(completedSerial)) {
-            mDevice->fn.FreeMemory(vkDevice, memory, nullptr);
-        }
-        mMemoriesToDelete.ClearUpTo(completedSerial);
-
-        for (VkPipelineLayout layout : mPipelineLayoutsToDelete.IterateUpTo(completedSerial)) {
-            mDevice->fn.DestroyPipelineLayout(vkDevice, layout, nullptr);
-        }
-        mPipelineLayoutsToDelete.ClearUpTo(completedSerial);
-
-        for (VkRenderPass renderPass : mRenderPassesToDelete.IterateUpTo(completedSerial)) {
-            mDevice->fn.DestroyRenderPass(vkDevice, renderPass, nullptr);
-        }
-        mRenderPassesToDelete.ClearUpTo(completedSerial);
-
-        for (VkFramebuffer framebuffer : mFramebuffersToDelete.IterateUpTo(completedSerial)) {
-            mDevice->fn.DestroyFramebuffer(vkDevice, framebuffer, nullptr);
-        }
-        mFramebuffersToDelete.ClearUpTo(completedSerial);
-
-        for (VkImageView view : mImageViewsToDelete.IterateUpTo(completedSerial)) {
-            mDevice->fn.DestroyImageView(vkDevice, view, nullptr);
-        }
-        mImageViewsToDelete.ClearUpTo(completedSerial);
-
-        for (VkShaderModule module : mShaderModulesToDelete.IterateUpTo(completedSerial)) {
-            mDevice->fn.DestroyShaderModule(vkDevice, module, nullptr);
-        }
-        mShaderModulesToDelete.ClearUpTo(completedSerial);
-
-        for (VkPipeline pipeline : mPipelinesToDelete.IterateUpTo(completedSerial)) {
-            mDevice->fn.DestroyPipeline(vkDevice, pipeline, nullptr);
-        }
-        mPipelinesToDelete.ClearUpTo(completedSerial);
-
-        // Vulkan swapchains must be destroyed before their corresponding VkSurface
-        for (VkSwapchainKHR swapChain : mSwapChainsToDelete.IterateUpTo(completedSerial)) {
-            mDevice->fn.DestroySwapchainKHR(vkDevice, swapChain, nullptr);
-        }
-        mSwapChainsToDelete.ClearUpTo(completedSerial);
-        for (VkSurfaceKHR surface : mSurfacesToDelete.IterateUpTo(completedSerial)) {
-            mDevice->fn.DestroySurfaceKHR(instance, surface, nullptr);
-        }
-        mSurfacesToDelete.ClearUpTo(completedSerial);
-
-        for (VkSemaphore semaphore : mSemaphoresToDelete.IterateUpTo(completedSerial)) {
-            mDevice->fn.DestroySemaphore(vkDevice, semaphore, nullptr);
-        }
-        mSemaphoresToDelete.ClearUpTo(completedSerial);
-
-        for (VkDescriptorPool pool : mDescriptorPoolsToDelete.IterateUpTo(completedSerial)) {
-            mDevice->fn.DestroyDescriptorPool(vkDevice, pool, nullptr);
-        }
-        mDescriptorPoolsToDelete.ClearUpTo(completedSerial);
-
-        for (VkSampler sampler : mSamplersToDelete.IterateUpTo(completedSerial)) {
-            mDevice->fn.DestroySampler(vkDevice, sampler, nullptr);
-        }
-        mSamplersToDelete.ClearUpTo(completedSerial);
+        mDevice->DeleteWhenUnused(DestroySwapChain, swapChain.GetU64());
     }
 
 }}  // namespace dawn_native::vulkan
@@ -15,17 +15,18 @@
 #ifndef DAWNNATIVE_VULKAN_FENCEDDELETER_H_
 #define DAWNNATIVE_VULKAN_FENCEDDELETER_H_
 
-#include "common/SerialQueue.h"
 #include "common/vulkan_platform.h"
 
 namespace dawn_native { namespace vulkan {
 
     class Device;
 
+    // Typed entry points to the device's DeferredDeletionQueue for the Vulkan objects. The
+    // objects are destroyed in the order they are given to DeleteWhenUnused, so resources must be
+    // given before the memory bound to them, and swapchains before their surface.
     class FencedDeleter {
       public:
         FencedDeleter(Device* device);
-        ~FencedDeleter();
 
         void DeleteWhenUnused(VkBuffer buffer);
         void DeleteWhenUnused(VkDescriptorPool pool);
@@ -33,33 +34,17 @@ namespace dawn_native { namespace vulkan {
         void DeleteWhenUnused(VkFramebuffer framebuffer);
         void DeleteWhenUnused(VkImage image);
         void DeleteWhenUnused(VkImageView view);
+        void DeleteWhenUnused(VkPipeline pipeline);
         void DeleteWhenUnused(VkPipelineLayout layout);
         void DeleteWhenUnused(VkRenderPass renderPass);
-        void DeleteWhenUnused(VkPipeline pipeline);
         void DeleteWhenUnused(VkSampler sampler);
         void DeleteWhenUnused(VkSemaphore semaphore);
         void DeleteWhenUnused(VkShaderModule module);
         void DeleteWhenUnused(VkSurfaceKHR surface);
         void DeleteWhenUnused(VkSwapchainKHR swapChain);
 
-        void Tick(Serial completedSerial);
-
       private:
         Device* mDevice = nullptr;
-        SerialQueue<VkBuffer> mBuffersToDelete;
-        SerialQueue<VkDescriptorPool> mDescriptorPoolsToDelete;
-        SerialQueue<VkDeviceMemory> mMemoriesToDelete;
-        SerialQueue<VkFramebuffer> mFramebuffersToDelete;
-        SerialQueue<VkImage> mImagesToDelete;
-        SerialQueue<VkImageView> mImageViewsToDelete;
-        SerialQueue<VkPipeline> mPipelinesToDelete;
-        SerialQueue<VkPipelineLayout> mPipelineLayoutsToDelete;
-        SerialQueue<VkRenderPass> mRenderPassesToDelete;
-        SerialQueue<VkSampler> mSamplersToDelete;
-        SerialQueue<VkSemaphore> mSemaphoresToDelete;
-        SerialQueue<VkShaderModule> mShaderModulesToDelete;
-        SerialQueue<VkSurfaceKHR> mSurfacesToDelete;
-        SerialQueue<VkSwapchainKHR> mSwapChainsToDelete;
     };
 
 }}  // namespace dawn_native::vulkan
@@ -287,12 +287,12 @@ namespace dawn_native { namespace vulkan {
         // If we own the resource, release it.
         if (mMemoryAllocation.GetMemory() != VK_NULL_HANDLE) {
             // We need to free both the memory allocation and the container. Memory should be freed
-            // after the VkImage is destroyed and this is taken care of by the FencedDeleter.
-            device->GetMemoryAllocator()->Free(&mMemoryAllocation);
-
+            // after the VkImage is destroyed so the VkImage is given to the deleter first.
             if (mHandle != VK_NULL_HANDLE) {
                 device->GetFencedDeleter()->DeleteWhenUnused(mHandle);
             }
+
+            device->GetMemoryAllocator()->Free(&mMemoryAllocation);
         }
         mHandle = VK_NULL_HANDLE;
     }
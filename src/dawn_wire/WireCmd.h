@@ -56,6 +56,24 @@ namespace dawn_wire {
         uint32_t status;
     };
 
+    // Sent when the fence reached a value the client signaled, so that the client can update its
+    // completed value and call the completion callbacks up to that value.
+    struct ReturnFenceUpdateCompletedValueCmd {
+        ReturnWireCmd commandId = ReturnWireCmd::FenceUpdateCompletedValue;
+
+        ObjectId fenceId;
+        ObjectSerial fenceSerial;
+        uint64_t value;
+    };
+
+    // The credit of the flow control: the total number of bytes of commands the server has
+    // executed since its creation.
+    struct ReturnBytesConsumedCmd {
+        ReturnWireCmd commandId = ReturnWireCmd::BytesConsumed;
+
+        uint64_t bytesConsumed;
+    };
+
     struct BufferUpdateMappedDataCmd {
         WireCmd commandId = WireCmd::BufferUpdateMappedDataCmd;
 
@@ -0,0 +1,106 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dawn_wire/WireStatistics.h"
+
+#include "dawn_wire/dawn_wire_statistics.h"
+
+#include <algorithm>
+
+namespace dawn_wire {
+
+#if defined(DAWN_WIRE_ENABLE_STATISTICS)
+    namespace {
+
+        // Statics are zero-initialized so the counters start at 0.
+        WireStatistics gStatistics;
+
+        uint64_t Load(const std::atomic<uint64_t>& statistic) {
+            return statistic.load(std::memory_order_relaxed);
+        }
+
+        void Clear(std::atomic<uint64_t>* statistic) {
+            statistic->store(0, std::memory_order_relaxed);
+        }
+
+    }  // anonymous namespace
+
+    WireStatistics* GetWireStatistics() {
+        return &gStatistics;
+    }
+#endif  // defined(DAWN_WIRE_ENABLE_STATISTICS)
+
+}  // namespace dawn_wire
+
+int dawnWireStatisticsEnabled(void) {
+#if defined(DAWN_WIRE_ENABLE_STATISTICS)
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+uint32_t dawnWireGetCommandCount(void) {
+    return static_cast<uint32_t>(dawn_wire::kWireCmdCount);
+}
+
+void dawnWireGetCommandStatistics(dawnWireCommandStatistics* statistics, uint32_t count) {
+    count = std::min(count, dawnWireGetCommandCount());
+    for (uint32_t i = 0; i < count; ++i) {
+        dawnWireCommandStatistics* out = &statistics[i];
+        *out = {};
+        out->name = dawn_wire::GetWireCmdName(static_cast<dawn_wire::WireCmd>(i));
+
+#if defined(DAWN_WIRE_ENABLE_STATISTICS)
+        const dawn_wire::CommandStatistics& command = dawn_wire::gStatistics.commands[i];
+        out->clientCount = dawn_wire::Load(command.clientCount);
+        out->clientBytes = dawn_wire::Load(command.clientBytes);
+        out->serverCount = dawn_wire::Load(command.serverCount);
+        out->serverBytes = dawn_wire::Load(command.serverBytes);
+        out->serverDeserializeNanoseconds = dawn_wire::Load(command.serverDeserializeNanoseconds);
+        out->serverExecuteNanoseconds = dawn_wire::Load(command.serverExecuteNanoseconds);
+#endif
+    }
+}
+
+void dawnWireGetMapStatistics(dawnWireMapStatistics* statistics) {
+    *statistics = {};
+
+#if defined(DAWN_WIRE_ENABLE_STATISTICS)
+    const dawn_wire::MapStatistics& maps = dawn_wire::gStatistics.maps;
+    statistics->requestCount = dawn_wire::Load(maps.requestCount);
+    statistics->replyCount = dawn_wire::Load(maps.replyCount);
+    statistics->totalLatencyNanoseconds = dawn_wire::Load(maps.totalLatencyNanoseconds);
+    statistics->maxLatencyNanoseconds = dawn_wire::Load(maps.maxLatencyNanoseconds);
+#endif
+}
+
+void dawnWireResetStatistics(void) {
+#if defined(DAWN_WIRE_ENABLE_STATISTICS)
+    for (dawn_wire::CommandStatistics& command : dawn_wire::gStatistics.commands) {
+        dawn_wire::Clear(&command.clientCount);
+        dawn_wire::Clear(&command.clientBytes);
+        dawn_wire::Clear(&command.serverCount);
+        dawn_wire::Clear(&command.serverBytes);
+        dawn_wire::Clear(&command.serverDeserializeNanoseconds);
+        dawn_wire::Clear(&command.serverExecuteNanoseconds);
+    }
+
+    dawn_wire::MapStatistics* maps = &dawn_wire::gStatistics.maps;
+    dawn_wire::Clear(&maps->requestCount);
+    dawn_wire::Clear(&maps->replyCount);
+    dawn_wire::Clear(&maps->totalLatencyNanoseconds);
+    dawn_wire::Clear(&maps->maxLatencyNanoseconds);
+#endif
+}
@@ -0,0 +1,150 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DAWNWIRE_WIRESTATISTICS_H_
+#define DAWNWIRE_WIRESTATISTICS_H_
+
+#include "dawn_wire/WireCmd.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Process-wide statistics of the wire, shared by all the clients and servers. They are only
+// collected when DAWN_WIRE_ENABLE_STATISTICS is defined, otherwise all the functions below are
+// no-ops. The counters are relaxed atomics so that the client, the server and the server's decode
+// thread can update them without synchronizing.
+namespace dawn_wire {
+
+#if defined(DAWN_WIRE_ENABLE_STATISTICS)
+
+    struct CommandStatistics {
+        std::atomic<uint64_t> clientCount;
+        std::atomic<uint64_t> clientBytes;
+        std::atomic<uint64_t> serverCount;
+        std::atomic<uint64_t> serverBytes;
+        std::atomic<uint64_t> serverDeserializeNanoseconds;
+        std::atomic<uint64_t> serverExecuteNanoseconds;
+    };
+
+    struct MapStatistics {
+        std::atomic<uint64_t> requestCount;
+        std::atomic<uint64_t> replyCount;
+        std::atomic<uint64_t> totalLatencyNanoseconds;
+        std::atomic<uint64_t> maxLatencyNanoseconds;
+    };
+
+    struct WireStatistics {
+        CommandStatistics commands[kWireCmdCount];
+        MapStatistics maps;
+    };
+
+    WireStatistics* GetWireStatistics();
+
+    inline void AddStatistic(std::atomic<uint64_t>* statistic, uint64_t value) {
+        statistic->fetch_add(value, std::memory_order_relaxed);
+    }
+
+    inline uint64_t GetStatisticsTimestamp() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now().time_since_epoch())
+                                         .count());
+    }
+
+    inline CommandStatistics* GetCommandStatistics(WireCmd command) {
+        size_t index = static_cast<size_t>(command);
+        if (index >= kWireCmdCount) {
+            return nullptr;
+        }
+        return &GetWireStatistics()->commands[index];
+    }
+
+    inline void RecordClientCommand(WireCmd command, size_t size) {
+        CommandStatistics* statistics = GetCommandStatistics(command);
+        if (statistics == nullptr) {
+            return;
+        }
+        AddStatistic(&statistics->clientCount, 1);
+        AddStatistic(&statistics->clientBytes, size);
+    }
+
+    // For data appended to a command that was already recorded.
+    inline void RecordClientCommandBytes(WireCmd command, size_t size) {
+        CommandStatistics* statistics = GetCommandStatistics(command);
+        if (statistics == nullptr) {
+            return;
+        }
+        AddStatistic(&statistics->clientBytes, size);
+    }
+
+    inline void RecordServerDeserialize(WireCmd command, size_t size, uint64_t startTime) {
+        CommandStatistics* statistics = GetCommandStatistics(command);
+        if (statistics == nullptr) {
+            return;
+        }
+        AddStatistic(&statistics->serverCount, 1);
+        AddStatistic(&statistics->serverBytes, size);
+        AddStatistic(&statistics->serverDeserializeNanoseconds,
+                     GetStatisticsTimestamp() - startTime);
+    }
+
+    inline void RecordServerExecute(WireCmd command, uint64_t startTime) {
+        CommandStatistics* statistics = GetCommandStatistics(command);
+        if (statistics == nullptr) {
+            return;
+        }
+        AddStatistic(&statistics->serverExecuteNanoseconds, GetStatisticsTimestamp() - startTime);
+    }
+
+    inline void RecordMapRequest() {
+        AddStatistic(&GetWireStatistics()->maps.requestCount, 1);
+    }
+
+    inline void RecordMapReply(uint64_t requestTime) {
+        MapStatistics* maps = &GetWireStatistics()->maps;
+        uint64_t latency = GetStatisticsTimestamp() - requestTime;
+
+        AddStatistic(&maps->replyCount, 1);
+        AddStatistic(&maps->totalLatencyNanoseconds, latency);
+
+        uint64_t maxLatency = maps->maxLatencyNanoseconds.load(std::memory_order_relaxed);
+        while (latency > maxLatency &&
+               !maps->maxLatencyNanoseconds.compare_exchange_weak(maxLatency, latency,
+                                                                  std::memory_order_relaxed)) {
+        }
+    }
+
+#else  // defined(DAWN_WIRE_ENABLE_STATISTICS)
+
+    inline uint64_t GetStatisticsTimestamp() {
+        return 0;
+    }
+    inline void RecordClientCommand(WireCmd, size_t) {
+    }
+    inline void RecordClientCommandBytes(WireCmd, size_t) {
+    }
+    inline void RecordServerDeserialize(WireCmd, size_t, uint64_t) {
+    }
+    inline void RecordServerExecute(WireCmd, uint64_t) {
+    }
+    inline void RecordMapRequest() {
+    }
+    inline void RecordMapReply(uint64_t) {
+    }
+
+#endif  // defined(DAWN_WIRE_ENABLE_STATISTICS)
+
+}  // namespace dawn_wire
+
+#endif  // DAWNWIRE_WIRESTATISTICS_H_
@@ -18,8 +18,21 @@
 #include <dawn/dawn.h>
 #include <dawn_native/dawn_native_export.h>
 
+#include <cstdint>
+
 namespace dawn_native { namespace null {
+    // Describes a simulated GPU queue that completes submissions on a background thread after a
+    // delay, instead of when they are submitted. The simulated GPU runs the submissions one after
+    // the other: each of them starts latencyNs after it is submitted, or when the previous one
+    // completes if that is later, and takes nsPerCommandBuffer for each of its command buffers.
+    // Map callbacks are then called by Device::Tick once their submissions completed.
+    struct SimulatedQueueDescriptor {
+        uint64_t latencyNs = 0;
+        uint64_t nsPerCommandBuffer = 0;
+    };
+
     DAWN_NATIVE_EXPORT dawnDevice CreateDevice();
+    DAWN_NATIVE_EXPORT dawnDevice CreateDevice(const SimulatedQueueDescriptor& queueDescriptor);
 }}  // namespace dawn_native::null
 
 #endif  // DAWNNATIVE_NULLBACKEND_H_
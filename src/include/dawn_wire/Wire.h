@@ -15,6 +15,7 @@
 #ifndef DAWNWIRE_WIRE_H_
 #define DAWNWIRE_WIRE_H_
 
+#include <cstddef>
 #include <cstdint>
 
 #include "dawn/dawn.h"
@@ -22,11 +23,28 @@
 
 namespace dawn_wire {
 
+    // A window of a serializer's buffer in which commands are written at cursor, which is then
+    // advanced past them.
+    struct CommandSpaceReservation {
+        char* cursor = nullptr;
+        char* end = nullptr;
+    };
+
     class DAWN_WIRE_EXPORT CommandSerializer {
       public:
         virtual ~CommandSerializer() = default;
         virtual void* GetCmdSpace(size_t size) = 0;
         virtual bool Flush() = 0;
+
+        // Optionally reserves at least minSize bytes so that the client can write many commands
+        // without a call to the serializer for each of them. The reservation is owned by the
+        // serializer: the bytes before its cursor are part of the commands, and the serializer
+        // ends the reservation by setting cursor and end to nullptr on its next call to
+        // GetCmdSpace, Flush or ReserveCmdSpace. Returns nullptr if reservations aren't supported.
+        virtual CommandSpaceReservation* ReserveCmdSpace(size_t minSize) {
+            (void)minSize;
+            return nullptr;
+        }
     };
 
     class DAWN_WIRE_EXPORT CommandHandler {
@@ -35,12 +53,155 @@ namespace dawn_wire {
         virtual const char* HandleCommands(const char* commands, size_t size) = 0;
     };
 
-    DAWN_WIRE_EXPORT CommandHandler* NewClientDevice(dawnProcTable* procs,
-                                                     dawnDevice* device,
-                                                     CommandSerializer* serializer);
-    DAWN_WIRE_EXPORT CommandHandler* NewServerCommandHandler(dawnDevice device,
-                                                             const dawnProcTable& procs,
-                                                             CommandSerializer* serializer);
+    // When the server calls deviceTick. Ticking is what makes the backend call map callbacks and
+    // reclaim the resources of deleted objects. Fence callbacks don't need a tick, but those the
+    // backend calls from another thread are only sent with the next batch of commands or flush.
+    enum class ServerTickPolicy {
+        // Tick before each batch of commands.
+        EveryBatch,
+        // Tick before a batch of commands if the last tick is at least tickIntervalMilliseconds old.
+        FixedInterval,
+        // Tick before a batch of commands only if there are map requests or fence signals waiting
+        // for their callback.
+        WhenPending,
+        // Never tick, the embedder calls deviceTick on the backend device itself.
+        Explicit,
+    };
+
+    // When the server flushes the serializer of its replies. With any policy other than Embedder,
+    // the replies to map requests are flushed as soon as they are written, or at the end of the
+    // tick that produced them.
+    enum class ServerReplyFlushPolicy {
+        // Never flush, the embedder flushes the serializer itself.
+        Embedder,
+        // Flush the replies at the end of each batch of commands.
+        EveryBatch,
+        // Flush the replies at the end of a batch of commands once the oldest of them is
+        // replyCoalescingWindowMicroseconds old or once replyCoalescingMaxBytes are waiting. The
+        // embedder calls ServerCommandHandler::FlushReplies when it stops sending commands.
+        CoalescingWindow,
+    };
+
+    struct ServerOptions {
+        // Batches of commands at least this large are decoded on a separate thread, ahead of
+        // the execution of the commands. Zero disables the decode thread.
+        size_t pipelinedDecodeMinBatchSize = 64 * 1024;
+
+        ServerTickPolicy tickPolicy = ServerTickPolicy::EveryBatch;
+        uint32_t tickIntervalMilliseconds = 0;
+
+        ServerReplyFlushPolicy replyFlushPolicy = ServerReplyFlushPolicy::Embedder;
+        uint32_t replyCoalescingWindowMicroseconds = 1000;
+        size_t replyCoalescingMaxBytes = 64 * 1024;
+
+        // Measure the time spent decoding and executing commands. This adds clock queries around
+        // each command so it is meant for profiling only.
+        bool collectTimings = false;
+
+        // Reply with the number of bytes of commands consumed after each batch, including the
+        // batches that fail, for the flow control of the client. These replies are flushed at the
+        // end of the batch like map replies so that a client waiting for them isn't stalled by the
+        // coalescing window.
+        bool reportConsumedBytes = false;
+    };
+
+    // Counters since the creation of the server, to compare how often it ticks with how often it
+    // receives commands.
+    struct ServerCounters {
+        uint64_t batchCount = 0;
+        uint64_t tickCount = 0;
+        uint64_t pendingMapRequestCount = 0;
+        uint64_t pendingFenceCompletionCount = 0;
+        uint64_t replyFlushCount = 0;
+        uint64_t consumedBytes = 0;
+
+        // Only updated when ServerOptions::collectTimings is set. With the decode thread, decoding
+        // overlaps with the execution of the commands.
+        uint64_t decodeNanoseconds = 0;
+        uint64_t executeNanoseconds = 0;
+    };
+
+    class DAWN_WIRE_EXPORT ServerCommandHandler : public CommandHandler {
+      public:
+        virtual ServerCounters GetCounters() const = 0;
+
+        // Flushes the replies written since the last flush, whatever the reply flush policy, with
+        // the fence completions the backend reported from another thread.
+        virtual void FlushReplies() = 0;
+    };
+
+    // A server for several clients sharing one device. Each client has its own namespace of object
+    // IDs. Their commands are queued and only executed in Tick, in round robin between the clients.
+    class DAWN_WIRE_EXPORT MultiClientServer {
+      public:
+        // Releases the objects of all the clients, then blocks until the device called the
+        // callbacks of their map requests and fence signals.
+        virtual ~MultiClientServer() = default;
+
+        // Adds a client that writes its commands in the returned handler and receives its replies
+        // in serializer. Each tick, the client can execute commandBytesPerTick bytes of commands.
+        // Batches of commands aren't split so a batch can go over the quota, the excess is then
+        // taken from the next ticks.
+        virtual CommandHandler* AddClient(CommandSerializer* serializer,
+                                          size_t commandBytesPerTick) = 0;
+        // Drops the queued commands of the client. The handler must not receive commands anymore.
+        // The objects the client didn't destroy are released in the next Tick.
+        virtual void RemoveClient(CommandHandler* client) = 0;
+
+        // Ticks the device and executes the queued commands within the quota of each client.
+        // Returns the number of bytes of commands executed.
+        virtual size_t Tick() = 0;
+
+        virtual size_t GetClientQueuedBytes(const CommandHandler* client) const = 0;
+        virtual ServerCounters GetClientCounters(const CommandHandler* client) const = 0;
+    };
+
+    struct ClientOptions {
+        // Decode the replies of the server on a separate thread. Their callbacks are then called
+        // only in ClientCommandHandler::DeliverCallbacks, at a point chosen by the application.
+        bool replyThread = false;
+
+        // Credit-based flow control: at most flowControlWindowBytes bytes of commands are in
+        // flight, serialized but not yet consumed by the server, which must be created with
+        // ServerOptions::reportConsumedBytes. Zero disables the flow control.
+        size_t flowControlWindowBytes = 0;
+        // Block in the API calls, after flushing the serializer, until the server consumed enough
+        // commands. Otherwise the calls never block and the application polls
+        // ClientCommandHandler::WouldBlock to throttle itself. Blocking requires the reply thread
+        // since the credit is received while the application thread is blocked.
+        bool flowControlBlocks = false;
+    };
+
+    class DAWN_WIRE_EXPORT ClientCommandHandler : public CommandHandler {
+      public:
+        // With the reply thread, calls the callbacks of all the replies received before the call.
+        // Returns false if the server sent invalid replies. Without the reply thread, callbacks are
+        // called in HandleCommands directly and this does nothing.
+        virtual bool DeliverCallbacks() = 0;
+
+        // The depth of the queue between the client and the server: the number of bytes of
+        // commands serialized but not yet reported consumed by the server.
+        virtual uint64_t GetInFlightBytes() const = 0;
+        // Whether more commands would go over the flow control window.
+        virtual bool WouldBlock() const = 0;
+    };
+
+    DAWN_WIRE_EXPORT ClientCommandHandler* NewClientDevice(
+        dawnProcTable* procs,
+        dawnDevice* device,
+        CommandSerializer* serializer,
+        const ClientOptions& options = ClientOptions());
+    DAWN_WIRE_EXPORT ServerCommandHandler* NewServerCommandHandler(
+        dawnDevice device,
+        const dawnProcTable& procs,
+        CommandSerializer* serializer,
+        const ServerOptions& options = ServerOptions());
+
+    // The tick policy of the client options is ignored, the device is ticked in Tick instead.
+    DAWN_WIRE_EXPORT MultiClientServer* NewMultiClientServer(
+        dawnDevice device,
+        const dawnProcTable& procs,
+        const ServerOptions& clientOptions = ServerOptions());
 
 }  // namespace dawn_wire
 
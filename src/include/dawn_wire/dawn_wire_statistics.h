@@ -0,0 +1,67 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DAWNWIRE_DAWN_WIRE_STATISTICS_H_
+#define DAWNWIRE_DAWN_WIRE_STATISTICS_H_
+
+#include "dawn_wire/dawn_wire_export.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Statistics of a single wire command, indexed by its WireCmd value. The client counts the
+// commands it serializes and the server the commands it receives, both over the whole process.
+typedef struct {
+    const char* name;
+    uint64_t clientCount;
+    uint64_t clientBytes;
+    uint64_t serverCount;
+    uint64_t serverBytes;
+    uint64_t serverDeserializeNanoseconds;
+    uint64_t serverExecuteNanoseconds;
+} dawnWireCommandStatistics;
+
+// Statistics of the buffer map requests, the latency is measured on the client from the
+// MapReadAsync or MapWriteAsync call to the call of the callback.
+typedef struct {
+    uint64_t requestCount;
+    uint64_t replyCount;
+    uint64_t totalLatencyNanoseconds;
+    uint64_t maxLatencyNanoseconds;
+} dawnWireMapStatistics;
+
+// Returns 1 if the wire was built with DAWN_WIRE_ENABLE_STATISTICS, otherwise the statistics
+// are always 0.
+DAWN_WIRE_EXPORT int dawnWireStatisticsEnabled(void);
+
+// Returns the number of wire commands, which is the size of the array to give to
+// dawnWireGetCommandStatistics.
+DAWN_WIRE_EXPORT uint32_t dawnWireGetCommandCount(void);
+
+// Copies the statistics of the first `count` commands. The counters are read one at a time while
+// the wire keeps running so the snapshot isn't atomic as a whole.
+DAWN_WIRE_EXPORT void dawnWireGetCommandStatistics(dawnWireCommandStatistics* statistics,
+                                                   uint32_t count);
+DAWN_WIRE_EXPORT void dawnWireGetMapStatistics(dawnWireMapStatistics* statistics);
+
+DAWN_WIRE_EXPORT void dawnWireResetStatistics(void);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // DAWNWIRE_DAWN_WIRE_STATISTICS_H_
@@ -35,6 +35,8 @@ namespace {
                 return utils::BackendType::D3D12;
             case MetalBackend:
                 return utils::BackendType::Metal;
+            case NullBackend:
+                return utils::BackendType::Null;
             case OpenGLBackend:
                 return utils::BackendType::OpenGL;
             case VulkanBackend:
@@ -50,6 +52,8 @@ namespace {
                 return "D3D12";
             case MetalBackend:
                 return "Metal";
+            case NullBackend:
+                return "Null";
             case OpenGLBackend:
                 return "OpenGL";
             case VulkanBackend:
@@ -117,6 +121,10 @@ bool DawnTest::IsMetal() const {
     return GetParam() == MetalBackend;
 }
 
+bool DawnTest::IsNull() const {
+    return GetParam() == NullBackend;
+}
+
 bool DawnTest::IsOpenGL() const {
     return GetParam() == OpenGLBackend;
 }
@@ -131,10 +139,13 @@ void DawnTest::SetUp() {
     mBinding.reset(utils::CreateBinding(ParamToBackendType(GetParam())));
     DAWN_ASSERT(mBinding != nullptr);
 
-    GLFWwindow* testWindow = GetWindowForBackend(mBinding.get(), GetParam());
-    DAWN_ASSERT(testWindow != nullptr);
+    // The null backend doesn't present anything so it runs without a window, on headless bots.
+    if (GetParam() != NullBackend) {
+        GLFWwindow* testWindow = GetWindowForBackend(mBinding.get(), GetParam());
+        DAWN_ASSERT(testWindow != nullptr);
 
-    mBinding->SetWindow(testWindow);
+        mBinding->SetWindow(testWindow);
+    }
 
     dawnDevice backendDevice = mBinding->CreateDevice();
     dawnProcTable backendProcs = dawn_native::GetProcs();
@@ -269,10 +280,16 @@ std::ostringstream& DawnTest::AddTextureExpectation(const char* file,
 }
 
 void DawnTest::WaitABit() {
-    device.Tick();
+    // Block until the GPU is done with the submitted work instead of polling for it. The timeout
+    // bounds the wait so that the loops calling this keep making progress.
+    constexpr uint64_t kWaitTimeoutNs = 10 * 1000 * 1000;
+    device.WaitForIdle(kWaitTimeoutNs);
     FlushWire();
 
-    utils::USleep(100);
+    // The wire server ignores the timeout and only ticks the device, so sleep to avoid spinning.
+    if (gTestUsesWire) {
+        utils::USleep(100);
+    }
 }
 
 void DawnTest::SwapBuffersForCapture() {
@@ -408,6 +425,9 @@ namespace detail {
 #if defined(DAWN_ENABLE_BACKEND_METAL)
             case MetalBackend:
 #endif
+#if defined(DAWN_ENABLE_BACKEND_NULL)
+            case NullBackend:
+#endif
 #if defined(DAWN_ENABLE_BACKEND_OPENGL)
             case OpenGLBackend:
 #endif
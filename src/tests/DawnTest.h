@@ -58,6 +58,7 @@ std::ostream& operator<<(std::ostream& stream, const RGBA8& color);
 enum BackendType {
     D3D12Backend,
     MetalBackend,
+    NullBackend,
     OpenGLBackend,
     VulkanBackend,
     NumBackendTypes,
@@ -87,6 +88,7 @@ class DawnTest : public ::testing::TestWithParam<BackendType> {
 
     bool IsD3D12() const;
     bool IsMetal() const;
+    bool IsNull() const;
     bool IsOpenGL() const;
     bool IsVulkan() const;
 
@@ -911,4 +911,9 @@ TEST_P(BlendStateTest, DefaultBlendColor) {
     }
 }
 
-DAWN_INSTANTIATE_TEST(BlendStateTest, D3D12Backend, MetalBackend, OpenGLBackend, VulkanBackend)
+DAWN_INSTANTIATE_TEST(BlendStateTest,
+                     D3D12Backend,
+                     MetalBackend,
+                     NullBackend,
+                     OpenGLBackend,
+                     VulkanBackend)
@@ -109,7 +109,12 @@ TEST_P(BufferMapReadTests, LargeRead) {
     buffer.Unmap();
 }
 
-DAWN_INSTANTIATE_TEST(BufferMapReadTests, D3D12Backend, MetalBackend, OpenGLBackend, VulkanBackend)
+DAWN_INSTANTIATE_TEST(BufferMapReadTests,
+                     D3D12Backend,
+                     MetalBackend,
+                     NullBackend,
+                     OpenGLBackend,
+                     VulkanBackend)
 
 class BufferMapWriteTests : public DawnTest {
     protected:
@@ -186,7 +191,12 @@ TEST_P(BufferMapWriteTests, LargeWrite) {
     EXPECT_BUFFER_U32_RANGE_EQ(myData.data(), buffer, 0, kDataSize);
 }
 
-DAWN_INSTANTIATE_TEST(BufferMapWriteTests, D3D12Backend, MetalBackend, OpenGLBackend, VulkanBackend)
+DAWN_INSTANTIATE_TEST(BufferMapWriteTests,
+                     D3D12Backend,
+                     MetalBackend,
+                     NullBackend,
+                     OpenGLBackend,
+                     VulkanBackend)
 
 class BufferSetSubDataTests : public DawnTest {
 };
@@ -262,5 +272,6 @@ TEST_P(BufferSetSubDataTests, LargeSetSubData) {
 DAWN_INSTANTIATE_TEST(BufferSetSubDataTests,
                      D3D12Backend,
                      MetalBackend,
+                     NullBackend,
                      OpenGLBackend,
                      VulkanBackend)
@@ -382,7 +382,12 @@ TEST_P(CopyTests_T2B, Texture2DArrayMip) {
     }
 }
 
-DAWN_INSTANTIATE_TEST(CopyTests_T2B, D3D12Backend, MetalBackend, OpenGLBackend, VulkanBackend)
+DAWN_INSTANTIATE_TEST(CopyTests_T2B,
+                     D3D12Backend,
+                     MetalBackend,
+                     NullBackend,
+                     OpenGLBackend,
+                     VulkanBackend)
 
 // Test that copying an entire texture with 256-byte aligned dimensions works
 TEST_P(CopyTests_B2T, FullTextureAligned) {
@@ -525,4 +530,9 @@ TEST_P(CopyTests_B2T, RowPitchUnaligned) {
     }
 }
 
-DAWN_INSTANTIATE_TEST(CopyTests_B2T, D3D12Backend, MetalBackend, OpenGLBackend, VulkanBackend)
+DAWN_INSTANTIATE_TEST(CopyTests_B2T,
+                     D3D12Backend,
+                     MetalBackend,
+                     NullBackend,
+                     OpenGLBackend,
+                     VulkanBackend)
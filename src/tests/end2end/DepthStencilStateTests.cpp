@@ -513,5 +513,6 @@ TEST_P(DepthStencilStateTest, StencilDepthPass) {
 DAWN_INSTANTIATE_TEST(DepthStencilStateTest,
                      D3D12Backend,
                      MetalBackend,
+                     NullBackend,
                      OpenGLBackend,
                      VulkanBackend)
@@ -0,0 +1,133 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tests/DawnTest.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+// The userdata of the completion callbacks, in the order they were called. The callbacks can be
+// called from a thread of the device.
+static std::mutex gCompletionsMutex;
+static std::vector<uint64_t> gCompletions;
+
+static void OnCompletion(dawnFenceCompletionStatus status, dawnCallbackUserdata userdata) {
+    ASSERT_EQ(DAWN_FENCE_COMPLETION_STATUS_SUCCESS, status);
+    std::lock_guard<std::mutex> lock(gCompletionsMutex);
+    gCompletions.push_back(userdata);
+}
+
+static std::vector<uint64_t> GetCompletions() {
+    std::lock_guard<std::mutex> lock(gCompletionsMutex);
+    return gCompletions;
+}
+
+class FenceTests : public DawnTest {
+    protected:
+        void SetUp() override {
+            DawnTest::SetUp();
+            std::lock_guard<std::mutex> lock(gCompletionsMutex);
+            gCompletions.clear();
+        }
+
+        dawn::Fence CreateFence(uint64_t initialValue) {
+            dawn::FenceDescriptor descriptor;
+            descriptor.initialValue = initialValue;
+
+            return queue.CreateFence(&descriptor);
+        }
+
+        void WaitForCompletedValue(const dawn::Fence& fence, uint64_t value) {
+            while (fence.GetCompletedValue() < value) {
+                WaitABit();
+            }
+        }
+};
+
+// Test that the completed value of the fence reaches the signaled value
+TEST_P(FenceTests, SimpleSignal) {
+    dawn::Fence fence = CreateFence(1);
+    EXPECT_EQ(1u, fence.GetCompletedValue());
+
+    queue.Signal(fence, 2);
+    WaitForCompletedValue(fence, 2);
+    EXPECT_EQ(2u, fence.GetCompletedValue());
+}
+
+// Test that the signal completes after the commands submitted before it, so the data of a copy
+// can be read back once the fence reached the value
+TEST_P(FenceTests, SignalAfterSubmit) {
+    dawn::BufferDescriptor descriptor;
+    descriptor.size = 4;
+    descriptor.usage = dawn::BufferUsageBit::TransferSrc | dawn::BufferUsageBit::TransferDst;
+    dawn::Buffer source = device.CreateBuffer(&descriptor);
+    dawn::Buffer destination = device.CreateBuffer(&descriptor);
+
+    uint32_t value = 0x01020304;
+    source.SetSubData(0, sizeof(value), reinterpret_cast<const uint8_t*>(&value));
+
+    dawn::CommandBuffer commands = device.CreateCommandBufferBuilder()
+        .CopyBufferToBuffer(source, 0, destination, 0, sizeof(value))
+        .GetResult();
+
+    dawn::Fence fence = CreateFence(0);
+    queue.Submit(1, &commands);
+    queue.Signal(fence, 1);
+    WaitForCompletedValue(fence, 1);
+
+    EXPECT_BUFFER_U32_EQ(value, destination, 0);
+}
+
+// Test that the completion callbacks are called for all the values. The signals can complete
+// before OnCompletion is called, so the order of the callbacks is only checked with the simulated
+// queue of the null backend.
+TEST_P(FenceTests, OnCompletionForAllValues) {
+    dawn::Fence fence = CreateFence(0);
+
+    queue.Signal(fence, 1);
+    queue.Signal(fence, 2);
+    queue.Signal(fence, 3);
+
+    fence.OnCompletion(3u, OnCompletion, 3);
+    fence.OnCompletion(1u, OnCompletion, 1);
+    fence.OnCompletion(2u, OnCompletion, 2);
+
+    WaitForCompletedValue(fence, 3);
+    // The callbacks can be called after the completed value was observed, and with the wire they
+    // are only received once the server replies.
+    while (GetCompletions().size() < 3) {
+        WaitABit();
+    }
+
+    std::vector<uint64_t> completions = GetCompletions();
+    std::sort(completions.begin(), completions.end());
+    EXPECT_EQ((std::vector<uint64_t>{1, 2, 3}), completions);
+}
+
+// Test that OnCompletion for a completed value calls the callback immediately
+TEST_P(FenceTests, OnCompletionForCompletedValue) {
+    dawn::Fence fence = CreateFence(1);
+
+    fence.OnCompletion(0u, OnCompletion, 0);
+    fence.OnCompletion(1u, OnCompletion, 1);
+    EXPECT_EQ((std::vector<uint64_t>{0, 1}), GetCompletions());
+}
+
+DAWN_INSTANTIATE_TEST(FenceTests,
+                     D3D12Backend,
+                     MetalBackend,
+                     NullBackend,
+                     OpenGLBackend,
+                     VulkanBackend)
@@ -0,0 +1,319 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "dawn_native/DawnNative.h"
+#include "dawn_native/NullBackend.h"
+#include "dawn_wire/Wire.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace {
+
+    // Serializes the commands in a buffer that the handler reads in place on Flush, like a
+    // shared memory ring buffer between two processes would.
+    class InProcessTransport : public dawn_wire::CommandSerializer {
+      public:
+        InProcessTransport() : mBuffer(kBufferSize) {
+        }
+
+        void SetHandler(dawn_wire::CommandHandler* handler) {
+            mHandler = handler;
+        }
+
+        void* GetCmdSpace(size_t size) override {
+            EndReservation();
+
+            if (size > mBuffer.size()) {
+                return nullptr;
+            }
+
+            if (mOffset + size > mBuffer.size()) {
+                if (!Flush()) {
+                    return nullptr;
+                }
+            }
+
+            char* result = &mBuffer[mOffset];
+            mOffset += size;
+            return result;
+        }
+
+        bool Flush() override {
+            EndReservation();
+
+            bool success = mHandler->HandleCommands(mBuffer.data(), mOffset) != nullptr;
+            mOffset = 0;
+            return success;
+        }
+
+        dawn_wire::CommandSpaceReservation* ReserveCmdSpace(size_t minSize) override {
+            EndReservation();
+
+            if (minSize > mBuffer.size()) {
+                return nullptr;
+            }
+            if (minSize > mBuffer.size() - mOffset && !Flush()) {
+                return nullptr;
+            }
+
+            mReservation.cursor = &mBuffer[mOffset];
+            mReservation.end = mBuffer.data() + mBuffer.size();
+            return &mReservation;
+        }
+
+      private:
+        void EndReservation() {
+            if (mReservation.cursor != nullptr) {
+                mOffset = static_cast<size_t>(mReservation.cursor - mBuffer.data());
+                mReservation.cursor = nullptr;
+                mReservation.end = nullptr;
+            }
+        }
+
+        // Large enough for a whole frame so that the frames are never split in several batches.
+        static constexpr size_t kBufferSize = 4 * 1024 * 1024;
+
+        std::vector<char> mBuffer;
+        size_t mOffset = 0;
+        dawn_wire::CommandSpaceReservation mReservation;
+        dawn_wire::CommandHandler* mHandler = nullptr;
+    };
+
+    constexpr uint32_t kCopiesPerFrame = 10000;
+    constexpr uint32_t kObjectsPerFrame = 10000;
+    constexpr uint32_t kMapRoundTrips = 1000;
+    constexpr size_t kFrameCount = 20;
+
+    double ElapsedNanoseconds(std::chrono::steady_clock::time_point start) {
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+
+    void OnDeviceError(const char* message, dawnCallbackUserdata) {
+        FAIL() << "Unexpected device error: " << message;
+    }
+
+    void Report(const char* name, double nanosecondsPerItem, const char* item) {
+        printf("%-32s %10.1f ns/%s\n", name, nanosecondsPerItem, item);
+    }
+
+}  // anonymous namespace
+
+// Runs the client and server in the same process on top of the null backend, so that the numbers
+// are the cost of the wire and the frontend validation only.
+class WireClientServerPerfTests : public testing::Test {
+  protected:
+    void SetUp() override {
+        mNativeProcs = dawn_native::GetProcs();
+        mBackendDevice = dawn_native::null::CreateDevice();
+
+        // The commands are decoded on the same thread so that the decode time can be measured per
+        // command, and the replies are flushed as soon as a batch is done to time map round trips.
+        dawn_wire::ServerOptions options;
+        options.pipelinedDecodeMinBatchSize = 0;
+        options.replyFlushPolicy = dawn_wire::ServerReplyFlushPolicy::EveryBatch;
+        options.collectTimings = true;
+
+        mWireServer.reset(dawn_wire::NewServerCommandHandler(mBackendDevice, mNativeProcs,
+                                                             &mServerToClient, options));
+        mClientToServer.SetHandler(mWireServer.get());
+
+        mWireClient.reset(dawn_wire::NewClientDevice(&procs, &device, &mClientToServer));
+        mServerToClient.SetHandler(mWireClient.get());
+
+        queue = procs.deviceCreateQueue(device);
+
+        // The benchmarks must measure the valid path, not how fast errors skip the commands.
+        procs.deviceSetErrorCallback(device, OnDeviceError, 0);
+    }
+
+    void TearDown() override {
+        procs.queueRelease(queue);
+        FlushClient();
+
+        mWireClient = nullptr;
+        mWireServer = nullptr;
+        mNativeProcs.deviceRelease(mBackendDevice);
+    }
+
+    void FlushClient() {
+        ASSERT_TRUE(mClientToServer.Flush());
+    }
+
+    dawnBuffer CreateBuffer(dawnBufferUsageBit usage, uint32_t size) {
+        dawnBufferDescriptor descriptor;
+        descriptor.nextInChain = nullptr;
+        descriptor.usage = usage;
+        descriptor.size = size;
+        return procs.deviceCreateBuffer(device, &descriptor);
+    }
+
+    // Records a command buffer made of kCopiesPerFrame copies and submits it.
+    void RecordCopyFrame(dawnBuffer source, dawnBuffer destination) {
+        dawnCommandBufferBuilder builder = procs.deviceCreateCommandBufferBuilder(device);
+        for (uint32_t i = 0; i < kCopiesPerFrame; ++i) {
+            procs.commandBufferBuilderCopyBufferToBuffer(builder, source, (i % 16) * 4,
+                                                         destination, (i % 15) * 4, 4);
+        }
+        dawnCommandBuffer commands = procs.commandBufferBuilderGetResult(builder);
+        procs.queueSubmit(queue, 1, &commands);
+
+        procs.commandBufferRelease(commands);
+        procs.commandBufferBuilderRelease(builder);
+    }
+
+    dawnProcTable procs;
+    dawnDevice device;
+    dawnQueue queue;
+
+    std::unique_ptr<dawn_wire::ServerCommandHandler> mWireServer;
+
+  private:
+    dawnProcTable mNativeProcs;
+    dawnDevice mBackendDevice;
+
+    InProcessTransport mClientToServer;
+    InProcessTransport mServerToClient;
+    std::unique_ptr<dawn_wire::ClientCommandHandler> mWireClient;
+};
+
+// Time the client calls, that compute the size of the commands and serialize them.
+TEST_F(WireClientServerPerfTests, ClientSerialize) {
+    dawnBuffer source = CreateBuffer(DAWN_BUFFER_USAGE_BIT_TRANSFER_SRC, 64);
+    dawnBuffer destination = CreateBuffer(DAWN_BUFFER_USAGE_BIT_TRANSFER_DST, 64);
+
+    double clientNanoseconds = 0;
+    for (size_t i = 0; i < kFrameCount; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        RecordCopyFrame(source, destination);
+        clientNanoseconds += ElapsedNanoseconds(start);
+
+        FlushClient();
+    }
+
+    Report("client serialize", clientNanoseconds / (kFrameCount * kCopiesPerFrame), "copy");
+
+    procs.bufferRelease(source);
+    procs.bufferRelease(destination);
+}
+
+// Time the server, split between the deserialization of the commands in its ServerAllocator and
+// their execution on the null backend.
+TEST_F(WireClientServerPerfTests, ServerDeserialize) {
+    dawnBuffer source = CreateBuffer(DAWN_BUFFER_USAGE_BIT_TRANSFER_SRC, 64);
+    dawnBuffer destination = CreateBuffer(DAWN_BUFFER_USAGE_BIT_TRANSFER_DST, 64);
+    FlushClient();
+
+    dawn_wire::ServerCounters before = mWireServer->GetCounters();
+    double serverNanoseconds = 0;
+    for (size_t i = 0; i < kFrameCount; ++i) {
+        RecordCopyFrame(source, destination);
+
+        auto start = std::chrono::steady_clock::now();
+        FlushClient();
+        serverNanoseconds += ElapsedNanoseconds(start);
+    }
+    dawn_wire::ServerCounters after = mWireServer->GetCounters();
+
+    double copyCount = kFrameCount * kCopiesPerFrame;
+    Report("server deserialize", (after.decodeNanoseconds - before.decodeNanoseconds) / copyCount,
+           "copy");
+    Report("server execute", (after.executeNanoseconds - before.executeNanoseconds) / copyCount,
+           "copy");
+    Report("server total", serverNanoseconds / copyCount, "copy");
+
+    procs.bufferRelease(source);
+    procs.bufferRelease(destination);
+}
+
+// Time the creation and destruction of objects, that allocate and free IDs on both sides.
+TEST_F(WireClientServerPerfTests, ObjectChurn) {
+    std::vector<dawnBuffer> buffers(kObjectsPerFrame);
+
+    double clientNanoseconds = 0;
+    double serverNanoseconds = 0;
+    for (size_t i = 0; i < kFrameCount; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        for (dawnBuffer& buffer : buffers) {
+            buffer = CreateBuffer(DAWN_BUFFER_USAGE_BIT_UNIFORM, 256);
+        }
+        // Release in the reverse order to reuse the IDs in the same order for each frame.
+        for (auto it = buffers.rbegin(); it != buffers.rend(); ++it) {
+            procs.bufferRelease(*it);
+        }
+        clientNanoseconds += ElapsedNanoseconds(start);
+
+        start = std::chrono::steady_clock::now();
+        FlushClient();
+        serverNanoseconds += ElapsedNanoseconds(start);
+    }
+
+    double objectCount = kFrameCount * kObjectsPerFrame;
+    Report("client create + release", clientNanoseconds / objectCount, "object");
+    Report("server create + release", serverNanoseconds / objectCount, "object");
+}
+
+// Time the round trip of a map request, from the MapReadAsync call to its callback.
+TEST_F(WireClientServerPerfTests, MapReadRoundTrip) {
+    dawnBuffer buffer = CreateBuffer(DAWN_BUFFER_USAGE_BIT_MAP_READ, 256);
+
+    struct MapResult {
+        uint32_t callbackCount = 0;
+        dawnBufferMapAsyncStatus status = DAWN_BUFFER_MAP_ASYNC_STATUS_UNKNOWN;
+    };
+    MapResult result;
+    auto callback = [](dawnBufferMapAsyncStatus status, const void*,
+                       dawnCallbackUserdata userdata) {
+        MapResult* result = reinterpret_cast<MapResult*>(static_cast<uintptr_t>(userdata));
+        result->callbackCount++;
+        result->status = status;
+    };
+    dawnCallbackUserdata userdata =
+        static_cast<dawnCallbackUserdata>(reinterpret_cast<uintptr_t>(&result));
+
+    std::vector<double> roundTrips;
+    roundTrips.reserve(kMapRoundTrips);
+    for (uint32_t i = 0; i < kMapRoundTrips; ++i) {
+        auto start = std::chrono::steady_clock::now();
+
+        // The null backend completes the map requests on the next submit.
+        procs.bufferMapReadAsync(buffer, 0, 256, callback, userdata);
+        procs.queueSubmit(queue, 0, nullptr);
+        FlushClient();
+
+        roundTrips.push_back(ElapsedNanoseconds(start));
+        ASSERT_EQ(result.callbackCount, i + 1);
+        ASSERT_EQ(result.status, DAWN_BUFFER_MAP_ASYNC_STATUS_SUCCESS);
+
+        procs.bufferUnmap(buffer);
+    }
+
+    std::sort(roundTrips.begin(), roundTrips.end());
+    double total = 0;
+    for (double roundTrip : roundTrips) {
+        total += roundTrip;
+    }
+    Report("map read round trip (mean)", total / kMapRoundTrips, "map");
+    Report("map read round trip (median)", roundTrips[kMapRoundTrips / 2], "map");
+    Report("map read round trip (p99)", roundTrips[kMapRoundTrips * 99 / 100], "map");
+
+    procs.bufferRelease(buffer);
+}
@@ -0,0 +1,420 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "dawn_wire/WireCmd.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace dawn_wire;
+
+namespace {
+
+    // The benchmark never dereferences objects so it uses handles whose value is the ID.
+    template <typename T>
+    T HandleForId(ObjectId id) {
+        return reinterpret_cast<T>(static_cast<uintptr_t>(id));
+    }
+
+    class HandleIdProvider : public ObjectIdProvider {
+      public:
+#define GET_ID(Type)                                                 \
+    ObjectId GetId(Type object) const override {                     \
+        return static_cast<ObjectId>(reinterpret_cast<uintptr_t>(object)); \
+    }
+        DAWN_WIRE_FOREACH_OBJECT_TYPE(GET_ID)
+#undef GET_ID
+    };
+
+    class HandleIdResolver : public ObjectIdResolver {
+      public:
+#define GET_FROM_ID(Type)                                              \
+    DeserializeResult GetFromId(ObjectId id, Type* out) const override { \
+        *out = HandleForId<Type>(id);                                  \
+        return DeserializeResult::Success;                             \
+    }
+        DAWN_WIRE_FOREACH_OBJECT_TYPE(GET_FROM_ID)
+#undef GET_FROM_ID
+    };
+
+    // Scratch space for the deserialization of a single command, like the server's allocator.
+    class ScratchAllocator : public DeserializeAllocator {
+      public:
+        void* GetSpace(size_t size) override {
+            size_t alignedOffset = (mOffset + 7) & ~size_t(7);
+            if (alignedOffset + size > sizeof(mScratch)) {
+                return nullptr;
+            }
+            mOffset = alignedOffset + size;
+            return &mScratch[alignedOffset];
+        }
+
+        void Reset() {
+            mOffset = 0;
+        }
+
+      private:
+        alignas(8) char mScratch[4096];
+        size_t mOffset = 0;
+    };
+
+    constexpr ObjectId kDeviceId = 1;
+    constexpr ObjectId kQueueId = 2;
+    constexpr ObjectId kBuilderId = 3;
+    constexpr ObjectId kRenderPassId = 4;
+    constexpr ObjectId kPipelineId = 5;
+    constexpr ObjectId kCommandBufferId = 6;
+
+    // The number of draws per frame in the Animometer sample
+    constexpr uint32_t kDrawsPerFrame = 10000;
+    constexpr uint32_t kPushConstantCount = 6;
+    constexpr size_t kDecodeIterations = 20;
+
+    // Records the commands of a frame in both encodings.
+    class FrameRecorder {
+      public:
+        FrameRecorder(bool deltaObjectIds) {
+#if defined(DAWN_WIRE_COMPACT_ENCODING)
+            mCompactState.deltaObjectIds = deltaObjectIds;
+#else
+            (void)deltaObjectIds;
+#endif
+        }
+
+        template <typename Cmd>
+        void Append(const Cmd& cmd) {
+            size_t offset = mFixed.size();
+            mFixed.resize(offset + cmd.GetRequiredSize());
+            cmd.Serialize(&mFixed[offset], mProvider);
+
+#if defined(DAWN_WIRE_COMPACT_ENCODING)
+            offset = mCompact.size();
+            mCompact.resize(offset + cmd.GetRequiredCompactSize(mProvider, mCompactState));
+            cmd.SerializeCompact(&mCompact[offset], mProvider, &mCompactState);
+#endif
+        }
+
+        const std::vector<char>& GetFixed() const {
+            return mFixed;
+        }
+        const std::vector<char>& GetCompact() const {
+            return mCompact;
+        }
+
+      private:
+        HandleIdProvider mProvider;
+        std::vector<char> mFixed;
+        std::vector<char> mCompact;
+#if defined(DAWN_WIRE_COMPACT_ENCODING)
+        CompactEncodingState mCompactState;
+#endif
+    };
+
+    // Records a frame similar to the one of the Animometer sample: a single render pass with
+    // a lot of SetPushConstants + DrawArrays.
+    void RecordAnimometerFrame(FrameRecorder* recorder) {
+        dawnCommandBufferBuilder builder = HandleForId<dawnCommandBufferBuilder>(kBuilderId);
+
+        {
+            DeviceCreateCommandBufferBuilderCmd cmd;
+            cmd.self = HandleForId<dawnDevice>(kDeviceId);
+            cmd.resultId = kBuilderId;
+            cmd.resultSerial = 1;
+            recorder->Append(cmd);
+        }
+        {
+            CommandBufferBuilderBeginRenderPassCmd cmd;
+            cmd.self = builder;
+            cmd.info = HandleForId<dawnRenderPassDescriptor>(kRenderPassId);
+            recorder->Append(cmd);
+        }
+        {
+            CommandBufferBuilderSetRenderPipelineCmd cmd;
+            cmd.self = builder;
+            cmd.pipeline = HandleForId<dawnRenderPipeline>(kPipelineId);
+            recorder->Append(cmd);
+        }
+
+        uint32_t shaderData[kPushConstantCount];
+        for (uint32_t i = 0; i < kDrawsPerFrame; ++i) {
+            float scale = 0.25f + (i % 64) / 256.0f;
+            float offset[2] = {(i % 97) / 97.0f, (i % 89) / 89.0f};
+            float time = i / 60.0f;
+            memcpy(&shaderData[0], &scale, sizeof(float));
+            memcpy(&shaderData[1], &time, sizeof(float));
+            memcpy(&shaderData[2], offset, sizeof(offset));
+            shaderData[4] = i * 2654435761u;
+            shaderData[5] = i % 4;
+
+            CommandBufferBuilderSetPushConstantsCmd pushConstants;
+            pushConstants.self = builder;
+            pushConstants.stages = DAWN_SHADER_STAGE_BIT_VERTEX;
+            pushConstants.offset = 0;
+            pushConstants.count = kPushConstantCount;
+            pushConstants.data = shaderData;
+            recorder->Append(pushConstants);
+
+            CommandBufferBuilderDrawArraysCmd draw;
+            draw.self = builder;
+            draw.vertexCount = 3;
+            draw.instanceCount = 1;
+            draw.firstVertex = 0;
+            draw.firstInstance = 0;
+            recorder->Append(draw);
+        }
+
+        {
+            CommandBufferBuilderEndRenderPassCmd cmd;
+            cmd.self = builder;
+            recorder->Append(cmd);
+        }
+        {
+            CommandBufferBuilderGetResultCmd cmd;
+            cmd.self = builder;
+            cmd.resultId = kCommandBufferId;
+            cmd.resultSerial = 1;
+            recorder->Append(cmd);
+        }
+        {
+            dawnCommandBuffer commandBuffer = HandleForId<dawnCommandBuffer>(kCommandBufferId);
+            QueueSubmitCmd cmd;
+            cmd.self = HandleForId<dawnQueue>(kQueueId);
+            cmd.numCommands = 1;
+            cmd.commands = &commandBuffer;
+            recorder->Append(cmd);
+        }
+    }
+
+    // Summary of the decoded frame, used to check both encodings decode to the same commands.
+    struct DecodedFrameSummary {
+        size_t commandCount = 0;
+        uint64_t drawCount = 0;
+        uint64_t pushConstantChecksum = 0;
+    };
+
+    void Accumulate(DecodedFrameSummary* summary, const CommandBufferBuilderSetPushConstantsCmd& cmd) {
+        EXPECT_EQ(cmd.selfId, kBuilderId);
+        for (uint32_t i = 0; i < cmd.count; ++i) {
+            summary->pushConstantChecksum = summary->pushConstantChecksum * 31 + cmd.data[i];
+        }
+    }
+
+    void Accumulate(DecodedFrameSummary* summary, const CommandBufferBuilderDrawArraysCmd& cmd) {
+        summary->drawCount += cmd.vertexCount * cmd.instanceCount;
+    }
+
+    template <typename Cmd>
+    void Accumulate(DecodedFrameSummary*, const Cmd&) {
+    }
+
+    template <typename Cmd>
+    bool DecodeFixed(const char** buffer, size_t* size, ScratchAllocator* allocator, const HandleIdResolver& resolver,
+                     DecodedFrameSummary* summary) {
+        Cmd cmd;
+        if (cmd.Deserialize(buffer, size, allocator, resolver) != DeserializeResult::Success) {
+            return false;
+        }
+        Accumulate(summary, cmd);
+        return true;
+    }
+
+    bool DecodeFixedFrame(const std::vector<char>& frame, DecodedFrameSummary* summary) {
+        ScratchAllocator allocator;
+        HandleIdResolver resolver;
+
+        const char* buffer = frame.data();
+        size_t size = frame.size();
+        while (size > 0) {
+            if (size < sizeof(WireCmd)) {
+                return false;
+            }
+            WireCmd commandId = *reinterpret_cast<const WireCmd*>(buffer);
+            allocator.Reset();
+
+            bool success = false;
+            switch (commandId) {
+#define DECODE_CASE(Name)                                                                      \
+    case WireCmd::Name:                                                                        \
+        success = DecodeFixed<Name##Cmd>(&buffer, &size, &allocator, resolver, summary); \
+        break;
+                DECODE_CASE(DeviceCreateCommandBufferBuilder)
+                DECODE_CASE(CommandBufferBuilderBeginRenderPass)
+                DECODE_CASE(CommandBufferBuilderSetRenderPipeline)
+                DECODE_CASE(CommandBufferBuilderSetPushConstants)
+                DECODE_CASE(CommandBufferBuilderDrawArrays)
+                DECODE_CASE(CommandBufferBuilderEndRenderPass)
+                DECODE_CASE(CommandBufferBuilderGetResult)
+                DECODE_CASE(QueueSubmit)
+#undef DECODE_CASE
+                default:
+                    break;
+            }
+
+            if (!success) {
+                return false;
+            }
+            summary->commandCount++;
+        }
+        return true;
+    }
+
+#if defined(DAWN_WIRE_COMPACT_ENCODING)
+    template <typename Cmd>
+    bool DecodeCompact(const char** buffer, size_t* size, ScratchAllocator* allocator, const HandleIdResolver& resolver,
+                       CompactEncodingState* state, DecodedFrameSummary* summary) {
+        Cmd cmd;
+        if (cmd.DeserializeCompact(buffer, size, allocator, resolver, state) != DeserializeResult::Success) {
+            return false;
+        }
+        Accumulate(summary, cmd);
+        return true;
+    }
+
+    bool DecodeCompactFrame(const std::vector<char>& frame, bool deltaObjectIds, DecodedFrameSummary* summary) {
+        ScratchAllocator allocator;
+        HandleIdResolver resolver;
+        CompactEncodingState state;
+        state.deltaObjectIds = deltaObjectIds;
+
+        const char* buffer = frame.data();
+        size_t size = frame.size();
+        while (size > 0) {
+            WireCmd commandId;
+            if (PeekCompactCommandId(buffer, size, &commandId) != DeserializeResult::Success) {
+                return false;
+            }
+            allocator.Reset();
+
+            bool success = false;
+            switch (commandId) {
+#define DECODE_CASE(Name)                                                                              \
+    case WireCmd::Name:                                                                                \
+        success = DecodeCompact<Name##Cmd>(&buffer, &size, &allocator, resolver, &state, summary); \
+        break;
+                DECODE_CASE(DeviceCreateCommandBufferBuilder)
+                DECODE_CASE(CommandBufferBuilderBeginRenderPass)
+                DECODE_CASE(CommandBufferBuilderSetRenderPipeline)
+                DECODE_CASE(CommandBufferBuilderSetPushConstants)
+                DECODE_CASE(CommandBufferBuilderDrawArrays)
+                DECODE_CASE(CommandBufferBuilderEndRenderPass)
+                DECODE_CASE(CommandBufferBuilderGetResult)
+                DECODE_CASE(QueueSubmit)
+#undef DECODE_CASE
+                default:
+                    break;
+            }
+
+            if (!success) {
+                return false;
+            }
+            summary->commandCount++;
+        }
+        return true;
+    }
+#endif  // defined(DAWN_WIRE_COMPACT_ENCODING)
+
+    // Runs decodeFrame a number of times and returns the average time per frame in microseconds.
+    template <typename F>
+    double TimeDecode(F decodeFrame) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < kDecodeIterations; ++i) {
+            DecodedFrameSummary summary;
+            EXPECT_TRUE(decodeFrame(&summary));
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        std::chrono::duration<double, std::micro> elapsed = end - start;
+        return elapsed.count() / kDecodeIterations;
+    }
+
+    void Report(const char* name, size_t bytesPerFrame, double microsecondsPerFrame) {
+        printf("%-24s %10zu bytes/frame %10.1f us/frame decode\n", name, bytesPerFrame,
+               microsecondsPerFrame);
+    }
+
+}  // anonymous namespace
+
+// Compares the size and decode speed of an Animometer frame in the fixed-size encoding with the
+// compact encoding, and checks both decode to the same commands.
+TEST(WireEncodingPerfTests, AnimometerFrame) {
+    FrameRecorder recorder(false);
+    RecordAnimometerFrame(&recorder);
+    const std::vector<char>& fixedFrame = recorder.GetFixed();
+
+    DecodedFrameSummary fixedSummary;
+    ASSERT_TRUE(DecodeFixedFrame(fixedFrame, &fixedSummary));
+    ASSERT_EQ(fixedSummary.commandCount, 2 * kDrawsPerFrame + 6);
+    ASSERT_EQ(fixedSummary.drawCount, 3 * kDrawsPerFrame);
+
+    double fixedTime = TimeDecode([&](DecodedFrameSummary* summary) {
+        return DecodeFixedFrame(fixedFrame, summary);
+    });
+    Report("fixed", fixedFrame.size(), fixedTime);
+
+#if defined(DAWN_WIRE_COMPACT_ENCODING)
+    for (bool deltaObjectIds : {false, true}) {
+        FrameRecorder compactRecorder(deltaObjectIds);
+        RecordAnimometerFrame(&compactRecorder);
+        const std::vector<char>& compactFrame = compactRecorder.GetCompact();
+
+        DecodedFrameSummary compactSummary;
+        ASSERT_TRUE(DecodeCompactFrame(compactFrame, deltaObjectIds, &compactSummary));
+        ASSERT_EQ(compactSummary.commandCount, fixedSummary.commandCount);
+        ASSERT_EQ(compactSummary.drawCount, fixedSummary.drawCount);
+        ASSERT_EQ(compactSummary.pushConstantChecksum, fixedSummary.pushConstantChecksum);
+        ASSERT_LT(compactFrame.size(), fixedFrame.size());
+
+        double compactTime = TimeDecode([&](DecodedFrameSummary* summary) {
+            return DecodeCompactFrame(compactFrame, deltaObjectIds, summary);
+        });
+        Report(deltaObjectIds ? "compact (delta IDs)" : "compact", compactFrame.size(),
+               compactTime);
+    }
+#endif  // defined(DAWN_WIRE_COMPACT_ENCODING)
+}
+
+// Check that a fixed-size frame truncated in the middle of the data following a command is
+// rejected when the size of the command is checked, before its members are read.
+TEST(WireEncodingPerfTests, FixedDecodeRejectsTruncatedFrames) {
+    FrameRecorder recorder(false);
+    RecordAnimometerFrame(&recorder);
+    std::vector<char> frame = recorder.GetFixed();
+
+    // Cut the last QueueSubmit in the middle of its array of command buffers.
+    frame.resize(frame.size() - 1);
+
+    DecodedFrameSummary summary;
+    ASSERT_FALSE(DecodeFixedFrame(frame, &summary));
+    ASSERT_EQ(summary.commandCount, 2 * kDrawsPerFrame + 5);
+}
+
+#if defined(DAWN_WIRE_COMPACT_ENCODING)
+// Check that a truncated compact stream is rejected instead of being read out of bounds.
+TEST(WireEncodingPerfTests, CompactDecodeRejectsTruncatedFrames) {
+    FrameRecorder recorder(true);
+    RecordAnimometerFrame(&recorder);
+    std::vector<char> frame = recorder.GetCompact();
+
+    // Cut the last QueueSubmit in the middle of its array of command buffers.
+    frame.resize(frame.size() - 1);
+
+    DecodedFrameSummary summary;
+    ASSERT_FALSE(DecodeCompactFrame(frame, true, &summary));
+}
+#endif  // defined(DAWN_WIRE_COMPACT_ENCODING)
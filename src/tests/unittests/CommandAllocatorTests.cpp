@@ -16,6 +16,8 @@
 
 #include "dawn_native/CommandAllocator.h"
 
+#include <vector>
+
 using namespace dawn_native;
 
 // Definition of the command types used in the tests
@@ -362,3 +364,49 @@ TEST(CommandAllocator, EmptyIterator) {
         iterator2.DataWasDestroyed();
     }
 }
+
+// Test that iterators can start at positions taken while allocating, across blocks
+TEST(CommandAllocator, IterateFromPositions) {
+    CommandAllocator allocator;
+
+    // Enough commands to span several blocks, with a position taken after each of them
+    const int kCommandCount = 5000;
+
+    std::vector<CommandPosition> positions;
+    for (int i = 0; i < kCommandCount; i++) {
+        CommandSmall* small = allocator.Allocate<CommandSmall>(CommandType::Small);
+        small->data = static_cast<uint16_t>(i);
+        positions.push_back(allocator.GetPosition());
+    }
+
+    CommandIterator iterator(std::move(allocator));
+    for (int i = 0; i < kCommandCount; i += 499) {
+        CommandIterator view(iterator, positions[i]);
+        CommandType type;
+
+        // The view starts at the command after the position and ends with the commands
+        int numCommands = 0;
+        while (view.NextCommandId(&type)) {
+            ASSERT_EQ(type, CommandType::Small);
+            CommandSmall* small = view.NextCommand<CommandSmall>();
+            ASSERT_EQ(small->data, i + 1 + numCommands);
+            numCommands++;
+        }
+        ASSERT_EQ(numCommands, kCommandCount - i - 1);
+    }
+
+    // Positions taken from an iterator can be used to continue iterating at the same command
+    CommandType type;
+    ASSERT_TRUE(iterator.NextCommandId(&type));
+    iterator.NextCommand<CommandSmall>();
+    CommandPosition position = iterator.GetPosition();
+
+    ASSERT_TRUE(iterator.NextCommandId(&type));
+    ASSERT_EQ(iterator.NextCommand<CommandSmall>()->data, 1u);
+
+    iterator.SetPosition(position);
+    ASSERT_TRUE(iterator.NextCommandId(&type));
+    ASSERT_EQ(iterator.NextCommand<CommandSmall>()->data, 1u);
+
+    iterator.DataWasDestroyed();
+}
@@ -0,0 +1,98 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "dawn_native/DeferredDeletionQueue.h"
+
+#include <vector>
+
+using namespace dawn_native;
+
+namespace {
+
+    // The handles destroyed by the destroy functions, with the second function making them
+    // negative so that the tests can check which function was called.
+    std::vector<int64_t> gDestroyedHandles;
+
+    void Destroy(DeviceBase*, uint64_t handle) {
+        gDestroyedHandles.push_back(static_cast<int64_t>(handle));
+    }
+
+    void DestroyNegated(DeviceBase*, uint64_t handle) {
+        gDestroyedHandles.push_back(-static_cast<int64_t>(handle));
+    }
+
+    class DeferredDeletionQueueTests : public testing::Test {
+      protected:
+        void SetUp() override {
+            gDestroyedHandles.clear();
+        }
+    };
+
+}  // anonymous namespace
+
+// Test that objects are destroyed only once their serial is completed
+TEST_F(DeferredDeletionQueueTests, DestroyedWhenSerialCompletes) {
+    DeferredDeletionQueue queue(nullptr);
+    ASSERT_TRUE(queue.Empty());
+
+    queue.Enqueue(Destroy, 1, 1);
+    queue.Enqueue(Destroy, 2, 2);
+    queue.Enqueue(Destroy, 3, 2);
+    queue.Enqueue(Destroy, 4, 4);
+
+    queue.Tick(0);
+    EXPECT_TRUE(gDestroyedHandles.empty());
+
+    queue.Tick(2);
+    EXPECT_EQ((std::vector<int64_t>{1, 2, 3}), gDestroyedHandles);
+    EXPECT_FALSE(queue.Empty());
+
+    // Ticking again with the same serial doesn't destroy objects twice.
+    queue.Tick(2);
+    EXPECT_EQ(3u, gDestroyedHandles.size());
+
+    queue.Tick(5);
+    EXPECT_EQ((std::vector<int64_t>{1, 2, 3, 4}), gDestroyedHandles);
+    EXPECT_TRUE(queue.Empty());
+}
+
+// Test that objects are destroyed in the order they were enqueued with their own function
+TEST_F(DeferredDeletionQueueTests, DestroyedInEnqueueOrder) {
+    DeferredDeletionQueue queue(nullptr);
+
+    queue.Enqueue(DestroyNegated, 1, 1);
+    queue.Enqueue(Destroy, 2, 1);
+    queue.Enqueue(DestroyNegated, 3, 1);
+    queue.Enqueue(Destroy, 4, 1);
+
+    queue.Tick(1);
+    EXPECT_EQ((std::vector<int64_t>{-1, 2, -3, 4}), gDestroyedHandles);
+    EXPECT_TRUE(queue.Empty());
+}
+
+// Test that objects can be enqueued after a partial Tick
+TEST_F(DeferredDeletionQueueTests, EnqueueAfterTick) {
+    DeferredDeletionQueue queue(nullptr);
+
+    queue.Enqueue(Destroy, 1, 1);
+    queue.Enqueue(Destroy, 2, 2);
+    queue.Tick(1);
+
+    queue.Enqueue(Destroy, 3, 3);
+    queue.Tick(3);
+    EXPECT_EQ((std::vector<int64_t>{1, 2, 3}), gDestroyedHandles);
+    EXPECT_TRUE(queue.Empty());
+}
@@ -16,6 +16,9 @@
 
 #include "dawn_native/RefCounted.h"
 
+#include <thread>
+#include <vector>
+
 using namespace dawn_native;
 
 struct RCTest : public RefCounted {
@@ -194,3 +197,32 @@ TEST(Ref, MoveAssignment) {
     destination = nullptr;
     ASSERT_TRUE(deleted);
 }
+
+// Test that references can be added and removed on several threads at once
+TEST(Ref, ConcurrentReferences) {
+    bool deleted = false;
+    RCTest* original = new RCTest(&deleted);
+    Ref<RCTest> source(original);
+    original->Release();
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < 4; ++i) {
+        threads.emplace_back([&source]() {
+            for (uint32_t j = 0; j < 10000; ++j) {
+                Ref<RCTest> copy(source);
+                copy->Reference();
+                copy->Release();
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_FALSE(deleted);
+    ASSERT_EQ(1u, original->GetInternalRefs());
+    ASSERT_EQ(0u, original->GetExternalRefs());
+
+    source = nullptr;
+    ASSERT_TRUE(deleted);
+}
@@ -0,0 +1,89 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "common/ThreadPool.h"
+
+#include <atomic>
+#include <vector>
+
+// Check that each iteration runs exactly once
+TEST(ThreadPool, EachIterationOnce) {
+    ThreadPool pool(4);
+    ASSERT_EQ(pool.GetThreadCount(), 4u);
+
+    for (uint32_t count : {0u, 1u, 3u, 4u, 1000u}) {
+        std::vector<std::atomic<uint32_t>> runs(count);
+        for (auto& run : runs) {
+            run = 0;
+        }
+
+        pool.ParallelFor(count, [&](uint32_t index, uint32_t) { runs[index]++; });
+
+        for (uint32_t i = 0; i < count; ++i) {
+            ASSERT_EQ(runs[i].load(), 1u);
+        }
+    }
+}
+
+// Check that the thread index is in range and never used by two iterations at the same time
+TEST(ThreadPool, ThreadIndexIsExclusive) {
+    ThreadPool pool(4);
+    std::vector<std::atomic<uint32_t>> users(pool.GetThreadCount());
+    for (auto& user : users) {
+        user = 0;
+    }
+    std::atomic<bool> overlapped(false);
+
+    pool.ParallelFor(1000, [&](uint32_t, uint32_t threadIndex) {
+        ASSERT_LT(threadIndex, pool.GetThreadCount());
+        if (users[threadIndex]++ != 0) {
+            overlapped = true;
+        }
+        users[threadIndex]--;
+    });
+
+    ASSERT_FALSE(overlapped.load());
+}
+
+// Check that the iterations of a thread that takes long are stolen by the others
+TEST(ThreadPool, UnevenIterations) {
+    ThreadPool pool(2);
+    std::atomic<uint32_t> done(0);
+
+    // The first half of the iterations, initially given to the calling thread, waits until the
+    // second half is done, which only finishes if the worker steals from the calling thread.
+    pool.ParallelFor(100, [&](uint32_t index, uint32_t) {
+        if (index == 0) {
+            while (done.load() < 99) {
+                std::this_thread::yield();
+            }
+        }
+        done++;
+    });
+
+    ASSERT_EQ(done.load(), 100u);
+}
+
+// Check that a pool with a single thread runs the loops on the calling thread
+TEST(ThreadPool, SingleThread) {
+    ThreadPool pool(1);
+    uint32_t sum = 0;
+    pool.ParallelFor(10, [&](uint32_t index, uint32_t threadIndex) {
+        ASSERT_EQ(threadIndex, 0u);
+        sum += index;
+    });
+    ASSERT_EQ(sum, 45u);
+}
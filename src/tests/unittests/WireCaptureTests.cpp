@@ -0,0 +1,165 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "utils/TerribleCommandBuffer.h"
+#include "utils/WireCapture.h"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+    // Records the batches of commands it receives.
+    class RecordingHandler : public dawn_wire::CommandHandler {
+      public:
+        const char* HandleCommands(const char* commands, size_t size) override {
+            batches.emplace_back(commands, size);
+            return commands + size;
+        }
+
+        std::vector<std::string> batches;
+    };
+
+    const char* kCapturePath = "dawn_wire_capture_test.bin";
+
+    std::vector<char> ReadFile(const char* path) {
+        std::vector<char> data;
+        FILE* file = fopen(path, "rb");
+        if (file == nullptr) {
+            return data;
+        }
+
+        char buffer[4096];
+        size_t read;
+        while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            data.insert(data.end(), buffer, buffer + read);
+        }
+        fclose(file);
+        return data;
+    }
+
+    void WriteCommand(dawn_wire::CommandSerializer* serializer, const char* command) {
+        size_t size = strlen(command);
+        char* space = static_cast<char*>(serializer->GetCmdSpace(size));
+        ASSERT_NE(space, nullptr);
+        memcpy(space, command, size);
+    }
+
+}  // anonymous namespace
+
+class WireCaptureTests : public testing::Test {
+  protected:
+    void TearDown() override {
+        remove(kCapturePath);
+    }
+};
+
+// Test the capture contains the batches of commands and the frame markers
+TEST_F(WireCaptureTests, CaptureAndRead) {
+    RecordingHandler handler;
+    // TerribleCommandBuffer is too big to be on the stack.
+    auto buffer = std::make_unique<utils::TerribleCommandBuffer>(&handler);
+
+    {
+        utils::WireCaptureSerializer capture(buffer.get(), kCapturePath);
+        ASSERT_TRUE(capture.IsOpen());
+
+        WriteCommand(&capture, "abc");
+        WriteCommand(&capture, "defgh");
+        ASSERT_TRUE(capture.Flush());
+        WriteCommand(&capture, "ij");
+        ASSERT_TRUE(capture.EndFrame());
+        WriteCommand(&capture, "klmnopqrs");
+        ASSERT_TRUE(capture.EndFrame());
+    }
+
+    // The commands are still forwarded to the wrapped serializer
+    ASSERT_EQ(handler.batches.size(), 3u);
+    ASSERT_EQ(handler.batches[0], "abcdefgh");
+    ASSERT_EQ(handler.batches[1], "ij");
+    ASSERT_EQ(handler.batches[2], "klmnopqrs");
+
+    std::vector<char> data = ReadFile(kCapturePath);
+    utils::WireCaptureReader reader(data.data(), data.size());
+    ASSERT_TRUE(reader.IsValid());
+
+    struct Record {
+        utils::WireCaptureRecordType type;
+        std::string payload;
+    };
+    std::vector<Record> expected = {
+        {utils::WireCaptureRecordType::Commands, "abcdefgh"},
+        {utils::WireCaptureRecordType::Commands, "ij"},
+        {utils::WireCaptureRecordType::EndFrame, ""},
+        {utils::WireCaptureRecordType::Commands, "klmnopqrs"},
+        {utils::WireCaptureRecordType::EndFrame, ""},
+    };
+
+    for (const Record& record : expected) {
+        utils::WireCaptureRecordType type;
+        const char* payload;
+        size_t size;
+        ASSERT_TRUE(reader.Next(&type, &payload, &size));
+        ASSERT_EQ(type, record.type);
+        ASSERT_EQ(std::string(payload, size), record.payload);
+
+        // Payloads are aligned relative to the start of the capture
+        ASSERT_EQ(static_cast<size_t>(payload - data.data()) % utils::kWireCaptureAlignment, 0u);
+    }
+
+    utils::WireCaptureRecordType type;
+    const char* payload;
+    size_t size;
+    ASSERT_FALSE(reader.Next(&type, &payload, &size));
+}
+
+// Test the reader rejects captures with a bad header or a truncated record
+TEST_F(WireCaptureTests, InvalidCaptures) {
+    RecordingHandler handler;
+    // TerribleCommandBuffer is too big to be on the stack.
+    auto buffer = std::make_unique<utils::TerribleCommandBuffer>(&handler);
+    {
+        utils::WireCaptureSerializer capture(buffer.get(), kCapturePath);
+        WriteCommand(&capture, "abcdefghijklmnop");
+        ASSERT_TRUE(capture.EndFrame());
+    }
+    std::vector<char> data = ReadFile(kCapturePath);
+
+    // Too small for the header
+    ASSERT_FALSE(utils::WireCaptureReader(data.data(), 4).IsValid());
+
+    // Bad magic
+    {
+        std::vector<char> badMagic = data;
+        badMagic[0] = 'X';
+        ASSERT_FALSE(utils::WireCaptureReader(badMagic.data(), badMagic.size()).IsValid());
+    }
+
+    // Truncated in the middle of the command payload
+    {
+        utils::WireCaptureReader reader(data.data(), sizeof(utils::WireCaptureHeader) +
+                                                         sizeof(utils::WireCaptureRecord) + 4);
+        ASSERT_TRUE(reader.IsValid());
+
+        utils::WireCaptureRecordType type;
+        const char* payload;
+        size_t size;
+        ASSERT_FALSE(reader.Next(&type, &payload, &size));
+    }
+}
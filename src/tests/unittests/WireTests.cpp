@@ -17,9 +17,15 @@
 
 #include "common/Assert.h"
 #include "dawn_wire/Wire.h"
+#include "dawn_wire/WireCmd.h"
+#include "dawn_wire/dawn_wire_statistics.h"
 #include "utils/TerribleCommandBuffer.h"
 
+#include <cstring>
+#include <limits>
 #include <memory>
+#include <thread>
+#include <vector>
 
 using namespace testing;
 using namespace dawn_wire;
@@ -117,10 +123,20 @@ static void ToMockBufferMapWriteCallback(dawnBufferMapAsyncStatus status, void*
     mockBufferMapWriteCallback->Call(status, lastMapWritePointer, userdata);
 }
 
+class MockFenceOnCompletionCallback {
+    public:
+        MOCK_METHOD2(Call, void(dawnFenceCompletionStatus status, dawnCallbackUserdata userdata));
+};
+
+static std::unique_ptr<MockFenceOnCompletionCallback> mockFenceOnCompletionCallback;
+static void ToMockFenceOnCompletionCallback(dawnFenceCompletionStatus status, dawnCallbackUserdata userdata) {
+    mockFenceOnCompletionCallback->Call(status, userdata);
+}
+
 class WireTestsBase : public Test {
     protected:
-        WireTestsBase(bool ignoreSetCallbackCalls)
-            : mIgnoreSetCallbackCalls(ignoreSetCallbackCalls) {
+        WireTestsBase(bool ignoreSetCallbackCalls, const ServerOptions& serverOptions = ServerOptions())
+            : mServerOptions(serverOptions), mIgnoreSetCallbackCalls(ignoreSetCallbackCalls) {
         }
 
         void SetUp() override {
@@ -128,6 +144,7 @@ class WireTestsBase : public Test {
             mockBuilderErrorCallback = std::make_unique<MockBuilderErrorCallback>();
             mockBufferMapReadCallback = std::make_unique<MockBufferMapReadCallback>();
             mockBufferMapWriteCallback = std::make_unique<MockBufferMapWriteCallback>();
+            mockFenceOnCompletionCallback = std::make_unique<MockFenceOnCompletionCallback>();
 
             dawnProcTable mockProcs;
             dawnDevice mockDevice;
@@ -143,11 +160,11 @@ class WireTestsBase : public Test {
             mS2cBuf = std::make_unique<utils::TerribleCommandBuffer>();
             mC2sBuf = std::make_unique<utils::TerribleCommandBuffer>(mWireServer.get());
 
-            mWireServer.reset(NewServerCommandHandler(mockDevice, mockProcs, mS2cBuf.get()));
+            mWireServer.reset(NewServerCommandHandler(mockDevice, mockProcs, mS2cBuf.get(), mServerOptions));
             mC2sBuf->SetHandler(mWireServer.get());
 
             dawnProcTable clientProcs;
-            mWireClient.reset(NewClientDevice(&clientProcs, &device, mC2sBuf.get()));
+            mWireClient.reset(NewClientDevice(&clientProcs, &device, mC2sBuf.get(), mClientOptions));
             dawnSetProcs(&clientProcs);
             mS2cBuf->SetHandler(mWireClient.get());
 
@@ -162,6 +179,7 @@ class WireTestsBase : public Test {
             mockBuilderErrorCallback = nullptr;
             mockBufferMapReadCallback = nullptr;
             mockBufferMapWriteCallback = nullptr;
+            mockFenceOnCompletionCallback = nullptr;
         }
 
         void FlushClient() {
@@ -172,15 +190,51 @@ class WireTestsBase : public Test {
             ASSERT_TRUE(mS2cBuf->Flush());
         }
 
+        ServerCounters GetServerCounters() const {
+            return mWireServer->GetCounters();
+        }
+
+        void FlushServerReplies() {
+            mWireServer->FlushReplies();
+        }
+
+        void DeliverClientCallbacks() {
+            ASSERT_TRUE(mWireClient->DeliverCallbacks());
+        }
+
+        uint64_t GetClientInFlightBytes() const {
+            return mWireClient->GetInFlightBytes();
+        }
+
+        bool ClientWouldBlock() const {
+            return mWireClient->WouldBlock();
+        }
+
+        // Sends a batch with a command the server doesn't know, that makes the batch fail.
+        void FlushInvalidCommand() {
+            uint32_t* invalidCommand = static_cast<uint32_t*>(mC2sBuf->GetCmdSpace(sizeof(uint32_t)));
+            *invalidCommand = 0xFFFFFFFF;
+            ASSERT_FALSE(mC2sBuf->Flush());
+        }
+
+        // Sends raw bytes to the client as if they were replies written by the server.
+        bool FlushRawReplies(const void* data, size_t size) {
+            memcpy(mS2cBuf->GetCmdSpace(size), data, size);
+            return mS2cBuf->Flush();
+        }
+
         MockProcTable api;
         dawnDevice apiDevice;
         dawnDevice device;
 
+        ServerOptions mServerOptions;
+        ClientOptions mClientOptions;
+
     private:
         bool mIgnoreSetCallbackCalls = false;
 
-        std::unique_ptr<CommandHandler> mWireServer;
-        std::unique_ptr<CommandHandler> mWireClient;
+        std::unique_ptr<ServerCommandHandler> mWireServer;
+        std::unique_ptr<ClientCommandHandler> mWireClient;
         std::unique_ptr<utils::TerribleCommandBuffer> mS2cBuf;
         std::unique_ptr<utils::TerribleCommandBuffer> mC2sBuf;
 };
@@ -247,6 +301,56 @@ TEST_F(WireTests, ReleaseCalledOnRefCount0) {
     FlushClient();
 }
 
+// Test that consecutive releases, batched in one destroy command, release all the objects and that
+// the IDs they free can be reused right after
+TEST_F(WireTests, ConsecutiveReleasesThenReuseIds) {
+    constexpr size_t kBuilderCount = 10;
+    std::vector<dawnCommandBufferBuilder> builders;
+    std::vector<dawnCommandBufferBuilder> apiBuilders;
+    for (size_t i = 0; i < kBuilderCount; ++i) {
+        builders.push_back(dawnDeviceCreateCommandBufferBuilder(device));
+        apiBuilders.push_back(api.GetNewCommandBufferBuilder());
+    }
+    {
+        InSequence sequence;
+        for (dawnCommandBufferBuilder apiBuilder : apiBuilders) {
+            EXPECT_CALL(api, DeviceCreateCommandBufferBuilder(apiDevice))
+                .WillOnce(Return(apiBuilder));
+        }
+    }
+    FlushClient();
+
+    // Objects of another type break the batch.
+    dawnBufferBuilder bufferBuilder = dawnDeviceCreateBufferBuilderForTesting(device);
+    dawnBufferBuilder apiBufferBuilder = api.GetNewBufferBuilder();
+    for (size_t i = 0; i < kBuilderCount; ++i) {
+        dawnCommandBufferBuilderRelease(builders[i]);
+        if (i == kBuilderCount / 2) {
+            dawnBufferBuilderRelease(bufferBuilder);
+        }
+    }
+    dawnCommandBufferBuilder newBuilder = dawnDeviceCreateCommandBufferBuilder(device);
+    dawnCommandBufferBuilderDispatch(newBuilder, 1, 2, 3);
+
+    dawnCommandBufferBuilder apiNewBuilder = api.GetNewCommandBufferBuilder();
+    {
+        InSequence sequence;
+        EXPECT_CALL(api, DeviceCreateBufferBuilderForTesting(apiDevice))
+            .WillOnce(Return(apiBufferBuilder));
+        for (size_t i = 0; i < kBuilderCount; ++i) {
+            EXPECT_CALL(api, CommandBufferBuilderRelease(apiBuilders[i]));
+            if (i == kBuilderCount / 2) {
+                EXPECT_CALL(api, BufferBuilderRelease(apiBufferBuilder));
+            }
+        }
+        EXPECT_CALL(api, DeviceCreateCommandBufferBuilder(apiDevice))
+            .WillOnce(Return(apiNewBuilder));
+        EXPECT_CALL(api, CommandBufferBuilderDispatch(apiNewBuilder, 1, 2, 3))
+            .Times(1);
+    }
+    FlushClient();
+}
+
 // Test that the wire is able to send numerical values
 TEST_F(WireTests, ValueArgument) {
     dawnCommandBufferBuilder builder = dawnDeviceCreateCommandBufferBuilder(device);
@@ -262,6 +366,16 @@ TEST_F(WireTests, ValueArgument) {
     FlushClient();
 }
 
+// Test that the server ignores the WaitForIdle timeout so that a client can't stall it
+TEST_F(WireTests, WaitForIdleDoesntBlockServer) {
+    dawnDeviceWaitForIdle(device, std::numeric_limits<uint64_t>::max());
+
+    EXPECT_CALL(api, DeviceWaitForIdle(apiDevice, 0))
+        .Times(1);
+
+    FlushClient();
+}
+
 // Test that the wire is able to send arrays of numerical values
 static constexpr uint32_t testPushConstantValues[4] = {
     0,
@@ -292,6 +406,40 @@ TEST_F(WireTests, ValueArrayArgument) {
     FlushClient();
 }
 
+// Test that arrays larger than the server's inline deserialization storage are received correctly
+// when the server reuses its allocations for the following commands and batches.
+TEST_F(WireTests, LargeValueArrayArgumentsReuseAllocations) {
+    constexpr uint32_t kCount = 4096;
+    std::vector<uint32_t> values(kCount);
+
+    dawnCommandBufferBuilder builder = dawnDeviceCreateCommandBufferBuilder(device);
+    dawnCommandBufferBuilder apiBuilder = api.GetNewCommandBufferBuilder();
+    EXPECT_CALL(api, DeviceCreateCommandBufferBuilder(apiDevice))
+        .WillOnce(Return(apiBuilder));
+
+    for (uint32_t batch = 0; batch < 3; ++batch) {
+        for (uint32_t command = 0; command < 3; ++command) {
+            uint32_t seed = batch * 3 + command;
+            for (uint32_t i = 0; i < kCount; ++i) {
+                values[i] = seed * kCount + i;
+            }
+            dawnCommandBufferBuilderSetPushConstants(builder, DAWN_SHADER_STAGE_BIT_VERTEX, 0, kCount, values.data());
+
+            auto checkValues = [seed](const uint32_t* received) {
+                for (uint32_t i = 0; i < kCount; ++i) {
+                    if (received[i] != seed * kCount + i) {
+                        return false;
+                    }
+                }
+                return reinterpret_cast<uintptr_t>(received) % alignof(uint32_t) == 0;
+            };
+            EXPECT_CALL(api, CommandBufferBuilderSetPushConstants(apiBuilder, DAWN_SHADER_STAGE_BIT_VERTEX, 0, kCount, ResultOf(checkValues, Eq(true))));
+        }
+
+        FlushClient();
+    }
+}
+
 // Test that the wire is able to send C strings
 TEST_F(WireTests, CStringArgument) {
     // Create shader module
@@ -643,6 +791,18 @@ TEST_F(WireSetCallbackTests, DeviceErrorCallback) {
     FlushServer();
 }
 
+// Test that the client rejects error messages whose length wraps once the null terminator is added
+TEST_F(WireSetCallbackTests, DeviceErrorCallbackLengthOverflow) {
+    dawnDeviceSetErrorCallback(device, ToMockDeviceErrorCallback, 0);
+    FlushClient();
+
+    ReturnDeviceErrorCallbackCmd cmd;
+    cmd.messageStrlen = std::numeric_limits<size_t>::max();
+
+    EXPECT_CALL(*mockDeviceErrorCallback, Call(_, _)).Times(0);
+    ASSERT_FALSE(FlushRawReplies(&cmd, sizeof(cmd)));
+}
+
 // Test the return wire for device error callbacks
 TEST_F(WireSetCallbackTests, BuilderErrorCallback) {
     uint64_t userdata1 = 982734;
@@ -752,6 +912,54 @@ TEST_F(WireBufferMappingTests, MappingForReadSuccessBuffer) {
     FlushClient();
 }
 
+// Check the statistics count the map request and its reply, or stay at 0 when they are disabled
+TEST_F(WireBufferMappingTests, Statistics) {
+    dawnWireResetStatistics();
+
+    dawnCallbackUserdata userdata = 8660;
+    dawnBufferMapReadAsync(buffer, 40, sizeof(uint32_t), ToMockBufferMapReadCallback, userdata);
+
+    uint32_t bufferContent = 31337;
+    EXPECT_CALL(api, OnBufferMapReadAsyncCallback(apiBuffer, 40, sizeof(uint32_t), _, _))
+        .WillOnce(InvokeWithoutArgs([&]() {
+            api.CallMapReadCallback(apiBuffer, DAWN_BUFFER_MAP_ASYNC_STATUS_SUCCESS, &bufferContent);
+        }));
+
+    FlushClient();
+
+    EXPECT_CALL(*mockBufferMapReadCallback, Call(DAWN_BUFFER_MAP_ASYNC_STATUS_SUCCESS, Pointee(Eq(bufferContent)), userdata))
+        .Times(1);
+
+    FlushServer();
+
+    std::vector<dawnWireCommandStatistics> commands(dawnWireGetCommandCount());
+    dawnWireGetCommandStatistics(commands.data(), dawnWireGetCommandCount());
+
+    const dawnWireCommandStatistics* mapAsync = nullptr;
+    for (const dawnWireCommandStatistics& command : commands) {
+        ASSERT_NE(command.name, nullptr);
+        if (strcmp(command.name, "BufferMapAsync") == 0) {
+            mapAsync = &command;
+        }
+    }
+    ASSERT_NE(mapAsync, nullptr);
+
+    dawnWireMapStatistics maps;
+    dawnWireGetMapStatistics(&maps);
+
+    uint64_t expectedCount = dawnWireStatisticsEnabled() ? 1 : 0;
+    ASSERT_EQ(mapAsync->clientCount, expectedCount);
+    ASSERT_EQ(mapAsync->serverCount, expectedCount);
+    ASSERT_EQ(mapAsync->clientBytes, mapAsync->serverBytes);
+    ASSERT_EQ(maps.requestCount, expectedCount);
+    ASSERT_EQ(maps.replyCount, expectedCount);
+    ASSERT_LE(maps.maxLatencyNanoseconds, maps.totalLatencyNanoseconds);
+
+    dawnWireResetStatistics();
+    dawnWireGetMapStatistics(&maps);
+    ASSERT_EQ(maps.requestCount, 0u);
+}
+
 // Check that things work correctly when a validation error happens when mapping the buffer for reading
 TEST_F(WireBufferMappingTests, ErrorWhileMappingForRead) {
     dawnCallbackUserdata userdata = 8654;
@@ -1103,3 +1311,901 @@ TEST_F(WireBufferMappingTests, DestroyInsideMapWriteCallback) {
 
     FlushClient();
 }
+
+class WireFenceTests : public WireTestsBase {
+    public:
+        WireFenceTests() : WireTestsBase(true) {
+        }
+
+        void SetUp() override {
+            WireTestsBase::SetUp();
+
+            apiQueue = api.GetNewQueue();
+            queue = dawnDeviceCreateQueue(device);
+            EXPECT_CALL(api, DeviceCreateQueue(apiDevice))
+                .WillOnce(Return(apiQueue));
+            FlushClient();
+
+            dawnFenceDescriptor descriptor;
+            descriptor.nextInChain = nullptr;
+            descriptor.initialValue = 1;
+
+            apiFence = api.GetNewFence();
+            fence = dawnQueueCreateFence(queue, &descriptor);
+            EXPECT_CALL(api, QueueCreateFence(apiQueue, _))
+                .WillOnce(Return(apiFence));
+            FlushClient();
+        }
+
+    protected:
+        dawnQueue queue;
+        dawnQueue apiQueue;
+        dawnFence fence;
+        dawnFence apiFence;
+};
+
+// Check that a signal waits for the value on the server and sends it back once it completes
+TEST_F(WireFenceTests, SignalThenCompletion) {
+    dawnQueueSignal(queue, fence, 2);
+    EXPECT_CALL(api, QueueSignal(apiQueue, apiFence, 2))
+        .Times(1);
+    EXPECT_CALL(api, OnFenceOnCompletionCallback(apiFence, 2, _, _))
+        .Times(1);
+    FlushClient();
+    EXPECT_EQ(1u, GetServerCounters().pendingFenceCompletionCount);
+
+    dawnCallbackUserdata userdata = 3820;
+    dawnFenceOnCompletion(fence, 2, ToMockFenceOnCompletionCallback, userdata);
+    EXPECT_EQ(1u, dawnFenceGetCompletedValue(fence));
+
+    // The backend completes the signal outside of a batch of commands.
+    api.CallFenceOnCompletionCallback(apiFence, DAWN_FENCE_COMPLETION_STATUS_SUCCESS);
+    EXPECT_EQ(0u, GetServerCounters().pendingFenceCompletionCount);
+
+    EXPECT_CALL(*mockFenceOnCompletionCallback, Call(DAWN_FENCE_COMPLETION_STATUS_SUCCESS, userdata))
+        .Times(1);
+    FlushServer();
+    EXPECT_EQ(2u, dawnFenceGetCompletedValue(fence));
+}
+
+// Check that a completion the backend reports from another thread is sent by the server on its
+// own thread, at its next flush
+TEST_F(WireFenceTests, CompletionFromOtherThread) {
+    dawnQueueSignal(queue, fence, 2);
+    EXPECT_CALL(api, QueueSignal(apiQueue, apiFence, 2))
+        .Times(1);
+    EXPECT_CALL(api, OnFenceOnCompletionCallback(apiFence, 2, _, _))
+        .Times(1);
+    FlushClient();
+
+    std::thread([this]() {
+        api.CallFenceOnCompletionCallback(apiFence, DAWN_FENCE_COMPLETION_STATUS_SUCCESS);
+    }).join();
+    EXPECT_EQ(1u, GetServerCounters().pendingFenceCompletionCount);
+    FlushServer();
+    EXPECT_EQ(1u, dawnFenceGetCompletedValue(fence));
+
+    FlushServerReplies();
+    EXPECT_EQ(0u, GetServerCounters().pendingFenceCompletionCount);
+    FlushServer();
+    EXPECT_EQ(2u, dawnFenceGetCompletedValue(fence));
+}
+
+// Check that completions the backend reports out of order, like for values signaled on the same
+// serial when one is queued from the completion waiter thread, don't make the wire fail
+TEST_F(WireFenceTests, CompletionsInReverseOrder) {
+    dawnFenceOnCompletionCallback callback2 = nullptr;
+    dawnFenceOnCompletionCallback callback3 = nullptr;
+    dawnCallbackUserdata userdata2 = 0;
+    dawnCallbackUserdata userdata3 = 0;
+
+    dawnQueueSignal(queue, fence, 2);
+    dawnQueueSignal(queue, fence, 3);
+    EXPECT_CALL(api, QueueSignal(apiQueue, apiFence, 2))
+        .Times(1);
+    EXPECT_CALL(api, QueueSignal(apiQueue, apiFence, 3))
+        .Times(1);
+    EXPECT_CALL(api, OnFenceOnCompletionCallback(apiFence, 2, _, _))
+        .WillOnce(DoAll(SaveArg<2>(&callback2), SaveArg<3>(&userdata2)));
+    EXPECT_CALL(api, OnFenceOnCompletionCallback(apiFence, 3, _, _))
+        .WillOnce(DoAll(SaveArg<2>(&callback3), SaveArg<3>(&userdata3)));
+    FlushClient();
+
+    EXPECT_CALL(*mockFenceOnCompletionCallback, Call(DAWN_FENCE_COMPLETION_STATUS_SUCCESS, 2))
+        .Times(1);
+    EXPECT_CALL(*mockFenceOnCompletionCallback, Call(DAWN_FENCE_COMPLETION_STATUS_SUCCESS, 3))
+        .Times(1);
+    dawnFenceOnCompletion(fence, 2, ToMockFenceOnCompletionCallback, 2);
+    dawnFenceOnCompletion(fence, 3, ToMockFenceOnCompletionCallback, 3);
+
+    // Value 2 is reported from another thread and queued, then value 3 is written right away.
+    std::thread([&]() {
+        callback2(DAWN_FENCE_COMPLETION_STATUS_SUCCESS, userdata2);
+    }).join();
+    callback3(DAWN_FENCE_COMPLETION_STATUS_SUCCESS, userdata3);
+    FlushServer();
+    EXPECT_EQ(3u, dawnFenceGetCompletedValue(fence));
+
+    // The stale value 2 is dropped by the server.
+    FlushServerReplies();
+    EXPECT_EQ(0u, GetServerCounters().pendingFenceCompletionCount);
+    FlushServer();
+    EXPECT_EQ(3u, dawnFenceGetCompletedValue(fence));
+
+    // The client ignores stale values too.
+    ReturnFenceUpdateCompletedValueCmd cmd;
+    cmd.fenceId = 1;
+    cmd.fenceSerial = 0;
+    cmd.value = 2;
+    ASSERT_TRUE(FlushRawReplies(&cmd, sizeof(cmd)));
+    EXPECT_EQ(3u, dawnFenceGetCompletedValue(fence));
+}
+
+// Check that OnCompletion is validated on the client, for values that are already completed or
+// were never signaled
+TEST_F(WireFenceTests, OnCompletionValidatedOnClient) {
+    dawnDeviceSetErrorCallback(device, ToMockDeviceErrorCallback, 0);
+
+    EXPECT_CALL(*mockFenceOnCompletionCallback, Call(DAWN_FENCE_COMPLETION_STATUS_SUCCESS, 1))
+        .Times(1);
+    dawnFenceOnCompletion(fence, 1, ToMockFenceOnCompletionCallback, 1);
+
+    EXPECT_CALL(*mockDeviceErrorCallback, Call(_, 0))
+        .Times(1);
+    EXPECT_CALL(*mockFenceOnCompletionCallback, Call(DAWN_FENCE_COMPLETION_STATUS_ERROR, 2))
+        .Times(1);
+    dawnFenceOnCompletion(fence, 2, ToMockFenceOnCompletionCallback, 2);
+
+    // Nothing is sent to the server.
+    FlushClient();
+}
+
+// Check that the server only waits for the signals that are valid
+TEST_F(WireFenceTests, InvalidSignalNotWaitedOn) {
+    dawnQueueSignal(queue, fence, 1);
+    EXPECT_CALL(api, QueueSignal(apiQueue, apiFence, 1))
+        .Times(1);
+    EXPECT_CALL(api, OnFenceOnCompletionCallback(_, _, _, _))
+        .Times(0);
+    FlushClient();
+
+    EXPECT_EQ(0u, GetServerCounters().pendingFenceCompletionCount);
+}
+
+// Check that the pending OnCompletion callbacks are called when the fence is destroyed
+TEST_F(WireFenceTests, DestroyBeforeCompletion) {
+    dawnQueueSignal(queue, fence, 2);
+    EXPECT_CALL(api, QueueSignal(apiQueue, apiFence, 2))
+        .Times(1);
+    EXPECT_CALL(api, OnFenceOnCompletionCallback(apiFence, 2, _, _))
+        .Times(1);
+    FlushClient();
+
+    dawnCallbackUserdata userdata = 1205;
+    dawnFenceOnCompletion(fence, 2, ToMockFenceOnCompletionCallback, userdata);
+
+    EXPECT_CALL(*mockFenceOnCompletionCallback, Call(DAWN_FENCE_COMPLETION_STATUS_UNKNOWN, userdata))
+        .Times(1);
+    dawnFenceRelease(fence);
+
+    EXPECT_CALL(api, FenceRelease(apiFence))
+        .Times(1);
+    FlushClient();
+
+    // The reply for the destroyed fence is ignored by the client.
+    api.CallFenceOnCompletionCallback(apiFence, DAWN_FENCE_COMPLETION_STATUS_SUCCESS);
+    FlushServer();
+}
+
+// Server options that make every batch of commands be decoded on the decode thread.
+static ServerOptions AlwaysPipelinedDecodeOptions() {
+    ServerOptions options;
+    options.pipelinedDecodeMinBatchSize = 1;
+    return options;
+}
+
+class WirePipelinedDecodeTests : public WireTestsBase {
+    public:
+        WirePipelinedDecodeTests() : WireTestsBase(true, AlwaysPipelinedDecodeOptions()) {
+        }
+};
+
+// Test that objects created in a batch can be used by the following commands of the batch, even
+// when they are decoded in a different chunk of commands.
+TEST_F(WirePipelinedDecodeTests, CreateThenCallManyTimes) {
+    constexpr uint32_t kDispatchCount = 1000;
+
+    dawnCommandBufferBuilder builder = dawnDeviceCreateCommandBufferBuilder(device);
+    for (uint32_t i = 0; i < kDispatchCount; ++i) {
+        dawnCommandBufferBuilderDispatch(builder, i, 1, 1);
+    }
+    dawnCommandBufferBuilderGetResult(builder);
+
+    dawnCommandBufferBuilder apiCmdBufBuilder = api.GetNewCommandBufferBuilder();
+    dawnCommandBuffer apiCmdBuf = api.GetNewCommandBuffer();
+    {
+        InSequence sequence;
+        EXPECT_CALL(api, DeviceCreateCommandBufferBuilder(apiDevice))
+            .WillOnce(Return(apiCmdBufBuilder));
+        for (uint32_t i = 0; i < kDispatchCount; ++i) {
+            EXPECT_CALL(api, CommandBufferBuilderDispatch(apiCmdBufBuilder, i, 1, 1))
+                .Times(1);
+        }
+        EXPECT_CALL(api, CommandBufferBuilderGetResult(apiCmdBufBuilder))
+            .WillOnce(Return(apiCmdBuf));
+    }
+
+    FlushClient();
+}
+
+// Test that an ID freed and reused by the client in the same batch refers to the new object
+TEST_F(WirePipelinedDecodeTests, ReleaseThenReuseId) {
+    dawnCommandBufferBuilder builder1 = dawnDeviceCreateCommandBufferBuilder(device);
+    dawnCommandBufferBuilderRelease(builder1);
+
+    dawnCommandBufferBuilder builder2 = dawnDeviceCreateCommandBufferBuilder(device);
+    dawnCommandBufferBuilderDispatch(builder2, 1, 2, 3);
+
+    dawnCommandBufferBuilder apiCmdBufBuilder1 = api.GetNewCommandBufferBuilder();
+    dawnCommandBufferBuilder apiCmdBufBuilder2 = api.GetNewCommandBufferBuilder();
+    {
+        InSequence sequence;
+        EXPECT_CALL(api, DeviceCreateCommandBufferBuilder(apiDevice))
+            .WillOnce(Return(apiCmdBufBuilder1));
+        EXPECT_CALL(api, CommandBufferBuilderRelease(apiCmdBufBuilder1));
+        EXPECT_CALL(api, DeviceCreateCommandBufferBuilder(apiDevice))
+            .WillOnce(Return(apiCmdBufBuilder2));
+        EXPECT_CALL(api, CommandBufferBuilderDispatch(apiCmdBufBuilder2, 1, 2, 3))
+            .Times(1);
+    }
+
+    FlushClient();
+}
+
+// Test that calls using an object that became an error earlier in the batch are skipped
+TEST_F(WirePipelinedDecodeTests, CallsSkippedAfterBuilderError) {
+    dawnCommandBufferBuilder cmdBufBuilder = dawnDeviceCreateCommandBufferBuilder(device);
+
+    dawnBufferBuilder bufferBuilder = dawnDeviceCreateBufferBuilderForTesting(device);
+    dawnBuffer buffer = dawnBufferBuilderGetResult(bufferBuilder);
+
+    dawnCommandBufferBuilderSetIndexBuffer(cmdBufBuilder, buffer, 0);
+    dawnCommandBufferBuilderDispatch(cmdBufBuilder, 1, 2, 3);
+
+    dawnCommandBufferBuilder apiCmdBufBuilder = api.GetNewCommandBufferBuilder();
+    EXPECT_CALL(api, DeviceCreateCommandBufferBuilder(apiDevice))
+        .WillOnce(Return(apiCmdBufBuilder));
+
+    dawnBufferBuilder apiBufferBuilder = api.GetNewBufferBuilder();
+    EXPECT_CALL(api, DeviceCreateBufferBuilderForTesting(apiDevice))
+        .WillOnce(Return(apiBufferBuilder));
+
+    EXPECT_CALL(api, BufferBuilderGetResult(apiBufferBuilder))
+        .WillOnce(InvokeWithoutArgs([&]() -> dawnBuffer {
+            api.CallBuilderErrorCallback(apiBufferBuilder, DAWN_BUILDER_ERROR_STATUS_ERROR, "Error");
+            return nullptr;
+        }));
+
+    // The builder becomes an error when it is used with the error buffer
+    EXPECT_CALL(api, CommandBufferBuilderSetIndexBuffer(_, _, _)).Times(0);
+    EXPECT_CALL(api, CommandBufferBuilderDispatch(_, _, _, _)).Times(0);
+
+    FlushClient();
+}
+
+// Tests for the different policies of the server for calling deviceTick
+class WireTickPolicyTests : public WireTestsBase {
+    public:
+        WireTickPolicyTests() : WireTestsBase(true) {
+        }
+
+        void SetUp() override {
+            // Each test sets up the wire with its own policy.
+        }
+
+        void SetUpWithTickPolicy(ServerTickPolicy policy, uint32_t intervalMilliseconds = 0) {
+            mServerOptions.tickPolicy = policy;
+            mServerOptions.tickIntervalMilliseconds = intervalMilliseconds;
+            WireTestsBase::SetUp();
+        }
+};
+
+// Test the server ticks before each batch of commands by default
+TEST_F(WireTickPolicyTests, EveryBatch) {
+    SetUpWithTickPolicy(ServerTickPolicy::EveryBatch);
+
+    EXPECT_CALL(api, DeviceTick(apiDevice)).Times(2);
+    FlushClient();
+    FlushClient();
+
+    ServerCounters counters = GetServerCounters();
+    ASSERT_EQ(counters.batchCount, 2u);
+    ASSERT_EQ(counters.tickCount, 2u);
+}
+
+// Test the server never ticks when the embedder ticks explicitly
+TEST_F(WireTickPolicyTests, Explicit) {
+    SetUpWithTickPolicy(ServerTickPolicy::Explicit);
+
+    EXPECT_CALL(api, DeviceTick(_)).Times(0);
+    dawnDeviceCreateCommandBufferBuilder(device);
+    EXPECT_CALL(api, DeviceCreateCommandBufferBuilder(apiDevice))
+        .WillOnce(Return(api.GetNewCommandBufferBuilder()));
+    FlushClient();
+    FlushClient();
+
+    ServerCounters counters = GetServerCounters();
+    ASSERT_EQ(counters.batchCount, 2u);
+    ASSERT_EQ(counters.tickCount, 0u);
+}
+
+// Test the server ticks at most once per interval
+TEST_F(WireTickPolicyTests, FixedInterval) {
+    // An interval long enough to never elapse during the test.
+    SetUpWithTickPolicy(ServerTickPolicy::FixedInterval, 3600 * 1000);
+
+    EXPECT_CALL(api, DeviceTick(_)).Times(0);
+    FlushClient();
+    FlushClient();
+
+    ServerCounters counters = GetServerCounters();
+    ASSERT_EQ(counters.batchCount, 2u);
+    ASSERT_EQ(counters.tickCount, 0u);
+}
+
+// Test the server only ticks while map requests are waiting for their callback
+TEST_F(WireTickPolicyTests, WhenPending) {
+    SetUpWithTickPolicy(ServerTickPolicy::WhenPending);
+
+    dawnBufferDescriptor descriptor;
+    descriptor.nextInChain = nullptr;
+    dawnBuffer buffer = dawnDeviceCreateBuffer(device, &descriptor);
+
+    dawnBuffer apiBuffer = api.GetNewBuffer();
+    EXPECT_CALL(api, DeviceCreateBuffer(apiDevice, _))
+        .WillOnce(Return(apiBuffer));
+    FlushClient();
+    ASSERT_EQ(GetServerCounters().tickCount, 0u);
+
+    // The tick happens for the first batch after the map request.
+    dawnCallbackUserdata userdata = 8653;
+    dawnBufferMapReadAsync(buffer, 40, sizeof(uint32_t), ToMockBufferMapReadCallback, userdata);
+    EXPECT_CALL(api, OnBufferMapReadAsyncCallback(apiBuffer, 40, sizeof(uint32_t), _, _))
+        .Times(1);
+    FlushClient();
+    ASSERT_EQ(GetServerCounters().pendingMapRequestCount, 1u);
+    ASSERT_EQ(GetServerCounters().tickCount, 0u);
+
+    EXPECT_CALL(api, DeviceTick(apiDevice))
+        .WillOnce(InvokeWithoutArgs([&]() {
+            api.CallMapReadCallback(apiBuffer, DAWN_BUFFER_MAP_ASYNC_STATUS_ERROR, nullptr);
+        }));
+    FlushClient();
+    ASSERT_EQ(GetServerCounters().pendingMapRequestCount, 0u);
+    ASSERT_EQ(GetServerCounters().tickCount, 1u);
+
+    EXPECT_CALL(*mockBufferMapReadCallback, Call(DAWN_BUFFER_MAP_ASYNC_STATUS_ERROR, nullptr, userdata))
+        .Times(1);
+    FlushServer();
+
+    // No more ticks once the callback has been called.
+    FlushClient();
+    ASSERT_EQ(GetServerCounters().tickCount, 1u);
+}
+
+// Tests for the flushing of the replies by the server
+class WireReplyFlushTests : public WireTestsBase {
+    public:
+        WireReplyFlushTests() : WireTestsBase(true) {
+        }
+
+        void SetUp() override {
+            // Each test sets up the wire with its own policy.
+        }
+
+        void SetUpWithReplyFlushPolicy(ServerReplyFlushPolicy policy) {
+            mServerOptions.replyFlushPolicy = policy;
+            // A window long enough to never elapse during the test.
+            mServerOptions.replyCoalescingWindowMicroseconds = 3600u * 1000 * 1000;
+            WireTestsBase::SetUp();
+
+            dawnDeviceSetErrorCallback(device, ToMockDeviceErrorCallback, 0);
+        }
+
+        // Makes the server produce a device error while it handles the next batch of commands.
+        void ProduceDeviceErrorInNextBatch() {
+            dawnDeviceCreateCommandBufferBuilder(device);
+            EXPECT_CALL(api, DeviceCreateCommandBufferBuilder(apiDevice))
+                .WillOnce(InvokeWithoutArgs([&]() {
+                    api.CallDeviceErrorCallback(apiDevice, "Some error message");
+                    return api.GetNewCommandBufferBuilder();
+                }));
+        }
+};
+
+// Test the server leaves the flushing of the replies to the embedder by default
+TEST_F(WireReplyFlushTests, Embedder) {
+    SetUpWithReplyFlushPolicy(ServerReplyFlushPolicy::Embedder);
+
+    ProduceDeviceErrorInNextBatch();
+    EXPECT_CALL(*mockDeviceErrorCallback, Call(_, _)).Times(0);
+    FlushClient();
+    ASSERT_EQ(GetServerCounters().replyFlushCount, 0u);
+
+    EXPECT_CALL(*mockDeviceErrorCallback, Call(StrEq("Some error message"), _)).Times(1);
+    FlushServer();
+}
+
+// Test the replies are flushed at the end of the batch that produced them
+TEST_F(WireReplyFlushTests, EveryBatch) {
+    SetUpWithReplyFlushPolicy(ServerReplyFlushPolicy::EveryBatch);
+
+    // Batches without replies don't flush
+    FlushClient();
+    ASSERT_EQ(GetServerCounters().replyFlushCount, 0u);
+
+    ProduceDeviceErrorInNextBatch();
+    EXPECT_CALL(*mockDeviceErrorCallback, Call(StrEq("Some error message"), _)).Times(1);
+    FlushClient();
+    ASSERT_EQ(GetServerCounters().replyFlushCount, 1u);
+}
+
+// Test the replies are held until the coalescing window elapses or they are flushed explicitly
+TEST_F(WireReplyFlushTests, CoalescingWindow) {
+    SetUpWithReplyFlushPolicy(ServerReplyFlushPolicy::CoalescingWindow);
+
+    ProduceDeviceErrorInNextBatch();
+    EXPECT_CALL(*mockDeviceErrorCallback, Call(_, _)).Times(0);
+    FlushClient();
+    ASSERT_EQ(GetServerCounters().replyFlushCount, 0u);
+
+    EXPECT_CALL(*mockDeviceErrorCallback, Call(StrEq("Some error message"), _)).Times(1);
+    FlushServerReplies();
+    ASSERT_EQ(GetServerCounters().replyFlushCount, 1u);
+
+    // Nothing to flush anymore
+    FlushServerReplies();
+    ASSERT_EQ(GetServerCounters().replyFlushCount, 1u);
+}
+
+// Test map replies are flushed without waiting for the coalescing window
+TEST_F(WireReplyFlushTests, MapRepliesAreNotCoalesced) {
+    SetUpWithReplyFlushPolicy(ServerReplyFlushPolicy::CoalescingWindow);
+
+    dawnBufferDescriptor descriptor;
+    descriptor.nextInChain = nullptr;
+    dawnBuffer buffer = dawnDeviceCreateBuffer(device, &descriptor);
+    dawnBuffer apiBuffer = api.GetNewBuffer();
+    EXPECT_CALL(api, DeviceCreateBuffer(apiDevice, _))
+        .WillOnce(Return(apiBuffer));
+    FlushClient();
+
+    dawnCallbackUserdata userdata = 8653;
+    dawnBufferMapReadAsync(buffer, 40, sizeof(uint32_t), ToMockBufferMapReadCallback, userdata);
+    EXPECT_CALL(api, OnBufferMapReadAsyncCallback(apiBuffer, 40, sizeof(uint32_t), _, _))
+        .Times(1);
+    FlushClient();
+
+    // The map callback fires while the embedder ticks the device outside of a batch of commands.
+    EXPECT_CALL(*mockBufferMapReadCallback, Call(DAWN_BUFFER_MAP_ASYNC_STATUS_ERROR, nullptr, userdata))
+        .Times(1);
+    api.CallMapReadCallback(apiBuffer, DAWN_BUFFER_MAP_ASYNC_STATUS_ERROR, nullptr);
+    ASSERT_EQ(GetServerCounters().replyFlushCount, 1u);
+}
+
+// Tests for the decoding of the replies on the client's reply thread
+class WireReplyThreadTests : public WireTestsBase {
+    public:
+        WireReplyThreadTests() : WireTestsBase(true) {
+        }
+
+        void SetUp() override {
+            mClientOptions.replyThread = true;
+            WireTestsBase::SetUp();
+        }
+};
+
+// Test callbacks are only called when the client delivers them
+TEST_F(WireReplyThreadTests, CallbacksAreDeferred) {
+    dawnDeviceSetErrorCallback(device, ToMockDeviceErrorCallback, 0);
+
+    api.CallDeviceErrorCallback(apiDevice, "First");
+    api.CallDeviceErrorCallback(apiDevice, "Second");
+
+    EXPECT_CALL(*mockDeviceErrorCallback, Call(_, _)).Times(0);
+    FlushServer();
+    Mock::VerifyAndClearExpectations(mockDeviceErrorCallback.get());
+
+    {
+        InSequence sequence;
+        EXPECT_CALL(*mockDeviceErrorCallback, Call(StrEq("First"), _)).Times(1);
+        EXPECT_CALL(*mockDeviceErrorCallback, Call(StrEq("Second"), _)).Times(1);
+    }
+    DeliverClientCallbacks();
+    Mock::VerifyAndClearExpectations(mockDeviceErrorCallback.get());
+
+    // Callbacks are delivered only once
+    EXPECT_CALL(*mockDeviceErrorCallback, Call(_, _)).Times(0);
+    DeliverClientCallbacks();
+}
+
+// Test map read data is still valid when the callback is delivered after the reply buffer is reused
+TEST_F(WireReplyThreadTests, MapReadData) {
+    dawnBufferDescriptor descriptor;
+    descriptor.nextInChain = nullptr;
+    dawnBuffer buffer = dawnDeviceCreateBuffer(device, &descriptor);
+    dawnBuffer apiBuffer = api.GetNewBuffer();
+    EXPECT_CALL(api, DeviceCreateBuffer(apiDevice, _))
+        .WillOnce(Return(apiBuffer));
+    FlushClient();
+
+    dawnCallbackUserdata userdata = 8653;
+    dawnBufferMapReadAsync(buffer, 40, sizeof(uint32_t), ToMockBufferMapReadCallback, userdata);
+
+    uint32_t bufferContent = 31337;
+    EXPECT_CALL(api, OnBufferMapReadAsyncCallback(apiBuffer, 40, sizeof(uint32_t), _, _))
+        .WillOnce(InvokeWithoutArgs([&]() {
+            api.CallMapReadCallback(apiBuffer, DAWN_BUFFER_MAP_ASYNC_STATUS_SUCCESS, &bufferContent);
+        }));
+    FlushClient();
+    FlushServer();
+
+    // Write over the reply buffer of the server.
+    dawnDeviceSetErrorCallback(device, ToMockDeviceErrorCallback, 0);
+    api.CallDeviceErrorCallback(apiDevice, "Some error message");
+    FlushServer();
+
+    {
+        InSequence sequence;
+        EXPECT_CALL(*mockBufferMapReadCallback, Call(DAWN_BUFFER_MAP_ASYNC_STATUS_SUCCESS, Pointee(Eq(bufferContent)), userdata))
+            .Times(1);
+        EXPECT_CALL(*mockDeviceErrorCallback, Call(StrEq("Some error message"), _)).Times(1);
+    }
+    DeliverClientCallbacks();
+}
+
+// Tests for the flow control between the client and the server
+static constexpr size_t kWindowBytes = 256;
+
+class WireFlowControlTests : public WireTestsBase {
+    public:
+        WireFlowControlTests() : WireTestsBase(true) {
+        }
+
+        void SetUp() override {
+            // Each test sets up the wire with its own options.
+        }
+
+        void SetUpWithFlowControl(bool blocks) {
+            mServerOptions.reportConsumedBytes = true;
+            mClientOptions.flowControlWindowBytes = kWindowBytes;
+            mClientOptions.flowControlBlocks = blocks;
+            if (blocks) {
+                // The credit comes back while the client is blocked in its call.
+                mClientOptions.replyThread = true;
+                mServerOptions.replyFlushPolicy = ServerReplyFlushPolicy::EveryBatch;
+            }
+            WireTestsBase::SetUp();
+
+            EXPECT_CALL(api, DeviceCreateCommandBufferBuilder(apiDevice))
+                .WillRepeatedly(InvokeWithoutArgs([&]() {
+                    return api.GetNewCommandBufferBuilder();
+                }));
+        }
+};
+
+// Test the client reports it would block once the window is full, and that the credit from the
+// server empties the queue
+TEST_F(WireFlowControlTests, WouldBlock) {
+    SetUpWithFlowControl(false);
+    ASSERT_EQ(GetClientInFlightBytes(), 0u);
+    ASSERT_FALSE(ClientWouldBlock());
+
+    while (!ClientWouldBlock()) {
+        dawnDeviceCreateCommandBufferBuilder(device);
+    }
+    uint64_t inFlightBytes = GetClientInFlightBytes();
+    ASSERT_GE(inFlightBytes, kWindowBytes);
+
+    // Commands over the window are still serialized without blocking.
+    dawnDeviceCreateCommandBufferBuilder(device);
+    ASSERT_GT(GetClientInFlightBytes(), inFlightBytes);
+    inFlightBytes = GetClientInFlightBytes();
+
+    // The commands are consumed but the client doesn't know until the replies are flushed.
+    FlushClient();
+    ASSERT_EQ(GetServerCounters().consumedBytes, inFlightBytes);
+    ASSERT_TRUE(ClientWouldBlock());
+
+    FlushServer();
+    ASSERT_EQ(GetClientInFlightBytes(), 0u);
+    ASSERT_FALSE(ClientWouldBlock());
+}
+
+// Test the server gives the credit for batches that fail
+TEST_F(WireFlowControlTests, CreditForFailedBatch) {
+    SetUpWithFlowControl(false);
+
+    while (!ClientWouldBlock()) {
+        dawnDeviceCreateCommandBufferBuilder(device);
+    }
+    FlushInvalidCommand();
+
+    FlushServer();
+    ASSERT_EQ(GetClientInFlightBytes(), 0u);
+    ASSERT_FALSE(ClientWouldBlock());
+}
+
+// Test a blocking client flushes its commands and waits for the credit to stay within the window
+TEST_F(WireFlowControlTests, Blocking) {
+    SetUpWithFlowControl(true);
+
+    for (int i = 0; i < 100; ++i) {
+        dawnDeviceCreateCommandBufferBuilder(device);
+        ASSERT_LE(GetClientInFlightBytes(), kWindowBytes);
+    }
+    ASSERT_GT(GetServerCounters().batchCount, 0u);
+
+    FlushClient();
+    DeliverClientCallbacks();
+    ASSERT_EQ(GetClientInFlightBytes(), 0u);
+}
+
+// Tests for the server multiplexing several clients on one device
+class WireMultiClientTests : public Test {
+    protected:
+        // One client with its own wire to the multi-client server
+        struct TestClient {
+            std::unique_ptr<utils::TerribleCommandBuffer> c2sBuf;
+            std::unique_ptr<utils::TerribleCommandBuffer> s2cBuf;
+            std::unique_ptr<ClientCommandHandler> wireClient;
+            CommandHandler* serverHandler;
+            dawnDevice device;
+
+            void FlushClient() {
+                ASSERT_TRUE(c2sBuf->Flush());
+            }
+
+            void FlushServer() {
+                ASSERT_TRUE(s2cBuf->Flush());
+            }
+        };
+
+        void SetUp() override {
+            mockDeviceErrorCallback = std::make_unique<MockDeviceErrorCallback>();
+
+            dawnProcTable mockProcs;
+            api.GetProcTableAndDevice(&mockProcs, &apiDevice);
+
+            EXPECT_CALL(api, OnDeviceSetErrorCallback(_, _, _)).Times(AnyNumber());
+            EXPECT_CALL(api, OnBuilderSetErrorCallback(_, _, _, _)).Times(AnyNumber());
+            EXPECT_CALL(api, DeviceTick(_)).Times(AnyNumber());
+            EXPECT_CALL(api, DeviceReference(apiDevice)).Times(AnyNumber());
+            EXPECT_CALL(api, DeviceRelease(apiDevice)).Times(AnyNumber());
+            // The objects the clients didn't destroy are released with the server.
+            EXPECT_CALL(api, BufferRelease(_)).Times(AnyNumber());
+            EXPECT_CALL(api, CommandBufferBuilderRelease(_)).Times(AnyNumber());
+
+            mServer.reset(NewMultiClientServer(apiDevice, mockProcs));
+        }
+
+        void TearDown() override {
+            dawnSetProcs(nullptr);
+            mClients.clear();
+            mServer = nullptr;
+
+            mockDeviceErrorCallback = nullptr;
+        }
+
+        TestClient* AddClient(size_t commandBytesPerTick) {
+            auto client = std::make_unique<TestClient>();
+            client->s2cBuf = std::make_unique<utils::TerribleCommandBuffer>();
+            client->serverHandler = mServer->AddClient(client->s2cBuf.get(), commandBytesPerTick);
+            client->c2sBuf = std::make_unique<utils::TerribleCommandBuffer>(client->serverHandler);
+
+            dawnProcTable clientProcs;
+            client->wireClient.reset(NewClientDevice(&clientProcs, &client->device, client->c2sBuf.get()));
+            client->s2cBuf->SetHandler(client->wireClient.get());
+            dawnSetProcs(&clientProcs);
+
+            mClients.push_back(std::move(client));
+            return mClients.back().get();
+        }
+
+        // Returns the size of a batch with a single command creating a command buffer builder.
+        size_t MeasureBatchSize() {
+            TestClient* probe = AddClient(0);
+            dawnDeviceCreateCommandBufferBuilder(probe->device);
+            probe->FlushClient();
+            size_t size = mServer->GetClientQueuedBytes(probe->serverHandler);
+            mServer->RemoveClient(probe->serverHandler);
+            return size;
+        }
+
+        MockProcTable api;
+        dawnDevice apiDevice;
+        std::unique_ptr<MultiClientServer> mServer;
+
+    private:
+        std::vector<std::unique_ptr<TestClient>> mClients;
+};
+
+// Test the clients use the same IDs for different objects and their commands wait for the tick
+TEST_F(WireMultiClientTests, SeparateIdNamespaces) {
+    TestClient* clientA = AddClient(1024 * 1024);
+    TestClient* clientB = AddClient(1024 * 1024);
+
+    dawnBufferDescriptor descriptor;
+    descriptor.nextInChain = nullptr;
+    dawnBuffer bufferA = dawnDeviceCreateBuffer(clientA->device, &descriptor);
+    dawnBuffer bufferB = dawnDeviceCreateBuffer(clientB->device, &descriptor);
+    clientA->FlushClient();
+    clientB->FlushClient();
+    ASSERT_GT(mServer->GetClientQueuedBytes(clientA->serverHandler), 0u);
+    ASSERT_GT(mServer->GetClientQueuedBytes(clientB->serverHandler), 0u);
+
+    dawnBuffer apiBufferA = api.GetNewBuffer();
+    dawnBuffer apiBufferB = api.GetNewBuffer();
+    EXPECT_CALL(api, DeviceCreateBuffer(apiDevice, _))
+        .WillOnce(Return(apiBufferA))
+        .WillOnce(Return(apiBufferB));
+    ASSERT_GT(mServer->Tick(), 0u);
+    ASSERT_EQ(mServer->GetClientQueuedBytes(clientA->serverHandler), 0u);
+    ASSERT_EQ(mServer->GetClientQueuedBytes(clientB->serverHandler), 0u);
+
+    dawnBufferUnmap(bufferB);
+    dawnBufferUnmap(bufferA);
+    clientA->FlushClient();
+    clientB->FlushClient();
+
+    EXPECT_CALL(api, BufferUnmap(apiBufferA)).Times(1);
+    EXPECT_CALL(api, BufferUnmap(apiBufferB)).Times(1);
+    mServer->Tick();
+}
+
+// Test each client executes its quota of commands per tick
+TEST_F(WireMultiClientTests, QuotaPerTick) {
+    size_t batchSize = MeasureBatchSize();
+    TestClient* clientA = AddClient(batchSize);
+    TestClient* clientB = AddClient(batchSize);
+
+    for (int i = 0; i < 3; ++i) {
+        dawnDeviceCreateCommandBufferBuilder(clientA->device);
+        clientA->FlushClient();
+    }
+    dawnDeviceCreateCommandBufferBuilder(clientB->device);
+    clientB->FlushClient();
+
+    EXPECT_CALL(api, DeviceCreateCommandBufferBuilder(apiDevice))
+        .Times(4)
+        .WillRepeatedly(InvokeWithoutArgs([&]() { return api.GetNewCommandBufferBuilder(); }));
+
+    uint64_t expectedBatchesA[] = {1, 2, 3, 3};
+    uint64_t expectedBatchesB[] = {1, 1, 1, 1};
+    for (int tick = 0; tick < 4; ++tick) {
+        mServer->Tick();
+        ASSERT_EQ(mServer->GetClientCounters(clientA->serverHandler).batchCount, expectedBatchesA[tick]);
+        ASSERT_EQ(mServer->GetClientCounters(clientB->serverHandler).batchCount, expectedBatchesB[tick]);
+    }
+}
+
+// Test a batch larger than the quota is executed but delays the next batches of the client
+TEST_F(WireMultiClientTests, BatchOverQuota) {
+    size_t batchSize = MeasureBatchSize();
+    TestClient* client = AddClient(batchSize);
+
+    for (int i = 0; i < 3; ++i) {
+        dawnDeviceCreateCommandBufferBuilder(client->device);
+    }
+    client->FlushClient();
+    dawnDeviceCreateCommandBufferBuilder(client->device);
+    client->FlushClient();
+
+    EXPECT_CALL(api, DeviceCreateCommandBufferBuilder(apiDevice))
+        .Times(4)
+        .WillRepeatedly(InvokeWithoutArgs([&]() { return api.GetNewCommandBufferBuilder(); }));
+
+    mServer->Tick();
+    ASSERT_EQ(mServer->GetClientCounters(client->serverHandler).batchCount, 1u);
+    mServer->Tick();
+    ASSERT_EQ(mServer->GetClientCounters(client->serverHandler).batchCount, 1u);
+
+    for (int i = 0; i < 3; ++i) {
+        mServer->Tick();
+    }
+    ASSERT_EQ(mServer->GetClientCounters(client->serverHandler).batchCount, 2u);
+}
+
+// Test device errors go to the client whose commands produced them, or to all clients otherwise
+TEST_F(WireMultiClientTests, DeviceErrors) {
+    TestClient* clientA = AddClient(1024 * 1024);
+    TestClient* clientB = AddClient(1024 * 1024);
+    dawnDeviceSetErrorCallback(clientA->device, ToMockDeviceErrorCallback, 1);
+    dawnDeviceSetErrorCallback(clientB->device, ToMockDeviceErrorCallback, 2);
+
+    dawnDeviceCreateCommandBufferBuilder(clientB->device);
+    clientB->FlushClient();
+    EXPECT_CALL(api, DeviceCreateCommandBufferBuilder(apiDevice))
+        .WillOnce(InvokeWithoutArgs([&]() {
+            api.CallDeviceErrorCallback(apiDevice, "Client error");
+            return api.GetNewCommandBufferBuilder();
+        }));
+    mServer->Tick();
+
+    EXPECT_CALL(*mockDeviceErrorCallback, Call(StrEq("Client error"), 2)).Times(1);
+    clientA->FlushServer();
+    clientB->FlushServer();
+
+    api.CallDeviceErrorCallback(apiDevice, "Device error");
+    EXPECT_CALL(*mockDeviceErrorCallback, Call(StrEq("Device error"), 1)).Times(1);
+    EXPECT_CALL(*mockDeviceErrorCallback, Call(StrEq("Device error"), 2)).Times(1);
+    clientA->FlushServer();
+    clientB->FlushServer();
+}
+
+// Test the commands of removed clients are dropped
+TEST_F(WireMultiClientTests, RemoveClient) {
+    TestClient* client = AddClient(1024 * 1024);
+
+    dawnDeviceCreateCommandBufferBuilder(client->device);
+    client->FlushClient();
+    mServer->RemoveClient(client->serverHandler);
+
+    EXPECT_CALL(api, DeviceCreateCommandBufferBuilder(_)).Times(0);
+    ASSERT_EQ(mServer->Tick(), 0u);
+}
+
+// Test the objects of removed clients are released on the next tick, with the device reference
+// the client had, last
+TEST_F(WireMultiClientTests, RemoveClientReleasesObjects) {
+    EXPECT_CALL(api, DeviceReference(apiDevice)).Times(1);
+    TestClient* client = AddClient(1024 * 1024);
+
+    dawnBufferDescriptor descriptor;
+    descriptor.nextInChain = nullptr;
+    dawnDeviceCreateBuffer(client->device, &descriptor);
+    client->FlushClient();
+
+    dawnBuffer apiBuffer = api.GetNewBuffer();
+    EXPECT_CALL(api, DeviceCreateBuffer(apiDevice, _)).WillOnce(Return(apiBuffer));
+    mServer->Tick();
+
+    mServer->RemoveClient(client->serverHandler);
+
+    {
+        InSequence sequence;
+        EXPECT_CALL(api, BufferRelease(apiBuffer)).Times(1);
+        EXPECT_CALL(api, DeviceRelease(apiDevice)).Times(1);
+    }
+    mServer->Tick();
+}
+
+// Test destroying the server releases the objects of the clients and waits for the callbacks the
+// device still has to call
+TEST_F(WireMultiClientTests, DestroyWithPendingMap) {
+    TestClient* client = AddClient(1024 * 1024);
+
+    dawnBufferDescriptor descriptor;
+    descriptor.nextInChain = nullptr;
+    dawnBuffer buffer = dawnDeviceCreateBuffer(client->device, &descriptor);
+    dawnBufferMapReadAsync(buffer, 0, sizeof(uint32_t),
+                           [](dawnBufferMapAsyncStatus, const void*, dawnCallbackUserdata) {}, 0);
+    client->FlushClient();
+
+    dawnBuffer apiBuffer = api.GetNewBuffer();
+    EXPECT_CALL(api, DeviceCreateBuffer(apiDevice, _)).WillOnce(Return(apiBuffer));
+    EXPECT_CALL(api, OnBufferMapReadAsyncCallback(apiBuffer, 0, sizeof(uint32_t), _, _)).Times(1);
+    mServer->Tick();
+    ASSERT_EQ(1u, mServer->GetClientCounters(client->serverHandler).pendingMapRequestCount);
+
+    {
+        InSequence sequence;
+        EXPECT_CALL(api, OnDeviceSetErrorCallback(apiDevice, nullptr, _)).Times(1);
+        EXPECT_CALL(api, BufferRelease(apiBuffer)).Times(1);
+        EXPECT_CALL(api, DeviceRelease(apiDevice)).Times(1);
+        EXPECT_CALL(api, DeviceWaitForIdle(apiDevice, _)).WillOnce(InvokeWithoutArgs([&]() {
+            api.CallMapReadCallback(apiBuffer, DAWN_BUFFER_MAP_ASYNC_STATUS_UNKNOWN, nullptr);
+        }));
+    }
+    mServer = nullptr;
+}
@@ -0,0 +1,280 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "dawn/dawncpp.h"
+#include "dawn_native/DawnNative.h"
+#include "dawn_native/NullBackend.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    // Tests only check that operations don't complete before the latency, which holds however
+    // loaded the machine is. Tests checking that an operation isn't complete yet use a latency
+    // longer than any test runs instead of relying on how fast they run.
+    constexpr uint64_t kLatencyNs = 100 * 1000 * 1000;
+    constexpr uint64_t kLongLatencyNs = 3600ull * 1000 * 1000 * 1000;
+
+    class SimulatedQueueTests : public testing::Test {
+      protected:
+        void SetUp() override {
+            dawnProcTable procs = dawn_native::GetProcs();
+            dawnSetProcs(&procs);
+        }
+
+        void SetUpDevice(uint64_t latencyNs) {
+            dawn_native::null::SimulatedQueueDescriptor queueDescriptor;
+            queueDescriptor.latencyNs = latencyNs;
+            device = dawn::Device::Acquire(dawn_native::null::CreateDevice(queueDescriptor));
+            queue = device.CreateQueue();
+        }
+
+        void TearDown() override {
+            queue = dawn::Queue();
+            device = dawn::Device();
+            dawnSetProcs(nullptr);
+        }
+
+        dawn::Buffer CreateMapReadBuffer() {
+            dawn::BufferDescriptor descriptor;
+            descriptor.size = 4;
+            descriptor.usage = dawn::BufferUsageBit::MapRead | dawn::BufferUsageBit::TransferDst;
+            return device.CreateBuffer(&descriptor);
+        }
+
+        void Submit() {
+            dawn::CommandBuffer commands = device.CreateCommandBufferBuilder().GetResult();
+            queue.Submit(1, &commands);
+        }
+
+        // Records the buffer index of each map callback in mCompletedMaps.
+        void MapRead(const dawn::Buffer& buffer, uint32_t index) {
+            mUserdata.push_back({this, index});
+            buffer.MapReadAsync(0, 4, MapReadCallback,
+                                static_cast<dawn::CallbackUserdata>(
+                                    reinterpret_cast<uintptr_t>(&mUserdata.back())));
+        }
+
+        // Ticks the device until count maps completed, and returns false on timeout.
+        bool WaitForMaps(size_t count) {
+            auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (mCompletedMaps.size() < count) {
+                if (std::chrono::steady_clock::now() > timeout) {
+                    return false;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                device.Tick();
+            }
+            return true;
+        }
+
+        dawn::Fence CreateFence() {
+            dawn::FenceDescriptor descriptor;
+            descriptor.initialValue = 0;
+            return queue.CreateFence(&descriptor);
+        }
+
+        // Records the value of each fence callback in mFenceCompletions. The callbacks are called
+        // from the completion waiter thread of the device.
+        void OnFenceCompletion(const dawn::Fence& fence, uint32_t value) {
+            mUserdata.push_back({this, value});
+            fence.OnCompletion(value, FenceCallback,
+                               static_cast<dawn::CallbackUserdata>(
+                                   reinterpret_cast<uintptr_t>(&mUserdata.back())));
+        }
+
+        // Waits without ticking the device until count fence callbacks were called, and returns
+        // false on timeout.
+        bool WaitForFenceCompletions(size_t count) {
+            std::unique_lock<std::mutex> lock(mFenceMutex);
+            return mFenceCondition.wait_for(lock, std::chrono::seconds(10), [this, count] {
+                return mFenceCompletions.size() >= count;
+            });
+        }
+
+        std::vector<uint32_t> GetFenceCompletions() {
+            std::lock_guard<std::mutex> lock(mFenceMutex);
+            return mFenceCompletions;
+        }
+
+        dawn::Device device;
+        dawn::Queue queue;
+        std::vector<uint32_t> mCompletedMaps;
+
+      private:
+        struct Userdata {
+            SimulatedQueueTests* test;
+            uint32_t index;
+        };
+
+        static void FenceCallback(dawnFenceCompletionStatus status,
+                                  dawnCallbackUserdata userdata) {
+            // Signals still in flight are cancelled when the device is destroyed.
+            if (status == DAWN_FENCE_COMPLETION_STATUS_UNKNOWN) {
+                return;
+            }
+            ASSERT_EQ(DAWN_FENCE_COMPLETION_STATUS_SUCCESS, status);
+            auto data = reinterpret_cast<Userdata*>(static_cast<uintptr_t>(userdata));
+            {
+                std::lock_guard<std::mutex> lock(data->test->mFenceMutex);
+                data->test->mFenceCompletions.push_back(data->index);
+            }
+            data->test->mFenceCondition.notify_all();
+        }
+
+        static void MapReadCallback(dawnBufferMapAsyncStatus status,
+                                    const void*,
+                                    dawnCallbackUserdata userdata) {
+            // Maps still in flight are cancelled when the buffer is destroyed.
+            if (status == DAWN_BUFFER_MAP_ASYNC_STATUS_UNKNOWN) {
+                return;
+            }
+            ASSERT_EQ(DAWN_BUFFER_MAP_ASYNC_STATUS_SUCCESS, status);
+            auto data = reinterpret_cast<Userdata*>(static_cast<uintptr_t>(userdata));
+            data->test->mCompletedMaps.push_back(data->index);
+        }
+
+        // A deque so that the userdata doesn't move when new maps are added.
+        std::deque<Userdata> mUserdata;
+
+        std::mutex mFenceMutex;
+        std::condition_variable mFenceCondition;
+        std::vector<uint32_t> mFenceCompletions;
+    };
+
+}  // anonymous namespace
+
+// Test that a map without work in flight completes at the next tick.
+TEST_F(SimulatedQueueTests, MapWithoutSubmissions) {
+    SetUpDevice(kLongLatencyNs);
+    dawn::Buffer buffer = CreateMapReadBuffer();
+    MapRead(buffer, 0);
+    EXPECT_TRUE(mCompletedMaps.empty());
+
+    device.Tick();
+    EXPECT_EQ(1u, mCompletedMaps.size());
+}
+
+// Test that a map waits for the submission before it.
+TEST_F(SimulatedQueueTests, MapWaitsForSubmission) {
+    SetUpDevice(kLongLatencyNs);
+    dawn::Buffer buffer = CreateMapReadBuffer();
+    Submit();
+    MapRead(buffer, 0);
+
+    device.Tick();
+    device.Tick();
+    EXPECT_TRUE(mCompletedMaps.empty());
+}
+
+// Test that a map completes after the latency of the submission before it.
+TEST_F(SimulatedQueueTests, MapCompletesAfterLatency) {
+    SetUpDevice(kLatencyNs);
+    dawn::Buffer buffer = CreateMapReadBuffer();
+    auto start = std::chrono::steady_clock::now();
+    Submit();
+    MapRead(buffer, 0);
+
+    ASSERT_TRUE(WaitForMaps(1));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::nanoseconds(kLatencyNs));
+}
+
+// Test that maps complete in the order of the submissions they wait for.
+TEST_F(SimulatedQueueTests, MapsCompleteInOrder) {
+    SetUpDevice(kLatencyNs);
+    std::vector<dawn::Buffer> buffers;
+    for (uint32_t i = 0; i < 3; ++i) {
+        buffers.push_back(CreateMapReadBuffer());
+        Submit();
+        MapRead(buffers.back(), i);
+    }
+
+    ASSERT_TRUE(WaitForMaps(3));
+    EXPECT_EQ((std::vector<uint32_t>{0, 1, 2}), mCompletedMaps);
+}
+
+// Test that waiting for the device to be idle completes a map without polling.
+TEST_F(SimulatedQueueTests, WaitForIdleCompletesMap) {
+    SetUpDevice(kLatencyNs);
+    dawn::Buffer buffer = CreateMapReadBuffer();
+    auto start = std::chrono::steady_clock::now();
+    Submit();
+    MapRead(buffer, 0);
+
+    device.WaitForIdle(std::numeric_limits<uint64_t>::max());
+    EXPECT_EQ(1u, mCompletedMaps.size());
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::nanoseconds(kLatencyNs));
+}
+
+// Test that waiting for the device to be idle returns after the timeout if the GPU is still busy.
+TEST_F(SimulatedQueueTests, WaitForIdleTimeout) {
+    SetUpDevice(kLongLatencyNs);
+    dawn::Buffer buffer = CreateMapReadBuffer();
+    Submit();
+    MapRead(buffer, 0);
+
+    device.WaitForIdle(1000 * 1000);
+    EXPECT_TRUE(mCompletedMaps.empty());
+}
+
+// Test that fence callbacks are called once the GPU is done with the signals, without ticking the
+// device.
+TEST_F(SimulatedQueueTests, FenceCompletesWithoutTick) {
+    SetUpDevice(kLatencyNs);
+    dawn::Fence fence = CreateFence();
+    auto start = std::chrono::steady_clock::now();
+    Submit();
+    queue.Signal(fence, 1);
+    Submit();
+    queue.Signal(fence, 2);
+    OnFenceCompletion(fence, 1);
+    OnFenceCompletion(fence, 2);
+
+    ASSERT_TRUE(WaitForFenceCompletions(2));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::nanoseconds(kLatencyNs));
+    EXPECT_EQ((std::vector<uint32_t>{1, 2}), GetFenceCompletions());
+    EXPECT_EQ(2u, fence.GetCompletedValue());
+}
+
+// Test that the callbacks are called even if the fence is released before the signal completes.
+TEST_F(SimulatedQueueTests, FenceReleasedBeforeCompletion) {
+    SetUpDevice(kLatencyNs);
+    {
+        dawn::Fence fence = CreateFence();
+        Submit();
+        queue.Signal(fence, 1);
+        OnFenceCompletion(fence, 1);
+    }
+
+    ASSERT_TRUE(WaitForFenceCompletions(1));
+}
+
+// Test that the device can be destroyed while the completion waiter waits for the GPU.
+TEST_F(SimulatedQueueTests, DestroyWhileWaitingForFence) {
+    SetUpDevice(kLongLatencyNs);
+    dawn::Fence fence = CreateFence();
+    Submit();
+    queue.Signal(fence, 1);
+    OnFenceCompletion(fence, 1);
+
+    EXPECT_TRUE(GetFenceCompletions().empty());
+}
@@ -0,0 +1,48 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tests/unittests/validation/ValidationTest.h"
+
+#include "utils/DawnHelpers.h"
+
+// The validation tests run on the null backend, which interprets the shaders on the CPU.
+class UnsupportedShaderTests : public ValidationTest {
+};
+
+// Test that a dispatch with a shader the interpreter doesn't support produces a device error
+// instead of doing nothing
+TEST_F(UnsupportedShaderTests, DispatchProducesDeviceError) {
+    // The interpreter only supports 32-bit scalars.
+    dawn::ShaderModule module = utils::CreateShaderModule(device, dawn::ShaderStage::Compute, R"(
+        #version 450
+        void main() {
+            double value = 1.0lf;
+        })");
+
+    dawn::ComputePipelineDescriptor descriptor;
+    descriptor.module = module.Clone();
+    descriptor.entryPoint = "main";
+    descriptor.layout = utils::MakeBasicPipelineLayout(device, nullptr);
+    dawn::ComputePipeline pipeline = device.CreateComputePipeline(&descriptor);
+
+    dawn::CommandBuffer commands = AssertWillBeSuccess(device.CreateCommandBufferBuilder())
+                                       .BeginComputePass()
+                                       .SetComputePipeline(pipeline)
+                                       .Dispatch(1, 1, 1)
+                                       .EndComputePass()
+                                       .GetResult();
+
+    dawn::Queue queue = device.CreateQueue();
+    ASSERT_DEVICE_ERROR(queue.Submit(1, &commands));
+}
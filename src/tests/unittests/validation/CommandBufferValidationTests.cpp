@@ -14,6 +14,12 @@
 
 #include "tests/unittests/validation/ValidationTest.h"
 
+#include "dawn_native/CommandBuffer.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
 class CommandBufferValidationTest : public ValidationTest {
 };
 
@@ -35,3 +41,138 @@ TEST_F(CommandBufferValidationTest, RenderPass) {
         .BeginRenderPass(renderpass)
         .GetResult();
 }
+
+// Tests for command buffers with enough passes to be validated in parallel
+TEST_F(CommandBufferValidationTest, ManyPasses) {
+    constexpr uint32_t kPassCount = 20;
+    auto renderpass = CreateSimpleRenderPass();
+
+    dawn::BufferDescriptor descriptor;
+    descriptor.size = 4;
+    descriptor.usage = dawn::BufferUsageBit::TransferSrc | dawn::BufferUsageBit::TransferDst;
+    dawn::Buffer buffer = device.CreateBuffer(&descriptor);
+
+    // Passes of both types with commands between them
+    {
+        dawn::CommandBufferBuilder builder =
+            AssertWillBeSuccess(device.CreateCommandBufferBuilder());
+        for (uint32_t i = 0; i < kPassCount; ++i) {
+            builder.BeginRenderPass(renderpass).EndRenderPass();
+            builder.CopyBufferToBuffer(buffer, 0, buffer, 0, 0);
+            builder.BeginComputePass().EndComputePass();
+        }
+        builder.GetResult();
+    }
+
+    // An error in one of the passes
+    {
+        dawn::CommandBufferBuilder builder =
+            AssertWillBeError(device.CreateCommandBufferBuilder());
+        for (uint32_t i = 0; i < kPassCount; ++i) {
+            builder.BeginRenderPass(renderpass);
+            if (i == kPassCount / 2) {
+                builder.Dispatch(1, 1, 1);
+            }
+            builder.EndRenderPass();
+        }
+        builder.GetResult();
+    }
+
+    // An error outside of the passes, after all of them
+    {
+        dawn::CommandBufferBuilder builder =
+            AssertWillBeError(device.CreateCommandBufferBuilder());
+        for (uint32_t i = 0; i < kPassCount; ++i) {
+            builder.BeginComputePass().EndComputePass();
+        }
+        builder.CopyBufferToBuffer(buffer, 0, buffer, 0, 8);
+        builder.GetResult();
+    }
+
+    // The last pass isn't finished
+    {
+        dawn::CommandBufferBuilder builder =
+            AssertWillBeError(device.CreateCommandBufferBuilder());
+        for (uint32_t i = 0; i < kPassCount; ++i) {
+            builder.BeginComputePass().EndComputePass();
+        }
+        builder.BeginRenderPass(renderpass);
+        builder.GetResult();
+    }
+}
+
+// Test that the passes validated in parallel report the same error as when they are validated
+// serially, including when several of them have an error.
+TEST_F(CommandBufferValidationTest, ManyPassesSameErrorInParallel) {
+    auto renderpass = CreateSimpleRenderPass();
+
+    auto GetErrorMessage = [&](uint32_t passCount) -> std::string {
+        std::string message;
+        dawn::CommandBufferBuilder builder = device.CreateCommandBufferBuilder();
+        builder.SetErrorCallback(
+            [](dawnBuilderErrorStatus status, const char* statusMessage,
+               dawn::CallbackUserdata userdata1, dawn::CallbackUserdata) {
+                if (status == DAWN_BUILDER_ERROR_STATUS_ERROR) {
+                    *reinterpret_cast<std::string*>(static_cast<uintptr_t>(userdata1)) =
+                        statusMessage;
+                }
+            },
+            static_cast<dawn::CallbackUserdata>(reinterpret_cast<uintptr_t>(&message)), 0);
+
+        // The first pass with an error is a render pass and the last pass is a compute pass with
+        // a different error that must not be the one reported.
+        for (uint32_t i = 0; i < passCount - 1; ++i) {
+            builder.BeginRenderPass(renderpass);
+            if (i == passCount / 2) {
+                builder.Dispatch(1, 1, 1);
+            }
+            builder.EndRenderPass();
+        }
+        builder.BeginComputePass().DrawArrays(3, 1, 0, 0).EndComputePass();
+        builder.GetResult();
+
+        return message;
+    };
+
+    constexpr uint32_t kThreshold =
+        static_cast<uint32_t>(dawn_native::kMinPassCountForParallelValidation);
+    std::string serialMessage = GetErrorMessage(kThreshold - 1);
+    ASSERT_NE("", serialMessage);
+    ASSERT_EQ(serialMessage, GetErrorMessage(kThreshold));
+    ASSERT_EQ(serialMessage, GetErrorMessage(kThreshold * 4));
+}
+
+// Test that command buffers using the same objects can be recorded on several threads at once
+TEST_F(CommandBufferValidationTest, RecordOnSeveralThreads) {
+    constexpr uint32_t kThreadCount = 4;
+    constexpr uint32_t kCommandBuffersPerThread = 50;
+
+    dawn::BufferDescriptor descriptor;
+    descriptor.size = 4;
+    descriptor.usage = dawn::BufferUsageBit::TransferSrc | dawn::BufferUsageBit::TransferDst;
+    dawn::Buffer source = device.CreateBuffer(&descriptor);
+    dawn::Buffer destination = device.CreateBuffer(&descriptor);
+
+    std::vector<std::vector<dawn::CommandBuffer>> commands(kThreadCount);
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < kThreadCount; ++i) {
+        threads.emplace_back([&, i]() {
+            for (uint32_t j = 0; j < kCommandBuffersPerThread; ++j) {
+                commands[i].push_back(device.CreateCommandBufferBuilder()
+                                          .CopyBufferToBuffer(source, 0, destination, 0, 4)
+                                          .GetResult());
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    dawn::Queue queue = device.CreateQueue();
+    for (const std::vector<dawn::CommandBuffer>& threadCommands : commands) {
+        for (const dawn::CommandBuffer& commandBuffer : threadCommands) {
+            ASSERT_NE(nullptr, commandBuffer.Get());
+        }
+        queue.Submit(static_cast<uint32_t>(threadCommands.size()), threadCommands.data());
+    }
+}
@@ -0,0 +1,141 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tests/unittests/validation/ValidationTest.h"
+
+#include <gmock/gmock.h>
+
+#include <memory>
+
+using namespace testing;
+
+class MockFenceOnCompletionCallback {
+    public:
+        MOCK_METHOD2(Call, void(dawnFenceCompletionStatus status, dawnCallbackUserdata userdata));
+};
+
+static std::unique_ptr<MockFenceOnCompletionCallback> mockFenceOnCompletionCallback;
+static void ToMockFenceOnCompletionCallback(dawnFenceCompletionStatus status, dawnCallbackUserdata userdata) {
+    mockFenceOnCompletionCallback->Call(status, userdata);
+}
+
+class FenceValidationTest : public ValidationTest {
+    protected:
+        dawn::Fence CreateFence(uint64_t initialValue) {
+            dawn::FenceDescriptor descriptor;
+            descriptor.initialValue = initialValue;
+
+            return queue.CreateFence(&descriptor);
+        }
+
+        dawn::Queue queue;
+
+    private:
+        void SetUp() override {
+            ValidationTest::SetUp();
+
+            mockFenceOnCompletionCallback = std::make_unique<MockFenceOnCompletionCallback>();
+            queue = device.CreateQueue();
+        }
+
+        void TearDown() override {
+            // Delete mocks so that expectations are checked
+            mockFenceOnCompletionCallback = nullptr;
+
+            ValidationTest::TearDown();
+        }
+};
+
+// Test that the fence starts with its initial value
+TEST_F(FenceValidationTest, CreationSuccess) {
+    dawn::Fence fence = CreateFence(3);
+    EXPECT_EQ(3u, fence.GetCompletedValue());
+}
+
+// Test that OnCompletion for a value that is already completed calls the callback immediately
+TEST_F(FenceValidationTest, OnCompletionImmediate) {
+    dawn::Fence fence = CreateFence(1);
+
+    EXPECT_CALL(*mockFenceOnCompletionCallback, Call(DAWN_FENCE_COMPLETION_STATUS_SUCCESS, 0))
+        .Times(1);
+    fence.OnCompletion(0u, ToMockFenceOnCompletionCallback, 0);
+
+    EXPECT_CALL(*mockFenceOnCompletionCallback, Call(DAWN_FENCE_COMPLETION_STATUS_SUCCESS, 1))
+        .Times(1);
+    fence.OnCompletion(1u, ToMockFenceOnCompletionCallback, 1);
+}
+
+// Test that OnCompletion for a value greater than the signaled value is an error
+TEST_F(FenceValidationTest, OnCompletionLargerThanSignaled) {
+    dawn::Fence fence = CreateFence(1);
+
+    EXPECT_CALL(*mockFenceOnCompletionCallback, Call(DAWN_FENCE_COMPLETION_STATUS_ERROR, 0))
+        .Times(1);
+    ASSERT_DEVICE_ERROR(fence.OnCompletion(2u, ToMockFenceOnCompletionCallback, 0));
+
+    queue.Signal(fence, 2);
+    EXPECT_CALL(*mockFenceOnCompletionCallback, Call(DAWN_FENCE_COMPLETION_STATUS_ERROR, 1))
+        .Times(1);
+    ASSERT_DEVICE_ERROR(fence.OnCompletion(3u, ToMockFenceOnCompletionCallback, 1));
+
+    // The signaled value itself is valid.
+    EXPECT_CALL(*mockFenceOnCompletionCallback, Call(DAWN_FENCE_COMPLETION_STATUS_SUCCESS, 2))
+        .Times(1);
+    fence.OnCompletion(2u, ToMockFenceOnCompletionCallback, 2);
+}
+
+// Test that a signal completes immediately when the GPU has no work in flight. The signals
+// waiting for the GPU are tested with the simulated queue of the null backend.
+TEST_F(FenceValidationTest, GetCompletedValueAfterSignal) {
+    dawn::Fence fence = CreateFence(1);
+
+    queue.Signal(fence, 3);
+    EXPECT_EQ(3u, fence.GetCompletedValue());
+}
+
+// Test that the callbacks of completed signals are called without ticking the device
+TEST_F(FenceValidationTest, OnCompletionWithoutTick) {
+    dawn::Fence fence = CreateFence(0);
+    queue.Signal(fence, 1);
+
+    EXPECT_CALL(*mockFenceOnCompletionCallback, Call(DAWN_FENCE_COMPLETION_STATUS_SUCCESS, 1))
+        .Times(1);
+    fence.OnCompletion(1u, ToMockFenceOnCompletionCallback, 1);
+}
+
+// Test that signaling a value that isn't greater than the signaled value is an error
+TEST_F(FenceValidationTest, SignalValueNotIncreasing) {
+    dawn::Fence fence = CreateFence(1);
+
+    ASSERT_DEVICE_ERROR(queue.Signal(fence, 0));
+    ASSERT_DEVICE_ERROR(queue.Signal(fence, 1));
+
+    queue.Signal(fence, 2);
+    ASSERT_DEVICE_ERROR(queue.Signal(fence, 2));
+
+    EXPECT_EQ(2u, fence.GetCompletedValue());
+}
+
+// Test that a fence can only be signaled on the queue it was created on
+TEST_F(FenceValidationTest, SignalOnOtherQueue) {
+    dawn::Fence fence = CreateFence(1);
+    dawn::Queue otherQueue = device.CreateQueue();
+
+    ASSERT_DEVICE_ERROR(otherQueue.Signal(fence, 2));
+
+    // The signal on the other queue didn't change the signaled value.
+    EXPECT_CALL(*mockFenceOnCompletionCallback, Call(DAWN_FENCE_COMPLETION_STATUS_ERROR, 0))
+        .Times(1);
+    ASSERT_DEVICE_ERROR(fence.OnCompletion(2u, ToMockFenceOnCompletionCallback, 0));
+}
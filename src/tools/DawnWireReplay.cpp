@@ -0,0 +1,378 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// dawn_wire_replay feeds a capture of the client-to-server wire commands, as recorded by
+// utils::WireCaptureSerializer, to a wire server as fast as possible and reports the time spent
+// decoding and executing each frame.
+
+#include "common/Platform.h"
+#include "utils/BackendBinding.h"
+#include "utils/WireCapture.h"
+
+#include <dawn/dawn.h>
+#include <dawn_native/DawnNative.h>
+#include <dawn_wire/Wire.h>
+#include "GLFW/glfw3.h"
+
+#if defined(DAWN_PLATFORM_WINDOWS)
+#    include <Windows.h>
+#elif defined(DAWN_PLATFORM_POSIX)
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#else
+#    error "Unsupported platform."
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+    // A read-only memory mapping of a whole file.
+    class MappedFile {
+      public:
+        ~MappedFile() {
+#if defined(DAWN_PLATFORM_WINDOWS)
+            if (mData != nullptr) {
+                UnmapViewOfFile(mData);
+            }
+            if (mMapping != nullptr) {
+                CloseHandle(mMapping);
+            }
+            if (mFile != INVALID_HANDLE_VALUE) {
+                CloseHandle(mFile);
+            }
+#elif defined(DAWN_PLATFORM_POSIX)
+            if (mData != nullptr) {
+                munmap(const_cast<char*>(mData), mSize);
+            }
+#endif
+        }
+
+        bool Open(const char* path) {
+#if defined(DAWN_PLATFORM_WINDOWS)
+            mFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (mFile == INVALID_HANDLE_VALUE) {
+                return false;
+            }
+
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(mFile, &size) || size.QuadPart == 0) {
+                return false;
+            }
+            mSize = static_cast<size_t>(size.QuadPart);
+
+            mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mMapping == nullptr) {
+                return false;
+            }
+            mData = static_cast<const char*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+            return mData != nullptr;
+#elif defined(DAWN_PLATFORM_POSIX)
+            int fd = open(path, O_RDONLY);
+            if (fd < 0) {
+                return false;
+            }
+
+            struct stat fileStat;
+            if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+                close(fd);
+                return false;
+            }
+            mSize = static_cast<size_t>(fileStat.st_size);
+
+            void* data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (data == MAP_FAILED) {
+                return false;
+            }
+            mData = static_cast<const char*>(data);
+            return true;
+#endif
+        }
+
+        const char* GetData() const {
+            return mData;
+        }
+        size_t GetSize() const {
+            return mSize;
+        }
+
+      private:
+        const char* mData = nullptr;
+        size_t mSize = 0;
+#if defined(DAWN_PLATFORM_WINDOWS)
+        HANDLE mFile = INVALID_HANDLE_VALUE;
+        HANDLE mMapping = nullptr;
+#endif
+    };
+
+    // The replies of the server aren't needed for the replay so they are dropped.
+    class DiscardSerializer : public dawn_wire::CommandSerializer {
+      public:
+        void* GetCmdSpace(size_t size) override {
+            if (mBuffer.size() < size) {
+                mBuffer.resize(size);
+            }
+            return mBuffer.data();
+        }
+        bool Flush() override {
+            return true;
+        }
+
+      private:
+        std::vector<char> mBuffer;
+    };
+
+    struct FrameTimings {
+        size_t bytes = 0;
+        uint64_t decodeNanoseconds = 0;
+        uint64_t executeNanoseconds = 0;
+        uint64_t totalNanoseconds = 0;
+    };
+
+    struct ReplayOptions {
+        const char* capturePath = nullptr;
+        utils::BackendType backendType = utils::BackendType::Null;
+        dawn_wire::ServerOptions serverOptions;
+        unsigned int repeatCount = 1;
+        bool printFrames = false;
+    };
+
+    double ToMilliseconds(uint64_t nanoseconds) {
+        return static_cast<double>(nanoseconds) / 1000000.0;
+    }
+
+    // Replays the whole capture on a new server and appends the timings of each frame.
+    bool Replay(const ReplayOptions& options,
+                const MappedFile& capture,
+                dawnDevice device,
+                const dawnProcTable& procs,
+                std::vector<FrameTimings>* frames) {
+        DiscardSerializer replies;
+        std::unique_ptr<dawn_wire::ServerCommandHandler> server(
+            dawn_wire::NewServerCommandHandler(device, procs, &replies, options.serverOptions));
+
+        utils::WireCaptureReader reader(capture.GetData(), capture.GetSize());
+        FrameTimings frame;
+        dawn_wire::ServerCounters frameStart = server->GetCounters();
+
+        utils::WireCaptureRecordType type;
+        const char* payload;
+        size_t size;
+        while (reader.Next(&type, &payload, &size)) {
+            switch (type) {
+                case utils::WireCaptureRecordType::Commands: {
+                    auto start = std::chrono::steady_clock::now();
+                    if (server->HandleCommands(payload, size) == nullptr) {
+                        fprintf(stderr, "The server failed to handle commands of frame %zu\n",
+                                frames->size());
+                        return false;
+                    }
+                    auto elapsed = std::chrono::steady_clock::now() - start;
+
+                    frame.bytes += size;
+                    frame.totalNanoseconds += static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+                } break;
+
+                case utils::WireCaptureRecordType::EndFrame: {
+                    dawn_wire::ServerCounters frameEnd = server->GetCounters();
+                    frame.decodeNanoseconds =
+                        frameEnd.decodeNanoseconds - frameStart.decodeNanoseconds;
+                    frame.executeNanoseconds =
+                        frameEnd.executeNanoseconds - frameStart.executeNanoseconds;
+                    frames->push_back(frame);
+
+                    frame = FrameTimings();
+                    frameStart = frameEnd;
+                } break;
+
+                default:
+                    fprintf(stderr, "Unknown capture record type %u\n",
+                            static_cast<uint32_t>(type));
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    void PrintSummary(const char* name, std::vector<uint64_t> values) {
+        if (values.empty()) {
+            return;
+        }
+        std::sort(values.begin(), values.end());
+
+        uint64_t sum = 0;
+        for (uint64_t value : values) {
+            sum += value;
+        }
+
+        printf("%-8s mean %8.3f ms  median %8.3f ms  p99 %8.3f ms  max %8.3f ms\n", name,
+               ToMilliseconds(sum / values.size()), ToMilliseconds(values[values.size() / 2]),
+               ToMilliseconds(values[(values.size() * 99) / 100]), ToMilliseconds(values.back()));
+    }
+
+    bool ParseBackend(const std::string& name, utils::BackendType* type) {
+        if (name == "d3d12") {
+            *type = utils::BackendType::D3D12;
+        } else if (name == "metal") {
+            *type = utils::BackendType::Metal;
+        } else if (name == "null") {
+            *type = utils::BackendType::Null;
+        } else if (name == "opengl") {
+            *type = utils::BackendType::OpenGL;
+        } else if (name == "vulkan") {
+            *type = utils::BackendType::Vulkan;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    void PrintUsage(const char* program) {
+        printf("Usage: %s [-b BACKEND] [-r REPEAT] [--decode-batch-size SIZE] [--frames] CAPTURE\n",
+               program);
+        printf("  BACKEND is one of: d3d12, metal, null, opengl, vulkan (default: null)\n");
+        printf("  REPEAT is the number of times the capture is replayed (default: 1)\n");
+        printf("  SIZE is the minimum batch size decoded on a separate thread, 0 disables it\n");
+        printf("  --frames prints the timings of every frame\n");
+    }
+
+    bool ParseOptions(int argc, const char** argv, ReplayOptions* options) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if ((arg == "-b" || arg == "--backend") && i + 1 < argc) {
+                if (!ParseBackend(argv[++i], &options->backendType)) {
+                    fprintf(stderr, "--backend expects a backend name (d3d12, metal, null, opengl, vulkan)\n");
+                    return false;
+                }
+            } else if ((arg == "-r" || arg == "--repeat") && i + 1 < argc) {
+                options->repeatCount = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+            } else if (arg == "--decode-batch-size" && i + 1 < argc) {
+                options->serverOptions.pipelinedDecodeMinBatchSize =
+                    static_cast<size_t>(strtoull(argv[++i], nullptr, 10));
+            } else if (arg == "--frames") {
+                options->printFrames = true;
+            } else if (arg == "-h" || arg == "--help") {
+                PrintUsage(argv[0]);
+                return false;
+            } else if (options->capturePath == nullptr) {
+                options->capturePath = argv[i];
+            } else {
+                PrintUsage(argv[0]);
+                return false;
+            }
+        }
+
+        if (options->capturePath == nullptr) {
+            PrintUsage(argv[0]);
+            return false;
+        }
+        return true;
+    }
+
+}  // anonymous namespace
+
+int main(int argc, const char** argv) {
+    ReplayOptions options;
+    options.serverOptions.collectTimings = true;
+    if (!ParseOptions(argc, argv, &options)) {
+        return 1;
+    }
+
+    MappedFile capture;
+    if (!capture.Open(options.capturePath)) {
+        fprintf(stderr, "Couldn't map %s\n", options.capturePath);
+        return 1;
+    }
+    if (!utils::WireCaptureReader(capture.GetData(), capture.GetSize()).IsValid()) {
+        fprintf(stderr, "%s isn't a wire capture made with the encoding of this build\n",
+                options.capturePath);
+        return 1;
+    }
+
+    std::unique_ptr<utils::BackendBinding> binding(utils::CreateBinding(options.backendType));
+    if (binding == nullptr) {
+        fprintf(stderr, "The backend isn't available in this build\n");
+        return 1;
+    }
+
+    // Backends other than the null backend can need a window to create their device.
+    GLFWwindow* window = nullptr;
+    if (options.backendType != utils::BackendType::Null) {
+        if (!glfwInit()) {
+            return 1;
+        }
+        binding->SetupGLFWWindowHints();
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        window = glfwCreateWindow(640, 480, "dawn_wire_replay", nullptr, nullptr);
+        if (window == nullptr) {
+            return 1;
+        }
+        binding->SetWindow(window);
+    }
+
+    dawnProcTable procs = dawn_native::GetProcs();
+
+    std::vector<FrameTimings> frames;
+    for (unsigned int i = 0; i < options.repeatCount; ++i) {
+        // Each replay starts from a new device because the capture creates its objects from
+        // scratch.
+        dawnDevice device = binding->CreateDevice();
+        bool success = Replay(options, capture, device, procs, &frames);
+        procs.deviceRelease(device);
+        if (!success) {
+            return 1;
+        }
+    }
+
+    std::vector<uint64_t> decode;
+    std::vector<uint64_t> execute;
+    std::vector<uint64_t> total;
+    size_t bytes = 0;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        const FrameTimings& frame = frames[i];
+        if (options.printFrames) {
+            printf("frame %6zu: %10zu bytes  decode %8.3f ms  execute %8.3f ms  total %8.3f ms\n",
+                   i, frame.bytes, ToMilliseconds(frame.decodeNanoseconds),
+                   ToMilliseconds(frame.executeNanoseconds), ToMilliseconds(frame.totalNanoseconds));
+        }
+
+        decode.push_back(frame.decodeNanoseconds);
+        execute.push_back(frame.executeNanoseconds);
+        total.push_back(frame.totalNanoseconds);
+        bytes += frame.bytes;
+    }
+
+    printf("%zu frames, %zu bytes\n", frames.size(), bytes);
+    PrintSummary("decode", decode);
+    PrintSummary("execute", execute);
+    PrintSummary("total", total);
+
+    if (window != nullptr) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
+    return 0;
+}
@@ -14,10 +14,32 @@
 
 #include "utils/BackendBinding.h"
 
+#include "common/SwapChainUtils.h"
 #include "dawn_native/NullBackend.h"
 
 namespace utils {
 
+    // The null backend creates the swap chain textures itself so there is nothing to present.
+    class SwapChainImplNull {
+      public:
+        struct WSIContext {};
+
+        void Init(WSIContext*) {
+        }
+
+        dawnSwapChainError Configure(dawnTextureFormat, dawnTextureUsageBit, uint32_t, uint32_t) {
+            return DAWN_SWAP_CHAIN_NO_ERROR;
+        }
+
+        dawnSwapChainError GetNextTexture(dawnSwapChainNextTexture*) {
+            return DAWN_SWAP_CHAIN_NO_ERROR;
+        }
+
+        dawnSwapChainError Present() {
+            return DAWN_SWAP_CHAIN_NO_ERROR;
+        }
+    };
+
     class NullBinding : public BackendBinding {
       public:
         void SetupGLFWWindowHints() override {
@@ -26,11 +48,17 @@ namespace utils {
             return dawn_native::null::CreateDevice();
         }
         uint64_t GetSwapChainImplementation() override {
-            return 0;
+            if (mSwapchainImpl.userData == nullptr) {
+                mSwapchainImpl = CreateSwapChainImplementation(new SwapChainImplNull);
+            }
+            return reinterpret_cast<uint64_t>(&mSwapchainImpl);
         }
         dawnTextureFormat GetPreferredSwapChainTextureFormat() override {
             return DAWN_TEXTURE_FORMAT_R8_G8_B8_A8_UNORM;
         }
+
+      private:
+        dawnSwapChainImplementation mSwapchainImpl = {};
     };
 
     BackendBinding* CreateNullBinding() {
@@ -33,6 +33,7 @@ namespace utils {
         // TODO(kainino@chromium.org): Should we early-out if size is 0?
         //   (Here and/or in the caller?) It might be good to make the wire receiver get a nullptr
         //   instead of pointer to zero-sized allocation in mBuffer.
+        EndReservation();
 
         if (size > sizeof(mBuffer)) {
             return nullptr;
@@ -52,9 +53,35 @@ namespace utils {
     }
 
     bool TerribleCommandBuffer::Flush() {
+        EndReservation();
+
         bool success = mHandler->HandleCommands(mBuffer, mOffset) != nullptr;
         mOffset = 0;
         return success;
     }
 
+    dawn_wire::CommandSpaceReservation* TerribleCommandBuffer::ReserveCmdSpace(size_t minSize) {
+        EndReservation();
+
+        if (minSize > sizeof(mBuffer)) {
+            return nullptr;
+        }
+        if (minSize > sizeof(mBuffer) - mOffset && !Flush()) {
+            return nullptr;
+        }
+
+        // The rest of the buffer is reserved.
+        mReservation.cursor = &mBuffer[mOffset];
+        mReservation.end = &mBuffer[sizeof(mBuffer)];
+        return &mReservation;
+    }
+
+    void TerribleCommandBuffer::EndReservation() {
+        if (mReservation.cursor != nullptr) {
+            mOffset = static_cast<size_t>(mReservation.cursor - mBuffer);
+            mReservation.cursor = nullptr;
+            mReservation.end = nullptr;
+        }
+    }
+
 }  // namespace utils
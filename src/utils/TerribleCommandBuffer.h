@@ -30,10 +30,15 @@ namespace utils {
 
         void* GetCmdSpace(size_t size) override;
         bool Flush() override;
+        dawn_wire::CommandSpaceReservation* ReserveCmdSpace(size_t minSize) override;
 
       private:
+        // Takes the commands written in the reservation into account and ends it.
+        void EndReservation();
+
         dawn_wire::CommandHandler* mHandler = nullptr;
         size_t mOffset = 0;
+        dawn_wire::CommandSpaceReservation mReservation;
         char mBuffer[10000000];
     };
 
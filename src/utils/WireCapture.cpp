@@ -0,0 +1,154 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "utils/WireCapture.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace utils {
+
+    namespace {
+
+        size_t GetPaddingSize(uint64_t size) {
+            return static_cast<size_t>((kWireCaptureAlignment - size % kWireCaptureAlignment) %
+                                       kWireCaptureAlignment);
+        }
+
+    }  // anonymous namespace
+
+    // WireCaptureSerializer
+
+    WireCaptureSerializer::WireCaptureSerializer(dawn_wire::CommandSerializer* serializer,
+                                                 const char* path)
+        : mSerializer(serializer) {
+        mFile = fopen(path, "wb");
+        if (mFile == nullptr) {
+            return;
+        }
+
+        WireCaptureHeader header;
+        memcpy(header.magic, kWireCaptureMagic, sizeof(header.magic));
+        header.version = kWireCaptureVersion;
+        header.flags = 0;
+        fwrite(&header, sizeof(header), 1, mFile);
+    }
+
+    WireCaptureSerializer::~WireCaptureSerializer() {
+        if (mFile != nullptr) {
+            CapturePendingCommands();
+            if (!mBatch.empty()) {
+                WriteRecord(WireCaptureRecordType::Commands, mBatch.data(), mBatch.size());
+            }
+            fclose(mFile);
+        }
+    }
+
+    bool WireCaptureSerializer::IsOpen() const {
+        return mFile != nullptr;
+    }
+
+    void* WireCaptureSerializer::GetCmdSpace(size_t size) {
+        CapturePendingCommands();
+
+        void* space = mSerializer->GetCmdSpace(size);
+        if (space != nullptr) {
+            mPendingCommands = static_cast<const char*>(space);
+            mPendingSize = size;
+        }
+        return space;
+    }
+
+    bool WireCaptureSerializer::Flush() {
+        CapturePendingCommands();
+        if (mFile != nullptr && !mBatch.empty()) {
+            WriteRecord(WireCaptureRecordType::Commands, mBatch.data(), mBatch.size());
+        }
+        mBatch.clear();
+
+        return mSerializer->Flush();
+    }
+
+    bool WireCaptureSerializer::EndFrame() {
+        bool success = Flush();
+        if (mFile != nullptr) {
+            WriteRecord(WireCaptureRecordType::EndFrame, nullptr, 0);
+        }
+        return success;
+    }
+
+    void WireCaptureSerializer::CapturePendingCommands() {
+        if (mPendingCommands != nullptr) {
+            mBatch.insert(mBatch.end(), mPendingCommands, mPendingCommands + mPendingSize);
+            mPendingCommands = nullptr;
+            mPendingSize = 0;
+        }
+    }
+
+    void WireCaptureSerializer::WriteRecord(WireCaptureRecordType type,
+                                            const char* data,
+                                            size_t size) {
+        WireCaptureRecord record;
+        record.type = type;
+        record.padding = 0;
+        record.size = size;
+        fwrite(&record, sizeof(record), 1, mFile);
+
+        if (size != 0) {
+            static constexpr char kZeroes[kWireCaptureAlignment] = {};
+            fwrite(data, 1, size, mFile);
+            fwrite(kZeroes, 1, GetPaddingSize(size), mFile);
+        }
+    }
+
+    // WireCaptureReader
+
+    WireCaptureReader::WireCaptureReader(const char* data, size_t size)
+        : mData(data), mSize(size), mOffset(sizeof(WireCaptureHeader)) {
+    }
+
+    bool WireCaptureReader::IsValid() const {
+        if (mSize < sizeof(WireCaptureHeader)) {
+            return false;
+        }
+
+        WireCaptureHeader header;
+        memcpy(&header, mData, sizeof(header));
+        return memcmp(header.magic, kWireCaptureMagic, sizeof(header.magic)) == 0 &&
+               header.version == kWireCaptureVersion && header.flags == 0;
+    }
+
+    bool WireCaptureReader::Next(WireCaptureRecordType* type, const char** payload, size_t* size) {
+        if (mOffset > mSize || mSize - mOffset < sizeof(WireCaptureRecord)) {
+            return false;
+        }
+
+        WireCaptureRecord record;
+        memcpy(&record, mData + mOffset, sizeof(record));
+        mOffset += sizeof(record);
+
+        if (record.size > mSize - mOffset) {
+            return false;
+        }
+
+        *type = record.type;
+        *payload = mData + mOffset;
+        *size = static_cast<size_t>(record.size);
+
+        // The last record can omit its padding.
+        mOffset += std::min(*size + GetPaddingSize(record.size), mSize - mOffset);
+        return true;
+    }
+
+}  // namespace utils
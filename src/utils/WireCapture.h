@@ -0,0 +1,101 @@
+// Copyright 2018 The Dawn Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef UTILS_WIRECAPTURE_H_
+#define UTILS_WIRECAPTURE_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "dawn_wire/Wire.h"
+
+namespace utils {
+
+    // A wire capture is a WireCaptureHeader followed by records. Each record is a
+    // WireCaptureRecord followed by its payload, padded to kWireCaptureAlignment bytes so that
+    // commands read from a memory-mapped capture are aligned like in a CommandSerializer.
+    static constexpr char kWireCaptureMagic[8] = {'D', 'A', 'W', 'N', 'W', 'I', 'R', 'E'};
+    // Incremented when the encoding of the commands changes, so old captures are rejected.
+    static constexpr uint32_t kWireCaptureVersion = 2;
+    static constexpr size_t kWireCaptureAlignment = 8;
+
+    struct WireCaptureHeader {
+        char magic[8];
+        uint32_t version;
+        // Reserved, must be 0.
+        uint32_t flags;
+    };
+
+    enum class WireCaptureRecordType : uint32_t {
+        // A batch of commands, as given to CommandHandler::HandleCommands.
+        Commands = 0,
+        // The end of a frame, without payload.
+        EndFrame = 1,
+    };
+
+    struct WireCaptureRecord {
+        WireCaptureRecordType type;
+        uint32_t padding;
+        uint64_t size;
+    };
+
+    // Forwards the commands to another serializer and writes a copy of them in a capture file.
+    class WireCaptureSerializer : public dawn_wire::CommandSerializer {
+      public:
+        WireCaptureSerializer(dawn_wire::CommandSerializer* serializer, const char* path);
+        ~WireCaptureSerializer();
+
+        bool IsOpen() const;
+
+        void* GetCmdSpace(size_t size) override;
+        bool Flush() override;
+
+        // Flushes and marks the end of a frame in the capture.
+        bool EndFrame();
+
+      private:
+        void CapturePendingCommands();
+        void WriteRecord(WireCaptureRecordType type, const char* data, size_t size);
+
+        dawn_wire::CommandSerializer* mSerializer;
+        FILE* mFile = nullptr;
+
+        // The space returned by the last GetCmdSpace is only filled after the call, so it is
+        // copied in the batch on the next call.
+        const char* mPendingCommands = nullptr;
+        size_t mPendingSize = 0;
+        std::vector<char> mBatch;
+    };
+
+    // Iterates over the records of a capture held in memory.
+    class WireCaptureReader {
+      public:
+        WireCaptureReader(const char* data, size_t size);
+
+        // Returns false if the header doesn't match captures made by this build.
+        bool IsValid() const;
+
+        // Gets the next record, returns false at the end of the capture or if it is truncated.
+        bool Next(WireCaptureRecordType* type, const char** payload, size_t* size);
+
+      private:
+        const char* mData;
+        size_t mSize;
+        size_t mOffset = 0;
+    };
+
+}  // namespace utils
+
+#endif  // UTILS_WIRECAPTURE_H_